@@ -0,0 +1,89 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * CommandLineCompiler converts an SVG file into the serialized form that
+ * MSCDocumentCreateFromSerializedData loads without parsing.
+ *
+ * Usage:
+ * $ CommandLineCompiler svg_file output_file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MetroSVG/MetroSVG.h"
+
+int main(int argc, const char *argv[]) {
+  int status = 0;
+  FILE *file = 0;
+  char *data = 0;
+  long data_length = 0;
+  MSCDocument *document = 0;
+  char *serialized_data = 0;
+  size_t serialized_length = 0;
+
+  do {
+    if (argc < 3) {
+      status = 4;
+      fprintf(stderr, "Too few arguments.\n");
+      break;
+    }
+
+    file = fopen(argv[1], "rb");
+    if (!file ||
+        fseek(file, 0, SEEK_END) != 0 ||
+        (data_length = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET) != 0 ||
+        !(data = malloc(data_length > 0 ? data_length : 1)) ||
+        fread(data, 1, data_length, file) != (size_t)data_length) {
+      status = 3;
+      fprintf(stderr, "Can't read input.\n");
+      break;
+    }
+    fclose(file);
+    file = 0;
+
+    document = MSCDocumentCreateFromData(data, data_length, NULL);
+    if (!document ||
+        !MSCDocumentCopySerializedData(document,
+                                       &serialized_data,
+                                       &serialized_length)) {
+      status = 1;
+      fprintf(stderr, "Error in parsing SVG.\n");
+      break;
+    }
+
+    file = fopen(argv[2], "wb");
+    if (!file ||
+        fwrite(serialized_data, 1, serialized_length, file) !=
+            serialized_length ||
+        fclose(file) != 0) {
+      file = 0;
+      status = 2;
+      fprintf(stderr, "Can't write output.\n");
+      break;
+    }
+    file = 0;
+  } while (0);
+
+  if (file) fclose(file);
+  if (document) MSCDocumentDelete(document);
+  free(data);
+  free(serialized_data);
+
+  return status;
+}
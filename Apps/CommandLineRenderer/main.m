@@ -15,6 +15,7 @@
  */
 
 #include <Foundation/Foundation.h>
+#include <unistd.h>
 
 #include "MetroSVG/MetroSVG.h"
 
@@ -31,16 +32,13 @@ int main(int argc, const char *argv[]) {
       break;
     }
 
-    NSString *inputFile = [NSString stringWithCString:argv[1]
-                                             encoding:NSUTF8StringEncoding];
-    NSData *data = [NSData dataWithContentsOfFile:inputFile];
-    if (!data) {
+    if (access(argv[1], R_OK) != 0) {
       status = 3;
       fprintf(stderr, "Can't read input.\n");
       break;
     }
 
-    document = MSCDocumentCreateFromData([data bytes], [data length], NULL);
+    document = MSCDocumentCreateFromFile(argv[1]);
     if (!document) {
       status = 1;
       fprintf(stderr, "Error in parsing SVG.\n");
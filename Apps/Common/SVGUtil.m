@@ -21,8 +21,7 @@
 @implementation SVGUtil
 
 + (CGImageRef)imageWithSVGFile:(NSString *)file size:(CGSize)size {
-  NSData *svgData = [NSData dataWithContentsOfFile:file];
-  MSCDocument *document = MSCDocumentCreateFromData([svgData bytes], [svgData length], "");
+  MSCDocument *document = MSCDocumentCreateFromFile([file fileSystemRepresentation]);
   CGImageRef image = MSCDocumentCreateCGImage(document, size, NULL);
   MSCDocumentDelete(document);
   return image;
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * SoftwareRenderer renders an SVG file with the built-in software renderer
+ * into a PAM file, which needs no image library to write. The image is
+ * rendered at its intrinsic size unless a size is given.
+ *
+ * Usage:
+ * $ SoftwareRenderer svg_file output_file [width height]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MetroSVG/MetroSVG.h"
+
+int main(int argc, const char *argv[]) {
+  int status = 0;
+  MSCDocument *document = 0;
+  MSCSize size;
+  size_t width = 0;
+  size_t height = 0;
+  unsigned char *pixels = 0;
+  FILE *file = 0;
+  size_t i;
+
+  do {
+    if (argc < 3 || argc == 4) {
+      status = 4;
+      fprintf(stderr, "Too few arguments.\n");
+      break;
+    }
+
+    document = MSCDocumentCreateFromFile(argv[1]);
+    if (!document) {
+      status = 1;
+      fprintf(stderr, "Error in parsing SVG.\n");
+      break;
+    }
+
+    if (argc > 4) {
+      size.width = atof(argv[3]);
+      size.height = atof(argv[4]);
+    } else {
+      size = MSCDocumentGetImageSize(document);
+    }
+    if (!(size.width >= 1 && size.height >= 1)) {
+      status = 4;
+      fprintf(stderr, "Invalid image size.\n");
+      break;
+    }
+    width = (size_t)size.width;
+    height = (size_t)size.height;
+
+    MSCSetRenderingBackend(kMSCRenderingBackendSoftware);
+    pixels = malloc(width * height * 4);
+    if (!pixels ||
+        !MSCDocumentRenderToBuffer(document, size, NULL, pixels, width * 4,
+                                   kMSCPixelFormatRGBA8888)) {
+      status = 1;
+      fprintf(stderr, "Error in parsing SVG.\n");
+      break;
+    }
+
+    // PAM expects straight alpha.
+    for (i = 0; i < width * height; ++i) {
+      unsigned char *pixel = pixels + i * 4;
+      if (pixel[3] != 0 && pixel[3] != 255) {
+        pixel[0] = (unsigned char)((pixel[0] * 255 + pixel[3] / 2) / pixel[3]);
+        pixel[1] = (unsigned char)((pixel[1] * 255 + pixel[3] / 2) / pixel[3]);
+        pixel[2] = (unsigned char)((pixel[2] * 255 + pixel[3] / 2) / pixel[3]);
+      }
+    }
+
+    file = fopen(argv[2], "wb");
+    if (!file ||
+        fprintf(file,
+                "P7\nWIDTH %zu\nHEIGHT %zu\nDEPTH 4\nMAXVAL 255\n"
+                "TUPLTYPE RGB_ALPHA\nENDHDR\n",
+                width, height) < 0 ||
+        fwrite(pixels, 4, width * height, file) != width * height ||
+        fclose(file) != 0) {
+      file = 0;
+      status = 2;
+      fprintf(stderr, "Can't write output.\n");
+      break;
+    }
+    file = 0;
+  } while (0);
+
+  if (file) fclose(file);
+  if (document) MSCDocumentDelete(document);
+  free(pixels);
+
+  return status;
+}
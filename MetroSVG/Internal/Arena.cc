@@ -0,0 +1,134 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// The memory of a block starts after its header, aligned for any type.
+const size_t kBlockHeaderSize =
+    (sizeof(void *) * 2 + alignof(std::max_align_t) - 1) &
+    ~(alignof(std::max_align_t) - 1);
+
+}  // namespace
+
+const size_t Arena::kDefaultBlockSize;
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size),
+      block_(NULL),
+      next_(NULL),
+      end_(NULL),
+      retired_bytes_(0),
+      cleanup_(NULL) {
+  static_assert(sizeof(Block) <= kBlockHeaderSize, "Block header too big");
+}
+
+Arena::~Arena() {
+  Reset();
+  FreeBlocks();
+}
+
+void *Arena::Allocate(size_t size, size_t alignment) {
+  size_t padding = -reinterpret_cast<uintptr_t>(next_) & (alignment - 1);
+  if (block_ == NULL ||
+      static_cast<size_t>(end_ - next_) < padding + size) {
+    AddBlock(size);
+    padding = 0;
+  }
+  char *result = next_ + padding;
+  next_ = result + size;
+  return result;
+}
+
+void Arena::Reset() {
+  while (cleanup_ != NULL) {
+    Cleanup *cleanup = cleanup_;
+    cleanup_ = cleanup->previous;
+    cleanup->destroy(cleanup->object);
+  }
+  if (block_ == NULL) {
+    return;
+  }
+  if (block_->previous != NULL) {
+    // Replace the blocks with one that holds as much.
+    size_t total_size = 0;
+    for (Block *block = block_; block != NULL; block = block->previous) {
+      total_size += block->size;
+    }
+    FreeBlocks();
+    AddBlock(total_size);
+  }
+  next_ = reinterpret_cast<char *>(block_) + kBlockHeaderSize;
+  retired_bytes_ = 0;
+}
+
+size_t Arena::used_bytes() const {
+  if (block_ == NULL) {
+    return 0;
+  }
+  return retired_bytes_ +
+      (next_ - (reinterpret_cast<char *>(block_) + kBlockHeaderSize));
+}
+
+size_t Arena::block_count() const {
+  size_t count = 0;
+  for (Block *block = block_; block != NULL; block = block->previous) {
+    ++count;
+  }
+  return count;
+}
+
+void Arena::AddCleanup(void *object, void (*destroy)(void *object)) {
+  Cleanup *cleanup =
+      static_cast<Cleanup *>(Allocate(sizeof(Cleanup), alignof(Cleanup)));
+  cleanup->previous = cleanup_;
+  cleanup->object = object;
+  cleanup->destroy = destroy;
+  cleanup_ = cleanup;
+}
+
+void Arena::AddBlock(size_t min_size) {
+  retired_bytes_ = used_bytes();
+  size_t size = std::max(block_size_, min_size);
+  Block *block =
+      static_cast<Block *>(::operator new(kBlockHeaderSize + size));
+  block->previous = block_;
+  block->size = size;
+  block_ = block;
+  next_ = reinterpret_cast<char *>(block) + kBlockHeaderSize;
+  end_ = next_ + size;
+}
+
+void Arena::FreeBlocks() {
+  while (block_ != NULL) {
+    Block *previous = block_->previous;
+    ::operator delete(block_);
+    block_ = previous;
+  }
+  next_ = NULL;
+  end_ = NULL;
+  retired_bytes_ = 0;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
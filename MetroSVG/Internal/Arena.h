@@ -0,0 +1,137 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+// Arena hands out memory for objects that live until the arena is reset,
+// e.g., the transient state of a render. Allocating is a pointer bump in
+// the current block, and all the memory is released at once by Reset or
+// the destructor. After a Reset, the arena keeps a single block big enough
+// for everything allocated before, so repeating the same work on the same
+// arena doesn't allocate from the heap again.
+// Arena is not thread-safe.
+class Arena {
+ public:
+  static const size_t kDefaultBlockSize = 4096;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of
+  // two no greater than alignof(std::max_align_t).
+  void *Allocate(size_t size, size_t alignment);
+
+  // Constructs a T in the arena. Its destructor, if not trivial, runs
+  // when the arena is reset or destroyed, in the reverse order of
+  // construction.
+  template<typename T, typename... Args>
+  T *New(Args&&... args) {
+    void *memory = Allocate(sizeof(T), alignof(T));
+    T *object = new(memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      AddCleanup(object, &Destroy<T>);
+    }
+    return object;
+  }
+
+  // Runs the pending destructors and makes all the memory available again.
+  void Reset();
+
+  // Bytes handed out since the last reset, including alignment padding.
+  size_t used_bytes() const;
+  // Number of blocks that the arena currently holds.
+  size_t block_count() const;
+
+ private:
+  struct Block {
+    Block *previous;
+    size_t size;
+    // Followed by |size| bytes of memory.
+  };
+
+  struct Cleanup {
+    Cleanup *previous;
+    void *object;
+    void (*destroy)(void *object);
+  };
+
+  template<typename T>
+  static void Destroy(void *object) {
+    static_cast<T *>(object)->~T();
+  }
+
+  size_t block_size_;
+  // The most recently added block, whose memory [next_, end_) is free.
+  Block *block_;
+  char *next_;
+  char *end_;
+  // Bytes of the blocks before |block_| that were handed out.
+  size_t retired_bytes_;
+  Cleanup *cleanup_;
+
+  void AddCleanup(void *object, void (*destroy)(void *object));
+  void AddBlock(size_t min_size);
+  void FreeBlocks();
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// ArenaAllocator lets standard containers allocate from an arena. Memory
+// given back by a container is only reclaimed when the arena is reset, so
+// containers that grow a lot are better reserved up front. The containers
+// must not be used after the arena is reset.
+template<typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(Arena *arena) : arena_(arena) {}
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *p, size_t n) {}
+
+  Arena *arena() const { return arena_; }
+
+ private:
+  Arena *arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() != b.arena();
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <XCTest/XCTest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "MetroSVG/Internal/Arena.h"
+
+using namespace metrosvg::internal;
+
+// Appends its id to a log when destroyed.
+struct LoggingObject {
+  std::vector<int> *log;
+  int id;
+
+  LoggingObject(std::vector<int> *log_in, int id_in)
+      : log(log_in), id(id_in) {}
+  ~LoggingObject() { log->push_back(id); }
+};
+
+@interface ArenaTest : XCTestCase
+@end
+
+@implementation ArenaTest
+
+- (void)testAllocate_Alignment {
+  Arena arena(64);
+  XCTAssertEqual(arena.block_count(), 0U);
+  arena.Allocate(1, 1);
+  void *p = arena.Allocate(8, 8);
+  XCTAssertEqual(reinterpret_cast<uintptr_t>(p) % 8, 0U);
+  XCTAssertEqual(arena.used_bytes(), 16U);
+  XCTAssertEqual(arena.block_count(), 1U);
+}
+
+- (void)testAllocate_AddsBlocks {
+  Arena arena(64);
+  char *a = static_cast<char *>(arena.Allocate(40, 1));
+  char *b = static_cast<char *>(arena.Allocate(40, 1));
+  XCTAssertEqual(arena.block_count(), 2U);
+  XCTAssert(b < a || b >= a + 40);
+  // Larger than a block.
+  arena.Allocate(1000, 1);
+  XCTAssertEqual(arena.block_count(), 3U);
+  XCTAssertEqual(arena.used_bytes(), 1080U);
+}
+
+- (void)testReset_ReusesMemory {
+  Arena arena(64);
+  for (int i = 0; i < 10; ++i) {
+    arena.Allocate(40, 8);
+  }
+  XCTAssertEqual(arena.block_count(), 10U);
+  arena.Reset();
+  XCTAssertEqual(arena.used_bytes(), 0U);
+  XCTAssertEqual(arena.block_count(), 1U);
+  // The same allocations fit in the block kept by Reset.
+  for (int i = 0; i < 10; ++i) {
+    arena.Allocate(40, 8);
+  }
+  XCTAssertEqual(arena.block_count(), 1U);
+  XCTAssertEqual(arena.used_bytes(), 400U);
+}
+
+- (void)testNew_DestroysOnReset {
+  std::vector<int> log;
+  Arena arena;
+  LoggingObject *first = arena.New<LoggingObject>(&log, 1);
+  arena.New<LoggingObject>(&log, 2);
+  XCTAssertEqual(first->id, 1);
+  XCTAssertEqual(log.size(), 0U);
+  arena.Reset();
+  XCTAssert(log == std::vector<int>({2, 1}));
+
+  arena.New<LoggingObject>(&log, 3);
+  arena.Reset();
+  arena.Reset();
+  XCTAssert(log == std::vector<int>({2, 1, 3}));
+}
+
+- (void)testNew_DestroysWithArena {
+  std::vector<int> log;
+  {
+    Arena arena;
+    arena.New<LoggingObject>(&log, 1);
+  }
+  XCTAssert(log == std::vector<int>({1}));
+}
+
+- (void)testArenaAllocator {
+  Arena arena;
+  std::vector<int, ArenaAllocator<int>> values((ArenaAllocator<int>(&arena)));
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(i);
+  }
+  XCTAssertEqual(values[99], 99);
+  XCTAssertGreaterThanOrEqual(arena.used_bytes(), 100 * sizeof(int));
+}
+
+@end
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Atom.h"
+
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Indexed by Atom.
+const char *const kAtomNames[] = {
+  "",
+  "circle",
+  "ellipse",
+  "g",
+  "line",
+  "linearGradient",
+  "path",
+  "polygon",
+  "polyline",
+  "radialGradient",
+  "rect",
+  "stop",
+  "style",
+  "svg",
+  "class",
+  "cx",
+  "cy",
+  "d",
+  "fx",
+  "fy",
+  "gradientTransform",
+  "gradientUnits",
+  "height",
+  "id",
+  "offset",
+  "points",
+  "preserveAspectRatio",
+  "r",
+  "rx",
+  "ry",
+  "type",
+  "viewBox",
+  "width",
+  "x",
+  "x1",
+  "x2",
+  "y",
+  "y1",
+  "y2",
+  "display",
+  "fill",
+  "fill-opacity",
+  "fill-rule",
+  "opacity",
+  "stop-color",
+  "stop-opacity",
+  "stroke",
+  "stroke-dasharray",
+  "stroke-dashoffset",
+  "stroke-linecap",
+  "stroke-linejoin",
+  "stroke-miterlimit",
+  "stroke-opacity",
+  "stroke-width",
+  "transform",
+  "visibility",
+};
+
+static_assert(ARRAYSIZE(kAtomNames) == kAtomCount,
+              "kAtomNames must match Atom");
+
+// Of the known names, only one hashes to each slot. If a new name collides
+// with another one, the switch in FindAtom won't compile, and the offset
+// basis of AtomHash has to be changed.
+template<size_t N>
+constexpr uint8_t AtomSlot(const char (&name)[N]) {
+  return AtomHash(name, N - 1) >> 24;
+}
+
+}  // namespace
+
+Atom FindAtom(const StringPiece &name) {
+  Atom atom;
+  switch (AtomHash(name.begin(), name.length()) >> 24) {
+    case AtomSlot("circle"): atom = kAtomCircle; break;
+    case AtomSlot("ellipse"): atom = kAtomEllipse; break;
+    case AtomSlot("g"): atom = kAtomG; break;
+    case AtomSlot("line"): atom = kAtomLine; break;
+    case AtomSlot("linearGradient"): atom = kAtomLinearGradient; break;
+    case AtomSlot("path"): atom = kAtomPath; break;
+    case AtomSlot("polygon"): atom = kAtomPolygon; break;
+    case AtomSlot("polyline"): atom = kAtomPolyline; break;
+    case AtomSlot("radialGradient"): atom = kAtomRadialGradient; break;
+    case AtomSlot("rect"): atom = kAtomRect; break;
+    case AtomSlot("stop"): atom = kAtomStop; break;
+    case AtomSlot("style"): atom = kAtomStyle; break;
+    case AtomSlot("svg"): atom = kAtomSvg; break;
+    case AtomSlot("class"): atom = kAtomClass; break;
+    case AtomSlot("cx"): atom = kAtomCx; break;
+    case AtomSlot("cy"): atom = kAtomCy; break;
+    case AtomSlot("d"): atom = kAtomD; break;
+    case AtomSlot("fx"): atom = kAtomFx; break;
+    case AtomSlot("fy"): atom = kAtomFy; break;
+    case AtomSlot("gradientTransform"): atom = kAtomGradientTransform; break;
+    case AtomSlot("gradientUnits"): atom = kAtomGradientUnits; break;
+    case AtomSlot("height"): atom = kAtomHeight; break;
+    case AtomSlot("id"): atom = kAtomId; break;
+    case AtomSlot("offset"): atom = kAtomOffset; break;
+    case AtomSlot("points"): atom = kAtomPoints; break;
+    case AtomSlot("preserveAspectRatio"):
+      atom = kAtomPreserveAspectRatio;
+      break;
+    case AtomSlot("r"): atom = kAtomR; break;
+    case AtomSlot("rx"): atom = kAtomRx; break;
+    case AtomSlot("ry"): atom = kAtomRy; break;
+    case AtomSlot("type"): atom = kAtomType; break;
+    case AtomSlot("viewBox"): atom = kAtomViewBox; break;
+    case AtomSlot("width"): atom = kAtomWidth; break;
+    case AtomSlot("x"): atom = kAtomX; break;
+    case AtomSlot("x1"): atom = kAtomX1; break;
+    case AtomSlot("x2"): atom = kAtomX2; break;
+    case AtomSlot("y"): atom = kAtomY; break;
+    case AtomSlot("y1"): atom = kAtomY1; break;
+    case AtomSlot("y2"): atom = kAtomY2; break;
+    case AtomSlot("display"): atom = kAtomDisplay; break;
+    case AtomSlot("fill"): atom = kAtomFill; break;
+    case AtomSlot("fill-opacity"): atom = kAtomFillOpacity; break;
+    case AtomSlot("fill-rule"): atom = kAtomFillRule; break;
+    case AtomSlot("opacity"): atom = kAtomOpacity; break;
+    case AtomSlot("stop-color"): atom = kAtomStopColor; break;
+    case AtomSlot("stop-opacity"): atom = kAtomStopOpacity; break;
+    case AtomSlot("stroke"): atom = kAtomStroke; break;
+    case AtomSlot("stroke-dasharray"): atom = kAtomStrokeDasharray; break;
+    case AtomSlot("stroke-dashoffset"): atom = kAtomStrokeDashoffset; break;
+    case AtomSlot("stroke-linecap"): atom = kAtomStrokeLinecap; break;
+    case AtomSlot("stroke-linejoin"): atom = kAtomStrokeLinejoin; break;
+    case AtomSlot("stroke-miterlimit"): atom = kAtomStrokeMiterlimit; break;
+    case AtomSlot("stroke-opacity"): atom = kAtomStrokeOpacity; break;
+    case AtomSlot("stroke-width"): atom = kAtomStrokeWidth; break;
+    case AtomSlot("transform"): atom = kAtomTransform; break;
+    case AtomSlot("visibility"): atom = kAtomVisibility; break;
+    default:
+      return kAtomUnknown;
+  }
+  return name == kAtomNames[atom] ? atom : kAtomUnknown;
+}
+
+const char *AtomName(Atom atom) {
+  return kAtomNames[atom];
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MetroSVG/Internal/StringPiece.h"
+
+namespace metrosvg {
+namespace internal {
+
+// Atoms are small integers that stand for the element, attribute and
+// property names that MetroSVG knows, so that names are compared once
+// when they are read and dispatched on with switch statements afterwards.
+// A name used for both an element and an attribute, like "style", has one
+// atom.
+enum Atom {
+  kAtomUnknown = 0,
+
+  // Element names.
+  kAtomCircle,
+  kAtomEllipse,
+  kAtomG,
+  kAtomLine,
+  kAtomLinearGradient,
+  kAtomPath,
+  kAtomPolygon,
+  kAtomPolyline,
+  kAtomRadialGradient,
+  kAtomRect,
+  kAtomStop,
+  kAtomStyle,
+  kAtomSvg,
+
+  // Attribute names.
+  kAtomClass,
+  kAtomCx,
+  kAtomCy,
+  kAtomD,
+  kAtomFx,
+  kAtomFy,
+  kAtomGradientTransform,
+  kAtomGradientUnits,
+  kAtomHeight,
+  kAtomId,
+  kAtomOffset,
+  kAtomPoints,
+  kAtomPreserveAspectRatio,
+  kAtomR,
+  kAtomRx,
+  kAtomRy,
+  kAtomType,
+  kAtomViewBox,
+  kAtomWidth,
+  kAtomX,
+  kAtomX1,
+  kAtomX2,
+  kAtomY,
+  kAtomY1,
+  kAtomY2,
+
+  // Property names, which can be attributes as well.
+  kAtomDisplay,
+  kAtomFill,
+  kAtomFillOpacity,
+  kAtomFillRule,
+  kAtomOpacity,
+  kAtomStopColor,
+  kAtomStopOpacity,
+  kAtomStroke,
+  kAtomStrokeDasharray,
+  kAtomStrokeDashoffset,
+  kAtomStrokeLinecap,
+  kAtomStrokeLinejoin,
+  kAtomStrokeMiterlimit,
+  kAtomStrokeOpacity,
+  kAtomStrokeWidth,
+  kAtomTransform,
+  kAtomVisibility,
+
+  // Not an atom; the number of atoms above.
+  kAtomCount,
+};
+
+// Returns the atom of |name|, or kAtomUnknown if it isn't a known name.
+// Names are case-sensitive.
+Atom FindAtom(const StringPiece &name);
+
+// Returns the name that |atom| stands for, or "" for kAtomUnknown.
+const char *AtomName(Atom atom);
+
+// The hash that FindAtom uses to pick the only atom that |name| can be:
+// 32-bit FNV-1a with an offset basis chosen so that the top 8 bits differ
+// between all the known names. It's constexpr so that the values for the
+// known names are computed at compile time.
+constexpr uint32_t AtomHash(const char *name, size_t length,
+                            uint32_t hash = 2166136261u ^ 471u) {
+  return length == 0 ? hash :
+      AtomHash(name + 1, length - 1,
+               (hash ^ static_cast<uint8_t>(*name)) * 16777619u);
+}
+
+}  // namespace internal
+}  // namespace metrosvg
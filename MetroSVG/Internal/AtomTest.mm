@@ -0,0 +1,114 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <XCTest/XCTest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "MetroSVG/Internal/Atom.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+using namespace metrosvg::internal;
+
+// Returns 100000 names for the performance tests to classify, in the
+// proportions of a typical icon document and including a few that aren't
+// known.
+static std::vector<std::string> BenchmarkNames() {
+  static const char *const kNames[] = {
+    "path", "d", "fill", "g", "transform", "path", "d", "fill", "stroke",
+    "stroke-width", "circle", "cx", "cy", "r", "rect", "x", "y", "width",
+    "height", "rx", "style", "class", "id", "opacity", "stroke-linecap",
+    "stroke-linejoin", "linearGradient", "stop", "offset", "stop-color",
+    "xmlns", "version", "xlink:href", "enable-background",
+  };
+  std::vector<std::string> names;
+  for (int i = 0; i < 100000; ++i) {
+    names.push_back(kNames[i % (sizeof(kNames) / sizeof(kNames[0]))]);
+  }
+  return names;
+}
+
+@interface AtomTest : XCTestCase
+@end
+
+@implementation AtomTest
+
+- (void)testFindAtom {
+  XCTAssertEqual(FindAtom("circle"), kAtomCircle);
+  XCTAssertEqual(FindAtom("style"), kAtomStyle);
+  XCTAssertEqual(FindAtom("preserveAspectRatio"), kAtomPreserveAspectRatio);
+  XCTAssertEqual(FindAtom("stroke-dashoffset"), kAtomStrokeDashoffset);
+  XCTAssertEqual(FindAtom(StringPiece("y2 ", 2)), kAtomY2);
+}
+
+- (void)testFindAtom_AllNames {
+  for (int i = 1; i < kAtomCount; ++i) {
+    Atom atom = static_cast<Atom>(i);
+    XCTAssertEqual(FindAtom(AtomName(atom)), atom, @"%s", AtomName(atom));
+  }
+}
+
+- (void)testFindAtom_UnknownNames {
+  XCTAssertEqual(FindAtom(""), kAtomUnknown);
+  XCTAssertEqual(FindAtom("Cx"), kAtomUnknown);
+  XCTAssertEqual(FindAtom("viewbox"), kAtomUnknown);
+  XCTAssertEqual(FindAtom("stroke-"), kAtomUnknown);
+  XCTAssertEqual(FindAtom("fills"), kAtomUnknown);
+  XCTAssertEqual(FindAtom("text"), kAtomUnknown);
+  XCTAssertEqual(FindAtom("xlink:href"), kAtomUnknown);
+  XCTAssertEqual(FindAtom(StringPiece("circle", 5)), kAtomUnknown);
+}
+
+- (void)testPerformance_FindAtom {
+  std::vector<std::string> names = BenchmarkNames();
+  const std::vector<std::string> *names_pointer = &names;
+  [self measureBlock:^{
+    int known_count = 0;
+    for (const std::string &name : *names_pointer) {
+      known_count += FindAtom(name) != kAtomUnknown;
+    }
+    XCTAssertGreaterThan(known_count, 0);
+  }];
+}
+
+// The baseline for testPerformance_FindAtom: comparing each name with the
+// known names in turn.
+- (void)testPerformance_FindAtomByComparingNames {
+  std::vector<std::string> names = BenchmarkNames();
+  const std::vector<std::string> *names_pointer = &names;
+  [self measureBlock:^{
+    int known_count = 0;
+    for (const std::string &name : *names_pointer) {
+      for (int i = 1; i < kAtomCount; ++i) {
+        if (name == AtomName(static_cast<Atom>(i))) {
+          ++known_count;
+          break;
+        }
+      }
+    }
+    XCTAssertGreaterThan(known_count, 0);
+  }];
+}
+
+- (void)testAtomName {
+  XCTAssertEqual(strcmp(AtomName(kAtomUnknown), ""), 0);
+  XCTAssertEqual(strcmp(AtomName(kAtomLinearGradient), "linearGradient"), 0);
+  XCTAssertEqual(strcmp(AtomName(kAtomStopColor), "stop-color"), 0);
+}
+
+@end
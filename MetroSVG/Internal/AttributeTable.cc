@@ -0,0 +1,35 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/AttributeTable.h"
+
+#include "MetroSVG/Internal/BasicValueParsers.h"
+
+namespace metrosvg {
+namespace internal {
+
+bool AttributeTable::FloatValue(Atom attribute, Float *out_float) const {
+  const StringPiece *value = Find(attribute);
+  return value && ParseFloat(*value, out_float);
+}
+
+bool AttributeTable::LengthValue(Atom attribute, Length *out_length) const {
+  const StringPiece *value = Find(attribute);
+  return value && ParseLength(*value, out_length);
+}
+
+}  // namespace internal
+}  // namespace metrosvg
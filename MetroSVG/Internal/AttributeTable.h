@@ -0,0 +1,56 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "MetroSVG/Internal/Atom.h"
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+namespace metrosvg {
+namespace internal {
+
+// AttributeTable holds the values of the attributes of one element,
+// indexed by Atom. It's meant to live on the stack: it never allocates
+// memory, and the values point to strings owned by someone else, typically
+// the XML reader, which must outlive the table.
+class AttributeTable {
+ public:
+  AttributeTable() {}
+
+  // Returns the value of the attribute, or NULL if it isn't set.
+  const StringPiece *Find(Atom attribute) const {
+    const StringPiece &value = values_[attribute];
+    return value.begin() ? &value : NULL;
+  }
+
+  // |value| must not be a StringPiece with a NULL pointer.
+  void Set(Atom attribute, const StringPiece &value) {
+    values_[attribute] = value;
+  }
+
+  // Parse the value of the attribute into |out_float| or |out_length|.
+  // Return false if the attribute isn't set or can't be parsed.
+  bool FloatValue(Atom attribute, Float *out_float) const;
+  bool LengthValue(Atom attribute, Length *out_length) const;
+
+ private:
+  StringPiece values_[kAtomCount];
+};
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/AttributeTable.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+using namespace metrosvg::internal;
+
+@interface AttributeTableTest : XCTestCase
+@end
+
+@implementation AttributeTableTest
+
+- (void)testFindAndSet {
+  AttributeTable attributes;
+  XCTAssert(attributes.Find(kAtomD) == NULL);
+  attributes.Set(kAtomD, "M 0 0");
+  attributes.Set(kAtomId, "");
+  XCTAssert(attributes.Find(kAtomD) != NULL);
+  XCTAssertTrue(*attributes.Find(kAtomD) == "M 0 0");
+  // An empty value is still set.
+  XCTAssert(attributes.Find(kAtomId) != NULL);
+  XCTAssertEqual(attributes.Find(kAtomId)->length(), 0U);
+}
+
+- (void)testFloatAndLengthValues {
+  AttributeTable attributes;
+  attributes.Set(kAtomX, "1.5");
+  attributes.Set(kAtomWidth, "50%");
+  attributes.Set(kAtomY, "abc");
+
+  Float value = 0;
+  XCTAssertTrue(attributes.FloatValue(kAtomX, &value));
+  XCTAssertEqual(value, 1.5);
+  XCTAssertFalse(attributes.FloatValue(kAtomY, &value));
+  XCTAssertFalse(attributes.FloatValue(kAtomHeight, &value));
+
+  Length length;
+  XCTAssertTrue(attributes.LengthValue(kAtomWidth, &length));
+  XCTAssertEqual(length.value, 50);
+  XCTAssertEqual(length.unit, Length::kUnitPercent);
+  XCTAssertFalse(attributes.LengthValue(kAtomHeight, &length));
+}
+
+@end
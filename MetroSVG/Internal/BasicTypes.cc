@@ -21,7 +21,7 @@
 namespace metrosvg {
 namespace internal {
 
-RgbColor::RgbColor(CGFloat red, CGFloat green, CGFloat blue)
+RgbColor::RgbColor(Float red, Float green, Float blue)
     : red_(ClampToUnitRange(red)),
       green_(ClampToUnitRange(green)),
       blue_(ClampToUnitRange(blue)) {}
@@ -16,17 +16,13 @@
 
 #pragma once
 
-#include <map>
-#include <string>
 #include <vector>
 
-#include <CoreGraphics/CoreGraphics.h>
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
 
-typedef std::map<std::string, std::string> StringMap;
-
 // RgbColor represents a color in the RGB color space.
 // Intensity of each color component takes a value from 0.0 to 1.0.
 class RgbColor {
@@ -34,21 +30,21 @@ class RgbColor {
   RgbColor()
       : red_(0), green_(0), blue_(0) {}
 
-  RgbColor(CGFloat red, CGFloat green, CGFloat blue);
+  RgbColor(Float red, Float green, Float blue);
 
-  CGFloat red() const { return red_; }
-  void set_red(CGFloat red) { red_ = red; }
+  Float red() const { return red_; }
+  void set_red(Float red) { red_ = red; }
 
-  CGFloat green() const { return green_; }
-  void set_green(CGFloat green) { green_ = green; }
+  Float green() const { return green_; }
+  void set_green(Float green) { green_ = green; }
 
-  CGFloat blue() const { return blue_; }
-  void set_blue(CGFloat blue) { blue_ = blue; }
+  Float blue() const { return blue_; }
+  void set_blue(Float blue) { blue_ = blue; }
 
  private:
-  CGFloat red_;
-  CGFloat green_;
-  CGFloat blue_;
+  Float red_;
+  Float green_;
+  Float blue_;
 };
 
 struct Length {
@@ -66,18 +62,18 @@ struct Length {
     kUnitPx,
   };
 
-  CGFloat value;
+  Float value;
   Unit unit;
 
   Length()
       : value(0), unit(kUnitNone) {}
-  Length(CGFloat value_in, Unit unit_in)
+  Length(Float value_in, Unit unit_in)
       : value(value_in), unit(unit_in) {}
 };
 
 struct LineDash {
-  std::vector<CGFloat> dash_values;
-  CGFloat phase;
+  std::vector<Float> dash_values;
+  Float phase;
 
   LineDash()
       : phase(0) {}
@@ -88,6 +84,18 @@ enum FillRule {
   kFillRuleEvenOdd,
 };
 
+enum LineCap {
+  kLineCapButt,
+  kLineCapRound,
+  kLineCapSquare,
+};
+
+enum LineJoin {
+  kLineJoinMiter,
+  kLineJoinRound,
+  kLineJoinBevel,
+};
+
 // Parsed value of the preserveAspectRatio attribute.
 struct PreserveAspectRatio {
   bool defer;
@@ -19,7 +19,13 @@
 #include <algorithm>
 #include <cctype>
 #include <cmath>
+#include <cstdint>
+#include <locale>
+#include <sstream>
+#include <string>
 
+#include "MetroSVG/Internal/CharacterScanning.h"
+#include "MetroSVG/Internal/DecimalConversion.h"
 #include "MetroSVG/Internal/Macros.h"
 
 namespace metrosvg {
@@ -27,6 +33,34 @@ namespace internal {
 
 namespace {
 
+// Significant digits of a float that always fit in a uint64_t.
+const int kMaxMantissaDigits = 19;
+// Exponents are only accumulated up to this magnitude, beyond which every
+// float overflows or underflows.
+const int kMaxExplicitExponent = 100000;
+
+// Returns the value of the hexadecimal digit |c|, or -1 if it isn't one.
+int HexDigitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+void DecimalToFloatValue(uint64_t mantissa, int exponent, double *value) {
+  *value = DecimalToDouble(mantissa, exponent);
+}
+
+void DecimalToFloatValue(uint64_t mantissa, int exponent, float *value) {
+  *value = DecimalToFloat(mantissa, exponent);
+}
+
 template<typename Word>
 struct DictionaryEntry {
   const char *word_string;
@@ -95,46 +129,28 @@ bool GenericConsumeValues(bool (*consume_value)(StringPiece *, Value *),
 bool ConsumeNumberDelimiter(StringPiece *s) {
   // A single comma surrounded by any amount of whitespace
   // constitutes a valid delimiter.
-  const char *it = s->begin();
-  bool seen_comma = false;
-  while (it != s->end()) {
-    if ((*it) == ',') {
-      if (seen_comma) {
-        break;
-      }
-      seen_comma = true;
-    } else if (!isspace(*it)) {
-      break;
-    }
-    ++it;
-  }
-  if (seen_comma) {
-    s->Advance(it - s->begin());
-    return true;
-  } else {
+  const char *it = s->begin() + CountLeadingWhitespace(s->begin(), s->end());
+  if (it == s->end() || *it != ',') {
     return false;
   }
+  ++it;
+  it += CountLeadingWhitespace(it, s->end());
+  s->Advance(it - s->begin());
+  return true;
 }
 
 bool ConsumeDecimalInt(StringPiece *s, int *n) {
-  int ret = 0;
-  const char *iter = s->begin();
-  for (; iter != s->end(); ++iter) {
-    char c = *iter;
-    if ('0' <= c && c <= '9') {
-      ret *= 10;
-      ret += c - '0';
-    } else {
-      break;
-    }
-  }
-  if (iter != s->begin()) {
-    *n = ret;
-    s->Advance(iter - s->begin());
-    return true;
-  } else {
+  size_t digit_count = CountLeadingDigits(s->begin(), s->end());
+  if (digit_count == 0) {
     return false;
   }
+  int ret = 0;
+  for (size_t i = 0; i < digit_count; ++i) {
+    ret = ret * 10 + ((*s)[i] - '0');
+  }
+  *n = ret;
+  s->Advance(digit_count);
+  return true;
 }
 
 bool ConsumeDecimalIntPercent(StringPiece *s, int *n) {
@@ -162,12 +178,11 @@ bool ConsumeHexInt(StringPiece *s, int requested_width, int *n) {
     }
   }
   for (; iter < limit; ++iter) {
-    char c = *iter;
-    if (ishexnumber(c)) {
-      result = result * 16 + digittoint(c);
-    } else {
+    int digit = HexDigitValue(*iter);
+    if (digit < 0) {
       break;
     }
+    result = result * 16 + digit;
   }
   intptr_t parsed_length = iter - s->begin();
   if ((requested_width > 0) && (parsed_length < requested_width)) {
@@ -193,70 +208,103 @@ bool ConsumeSign(StringPiece *s) {
   return false;
 }
 
-bool ConsumeFloat(StringPiece *s, CGFloat *f) {
-  bool base_is_negative = false;
-  int base_integer = 0;
-  int fraction_as_int = 0;
-
+bool ConsumeFloat(StringPiece *s, Float *f) {
   StringPiece after_sign(*s);
   ConsumeWhitespace(&after_sign);
-  base_is_negative = ConsumeSign(&after_sign);
-
-  StringPiece after_base(after_sign);
-  ConsumeDecimalInt(&after_base, &base_integer);
-  bool had_base_integer = after_base.begin() != after_sign.begin();
-
-  size_t base_fraction_length = 0;
-  if (after_base.length()) {
-    const char maybe_decimal_point = *after_base.begin();
-    if (maybe_decimal_point == '.') {
-      after_base.Advance(1);
-      const char *before_fraction = after_base.begin();
-      if (ConsumeDecimalInt(&after_base, &fraction_as_int)) {
-        base_fraction_length = after_base.begin() - before_fraction;
+  bool is_negative = ConsumeSign(&after_sign);
+
+  // The first kMaxMantissaDigits significant digits make up the mantissa,
+  // and |exponent| accounts for the decimal point and the digits that
+  // don't fit. Leading zeros aren't significant.
+  uint64_t mantissa = 0;
+  int mantissa_digits = 0;
+  int exponent = 0;
+  bool is_truncated = false;
+  bool has_digits = false;
+  const char *iter = after_sign.begin();
+  const char *end = after_sign.end();
+  for (; iter != end && '0' <= *iter && *iter <= '9'; ++iter) {
+    if (mantissa_digits < kMaxMantissaDigits) {
+      mantissa = mantissa * 10 + (*iter - '0');
+      mantissa_digits += mantissa != 0;
+    } else {
+      ++exponent;
+      is_truncated |= *iter != '0';
+    }
+    has_digits = true;
+  }
+  if (iter != end && *iter == '.') {
+    ++iter;
+    for (; iter != end && '0' <= *iter && *iter <= '9'; ++iter) {
+      if (mantissa_digits < kMaxMantissaDigits) {
+        mantissa = mantissa * 10 + (*iter - '0');
+        mantissa_digits += mantissa != 0;
+        --exponent;
+      } else {
+        is_truncated |= *iter != '0';
       }
+      has_digits = true;
     }
   }
   // Must have non-empty base or fraction.
-  if (!had_base_integer && !base_fraction_length) {
+  if (!has_digits) {
     return false;
   }
-  CGFloat fraction_value =
-      fraction_as_int / std::powf(10, base_fraction_length);
-  CGFloat value = (base_is_negative ? -1 : 1) * (base_integer + fraction_value);
-
-  if (after_base.length()) {
-    StringPiece reading_exponent(after_base);
-    const char maybe_e = *reading_exponent.begin();
-    if (maybe_e == 'e') {
-      reading_exponent.Advance(1);
-      int exponent = 0;
-      bool exponent_is_negative = false;
-      exponent_is_negative = ConsumeSign(&reading_exponent);
-      if (ConsumeDecimalInt(&reading_exponent, &exponent)) {
-        value *= std::pow(10, (exponent_is_negative ? -1 : 1) * exponent);
-        after_base.Advance(reading_exponent.begin() - after_base.begin());
+
+  if (iter != end && *iter == 'e') {
+    StringPiece reading_exponent(iter + 1, end);
+    bool exponent_is_negative = ConsumeSign(&reading_exponent);
+    const char *exponent_iter = reading_exponent.begin();
+    int explicit_exponent = 0;
+    for (; exponent_iter != end &&
+           '0' <= *exponent_iter && *exponent_iter <= '9';
+         ++exponent_iter) {
+      // Larger exponents overflow or underflow all the same.
+      if (explicit_exponent < kMaxExplicitExponent) {
+        explicit_exponent = explicit_exponent * 10 + (*exponent_iter - '0');
       }
     }
+    if (exponent_iter != reading_exponent.begin()) {
+      exponent += exponent_is_negative ? -explicit_exponent
+                                       : explicit_exponent;
+      iter = exponent_iter;
+    }
+  }
+
+  Float value;
+  DecimalToFloatValue(mantissa, exponent, &value);
+  if (is_truncated) {
+    // The dropped digits only matter if they can change the rounding,
+    // which takes the exact decimal value.
+    Float upper_value;
+    DecimalToFloatValue(mantissa + 1, exponent, &upper_value);
+    if (value != upper_value) {
+      std::istringstream stream(std::string(after_sign.begin(), iter));
+      stream.imbue(std::locale::classic());
+      stream >> value;
+    }
   }
-  if (isinf(value)) {
+  if (is_negative) {
+    value = -value;
+  }
+  if (std::isinf(value)) {
     return false;
   }
   *f = value;
-  s->Advance(after_base.begin() - s->begin());
+  s->Advance(iter - s->begin());
   return true;
 }
 
-bool ParseFloat(StringPiece s, CGFloat *f) {
+bool ParseFloat(StringPiece s, Float *f) {
   return GenericParse1(ConsumeFloat, s, f);
 }
 
-bool ConsumeFloats(StringPiece *s, int count, CGFloat *farray) {
+bool ConsumeFloats(StringPiece *s, int count, Float *farray) {
   return GenericConsumeValues(ConsumeFloat, ConsumeNumberDelimiter,
                               s, count, farray, true);
 }
 
-bool ParseFloats(StringPiece s, int count, CGFloat *farray) {
+bool ParseFloats(StringPiece s, int count, Float *farray) {
   return GenericParse2(ConsumeFloats, s, count, farray);
 }
 
@@ -274,7 +322,7 @@ static const DictionaryEntry<Length::Unit> kLengthUnitDictionary[] = {
 
 bool ConsumeLength(StringPiece *s, Length *length) {
   StringPiece s_copy = *s;
-  CGFloat f;
+  Float f;
   if (!ConsumeFloat(&s_copy, &f)) {
     return false;
   }
@@ -315,7 +363,7 @@ bool ParseLengths(StringPiece s, std::vector<Length> *lengths) {
 
 bool ConsumeParenthesizedFloats(StringPiece *s,
                                 int count,
-                                CGFloat *out_floats) {
+                                Float *out_floats) {
   StringPiece s_copy = *s;
   if (!ConsumeString(&s_copy, "(", true)) {
     return false;
@@ -432,7 +480,7 @@ bool ConsumeHexadecimalColor(StringPiece *s, RgbColor *rgb) {
   }
   // Now we know we have enough hex digits to consume either a three-digit
   // or six-digit hex color.
-  CGFloat color_comps[3];
+  Float color_comps[3];
   bool is_three_digits = (hex_digit_count < 6);
   for (int i = 0; i < 3 ; i++) {
     if (!ConsumeHexInt(&s_copy, is_three_digits ? 1 : 2, &color_int)) {
@@ -502,16 +550,12 @@ bool ParseRgbColor(StringPiece s, RgbColor *rgb) {
 }
 
 bool ConsumeWhitespace(StringPiece *s) {
-  const char *it = s->begin();
-  while (it != s->end() && (isspace(*it))) {
-    ++it;
-  }
-  if (it != s->begin()) {
-    s->Advance(it - s->begin());
-    return true;
-  } else {
+  size_t whitespace_count = CountLeadingWhitespace(s->begin(), s->end());
+  if (whitespace_count == 0) {
     return false;
   }
+  s->Advance(whitespace_count);
+  return true;
 }
 
 StringPiece TrimTrailingWhitespace(const StringPiece &s) {
@@ -20,9 +20,8 @@
 #include <cstring>
 #include <vector>
 
-#include <CoreGraphics/CoreGraphics.h>
-
 #include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
 #include "MetroSVG/Internal/StringPiece.h"
 // Must include this here to get default value of SVG_COLOR_KEYWORD_SUPPORT.
 #include "MetroSVG/Internal/SVGStandardColor.h"
@@ -59,19 +58,19 @@ bool ConsumeDecimalIntPercent(StringPiece *s, int *n);
 bool ConsumeHexInt(StringPiece *s, int width, int *n);
 
 // Consumes or parses a float value, e.g., "0.", "13.3", "-.2", "9.41-e3".
-bool ConsumeFloat(StringPiece *s, CGFloat *f);
-bool ParseFloat(StringPiece s, CGFloat *f);
+bool ConsumeFloat(StringPiece *s, Float *f);
+bool ParseFloat(StringPiece s, Float *f);
 
 // Consumes or parses the given number of floats separated by commas,
 // e.g., "-0.5., 65.2".
-bool ConsumeFloats(StringPiece *s, int count, CGFloat *farray);
-bool ParseFloats(StringPiece s, int count, CGFloat *farray);
+bool ConsumeFloats(StringPiece *s, int count, Float *farray);
+bool ParseFloats(StringPiece s, int count, Float *farray);
 
 // Parses the given number of floats surrounded by parentheses,
 // e.g., "(-0.5., 65.2)".
 bool ConsumeParenthesizedFloats(StringPiece *s,
                                 int count,
-                                CGFloat *farray);
+                                Float *farray);
 
 // Consumes or parses a float value followed by a length unit,
 // e.g., "5.6in", "-12px".
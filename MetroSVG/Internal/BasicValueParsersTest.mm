@@ -16,13 +16,98 @@
 
 #import <XCTest/XCTest.h>
 
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <string>
+
 #include "MetroSVG/Internal/BasicTypes.h"
 #include "MetroSVG/Internal/BasicValueParsers.h"
 #include "MetroSVG/Internal/StringPiece.h"
 
 using namespace metrosvg::internal;
 
-static const CGFloat kTolerance = 0.001f;
+static const Float kTolerance = 0.001f;
+
+// Appends between |min_count| and |max_count| random decimal digits.
+static void AppendDigits(std::mt19937 *random,
+                         int min_count,
+                         int max_count,
+                         std::string *s) {
+  int count = min_count + (*random)() % (max_count - min_count + 1);
+  for (int i = 0; i < count; ++i) {
+    s->push_back('0' + (*random)() % 10);
+  }
+}
+
+// Returns whether ConsumeFloat parses |s| to the same value as strtod, or
+// strtof if Float is a float, and consumes all of it.
+static bool ConsumesFloatLikeStrtod(const std::string &s) {
+  Float expected = sizeof(Float) == sizeof(float) ?
+      strtof(s.c_str(), NULL) : strtod(s.c_str(), NULL);
+  StringPiece sp(s);
+  Float f;
+  if (std::isinf(expected)) {
+    return !ConsumeFloat(&sp, &f);
+  }
+  return ConsumeFloat(&sp, &f) && sp.length() == 0 && f == expected &&
+         std::signbit(f) == std::signbit(expected);
+}
+
+// Returns 100000 space-separated random numbers for the performance tests,
+// each with a sign and the given numbers of digits around the decimal
+// point.
+static std::string BenchmarkNumbers(int integer_digits, int fraction_digits) {
+  std::mt19937 random(2);
+  std::string s;
+  for (int i = 0; i < 100000; ++i) {
+    if (random() % 2) {
+      s.push_back('-');
+    }
+    AppendDigits(&random, integer_digits, integer_digits, &s);
+    s.push_back('.');
+    AppendDigits(&random, fraction_digits, fraction_digits, &s);
+    s.push_back(' ');
+  }
+  return s;
+}
+
+// Measures consuming all the numbers in |numbers| with ConsumeFloat.
+static void MeasureConsumeFloat(XCTestCase *test_case,
+                                const std::string &numbers) {
+  const std::string *numbers_pointer = &numbers;
+  [test_case measureBlock:^{
+    StringPiece sp(*numbers_pointer);
+    Float sum = 0;
+    Float f;
+    while (ConsumeFloat(&sp, &f)) {
+      sum += f;
+      ConsumeWhitespace(&sp);
+    }
+    XCTAssertEqual(sp.length(), 0U);
+    XCTAssertFalse(std::isnan(sum));
+  }];
+}
+
+// Measures the same work as MeasureConsumeFloat with strtod, as a
+// baseline.
+static void MeasureStrtod(XCTestCase *test_case, const std::string &numbers) {
+  const std::string *numbers_pointer = &numbers;
+  [test_case measureBlock:^{
+    const char *p = numbers_pointer->c_str();
+    double sum = 0;
+    char *end;
+    for (;;) {
+      double d = strtod(p, &end);
+      if (end == p) {
+        break;
+      }
+      sum += d;
+      p = end;
+    }
+    XCTAssertFalse(std::isnan(sum));
+  }];
+}
 
 @interface BasicValueParsersTest : XCTestCase
 @end
@@ -142,7 +227,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_Success {
   StringPiece s("123.456@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123.456, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -150,7 +235,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNegative {
   StringPiece s("-123.456@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, -123.456, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -158,7 +243,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNoFraction {
   StringPiece s("123@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -166,7 +251,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNoFractionNegative {
   StringPiece s("-123@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, -123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -174,7 +259,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNoFractionDecimal {
   StringPiece s("123.@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -182,7 +267,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNoInteger {
   StringPiece s(".123@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 0.123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -190,7 +275,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNoIntegerNegative {
   StringPiece s("-.123@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, -0.123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -198,7 +283,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessIntegerPlusExponent {
   StringPiece s("123e3@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123000, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -206,7 +291,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessIntegerNegativeExponent {
   StringPiece s("123e-3@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, .123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -214,7 +299,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessNegativeIntegerNegativeExponent {
   StringPiece s("-123e-3@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, -0.123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -222,7 +307,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessFractionPlusExponent {
   StringPiece s(".123e3@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -230,7 +315,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessFractionMinusExponent {
   StringPiece s(".1e-1@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 0.01, kTolerance);
   XCTAssertEqual(s.length(), 2U);
@@ -238,7 +323,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessShouldntSwallowE {
   StringPiece s("123e@@");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 123., kTolerance);
   XCTAssertEqual(s.length(), 3U);
@@ -246,7 +331,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloats_SuccessMultipleSpaces {
   StringPiece s("54.003 15.434 0.6");
-  CGFloat f[3];
+  Float f[3];
   XCTAssertTrue(ConsumeFloats(&s, 3, f));
   XCTAssertEqualWithAccuracy(f[0], 54.003, kTolerance);
   XCTAssertEqualWithAccuracy(f[1], 15.434, kTolerance);
@@ -256,7 +341,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloats_SuccessMultipleCommas {
   StringPiece s("54.003,15.434,0.6");
-  CGFloat f[3];
+  Float f[3];
   XCTAssertTrue(ConsumeFloats(&s, 3, f));
   XCTAssertEqualWithAccuracy(f[0], 54.003, kTolerance);
   XCTAssertEqualWithAccuracy(f[1], 15.434, kTolerance);
@@ -267,7 +352,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_SuccessMultipleCommands {
   StringPiece s("54.003,15.434c3.338,0,6.041-2.71,6.041-6.036c");
   size_t previous_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 54.003, kTolerance);
   XCTAssertEqual(previous_length, 6 + s.length());
@@ -321,7 +406,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeFloat_SuccessExtremelySmall {
   StringPiece s("1e-400@@");
-  CGFloat f;
+  Float f;
   // TODO: Is this the expected behavior?
   XCTAssertTrue(ConsumeFloat(&s, &f));
   XCTAssertEqualWithAccuracy(f, 0.0f, kTolerance);
@@ -331,7 +416,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureNoNumber {
   StringPiece s("@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -339,7 +424,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureEmpty {
   StringPiece s("");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -347,15 +432,84 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureSignOnly {
   StringPiece s("-@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
 
+- (void)testConsumeFloat_CorrectlyRounded {
+  XCTAssert(ConsumesFloatLikeStrtod("0.1"));
+  XCTAssert(ConsumesFloatLikeStrtod("-0"));
+  XCTAssert(ConsumesFloatLikeStrtod("2.2250738585072011e-308"));
+  XCTAssert(ConsumesFloatLikeStrtod("9007199254740993"));
+  XCTAssert(ConsumesFloatLikeStrtod("1.7976931348623157e308"));
+  XCTAssert(ConsumesFloatLikeStrtod("1e309"));
+  // More digits than fit in the mantissa, exactly halfway between two
+  // doubles up to the last one.
+  XCTAssert(ConsumesFloatLikeStrtod("9007199254740993.0000000000000000001"));
+  XCTAssert(ConsumesFloatLikeStrtod("9007199254740993.0000000000000000000"));
+  XCTAssert(ConsumesFloatLikeStrtod(
+      "0.000000000000000000000000000000001234567890123456789012345"));
+  XCTAssert(ConsumesFloatLikeStrtod("123456789012345678901234567890e-400"));
+}
+
+- (void)testConsumeFloat_RandomNumbersMatchStrtod {
+  std::mt19937 random(1);
+  for (int i = 0; i < 100000; ++i) {
+    std::string s;
+    if (random() % 2) {
+      s.push_back('-');
+    }
+    // Short numbers like those in path data, or long ones. There must be
+    // a digit before or after the decimal point.
+    int max_digits = i % 4 ? 6 : 30;
+    size_t integer_begin = s.size();
+    AppendDigits(&random, 0, max_digits, &s);
+    bool has_integer = s.size() > integer_begin;
+    if (random() % 4) {
+      s.push_back('.');
+      AppendDigits(&random, has_integer ? 0 : 1, max_digits, &s);
+    } else if (!has_integer) {
+      AppendDigits(&random, 1, max_digits, &s);
+    }
+    if (random() % 4 == 0) {
+      s.push_back('e');
+      if (random() % 2) {
+        s.push_back('-');
+      }
+      AppendDigits(&random, 1, 3, &s);
+    }
+    bool matches = ConsumesFloatLikeStrtod(s);
+    XCTAssert(matches, @"%s", s.c_str());
+    if (!matches) {
+      break;
+    }
+  }
+}
+
+// Numbers like those in path data.
+- (void)testPerformance_ConsumeFloat_ThreeDecimals {
+  MeasureConsumeFloat(self, BenchmarkNumbers(2, 3));
+}
+
+- (void)testPerformance_ConsumeFloat_ThreeDecimalsWithStrtod {
+  MeasureStrtod(self, BenchmarkNumbers(2, 3));
+}
+
+// Numbers with 17 significant digits, as printed by tools that write
+// doubles out in full.
+- (void)testPerformance_ConsumeFloat_SeventeenDigits {
+  MeasureConsumeFloat(self, BenchmarkNumbers(3, 14));
+}
+
+- (void)testPerformance_ConsumeFloat_SeventeenDigitsWithStrtod {
+  MeasureStrtod(self, BenchmarkNumbers(3, 14));
+}
+
 - (void)testConsumeFloat_FailureDecimalOnly {
   StringPiece s(".@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -363,7 +517,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureSignDecimalOnly {
   StringPiece s("-.@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -371,7 +525,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureSignDecimalEOnly {
   StringPiece s("-.e@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -379,7 +533,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureDecimalEOnly {
   StringPiece s(".e@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -387,7 +541,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureEOnly {
   StringPiece s("e@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -395,7 +549,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureNoBase {
   StringPiece s("e-4@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -403,7 +557,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureOutsideSinglePrecisionHigh {
   StringPiece s("1e400@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
@@ -411,34 +565,34 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeFloat_FailureOutsideSinglePrecisionHighNegative {
   StringPiece s("-1e400@@");
   size_t original_length = s.length();
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ConsumeFloat(&s, &f));
   XCTAssertEqual(s.length(), original_length);
 }
 
 - (void)testParseFloat_Success {
   StringPiece s("123.456");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ParseFloat(s, &f));
   XCTAssertEqualWithAccuracy(f, 123.456, kTolerance);
 }
 
 - (void)testParseFloat_SuccessNegative {
   StringPiece s("-123.456");
-  CGFloat f;
+  Float f;
   XCTAssertTrue(ParseFloat(s, &f));
   XCTAssertEqualWithAccuracy(f, -123.456, kTolerance);
 }
 
 - (void)testParseFloat_Failure {
   StringPiece s("123.456@@");
-  CGFloat f;
+  Float f;
   XCTAssertFalse(ParseFloat(s, &f));
 }
 
 - (void)testConsumeFloats_Success {
   StringPiece s("12.34,56.78-12.34@@");
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertTrue(ConsumeFloats(&s, 3, farray));
   XCTAssertEqualWithAccuracy(farray[0], 12.34, kTolerance);
   XCTAssertEqualWithAccuracy(farray[1], 56.78, kTolerance);
@@ -448,7 +602,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testParseFloats_Success {
   StringPiece s("12.34,56.78-12.34");
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertTrue(ParseFloats(s, 3, farray));
   XCTAssertEqualWithAccuracy(farray[0], 12.34, kTolerance);
   XCTAssertEqualWithAccuracy(farray[1], 56.78, kTolerance);
@@ -459,7 +613,7 @@ static const CGFloat kTolerance = 0.001f;
   // SVG v1.1 specification section 8.3.8 says that floating-point
   // constants without digits before the decimal point are legal.
   StringPiece s("12.3456.78-12.34@@");
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertTrue(ConsumeFloats(&s, 3, farray));
   XCTAssertEqual(2U, s.length());
 }
@@ -523,7 +677,7 @@ static const CGFloat kTolerance = 0.001f;
 
 - (void)testConsumeParenthesizedFloats_Success {
   StringPiece s("(12.34,56.78-12.34)@@");
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertTrue(ConsumeParenthesizedFloats(&s, 3, farray));
   XCTAssertEqualWithAccuracy(farray[0], 12.34, kTolerance);
   XCTAssertEqualWithAccuracy(farray[1], 56.78, kTolerance);
@@ -534,7 +688,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeParenthesizedFloats_FailureNoOpeningParenthesis {
   StringPiece s("12.34,56.78-12.34)@@");
   size_t original_length = s.length();
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertFalse(ConsumeParenthesizedFloats(&s, 3, farray));
   XCTAssertEqual(original_length, s.length());
 }
@@ -542,7 +696,7 @@ static const CGFloat kTolerance = 0.001f;
 - (void)testConsumeParenthesizedFloats_FailureNoClosingParenthesis {
   StringPiece s("(12.34,56.78-12.34@@");
   size_t original_length = s.length();
-  CGFloat farray[3];
+  Float farray[3];
   XCTAssertFalse(ConsumeParenthesizedFloats(&s, 3, farray));
   XCTAssertEqual(original_length, s.length());
 }
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
+
+namespace metrosvg {
+namespace internal {
+
+struct Gradient;
+struct SceneGraph;
+
+// Canvas is the drawing surface that Renderer paints a document onto.
+// The operations mirror those of a CoreGraphics context, so that a backend
+// can be implemented on top of CoreGraphics as well as on top of other
+// graphics libraries or a software rasterizer.
+//
+// A canvas is |width| x |height| pixels and starts out fully transparent.
+// Its initial user space has the origin at the top-left corner, with the
+// y axis pointing down, and one unit per pixel. The initial graphics state
+// paints with opaque black, a line width of 1, butt caps, miter joins,
+// a miter limit of 10, and no dash pattern or clip.
+//
+// Like with CoreGraphics, the current path is cleared by the operations
+// that paint or clip with it. The points of a path are interpreted in the
+// user space at the time they are added.
+class Canvas {
+ public:
+  virtual ~Canvas() {}
+
+  virtual size_t width() const = 0;
+  virtual size_t height() const = 0;
+
+  // Graphics state.
+  virtual void SaveGState() = 0;
+  virtual void RestoreGState() = 0;
+  virtual void ConcatCTM(const AffineTransform &transform) = 0;
+  // |alpha| is clamped to [0, 1].
+  virtual void SetAlpha(Float alpha) = 0;
+  virtual void SetRGBFillColor(Float red,
+                               Float green,
+                               Float blue,
+                               Float alpha) = 0;
+  virtual void SetRGBStrokeColor(Float red,
+                                 Float green,
+                                 Float blue,
+                                 Float alpha) = 0;
+  virtual void SetLineWidth(Float width) = 0;
+  virtual void SetLineCap(LineCap cap) = 0;
+  virtual void SetLineJoin(LineJoin join) = 0;
+  virtual void SetMiterLimit(Float limit) = 0;
+  // An empty dash pattern means solid lines.
+  virtual void SetLineDash(Float phase,
+                           const Float *lengths,
+                           size_t count) = 0;
+  virtual void ClipToRect(FloatRect rect) = 0;
+
+  // Until the matching EndTransparencyLayer, drawing goes to an offscreen
+  // layer, which is then composited with the alpha of the graphics state
+  // at the time BeginTransparencyLayer was called.
+  virtual void BeginTransparencyLayer() = 0;
+  virtual void EndTransparencyLayer() = 0;
+
+  // Path construction.
+  virtual void BeginPath() = 0;
+  virtual void MoveToPoint(Float x, Float y) = 0;
+  virtual void AddLineToPoint(Float x, Float y) = 0;
+  virtual void AddCurveToPoint(Float cp1x, Float cp1y,
+                               Float cp2x, Float cp2y,
+                               Float x, Float y) = 0;
+  virtual void AddQuadCurveToPoint(Float cpx, Float cpy,
+                                   Float x, Float y) = 0;
+  // Adds a circular arc, transformed by |transform| if it's not NULL.
+  // Same as CGPathAddArc.
+  virtual void AddArc(const AffineTransform *transform,
+                      Float x, Float y, Float radius,
+                      Float start_angle, Float end_angle,
+                      bool clockwise) = 0;
+  virtual void AddEllipseInRect(FloatRect rect) = 0;
+  virtual void AddRoundedRect(FloatRect rect,
+                              Float corner_width,
+                              Float corner_height) = 0;
+  virtual void ClosePath() = 0;
+  // Adds the path segments of the path, polygon or polyline element at
+  // |element_index| in |graph|, which belongs to a prepared document.
+  // Canvases that keep the paths they build across renders, until the
+  // document is deleted, add the kept path and return true. Others return
+  // false without adding anything, and the segments are added one at a
+  // time instead.
+  virtual bool AddElementPath(const SceneGraph &graph, size_t element_index) {
+    return false;
+  }
+  // Returns the origin if the path is empty.
+  virtual FloatPoint GetPathCurrentPoint() = 0;
+  // Returns the bounding box of the path in user space, excluding control
+  // points.
+  virtual FloatRect GetPathBoundingBox() = 0;
+  // Returns a rectangle in user space that contains the clip, or the null
+  // rectangle if nothing can be painted. Nothing outside of it is painted.
+  virtual FloatRect GetClipBoundingBox() = 0;
+
+  // Painting.
+  virtual void FillPath(FillRule fill_rule) = 0;
+  virtual void StrokePath() = 0;
+  // Replaces the path with the outline of its stroke, using the current
+  // line attributes.
+  virtual void ReplacePathWithStrokedPath() = 0;
+  // Intersects the clip with the path, using the nonzero rule.
+  virtual void Clip() = 0;
+  // Draws the gradient over the whole clip, extending the colors at both
+  // ends. The stops of |gradient| are used; the coordinates are given by
+  // the other arguments in user space.
+  virtual void DrawLinearGradient(const Gradient &gradient,
+                                  FloatPoint start_point,
+                                  FloatPoint end_point) = 0;
+  virtual void DrawRadialGradient(const Gradient &gradient,
+                                  FloatPoint focal_point,
+                                  FloatPoint center_point,
+                                  Float radius) = 0;
+
+  // Image output. Copies the pixels of the canvas into |pixels| as 8-bit
+  // RGBA with premultiplied alpha, top row first. |bytes_per_row| must be
+  // at least 4 * width().
+  virtual void ReadPixels(void *pixels, size_t bytes_per_row) = 0;
+};
+
+}  // namespace internal
+}  // namespace metrosvg
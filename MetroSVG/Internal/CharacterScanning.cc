@@ -0,0 +1,261 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/CharacterScanning.h"
+
+#include <cstdint>
+
+#if !defined(SVG_X86_SCANNING_KERNELS)
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || defined(__GNUC__))
+#define SVG_X86_SCANNING_KERNELS 1
+#else
+#define SVG_X86_SCANNING_KERNELS 0
+#endif
+#endif  // !defined(SVG_X86_SCANNING_KERNELS)
+
+#if SVG_X86_SCANNING_KERNELS
+#include <immintrin.h>
+#endif  // SVG_X86_SCANNING_KERNELS
+
+#include "MetroSVG/Internal/CPUFeatures.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Most runs in attribute values are shorter than a block, so the
+// characters up to this many are classified one at a time before the rest
+// of a longer run is handed to the kernels.
+const ptrdiff_t kScalarPrefixLength = 16;
+
+inline bool IsScannedWhitespace(char c) {
+  return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+inline bool IsScannedDigit(char c) {
+  return static_cast<unsigned char>(c - '0') <= 9;
+}
+
+size_t CountLeadingWhitespaceScalar(const char *begin, const char *end) {
+  const char *it = begin;
+  while (it != end && IsScannedWhitespace(*it)) {
+    ++it;
+  }
+  return it - begin;
+}
+
+size_t CountLeadingDigitsScalar(const char *begin, const char *end) {
+  const char *it = begin;
+  while (it != end && IsScannedDigit(*it)) {
+    ++it;
+  }
+  return it - begin;
+}
+
+const ScanningKernels kScalarScanningKernels = {
+  CountLeadingWhitespaceScalar,
+  CountLeadingDigitsScalar,
+};
+
+#if SVG_X86_SCANNING_KERNELS
+
+// The vector kernels below compute a bit mask of the characters of a
+// block that belong to the class and stop at its first clear bit.
+// Characters left over at the end go through the scalar kernels, so
+// nothing is read past |end|. Bytes are compared as unsigned by checking
+// that subtracting the start of a range leaves them at most its width.
+// The target attributes let the kernels be built without enabling the
+// instruction sets for the rest of the file; they only run after
+// GetScanningKernels has checked that the CPU supports them.
+
+#define SVG_TARGET_SSE2 __attribute__((target("sse2")))
+#define SVG_TARGET_AVX2 __attribute__((target("avx2")))
+
+SVG_TARGET_SSE2 inline __m128i InRangeSSE2(__m128i bytes,
+                                            char first,
+                                            char last) {
+  __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8(first));
+  __m128i clamped = _mm_min_epu8(offset, _mm_set1_epi8(last - first));
+  return _mm_cmpeq_epi8(offset, clamped);
+}
+
+SVG_TARGET_SSE2 inline uint32_t WhitespaceMaskSSE2(const char *block) {
+  __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+  __m128i is_space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+  __m128i is_control = InRangeSSE2(bytes, '\t', '\r');
+  return _mm_movemask_epi8(_mm_or_si128(is_space, is_control));
+}
+
+SVG_TARGET_SSE2 inline uint32_t DigitMaskSSE2(const char *block) {
+  __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+  return _mm_movemask_epi8(InRangeSSE2(bytes, '0', '9'));
+}
+
+SVG_TARGET_SSE2 size_t CountLeadingWhitespaceSSE2(const char *begin,
+                                                  const char *end) {
+  const char *it = begin;
+  for (; end - it >= 16; it += 16) {
+    uint32_t mask = WhitespaceMaskSSE2(it);
+    if (mask != 0xFFFF) {
+      return (it - begin) + __builtin_ctz(~mask);
+    }
+  }
+  return (it - begin) + CountLeadingWhitespaceScalar(it, end);
+}
+
+SVG_TARGET_SSE2 size_t CountLeadingDigitsSSE2(const char *begin,
+                                              const char *end) {
+  const char *it = begin;
+  for (; end - it >= 16; it += 16) {
+    uint32_t mask = DigitMaskSSE2(it);
+    if (mask != 0xFFFF) {
+      return (it - begin) + __builtin_ctz(~mask);
+    }
+  }
+  return (it - begin) + CountLeadingDigitsScalar(it, end);
+}
+
+SVG_TARGET_AVX2 inline __m256i InRangeAVX2(__m256i bytes,
+                                            char first,
+                                            char last) {
+  __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8(first));
+  __m256i clamped = _mm256_min_epu8(offset, _mm256_set1_epi8(last - first));
+  return _mm256_cmpeq_epi8(offset, clamped);
+}
+
+SVG_TARGET_AVX2 inline uint32_t WhitespaceMaskAVX2(const char *block) {
+  __m256i bytes =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+  __m256i is_space = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' '));
+  __m256i is_control = InRangeAVX2(bytes, '\t', '\r');
+  return _mm256_movemask_epi8(_mm256_or_si256(is_space, is_control));
+}
+
+SVG_TARGET_AVX2 inline uint32_t DigitMaskAVX2(const char *block) {
+  __m256i bytes =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+  return _mm256_movemask_epi8(InRangeAVX2(bytes, '0', '9'));
+}
+
+SVG_TARGET_AVX2 size_t CountLeadingWhitespaceAVX2(const char *begin,
+                                                  const char *end) {
+  const char *it = begin;
+  for (; end - it >= 32; it += 32) {
+    uint32_t mask = WhitespaceMaskAVX2(it);
+    if (mask != 0xFFFFFFFF) {
+      return (it - begin) + __builtin_ctz(~mask);
+    }
+  }
+  return (it - begin) + CountLeadingWhitespaceSSE2(it, end);
+}
+
+SVG_TARGET_AVX2 size_t CountLeadingDigitsAVX2(const char *begin,
+                                              const char *end) {
+  const char *it = begin;
+  for (; end - it >= 32; it += 32) {
+    uint32_t mask = DigitMaskAVX2(it);
+    if (mask != 0xFFFFFFFF) {
+      return (it - begin) + __builtin_ctz(~mask);
+    }
+  }
+  return (it - begin) + CountLeadingDigitsSSE2(it, end);
+}
+
+#undef SVG_TARGET_SSE2
+#undef SVG_TARGET_AVX2
+
+const ScanningKernels kSSE2ScanningKernels = {
+  CountLeadingWhitespaceSSE2,
+  CountLeadingDigitsSSE2,
+};
+
+const ScanningKernels kAVX2ScanningKernels = {
+  CountLeadingWhitespaceAVX2,
+  CountLeadingDigitsAVX2,
+};
+
+#endif  // SVG_X86_SCANNING_KERNELS
+
+const ScanningKernels *ChooseScanningKernels() {
+  const ScanningKernelType kPreferredTypes[] = {
+    kScanningKernelAVX2,
+    kScanningKernelSSE2,
+  };
+  for (ScanningKernelType type : kPreferredTypes) {
+    const ScanningKernels *kernels = GetScanningKernels(type);
+    if (kernels) {
+      return kernels;
+    }
+  }
+  return &kScalarScanningKernels;
+}
+
+inline const ScanningKernels &BestScanningKernels() {
+  static const ScanningKernels *kernels = ChooseScanningKernels();
+  return *kernels;
+}
+
+}  // namespace
+
+size_t CountLeadingWhitespace(const char *begin, const char *end) {
+  const char *prefix_end =
+      end - begin > kScalarPrefixLength ? begin + kScalarPrefixLength : end;
+  const char *it = begin;
+  while (it != prefix_end && IsScannedWhitespace(*it)) {
+    ++it;
+  }
+  if (it != begin + kScalarPrefixLength) {
+    return it - begin;
+  }
+  return kScalarPrefixLength +
+         BestScanningKernels().count_leading_whitespace(it, end);
+}
+
+size_t CountLeadingDigits(const char *begin, const char *end) {
+  const char *prefix_end =
+      end - begin > kScalarPrefixLength ? begin + kScalarPrefixLength : end;
+  const char *it = begin;
+  while (it != prefix_end && IsScannedDigit(*it)) {
+    ++it;
+  }
+  if (it != begin + kScalarPrefixLength) {
+    return it - begin;
+  }
+  return kScalarPrefixLength +
+         BestScanningKernels().count_leading_digits(it, end);
+}
+
+const ScanningKernels *GetScanningKernels(ScanningKernelType type) {
+  switch (type) {
+    case kScanningKernelScalar:
+      return &kScalarScanningKernels;
+#if SVG_X86_SCANNING_KERNELS
+    case kScanningKernelSSE2:
+      return CPUSupportsSSE2() ? &kSSE2ScanningKernels : NULL;
+    case kScanningKernelAVX2:
+      return CPUSupportsAVX2() ? &kAVX2ScanningKernels : NULL;
+#endif  // SVG_X86_SCANNING_KERNELS
+    default:
+      return NULL;
+  }
+}
+
+}  // namespace internal
+}  // namespace metrosvg
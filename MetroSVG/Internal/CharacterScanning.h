@@ -0,0 +1,55 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace metrosvg {
+namespace internal {
+
+// Scanners for the character classes of the value parsers. Whitespace is
+// space, tab, line feed, vertical tab, form feed and carriage return, as
+// classified by isspace in the C locale. Digits are '0' to '9'.
+
+// Returns the number of whitespace characters at the start of
+// [begin, end).
+size_t CountLeadingWhitespace(const char *begin, const char *end);
+
+// Returns the number of digits at the start of [begin, end).
+size_t CountLeadingDigits(const char *begin, const char *end);
+
+// The functions above classify 16 or 32 characters at a time on CPUs that
+// support it, with the implementation chosen on first use. Short runs are
+// counted without going through the implementations, which all return
+// the same results.
+enum ScanningKernelType {
+  kScanningKernelScalar,
+  kScanningKernelSSE2,
+  kScanningKernelAVX2,
+};
+
+struct ScanningKernels {
+  size_t (*count_leading_whitespace)(const char *begin, const char *end);
+  size_t (*count_leading_digits)(const char *begin, const char *end);
+};
+
+// Returns the implementation of the kernels of |type|, or NULL if it isn't
+// built in or the CPU doesn't support it.
+const ScanningKernels *GetScanningKernels(ScanningKernelType type);
+
+}  // namespace internal
+}  // namespace metrosvg
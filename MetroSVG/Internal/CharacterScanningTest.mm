@@ -0,0 +1,113 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/CharacterScanning.h"
+
+using namespace metrosvg::internal;
+
+static std::vector<const ScanningKernels *> SupportedKernels() {
+  std::vector<const ScanningKernels *> kernels;
+  for (ScanningKernelType type : {kScanningKernelSSE2,
+                                  kScanningKernelAVX2}) {
+    if (GetScanningKernels(type)) {
+      kernels.push_back(GetScanningKernels(type));
+    }
+  }
+  return kernels;
+}
+
+static size_t CountWhitespace(const std::string &s) {
+  return CountLeadingWhitespace(s.data(), s.data() + s.size());
+}
+
+static size_t CountDigits(const std::string &s) {
+  return CountLeadingDigits(s.data(), s.data() + s.size());
+}
+
+@interface CharacterScanningTest : XCTestCase
+@end
+
+@implementation CharacterScanningTest
+
+- (void)testCountLeadingWhitespace {
+  XCTAssertEqual(CountWhitespace(""), 0U);
+  XCTAssertEqual(CountWhitespace("a "), 0U);
+  XCTAssertEqual(CountWhitespace(" a"), 1U);
+  XCTAssertEqual(CountWhitespace(" \t\n\v\f\r,"), 6U);
+  XCTAssertEqual(CountWhitespace("   "), 3U);
+  XCTAssertEqual(CountWhitespace(std::string(40, ' ') + "1"), 40U);
+}
+
+- (void)testCountLeadingDigits {
+  XCTAssertEqual(CountDigits(""), 0U);
+  XCTAssertEqual(CountDigits(".5"), 0U);
+  XCTAssertEqual(CountDigits("7"), 1U);
+  XCTAssertEqual(CountDigits("0123456789/:"), 10U);
+  XCTAssertEqual(CountDigits(std::string(40, '9') + ".5"), 40U);
+}
+
+- (void)testCountLeadingWhitespace_MatchesIsspace {
+  for (int c = 0; c < 256; ++c) {
+    std::string s(1, static_cast<char>(c));
+    XCTAssertEqual(CountWhitespace(s), isspace(c) ? 1U : 0U, @"%d", c);
+    XCTAssertEqual(CountDigits(s), isdigit(c) ? 1U : 0U, @"%d", c);
+  }
+}
+
+- (void)testGetScanningKernels_Scalar {
+  XCTAssert(GetScanningKernels(kScanningKernelScalar) != NULL);
+}
+
+- (void)testKernelsMatchScalar {
+  // Runs of every length up to a few blocks, ended by every byte value or
+  // by the end of the string.
+  const ScanningKernels *scalar = GetScanningKernels(kScanningKernelScalar);
+  for (const ScanningKernels *kernels : SupportedKernels()) {
+    for (size_t length = 0; length < 70; ++length) {
+      for (int terminator = -1; terminator < 256; ++terminator) {
+        std::string whitespace;
+        std::string digits;
+        for (size_t i = 0; i < length; ++i) {
+          whitespace += " \t\n\v\f\r"[i % 6];
+          digits += '0' + i % 10;
+        }
+        if (terminator >= 0) {
+          whitespace += static_cast<char>(terminator);
+          digits += static_cast<char>(terminator);
+        }
+        // Trailing characters that must not be read.
+        std::string buffer = whitespace + "   ";
+        const char *begin = buffer.data();
+        const char *end = begin + whitespace.size();
+        XCTAssertEqual(kernels->count_leading_whitespace(begin, end),
+                       scalar->count_leading_whitespace(begin, end));
+        buffer = digits + "999";
+        begin = buffer.data();
+        end = begin + digits.size();
+        XCTAssertEqual(kernels->count_leading_digits(begin, end),
+                       scalar->count_leading_digits(begin, end));
+      }
+    }
+  }
+}
+
+@end
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Compositing.h"
+
+#include <cstring>
+
+#if !defined(SVG_X86_COMPOSITING_KERNELS)
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || defined(__GNUC__))
+#define SVG_X86_COMPOSITING_KERNELS 1
+#else
+#define SVG_X86_COMPOSITING_KERNELS 0
+#endif
+#endif  // !defined(SVG_X86_COMPOSITING_KERNELS)
+
+#if SVG_X86_COMPOSITING_KERNELS
+#include <immintrin.h>
+#endif  // SVG_X86_COMPOSITING_KERNELS
+
+#include "MetroSVG/Internal/CPUFeatures.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Pixels are processed as 32-bit words holding the four channels, two of
+// which are multiplied at a time in 16-bit lanes. The channel order
+// doesn't matter, except that the alpha of a pixel is read from its bytes.
+
+inline uint32_t LoadPixel(const uint8_t *pixel) {
+  uint32_t value;
+  memcpy(&value, pixel, sizeof(value));
+  return value;
+}
+
+inline void StorePixel(uint8_t *pixel, uint32_t value) {
+  memcpy(pixel, &value, sizeof(value));
+}
+
+// Multiplies each channel of |pixel| by |scale| / 255, rounding the same
+// way as DivideBy255.
+inline uint32_t ScalePixel(uint32_t pixel, uint32_t scale) {
+  uint32_t rb = (pixel & 0x00FF00FF) * scale + 0x00800080;
+  uint32_t ga = ((pixel >> 8) & 0x00FF00FF) * scale + 0x00800080;
+  rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+  ga = (ga + ((ga >> 8) & 0x00FF00FF)) & 0xFF00FF00;
+  return rb | ga;
+}
+
+// Composites |src| scaled by |coverage| over |dst|. The channels of
+// premultiplied colors never exceed their alpha, so the sums of the
+// channels don't overflow.
+inline void CompositePixel(uint8_t *dst, const uint8_t *src,
+                           uint32_t coverage) {
+  uint32_t alpha = DivideBy255(src[3] * coverage);
+  StorePixel(dst, ScalePixel(LoadPixel(src), coverage) +
+                  ScalePixel(LoadPixel(dst), 255 - alpha));
+}
+
+void CompositeSolidSpanScalar(uint8_t *dst,
+                              const uint8_t *coverage,
+                              size_t count,
+                              const uint8_t color[4]) {
+  uint32_t packed_color = LoadPixel(color);
+  uint32_t inverse_alpha = 255 - color[3];
+  size_t i = 0;
+  while (i < count) {
+    if (coverage[i] == 255) {
+      // Fully covered runs don't need to scale the color.
+      size_t run_end = i + 1;
+      while (run_end < count && coverage[run_end] == 255) {
+        ++run_end;
+      }
+      if (inverse_alpha == 0) {
+        for (; i < run_end; ++i) {
+          StorePixel(dst + i * 4, packed_color);
+        }
+      } else {
+        for (; i < run_end; ++i) {
+          StorePixel(dst + i * 4,
+                     packed_color +
+                     ScalePixel(LoadPixel(dst + i * 4), inverse_alpha));
+        }
+      }
+      continue;
+    }
+    if (coverage[i] != 0) {
+      CompositePixel(dst + i * 4, color, coverage[i]);
+    }
+    ++i;
+  }
+}
+
+void CompositeSpanScalar(uint8_t *dst,
+                         const uint8_t *src,
+                         const uint8_t *coverage,
+                         size_t count) {
+  for (size_t i = 0; i < count; ++i, dst += 4, src += 4) {
+    if (coverage[i] != 0) {
+      CompositePixel(dst, src, coverage[i]);
+    }
+  }
+}
+
+const CompositingKernels kScalarCompositingKernels = {
+  CompositeSolidSpanScalar,
+  CompositeSpanScalar,
+};
+
+#if SVG_X86_COMPOSITING_KERNELS
+
+// The vector kernels below widen the channels to 16-bit lanes and apply
+// the same arithmetic as CompositePixel to several pixels at a time.
+// Pixels left over at the end of a span go through the scalar kernels.
+// The target attributes let the kernels be built without enabling the
+// instruction sets for the rest of the file; they only run after
+// GetCompositingKernels has checked that the CPU supports them.
+
+#define SVG_TARGET_SSE2 __attribute__((target("sse2")))
+#define SVG_TARGET_AVX2 __attribute__((target("avx2")))
+
+inline uint32_t LoadCoverage4(const uint8_t *coverage) {
+  uint32_t value;
+  memcpy(&value, coverage, sizeof(value));
+  return value;
+}
+
+inline uint64_t LoadCoverage8(const uint8_t *coverage) {
+  uint64_t value;
+  memcpy(&value, coverage, sizeof(value));
+  return value;
+}
+
+// SSE2: four pixels per iteration, two in each 16-bit half.
+
+SVG_TARGET_SSE2 inline __m128i DivideBy255SSE2(__m128i value) {
+  value = _mm_add_epi16(value, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(value, _mm_srli_epi16(value, 8)), 8);
+}
+
+// |dst|, |src| and |coverage| hold two pixels each, widened to 16 bits.
+SVG_TARGET_SSE2 inline __m128i CompositePixelsSSE2(__m128i dst,
+                                                   __m128i src,
+                                                   __m128i coverage) {
+  __m128i scaled_src = DivideBy255SSE2(_mm_mullo_epi16(src, coverage));
+  __m128i alpha =
+      _mm_shufflehi_epi16(_mm_shufflelo_epi16(scaled_src, 0xFF), 0xFF);
+  __m128i inverse_alpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  return _mm_add_epi16(
+      scaled_src, DivideBy255SSE2(_mm_mullo_epi16(dst, inverse_alpha)));
+}
+
+// Returns the coverage of four pixels, each repeated for the channels.
+SVG_TARGET_SSE2 inline __m128i ExpandCoverageSSE2(uint32_t coverage) {
+  __m128i value = _mm_cvtsi32_si128(static_cast<int>(coverage));
+  value = _mm_unpacklo_epi8(value, value);
+  return _mm_unpacklo_epi16(value, value);
+}
+
+SVG_TARGET_SSE2 inline void CompositeFourPixelsSSE2(uint8_t *dst,
+                                                    __m128i src,
+                                                    uint32_t coverage) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i dst_pixels = _mm_loadu_si128(reinterpret_cast<__m128i *>(dst));
+  __m128i expanded_coverage = ExpandCoverageSSE2(coverage);
+  __m128i low =
+      CompositePixelsSSE2(_mm_unpacklo_epi8(dst_pixels, zero),
+                          _mm_unpacklo_epi8(src, zero),
+                          _mm_unpacklo_epi8(expanded_coverage, zero));
+  __m128i high =
+      CompositePixelsSSE2(_mm_unpackhi_epi8(dst_pixels, zero),
+                          _mm_unpackhi_epi8(src, zero),
+                          _mm_unpackhi_epi8(expanded_coverage, zero));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                   _mm_packus_epi16(low, high));
+}
+
+SVG_TARGET_SSE2 void CompositeSolidSpanSSE2(uint8_t *dst,
+                                            const uint8_t *coverage,
+                                            size_t count,
+                                            const uint8_t color[4]) {
+  __m128i color_pixels =
+      _mm_set1_epi32(static_cast<int>(LoadPixel(color)));
+  bool opaque = color[3] == 255;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32_t pixel_coverage = LoadCoverage4(coverage + i);
+    if (pixel_coverage == 0) {
+      continue;
+    }
+    if (pixel_coverage == 0xFFFFFFFF && opaque) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4),
+                       color_pixels);
+      continue;
+    }
+    CompositeFourPixelsSSE2(dst + i * 4, color_pixels, pixel_coverage);
+  }
+  CompositeSolidSpanScalar(dst + i * 4, coverage + i, count - i, color);
+}
+
+SVG_TARGET_SSE2 void CompositeSpanSSE2(uint8_t *dst,
+                                       const uint8_t *src,
+                                       const uint8_t *coverage,
+                                       size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32_t pixel_coverage = LoadCoverage4(coverage + i);
+    if (pixel_coverage == 0) {
+      continue;
+    }
+    __m128i src_pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+    CompositeFourPixelsSSE2(dst + i * 4, src_pixels, pixel_coverage);
+  }
+  CompositeSpanScalar(dst + i * 4, src + i * 4, coverage + i, count - i);
+}
+
+// AVX2: eight pixels per iteration. The 16-bit unpacking and packing work
+// within each 128-bit lane, so the coverage is laid out to match.
+
+SVG_TARGET_AVX2 inline __m256i DivideBy255AVX2(__m256i value) {
+  value = _mm256_add_epi16(value, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(
+      _mm256_add_epi16(value, _mm256_srli_epi16(value, 8)), 8);
+}
+
+SVG_TARGET_AVX2 inline __m256i CompositePixelsAVX2(__m256i dst,
+                                                   __m256i src,
+                                                   __m256i coverage) {
+  __m256i scaled_src = DivideBy255AVX2(_mm256_mullo_epi16(src, coverage));
+  __m256i alpha =
+      _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(scaled_src, 0xFF), 0xFF);
+  __m256i inverse_alpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+  return _mm256_add_epi16(
+      scaled_src, DivideBy255AVX2(_mm256_mullo_epi16(dst, inverse_alpha)));
+}
+
+SVG_TARGET_AVX2 inline __m256i ExpandCoverageAVX2(uint64_t coverage) {
+  __m128i value =
+      _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&coverage));
+  const __m256i kShuffle = _mm256_setr_epi8(
+      0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+      4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+  return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(value), kShuffle);
+}
+
+SVG_TARGET_AVX2 inline void CompositeEightPixelsAVX2(uint8_t *dst,
+                                                     __m256i src,
+                                                     uint64_t coverage) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i dst_pixels =
+      _mm256_loadu_si256(reinterpret_cast<__m256i *>(dst));
+  __m256i expanded_coverage = ExpandCoverageAVX2(coverage);
+  __m256i low =
+      CompositePixelsAVX2(_mm256_unpacklo_epi8(dst_pixels, zero),
+                          _mm256_unpacklo_epi8(src, zero),
+                          _mm256_unpacklo_epi8(expanded_coverage, zero));
+  __m256i high =
+      CompositePixelsAVX2(_mm256_unpackhi_epi8(dst_pixels, zero),
+                          _mm256_unpackhi_epi8(src, zero),
+                          _mm256_unpackhi_epi8(expanded_coverage, zero));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                      _mm256_packus_epi16(low, high));
+}
+
+SVG_TARGET_AVX2 void CompositeSolidSpanAVX2(uint8_t *dst,
+                                            const uint8_t *coverage,
+                                            size_t count,
+                                            const uint8_t color[4]) {
+  __m256i color_pixels =
+      _mm256_set1_epi32(static_cast<int>(LoadPixel(color)));
+  bool opaque = color[3] == 255;
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    uint64_t pixel_coverage = LoadCoverage8(coverage + i);
+    if (pixel_coverage == 0) {
+      continue;
+    }
+    if (pixel_coverage == ~static_cast<uint64_t>(0) && opaque) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i * 4),
+                          color_pixels);
+      continue;
+    }
+    CompositeEightPixelsAVX2(dst + i * 4, color_pixels, pixel_coverage);
+  }
+  CompositeSolidSpanScalar(dst + i * 4, coverage + i, count - i, color);
+}
+
+SVG_TARGET_AVX2 void CompositeSpanAVX2(uint8_t *dst,
+                                       const uint8_t *src,
+                                       const uint8_t *coverage,
+                                       size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    uint64_t pixel_coverage = LoadCoverage8(coverage + i);
+    if (pixel_coverage == 0) {
+      continue;
+    }
+    __m256i src_pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i * 4));
+    CompositeEightPixelsAVX2(dst + i * 4, src_pixels, pixel_coverage);
+  }
+  CompositeSpanScalar(dst + i * 4, src + i * 4, coverage + i, count - i);
+}
+
+#undef SVG_TARGET_SSE2
+#undef SVG_TARGET_AVX2
+
+const CompositingKernels kSSE2CompositingKernels = {
+  CompositeSolidSpanSSE2,
+  CompositeSpanSSE2,
+};
+
+const CompositingKernels kAVX2CompositingKernels = {
+  CompositeSolidSpanAVX2,
+  CompositeSpanAVX2,
+};
+
+#endif  // SVG_X86_COMPOSITING_KERNELS
+
+const CompositingKernels *ChooseCompositingKernels() {
+  const CompositingKernelType kPreferredTypes[] = {
+    kCompositingKernelAVX2,
+    kCompositingKernelSSE2,
+  };
+  for (CompositingKernelType type : kPreferredTypes) {
+    const CompositingKernels *kernels = GetCompositingKernels(type);
+    if (kernels) {
+      return kernels;
+    }
+  }
+  return &kScalarCompositingKernels;
+}
+
+inline const CompositingKernels &BestCompositingKernels() {
+  static const CompositingKernels *kernels = ChooseCompositingKernels();
+  return *kernels;
+}
+
+}  // namespace
+
+void CompositeSolidSpan(uint8_t *dst,
+                        const uint8_t *coverage,
+                        size_t count,
+                        const uint8_t color[4]) {
+  BestCompositingKernels().composite_solid_span(dst, coverage, count, color);
+}
+
+void CompositeSpan(uint8_t *dst,
+                   const uint8_t *src,
+                   const uint8_t *coverage,
+                   size_t count) {
+  BestCompositingKernels().composite_span(dst, src, coverage, count);
+}
+
+const CompositingKernels *GetCompositingKernels(CompositingKernelType type) {
+  switch (type) {
+    case kCompositingKernelScalar:
+      return &kScalarCompositingKernels;
+#if SVG_X86_COMPOSITING_KERNELS
+    case kCompositingKernelSSE2:
+      return CPUSupportsSSE2() ? &kSSE2CompositingKernels : NULL;
+    case kCompositingKernelAVX2:
+      return CPUSupportsAVX2() ? &kAVX2CompositingKernels : NULL;
+#endif  // SVG_X86_COMPOSITING_KERNELS
+    default:
+      return NULL;
+  }
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace metrosvg {
+namespace internal {
+
+// Span kernels of the software renderer. Pixels are 8-bit RGBA with
+// premultiplied alpha, in the layout of kCGImageAlphaPremultipliedLast
+// with the default byte order, i.e. R, G, B and A bytes in that order.
+// Sources are composited with the source-over operator after being
+// scaled by a coverage value from 0 to 255.
+
+// Returns x / 255 rounded to the nearest integer, for x in [0, 255 * 255].
+static inline uint32_t DivideBy255(uint32_t x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+// Composites |color| over |count| pixels of |dst|, scaled by the
+// corresponding values of |coverage|.
+void CompositeSolidSpan(uint8_t *dst,
+                        const uint8_t *coverage,
+                        size_t count,
+                        const uint8_t color[4]);
+
+// Composites the |count| pixels of |src| over those of |dst|, scaled by
+// the corresponding values of |coverage|.
+void CompositeSpan(uint8_t *dst,
+                   const uint8_t *src,
+                   const uint8_t *coverage,
+                   size_t count);
+
+// The functions above run the fastest implementation of the kernels that
+// the CPU supports, which is chosen on first use. The implementations
+// produce bit-identical results.
+enum CompositingKernelType {
+  kCompositingKernelScalar,
+  kCompositingKernelSSE2,
+  kCompositingKernelAVX2,
+};
+
+struct CompositingKernels {
+  void (*composite_solid_span)(uint8_t *dst,
+                               const uint8_t *coverage,
+                               size_t count,
+                               const uint8_t color[4]);
+  void (*composite_span)(uint8_t *dst,
+                         const uint8_t *src,
+                         const uint8_t *coverage,
+                         size_t count);
+};
+
+// Returns the implementation of the kernels of |type|, or NULL if it isn't
+// built in or the CPU doesn't support it.
+const CompositingKernels *GetCompositingKernels(CompositingKernelType type);
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Compositing.h"
+#include "MetroSVG/Internal/Utils.h"
+
+using namespace metrosvg::internal;
+
+// Fills |pixels| with random premultiplied pixels. Some are fully
+// transparent and some opaque.
+static void RandomPixels(std::mt19937 *random, std::vector<uint8_t> *pixels) {
+  for (size_t i = 0; i < pixels->size(); i += 4) {
+    uint8_t alpha;
+    switch ((*random)() % 4) {
+      case 0:
+        alpha = 0;
+        break;
+      case 1:
+        alpha = 255;
+        break;
+      default:
+        alpha = (*random)() % 256;
+        break;
+    }
+    for (int channel = 0; channel < 3; ++channel) {
+      (*pixels)[i + channel] = (*random)() % (alpha + 1);
+    }
+    (*pixels)[i + 3] = alpha;
+  }
+}
+
+// Fills |coverage| with random values, including runs of 0 and 255 long
+// enough for the vector kernels to take their shortcuts.
+static void RandomCoverage(std::mt19937 *random,
+                           std::vector<uint8_t> *coverage) {
+  size_t i = 0;
+  while (i < coverage->size()) {
+    size_t run = 1 + (*random)() % 12;
+    uint32_t kind = (*random)() % 3;
+    for (; run > 0 && i < coverage->size(); --run, ++i) {
+      if (kind == 0) {
+        (*coverage)[i] = 0;
+      } else if (kind == 1) {
+        (*coverage)[i] = 255;
+      } else {
+        (*coverage)[i] = (*random)() % 256;
+      }
+    }
+  }
+}
+
+static std::vector<const CompositingKernels *> SupportedKernels() {
+  std::vector<const CompositingKernels *> kernels;
+  for (CompositingKernelType type : {kCompositingKernelSSE2,
+                                     kCompositingKernelAVX2}) {
+    if (GetCompositingKernels(type)) {
+      kernels.push_back(GetCompositingKernels(type));
+    }
+  }
+  return kernels;
+}
+
+// Size of the spans composited by the performance tests, a canvas of
+// 1024 x 1024 pixels.
+static const size_t kBenchmarkSpanLength = 1024;
+static const int kBenchmarkSpanCount = 1024;
+
+// Composites a translucent color with |composite_solid_span| over the
+// benchmark spans, with coverage like that of antialiased shapes.
+static void MeasureSolidSpans(XCTestCase *test_case,
+                              void (*composite_solid_span)(
+                                  uint8_t *dst,
+                                  const uint8_t *coverage,
+                                  size_t count,
+                                  const uint8_t color[4])) {
+  std::mt19937 random(3);
+  std::vector<uint8_t> dst(kBenchmarkSpanLength * 4);
+  std::vector<uint8_t> coverage(kBenchmarkSpanLength);
+  RandomPixels(&random, &dst);
+  RandomCoverage(&random, &coverage);
+  uint8_t *dst_pixels = dst.data();
+  const uint8_t *coverage_values = coverage.data();
+  [test_case measureBlock:^{
+    const uint8_t color[] = {64, 32, 0, 128};
+    for (int i = 0; i < kBenchmarkSpanCount; ++i) {
+      composite_solid_span(dst_pixels, coverage_values, kBenchmarkSpanLength,
+                           color);
+    }
+  }];
+}
+
+// Composites random pixels with |composite_span| over the benchmark spans,
+// as when a gradient or a transparency layer is painted.
+static void MeasureSpans(XCTestCase *test_case,
+                         void (*composite_span)(uint8_t *dst,
+                                                const uint8_t *src,
+                                                const uint8_t *coverage,
+                                                size_t count)) {
+  std::mt19937 random(4);
+  std::vector<uint8_t> dst(kBenchmarkSpanLength * 4);
+  std::vector<uint8_t> src(kBenchmarkSpanLength * 4);
+  std::vector<uint8_t> coverage(kBenchmarkSpanLength);
+  RandomPixels(&random, &dst);
+  RandomPixels(&random, &src);
+  RandomCoverage(&random, &coverage);
+  uint8_t *dst_pixels = dst.data();
+  const uint8_t *src_pixels = src.data();
+  const uint8_t *coverage_values = coverage.data();
+  [test_case measureBlock:^{
+    for (int i = 0; i < kBenchmarkSpanCount; ++i) {
+      composite_span(dst_pixels, src_pixels, coverage_values,
+                     kBenchmarkSpanLength);
+    }
+  }];
+}
+
+@interface CompositingTest : XCTestCase
+@end
+
+@implementation CompositingTest
+
+- (void)testCompositeSolidSpan_Coverage {
+  uint8_t dst[] = {
+    0, 0, 0, 0,
+    100, 0, 0, 100,
+    100, 0, 0, 100,
+    255, 255, 255, 255,
+  };
+  const uint8_t coverage[] = {255, 0, 255, 128};
+  const uint8_t color[] = {0, 0, 128, 128};
+  CompositeSolidSpan(dst, coverage, 4, color);
+  const uint8_t expected[] = {
+    0, 0, 128, 128,
+    100, 0, 0, 100,
+    50, 0, 128, 178,
+    191, 191, 255, 255,
+  };
+  XCTAssertEqual(memcmp(dst, expected, sizeof(dst)), 0);
+}
+
+- (void)testCompositeSpan_Coverage {
+  uint8_t dst[] = {
+    10, 20, 30, 40,
+    10, 20, 30, 40,
+    10, 20, 30, 40,
+  };
+  const uint8_t src[] = {
+    255, 0, 0, 255,
+    255, 0, 0, 255,
+    0, 0, 0, 0,
+  };
+  const uint8_t coverage[] = {0, 255, 255};
+  CompositeSpan(dst, src, coverage, 3);
+  const uint8_t expected[] = {
+    10, 20, 30, 40,
+    255, 0, 0, 255,
+    10, 20, 30, 40,
+  };
+  XCTAssertEqual(memcmp(dst, expected, sizeof(dst)), 0);
+}
+
+- (void)testGetCompositingKernels_Scalar {
+  XCTAssert(GetCompositingKernels(kCompositingKernelScalar) != NULL);
+}
+
+- (void)testCompositeSolidSpan_KernelsMatchScalar {
+  const CompositingKernels *scalar =
+      GetCompositingKernels(kCompositingKernelScalar);
+  std::mt19937 random(1);
+  for (const CompositingKernels *kernels : SupportedKernels()) {
+    for (size_t count = 0; count < 70; ++count) {
+      // Spans of the canvases don't start at aligned addresses.
+      for (size_t offset = 0; offset < 3; ++offset) {
+        std::vector<uint8_t> dst((count + offset) * 4);
+        std::vector<uint8_t> coverage(count + offset);
+        RandomPixels(&random, &dst);
+        RandomCoverage(&random, &coverage);
+        std::vector<uint8_t> color(4);
+        RandomPixels(&random, &color);
+        std::vector<uint8_t> expected = dst;
+        scalar->composite_solid_span(&expected[offset * 4],
+                                     &coverage[offset], count, &color[0]);
+        kernels->composite_solid_span(&dst[offset * 4],
+                                      &coverage[offset], count, &color[0]);
+        XCTAssert(dst == expected);
+      }
+    }
+  }
+}
+
+- (void)testCompositeSpan_KernelsMatchScalar {
+  const CompositingKernels *scalar =
+      GetCompositingKernels(kCompositingKernelScalar);
+  std::mt19937 random(2);
+  for (const CompositingKernels *kernels : SupportedKernels()) {
+    for (size_t count = 0; count < 70; ++count) {
+      for (size_t offset = 0; offset < 3; ++offset) {
+        std::vector<uint8_t> dst((count + offset) * 4);
+        std::vector<uint8_t> src((count + offset) * 4);
+        std::vector<uint8_t> coverage(count + offset);
+        RandomPixels(&random, &dst);
+        RandomPixels(&random, &src);
+        RandomCoverage(&random, &coverage);
+        std::vector<uint8_t> expected = dst;
+        scalar->composite_span(&expected[offset * 4], &src[offset * 4],
+                               &coverage[offset], count);
+        kernels->composite_span(&dst[offset * 4], &src[offset * 4],
+                                &coverage[offset], count);
+        XCTAssert(dst == expected);
+      }
+    }
+  }
+}
+
+- (void)testCompositeSpan_KernelsMatchScalarExhaustively {
+  // Every combination of a source alpha and coverage over a few
+  // destinations.
+  const CompositingKernels *scalar =
+      GetCompositingKernels(kCompositingKernelScalar);
+  for (const CompositingKernels *kernels : SupportedKernels()) {
+    for (int alpha = 0; alpha < 256; ++alpha) {
+      std::vector<uint8_t> src(256 * 4);
+      std::vector<uint8_t> coverage(256);
+      for (int i = 0; i < 256; ++i) {
+        src[i * 4] = alpha;
+        src[i * 4 + 1] = alpha / 2;
+        src[i * 4 + 2] = 0;
+        src[i * 4 + 3] = alpha;
+        coverage[i] = i;
+      }
+      for (uint8_t dst_alpha : {0, 1, 128, 254, 255}) {
+        std::vector<uint8_t> dst(256 * 4);
+        for (int i = 0; i < 256; ++i) {
+          dst[i * 4] = dst_alpha;
+          dst[i * 4 + 1] = 0;
+          dst[i * 4 + 2] = dst_alpha / 3;
+          dst[i * 4 + 3] = dst_alpha;
+        }
+        std::vector<uint8_t> expected = dst;
+        scalar->composite_span(&expected[0], &src[0], &coverage[0], 256);
+        kernels->composite_span(&dst[0], &src[0], &coverage[0], 256);
+        XCTAssert(dst == expected);
+      }
+    }
+  }
+}
+
+// The performance tests compare the scalar kernels with the ones that the
+// software renderer picks for the CPU.
+
+- (void)testPerformance_CompositeSolidSpan_Scalar {
+  MeasureSolidSpans(
+      self,
+      GetCompositingKernels(kCompositingKernelScalar)->composite_solid_span);
+}
+
+- (void)testPerformance_CompositeSolidSpan {
+  MeasureSolidSpans(self, CompositeSolidSpan);
+}
+
+- (void)testPerformance_CompositeSpan_Scalar {
+  MeasureSpans(self,
+               GetCompositingKernels(kCompositingKernelScalar)->composite_span);
+}
+
+- (void)testPerformance_CompositeSpan {
+  MeasureSpans(self, CompositeSpan);
+}
+
+@end
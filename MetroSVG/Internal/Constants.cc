@@ -21,7 +21,7 @@
 namespace metrosvg {
 namespace internal {
 
-const CGFloat kPi = static_cast<CGFloat>(M_PI);
+const Float kPi = static_cast<Float>(M_PI);
 
 }  // namespace internal
 }  // namespace metrosvg
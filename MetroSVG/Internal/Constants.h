@@ -16,12 +16,12 @@
 
 #pragma once
 
-#include <CoreGraphics/CoreGraphics.h>
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
 
-extern const CGFloat kPi;
+extern const Float kPi;
 
 }  // namespace internal
 }  // namespace metrosvg
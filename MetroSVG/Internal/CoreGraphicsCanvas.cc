@@ -0,0 +1,362 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/CoreGraphicsCanvas.h"
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include <CoreGraphics/CoreGraphics.h>
+
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/GradientCache.h"
+#include "MetroSVG/Internal/PathCache.h"
+#include "MetroSVG/Internal/Utils.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Float is as wide as CGFloat, so dash lengths can be passed to CoreGraphics
+// as they are.
+static_assert(std::is_same<Float, CGFloat>::value,
+              "Float must be the same type as CGFloat");
+
+const CGGradientDrawingOptions kGradientDrawingOptions =
+    kCGGradientDrawsBeforeStartLocation | kCGGradientDrawsAfterEndLocation;
+
+CGPoint ToCGPoint(FloatPoint point) {
+  return CGPointMake(point.x, point.y);
+}
+
+CGRect ToCGRect(const FloatRect &rect) {
+  return CGRectMake(rect.origin.x, rect.origin.y,
+                    rect.size.width, rect.size.height);
+}
+
+CGAffineTransform ToCGAffineTransform(const AffineTransform &transform) {
+  return CGAffineTransformMake(transform.a, transform.b,
+                               transform.c, transform.d,
+                               transform.tx, transform.ty);
+}
+
+FloatRect ToFloatRect(CGRect rect) {
+  return FloatRect(rect.origin.x, rect.origin.y,
+                   rect.size.width, rect.size.height);
+}
+
+}  // namespace
+
+CoreGraphicsCanvas::CoreGraphicsCanvas(size_t width, size_t height)
+    : CoreGraphicsCanvas(width, height, NULL, width * 4,
+                         kMSCPixelFormatRGBA8888) {}
+
+CoreGraphicsCanvas::CoreGraphicsCanvas(size_t width,
+                                       size_t height,
+                                       void *pixels,
+                                       size_t bytes_per_row,
+                                       MSCPixelFormat format)
+    : width_(width),
+      height_(height),
+      format_(format),
+      path_(CGPathCreateMutable()) {
+  CGBitmapInfo bitmap_info;
+  if (format_ == kMSCPixelFormatBGRA8888) {
+    bitmap_info = (CGBitmapInfo)kCGImageAlphaPremultipliedFirst |
+                  kCGBitmapByteOrder32Little;
+  } else {
+    bitmap_info = (CGBitmapInfo)kCGImageAlphaPremultipliedLast;
+  }
+  CGColorSpaceRef color_space = CGColorSpaceCreateDeviceRGB();
+  context_ = CGBitmapContextCreate(pixels,
+                                   width_,
+                                   height_,
+                                   8,
+                                   bytes_per_row,
+                                   color_space,
+                                   bitmap_info);
+  CGColorSpaceRelease(color_space);
+
+  CGContextClearRect(context_, CGRectMake(0.f, 0.f, width_, height_));
+
+  // These transforms are needed because the coordinate systems of
+  // UIImage and CG contexts are flipped from each other.
+  // TODO: Figure out how to handle this on OS X.
+  CGContextTranslateCTM(context_, 0.f, height_);
+  CGContextScaleCTM(context_, 1.f, -1.f);
+}
+
+CoreGraphicsCanvas::~CoreGraphicsCanvas() {
+  CGPathRelease(path_);
+  CGContextRelease(context_);
+}
+
+CGImageRef CoreGraphicsCanvas::CreateCGImage() {
+  return CGBitmapContextCreateImage(context_);
+}
+
+void CoreGraphicsCanvas::SaveGState() {
+  CGContextSaveGState(context_);
+}
+
+void CoreGraphicsCanvas::RestoreGState() {
+  FlushPath();
+  CGContextRestoreGState(context_);
+}
+
+void CoreGraphicsCanvas::ConcatCTM(const AffineTransform &transform) {
+  FlushPath();
+  CGContextConcatCTM(context_, ToCGAffineTransform(transform));
+}
+
+void CoreGraphicsCanvas::SetAlpha(Float alpha) {
+  CGContextSetAlpha(context_, alpha);
+}
+
+void CoreGraphicsCanvas::SetRGBFillColor(Float red,
+                                         Float green,
+                                         Float blue,
+                                         Float alpha) {
+  CGContextSetRGBFillColor(context_, red, green, blue, alpha);
+}
+
+void CoreGraphicsCanvas::SetRGBStrokeColor(Float red,
+                                           Float green,
+                                           Float blue,
+                                           Float alpha) {
+  CGContextSetRGBStrokeColor(context_, red, green, blue, alpha);
+}
+
+void CoreGraphicsCanvas::SetLineWidth(Float width) {
+  CGContextSetLineWidth(context_, width);
+}
+
+void CoreGraphicsCanvas::SetLineCap(LineCap cap) {
+  switch (cap) {
+    case kLineCapButt:
+      CGContextSetLineCap(context_, kCGLineCapButt);
+      break;
+    case kLineCapRound:
+      CGContextSetLineCap(context_, kCGLineCapRound);
+      break;
+    case kLineCapSquare:
+      CGContextSetLineCap(context_, kCGLineCapSquare);
+      break;
+  }
+}
+
+void CoreGraphicsCanvas::SetLineJoin(LineJoin join) {
+  switch (join) {
+    case kLineJoinMiter:
+      CGContextSetLineJoin(context_, kCGLineJoinMiter);
+      break;
+    case kLineJoinRound:
+      CGContextSetLineJoin(context_, kCGLineJoinRound);
+      break;
+    case kLineJoinBevel:
+      CGContextSetLineJoin(context_, kCGLineJoinBevel);
+      break;
+  }
+}
+
+void CoreGraphicsCanvas::SetMiterLimit(Float limit) {
+  CGContextSetMiterLimit(context_, limit);
+}
+
+void CoreGraphicsCanvas::SetLineDash(Float phase,
+                                     const Float *lengths,
+                                     size_t count) {
+  CGContextSetLineDash(context_, phase, lengths, count);
+}
+
+void CoreGraphicsCanvas::ClipToRect(FloatRect rect) {
+  CGContextClipToRect(context_, ToCGRect(rect));
+}
+
+void CoreGraphicsCanvas::BeginTransparencyLayer() {
+  CGContextBeginTransparencyLayer(context_, nullptr);
+}
+
+void CoreGraphicsCanvas::EndTransparencyLayer() {
+  CGContextEndTransparencyLayer(context_);
+}
+
+void CoreGraphicsCanvas::BeginPath() {
+  if (!CGPathIsEmpty(path_)) {
+    CGPathRelease(path_);
+    path_ = CGPathCreateMutable();
+  }
+  CGContextBeginPath(context_);
+}
+
+void CoreGraphicsCanvas::MoveToPoint(Float x, Float y) {
+  CGPathMoveToPoint(path_, NULL, x, y);
+}
+
+void CoreGraphicsCanvas::AddLineToPoint(Float x, Float y) {
+  CGPathAddLineToPoint(path_, NULL, x, y);
+}
+
+void CoreGraphicsCanvas::AddCurveToPoint(Float cp1x, Float cp1y,
+                                         Float cp2x, Float cp2y,
+                                         Float x, Float y) {
+  CGPathAddCurveToPoint(path_, NULL, cp1x, cp1y, cp2x, cp2y, x, y);
+}
+
+void CoreGraphicsCanvas::AddQuadCurveToPoint(Float cpx, Float cpy,
+                                             Float x, Float y) {
+  CGPathAddQuadCurveToPoint(path_, NULL, cpx, cpy, x, y);
+}
+
+void CoreGraphicsCanvas::AddArc(const AffineTransform *transform,
+                                Float x, Float y, Float radius,
+                                Float start_angle, Float end_angle,
+                                bool clockwise) {
+  CGAffineTransform cg_transform;
+  if (transform) {
+    cg_transform = ToCGAffineTransform(*transform);
+  }
+  CGPathAddArc(path_, transform ? &cg_transform : NULL, x, y, radius,
+               start_angle, end_angle, clockwise);
+}
+
+void CoreGraphicsCanvas::AddEllipseInRect(FloatRect rect) {
+  CGPathAddEllipseInRect(path_, NULL, ToCGRect(rect));
+}
+
+void CoreGraphicsCanvas::AddRoundedRect(FloatRect rect,
+                                        Float corner_width,
+                                        Float corner_height) {
+  CGPathAddRoundedRect(path_, NULL, ToCGRect(rect), corner_width,
+                       corner_height);
+}
+
+void CoreGraphicsCanvas::ClosePath() {
+  CGPathCloseSubpath(path_);
+}
+
+bool CoreGraphicsCanvas::AddElementPath(const SceneGraph &graph,
+                                        size_t element_index) {
+  CGPathRef path = PathCache::Shared()->CreatePath(graph, element_index);
+  // When no segments are pending, the path goes straight into the context
+  // rather than being copied into |path_| first.
+  if (CGPathIsEmpty(path_)) {
+    CGContextAddPath(context_, path);
+  } else {
+    CGPathAddPath(path_, NULL, path);
+  }
+  CGPathRelease(path);
+  return true;
+}
+
+FloatPoint CoreGraphicsCanvas::GetPathCurrentPoint() {
+  CGPoint point;
+  if (CGPathIsEmpty(path_)) {
+    point = CGContextIsPathEmpty(context_) ?
+        CGPointZero : CGContextGetPathCurrentPoint(context_);
+  } else {
+    point = CGPathGetCurrentPoint(path_);
+  }
+  return FloatPoint(point.x, point.y);
+}
+
+FloatRect CoreGraphicsCanvas::GetPathBoundingBox() {
+  FlushPath();
+  return ToFloatRect(CGContextGetPathBoundingBox(context_));
+}
+
+FloatRect CoreGraphicsCanvas::GetClipBoundingBox() {
+  return ToFloatRect(CGContextGetClipBoundingBox(context_));
+}
+
+void CoreGraphicsCanvas::FillPath(FillRule fill_rule) {
+  FlushPath();
+  if (fill_rule == kFillRuleEvenOdd) {
+    CGContextEOFillPath(context_);
+  } else {
+    CGContextFillPath(context_);
+  }
+}
+
+void CoreGraphicsCanvas::StrokePath() {
+  FlushPath();
+  CGContextStrokePath(context_);
+}
+
+void CoreGraphicsCanvas::ReplacePathWithStrokedPath() {
+  FlushPath();
+  CGContextReplacePathWithStrokedPath(context_);
+}
+
+void CoreGraphicsCanvas::Clip() {
+  FlushPath();
+  CGContextClip(context_);
+}
+
+void CoreGraphicsCanvas::DrawLinearGradient(const Gradient &gradient,
+                                            FloatPoint start_point,
+                                            FloatPoint end_point) {
+  CGGradientRef cg_gradient =
+      CGGradientCache::Shared()->CreateCGGradient(gradient);
+  auto delete_cg_gradient = MakeUniquePtr(cg_gradient, CGGradientRelease);
+  CGContextDrawLinearGradient(context_, cg_gradient, ToCGPoint(start_point),
+                              ToCGPoint(end_point), kGradientDrawingOptions);
+}
+
+void CoreGraphicsCanvas::DrawRadialGradient(const Gradient &gradient,
+                                            FloatPoint focal_point,
+                                            FloatPoint center_point,
+                                            Float radius) {
+  CGGradientRef cg_gradient =
+      CGGradientCache::Shared()->CreateCGGradient(gradient);
+  auto delete_cg_gradient = MakeUniquePtr(cg_gradient, CGGradientRelease);
+  CGContextDrawRadialGradient(context_, cg_gradient, ToCGPoint(focal_point), 0,
+                              ToCGPoint(center_point), radius,
+                              kGradientDrawingOptions);
+}
+
+void CoreGraphicsCanvas::ReadPixels(void *pixels, size_t bytes_per_row) {
+  const char *data =
+      static_cast<const char *>(CGBitmapContextGetData(context_));
+  if (data == NULL) {
+    return;
+  }
+  // The bitmap context stores the top row first, regardless of the flip
+  // applied to its CTM.
+  size_t context_bytes_per_row = CGBitmapContextGetBytesPerRow(context_);
+  for (size_t y = 0; y < height_; ++y) {
+    char *row = static_cast<char *>(pixels) + y * bytes_per_row;
+    memcpy(row, data + y * context_bytes_per_row, width_ * 4);
+    if (format_ == kMSCPixelFormatBGRA8888) {
+      for (size_t x = 0; x < width_; ++x) {
+        std::swap(row[x * 4], row[x * 4 + 2]);
+      }
+    }
+  }
+}
+
+void CoreGraphicsCanvas::FlushPath() {
+  if (!CGPathIsEmpty(path_)) {
+    CGContextAddPath(context_, path_);
+    CGPathRelease(path_);
+    path_ = CGPathCreateMutable();
+  }
+}
+
+}  // namespace internal
+}  // namespace metrosvg
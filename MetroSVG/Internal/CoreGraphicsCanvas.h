@@ -0,0 +1,128 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <CoreGraphics/CoreGraphics.h>
+
+#include "MetroSVG/Internal/Canvas.h"
+#include "MetroSVG/Internal/Macros.h"
+#include "MetroSVG/MetroSVG.h"
+
+namespace metrosvg {
+namespace internal {
+
+// A canvas backed by a CoreGraphics bitmap context.
+class CoreGraphicsCanvas : public Canvas {
+ public:
+  CoreGraphicsCanvas(size_t width, size_t height);
+  // Renders into |pixels| instead of memory owned by the canvas. |pixels|
+  // must hold |height| rows of |bytes_per_row| bytes, which is at least
+  // 4 * |width|, and outlive the canvas. The pixels are cleared.
+  CoreGraphicsCanvas(size_t width,
+                     size_t height,
+                     void *pixels,
+                     size_t bytes_per_row,
+                     MSCPixelFormat format);
+  virtual ~CoreGraphicsCanvas();
+
+  // Returns an image of the current contents of the canvas.
+  // Caller should release the returned instance.
+  CGImageRef CreateCGImage();
+
+  virtual size_t width() const { return width_; }
+  virtual size_t height() const { return height_; }
+
+  virtual void SaveGState();
+  virtual void RestoreGState();
+  virtual void ConcatCTM(const AffineTransform &transform);
+  virtual void SetAlpha(Float alpha);
+  virtual void SetRGBFillColor(Float red,
+                               Float green,
+                               Float blue,
+                               Float alpha);
+  virtual void SetRGBStrokeColor(Float red,
+                                 Float green,
+                                 Float blue,
+                                 Float alpha);
+  virtual void SetLineWidth(Float width);
+  virtual void SetLineCap(LineCap cap);
+  virtual void SetLineJoin(LineJoin join);
+  virtual void SetMiterLimit(Float limit);
+  virtual void SetLineDash(Float phase,
+                           const Float *lengths,
+                           size_t count);
+  virtual void ClipToRect(FloatRect rect);
+
+  virtual void BeginTransparencyLayer();
+  virtual void EndTransparencyLayer();
+
+  virtual void BeginPath();
+  virtual void MoveToPoint(Float x, Float y);
+  virtual void AddLineToPoint(Float x, Float y);
+  virtual void AddCurveToPoint(Float cp1x, Float cp1y,
+                               Float cp2x, Float cp2y,
+                               Float x, Float y);
+  virtual void AddQuadCurveToPoint(Float cpx, Float cpy,
+                                   Float x, Float y);
+  virtual void AddArc(const AffineTransform *transform,
+                      Float x, Float y, Float radius,
+                      Float start_angle, Float end_angle,
+                      bool clockwise);
+  virtual void AddEllipseInRect(FloatRect rect);
+  virtual void AddRoundedRect(FloatRect rect,
+                              Float corner_width,
+                              Float corner_height);
+  virtual void ClosePath();
+  // Adds the path kept by PathCache::Shared().
+  virtual bool AddElementPath(const SceneGraph &graph, size_t element_index);
+  virtual FloatPoint GetPathCurrentPoint();
+  virtual FloatRect GetPathBoundingBox();
+  virtual FloatRect GetClipBoundingBox();
+
+  virtual void FillPath(FillRule fill_rule);
+  virtual void StrokePath();
+  virtual void ReplacePathWithStrokedPath();
+  virtual void Clip();
+  virtual void DrawLinearGradient(const Gradient &gradient,
+                                  FloatPoint start_point,
+                                  FloatPoint end_point);
+  virtual void DrawRadialGradient(const Gradient &gradient,
+                                  FloatPoint focal_point,
+                                  FloatPoint center_point,
+                                  Float radius);
+
+  virtual void ReadPixels(void *pixels, size_t bytes_per_row);
+
+ private:
+  size_t width_;
+  size_t height_;
+  MSCPixelFormat format_;
+  CGContextRef context_;
+  // Path segments are collected here rather than in the context, because
+  // CGContext has no equivalent of CGPathAddArc with a transform.
+  CGMutablePathRef path_;
+
+  // Moves the collected path segments into the context.
+  void FlushPath();
+
+  DISALLOW_COPY_AND_ASSIGN(CoreGraphicsCanvas);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
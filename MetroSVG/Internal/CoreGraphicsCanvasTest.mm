@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/CoreGraphicsCanvas.h"
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/GradientCache.h"
+
+using namespace metrosvg::internal;
+
+@interface CoreGraphicsCanvasTest : XCTestCase
+@end
+
+@implementation CoreGraphicsCanvasTest
+
+- (void)testReadPixels_InitiallyTransparent {
+  CoreGraphicsCanvas canvas(4, 2);
+  std::vector<uint8_t> pixels(4 * 4 * 2, 0xff);
+  canvas.ReadPixels(pixels.data(), 4 * 4);
+  for (uint8_t value : pixels) {
+    XCTAssertEqual(value, 0);
+  }
+}
+
+- (void)testReadPixels_TopRowFirst {
+  CoreGraphicsCanvas canvas(2, 2);
+  canvas.SetRGBFillColor(1, 0, 0, 1);
+  canvas.BeginPath();
+  canvas.AddRoundedRect(FloatRect(0, 0, 2, 1), 0, 0);
+  canvas.FillPath(kFillRuleNonZero);
+
+  // Rows are padded to check that |bytes_per_row| is respected.
+  std::vector<uint8_t> pixels(12 * 2);
+  canvas.ReadPixels(pixels.data(), 12);
+  XCTAssertEqual(pixels[0], 0xff);
+  XCTAssertEqual(pixels[3], 0xff);
+  XCTAssertEqual(pixels[4], 0xff);
+  XCTAssertEqual(pixels[12], 0);
+  XCTAssertEqual(pixels[15], 0);
+}
+
+- (void)testExternalPixels {
+  // Rows are padded to check that the padding is left alone.
+  std::vector<uint8_t> pixels(12 * 2, 0xab);
+  CoreGraphicsCanvas canvas(2, 2, pixels.data(), 12, kMSCPixelFormatBGRA8888);
+  canvas.SetRGBFillColor(1, 0, 0, 1);
+  canvas.BeginPath();
+  canvas.AddRoundedRect(FloatRect(0, 0, 2, 1), 0, 0);
+  canvas.FillPath(kFillRuleNonZero);
+
+  XCTAssertEqual(pixels[0], 0);
+  XCTAssertEqual(pixels[2], 0xff);
+  XCTAssertEqual(pixels[3], 0xff);
+  XCTAssertEqual(pixels[8], 0xab);
+  XCTAssertEqual(pixels[12], 0);
+  XCTAssertEqual(pixels[15], 0);
+
+  // ReadPixels still returns RGBA.
+  std::vector<uint8_t> rgba_pixels(8 * 2);
+  canvas.ReadPixels(rgba_pixels.data(), 8);
+  XCTAssertEqual(rgba_pixels[0], 0xff);
+  XCTAssertEqual(rgba_pixels[2], 0);
+  XCTAssertEqual(rgba_pixels[3], 0xff);
+}
+
+- (void)testGetPathCurrentPoint {
+  CoreGraphicsCanvas canvas(2, 2);
+  canvas.BeginPath();
+  XCTAssert(canvas.GetPathCurrentPoint() == FloatPoint());
+  canvas.MoveToPoint(1, 2);
+  canvas.AddLineToPoint(3, 4);
+  XCTAssert(canvas.GetPathCurrentPoint() == FloatPoint(3, 4));
+}
+
+- (void)testDrawGradient_UsesSharedCache {
+  Gradient gradient(Gradient::kTypeLinear, AttributeTable());
+  gradient.stops.push_back(GradientStop(0, RgbColor(0.25, 0.5, 0.75), 1));
+  gradient.stops.push_back(GradientStop(1, RgbColor(0.75, 0.5, 0.25), 0.5));
+  CGGradientCache *cache = CGGradientCache::Shared();
+  size_t hit_count = cache->hit_count();
+  size_t miss_count = cache->miss_count();
+
+  CoreGraphicsCanvas canvas(2, 2);
+  canvas.DrawLinearGradient(gradient, FloatPoint(), FloatPoint(2, 0));
+  canvas.DrawRadialGradient(gradient, FloatPoint(), FloatPoint(), 2);
+  XCTAssertEqual(cache->hit_count() + cache->miss_count(),
+                 hit_count + miss_count + 2);
+  XCTAssertGreaterThanOrEqual(cache->hit_count(), hit_count + 1);
+}
+
+@end
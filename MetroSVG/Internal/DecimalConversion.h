@@ -0,0 +1,39 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace metrosvg {
+namespace internal {
+
+// Return the double or float nearest to |mantissa| * 10^|exponent|, with
+// ties rounded to even, which is what strtod and strtof return for a
+// decimal number of up to 19 significant digits. The results overflow to
+// infinity and underflow to zero.
+//
+// Values whose mantissa and power of ten are both exactly representable
+// are converted with a single floating-point multiplication or division.
+// The others use the Eisel-Lemire algorithm, which multiplies the mantissa
+// by a 128-bit approximation of the power of ten. The approximation is
+// always close enough to round correctly (Mushtak and Lemire, "Fast Number
+// Parsing Without Fallback", 2023).
+double DecimalToDouble(uint64_t mantissa, int exponent);
+float DecimalToFloat(uint64_t mantissa, int exponent);
+
+}  // namespace internal
+}  // namespace metrosvg
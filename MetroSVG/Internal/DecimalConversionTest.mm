@@ -0,0 +1,108 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <XCTest/XCTest.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "MetroSVG/Internal/DecimalConversion.h"
+
+using namespace metrosvg::internal;
+
+// Returns whether DecimalToDouble and DecimalToFloat agree with strtod and
+// strtof for |mantissa| * 10^|exponent|.
+static bool MatchesStrtod(uint64_t mantissa, int exponent) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%llue%d",
+           static_cast<unsigned long long>(mantissa), exponent);
+  return DecimalToDouble(mantissa, exponent) == strtod(buffer, NULL) &&
+         DecimalToFloat(mantissa, exponent) == strtof(buffer, NULL);
+}
+
+@interface DecimalConversionTest : XCTestCase
+@end
+
+@implementation DecimalConversionTest
+
+- (void)testDecimalToDouble {
+  XCTAssertEqual(DecimalToDouble(0, 0), 0.0);
+  XCTAssertEqual(DecimalToDouble(0, 500), 0.0);
+  XCTAssertEqual(DecimalToDouble(15, -1), 1.5);
+  XCTAssertEqual(DecimalToDouble(1, -1), 0.1);
+  XCTAssertEqual(DecimalToDouble(123456789012345678ULL, -17),
+                 1.23456789012345678);
+  XCTAssertEqual(DecimalToDouble(17976931348623157ULL, 292), DBL_MAX);
+  XCTAssertEqual(DecimalToDouble(22250738585072014ULL, -324), DBL_MIN);
+}
+
+- (void)testDecimalToDouble_Subnormal {
+  XCTAssertEqual(DecimalToDouble(49406564584124654ULL, -340),
+                 std::nextafter(0.0, 1.0));
+  // Half of the smallest subnormal rounds to even, i.e., zero.
+  XCTAssertEqual(DecimalToDouble(24703282292062327ULL, -340), 0.0);
+  XCTAssertEqual(DecimalToDouble(1, -400), 0.0);
+}
+
+- (void)testDecimalToDouble_Overflow {
+  XCTAssert(std::isinf(DecimalToDouble(1, 309)));
+  XCTAssert(std::isinf(DecimalToDouble(18, 307)));
+  XCTAssert(std::isinf(DecimalToDouble(1, 100000)));
+}
+
+- (void)testDecimalToDouble_Halfway {
+  // 2^53 + 1 is halfway between two doubles and rounds to the even one.
+  XCTAssertEqual(DecimalToDouble(9007199254740993ULL, 0),
+                 9007199254740992.0);
+  XCTAssertEqual(DecimalToDouble(9007199254740995ULL, 0),
+                 9007199254740996.0);
+  XCTAssertEqual(DecimalToDouble(90071992547409930ULL, -1),
+                 9007199254740992.0);
+}
+
+- (void)testDecimalToFloat {
+  XCTAssertEqual(DecimalToFloat(15, -1), 1.5f);
+  XCTAssertEqual(DecimalToFloat(1, -1), 0.1f);
+  XCTAssertEqual(DecimalToFloat(34028235, 31), FLT_MAX);
+  XCTAssert(std::isinf(DecimalToFloat(34028236, 31)));
+  XCTAssertEqual(DecimalToFloat(1, -46), 0.0f);
+  // 2^24 + 1 rounds to even.
+  XCTAssertEqual(DecimalToFloat(16777217, 0), 16777216.0f);
+}
+
+- (void)testDecimalToDouble_MatchesStrtod {
+  std::mt19937_64 random(1);
+  for (int i = 0; i < 200000; ++i) {
+    int digits = 1 + random() % 19;
+    uint64_t mantissa = 0;
+    for (int j = 0; j < digits; ++j) {
+      mantissa = mantissa * 10 + random() % 10;
+    }
+    int exponent = i % 2 ? static_cast<int>(random() % 700) - 360
+                         : static_cast<int>(random() % 60) - 30;
+    bool matches = MatchesStrtod(mantissa, exponent);
+    XCTAssert(matches, @"%llue%d",
+              static_cast<unsigned long long>(mantissa), exponent);
+    if (!matches) {
+      break;
+    }
+  }
+}
+
+@end
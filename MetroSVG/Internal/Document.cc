@@ -16,82 +16,380 @@
 
 #include "MetroSVG/Internal/Document.h"
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <libxml/xmlreader.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
 #include "MetroSVG/Internal/BasicValueParsers.h"
+#include "MetroSVG/Internal/Canvas.h"
 #include "MetroSVG/Internal/Renderer.h"
+#include "MetroSVG/Internal/SceneGraphArchive.h"
+#include "MetroSVG/Internal/SoftwareCanvas.h"
 #include "MetroSVG/Internal/StringPiece.h"
+#include "MetroSVG/Internal/ThreadPool.h"
+#include "MetroSVG/Internal/TiledRendering.h"
 #include "MetroSVG/Internal/Utils.h"
+#include "MetroSVG/Internal/XMLPullParser.h"
+
+#if MSC_CORE_GRAPHICS_SUPPORT
+#include "MetroSVG/Internal/CoreGraphicsCanvas.h"
+#include "MetroSVG/Internal/PathCache.h"
+#endif
 
 namespace metrosvg {
 namespace internal {
 
+namespace {
+
+// Applies an attribute of the outermost svg element to the metadata.
+// Returns false if the width or height is invalid.
+bool ProcessImageMetaDataAttribute(const StringPiece &name,
+                                   const StringPiece &value,
+                                   Length *width,
+                                   Length *height,
+                                   FloatRect *view_box) {
+  if (name == "width") {
+    return ParseLength(value, width);
+  } else if (name == "height") {
+    return ParseLength(value, height);
+  } else if (name == "viewBox") {
+    Float values[4] = {0, 0, 0, 0};
+    if (ParseFloats(value, 4, values)) {
+      *view_box = FloatRect(values[0], values[1], values[2], values[3]);
+    }
+  }
+  return true;
+}
+
+// Reads the metadata from the root start tag, which is as far as the data
+// is scanned. Returns false if the pull parser doesn't support the data up
+// to there or the root isn't an svg element. Otherwise, |success| tells
+// whether the metadata is valid.
+bool SniffImageMetaData(const char *data,
+                        size_t data_length,
+                        Length *width,
+                        Length *height,
+                        FloatRect *view_box,
+                        bool *success) {
+  XMLPullParser parser(data, data_length);
+  if (parser.Next() != XMLPullParser::kStatusNode ||
+      parser.node_type() != XMLPullParser::kNodeTypeStartElement ||
+      !(parser.name() == "svg")) {
+    return false;
+  }
+  *success = true;
+  for (const XMLPullParser::Attribute &attribute : parser.attributes()) {
+    if (!ProcessImageMetaDataAttribute(attribute.name, attribute.value,
+                                       width, height, view_box)) {
+      *success = false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 // Get size of the outmost svg element in given svg data.
 bool GetImageMetaDataFromSVGData(const char *data,
                                  size_t data_length,
-                                 CGSize *image_size,
-                                 CGRect *view_box) {
+                                 FloatSize *image_size,
+                                 FloatRect *view_box) {
   // Defaults to 100% per spec but we don't support length units yet.
   // http://www.w3.org/TR/SVG/struct.html#SVGElementWidthAttribute
   Length width(100.f, Length::kUnitNone);
   Length height(100.f, Length::kUnitNone);
 
-  xmlTextReader *reader =
-      xmlReaderForMemory(data, static_cast<int>(data_length), NULL, NULL, 0);
-  bool success = true;
-  int last_xml_status;
-  while ((last_xml_status = xmlTextReaderRead(reader)) > 0) {
-    int node_type = xmlTextReaderNodeType(reader);
-    StringPiece elem_name =
-        reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
-    if (node_type == XML_READER_TYPE_ELEMENT && elem_name == "svg") {
-      while (xmlTextReaderMoveToNextAttribute(reader)) {
-        StringPiece attr_name =
-            reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
-        StringPiece attr_value =
-            reinterpret_cast<const char *>(xmlTextReaderConstValue(reader));
-        if (attr_name == "width") {
-          if (!ParseLength(attr_value, &width)) {
+  bool success;
+  if (!SniffImageMetaData(data, data_length, &width, &height, view_box,
+                          &success)) {
+    // Unusual data is left to libxml2, which reads until it finds an svg
+    // element.
+    InitializeXMLParser();
+    xmlTextReader *reader =
+        xmlReaderForMemory(data, static_cast<int>(data_length), NULL, NULL,
+                           0);
+    success = true;
+    int last_xml_status;
+    while ((last_xml_status = xmlTextReaderRead(reader)) > 0) {
+      int node_type = xmlTextReaderNodeType(reader);
+      StringPiece elem_name =
+          reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+      if (node_type == XML_READER_TYPE_ELEMENT && elem_name == "svg") {
+        while (xmlTextReaderMoveToNextAttribute(reader)) {
+          StringPiece attr_name =
+              reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+          StringPiece attr_value =
+              reinterpret_cast<const char *>(xmlTextReaderConstValue(reader));
+          if (!ProcessImageMetaDataAttribute(attr_name, attr_value,
+                                             &width, &height, view_box)) {
             success = false;
           }
-        } else if (attr_name == "height") {
-          if (!ParseLength(attr_value, &height)) {
-            success = false;
-          }
-        } else if (attr_name == "viewBox") {
-          CGFloat values[4] = {0, 0, 0, 0};
-          if (ParseFloats(attr_value, 4, values)) {
-            *view_box =
-                CGRectMake(values[0], values[1], values[2], values[3]);
-          }
         }
+        break;
       }
-      break;
     }
-  }
-  xmlFreeTextReader(reader);
+    xmlFreeTextReader(reader);
 
-  if (last_xml_status < 0) {
-    success = false;
+    if (last_xml_status < 0) {
+      success = false;
+    }
   }
 
   if (success) {
-    *image_size = CGSizeMake(width.value, height.value);
+    *image_size = FloatSize(width.value, height.value);
     return true;
   } else {
     return false;
   }
 }
 
+// Get size of the outmost svg element from the attributes collected by
+// |parser|.
+bool GetImageMetaDataFromStreamParser(const SceneGraphStreamParser &parser,
+                                      FloatSize *image_size,
+                                      FloatRect *view_box) {
+  Length width(100.f, Length::kUnitNone);
+  Length height(100.f, Length::kUnitNone);
+  for (const auto &attribute : parser.svg_attributes()) {
+    if (!ProcessImageMetaDataAttribute(attribute.first, attribute.second,
+                                       &width, &height, view_box)) {
+      return false;
+    }
+  }
+  *image_size = FloatSize(width.value, height.value);
+  return true;
+}
+
+// Length of the magic number that gzip data starts with.
+const size_t kGzipMagicLength = 2;
+
+// Returns whether |data| starts with the magic number of gzip.
+bool IsGzipData(const char *data, size_t data_length) {
+  return data_length >= kGzipMagicLength &&
+         static_cast<unsigned char>(data[0]) == 0x1f &&
+         static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+// Decompresses gzip-compressed |data| into the parser of |loader| a buffer
+// at a time, so the decompressed data is never in memory as a whole.
+// Returns false if the data is corrupt, or what was decompressed is not
+// well-formed.
+bool InflateLoaderData(MSCDocumentLoader *loader,
+                       const char *data,
+                       size_t data_length) {
+  const size_t kBufferLength = 64 * 1024;
+  z_stream *stream = loader->gzip_stream.get();
+  if (!loader->inflate_buffer) {
+    loader->inflate_buffer.reset(new Bytef[kBufferLength]);
+  }
+  stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+  stream->avail_in = 0;
+  size_t remaining_length = data_length;
+  do {
+    if (stream->avail_in == 0) {
+      // avail_in is narrower than size_t.
+      stream->avail_in =
+          static_cast<uInt>(std::min<size_t>(remaining_length, UINT_MAX));
+      remaining_length -= stream->avail_in;
+    }
+    if (loader->gzip_stream_ended) {
+      // Like gzip -d, ignore zero bytes after the last member, e.g.,
+      // padding up to a block size.
+      while (stream->avail_in > 0 && *stream->next_in == 0) {
+        ++stream->next_in;
+        --stream->avail_in;
+        loader->has_gzip_padding = true;
+      }
+      if (stream->avail_in == 0) {
+        if (remaining_length == 0) {
+          break;
+        }
+        continue;
+      }
+      if (loader->has_gzip_padding) {
+        return false;
+      }
+      // Another gzip member follows, as in the output of cat a.gz b.gz.
+      if (inflateReset(stream) != Z_OK) {
+        return false;
+      }
+      loader->gzip_stream_ended = false;
+    }
+    stream->next_out = loader->inflate_buffer.get();
+    stream->avail_out = kBufferLength;
+    int zlib_status = inflate(stream, Z_NO_FLUSH);
+    if (zlib_status == Z_BUF_ERROR) {
+      // Nothing was left to decompress.
+      break;
+    } else if (zlib_status == Z_STREAM_END) {
+      loader->gzip_stream_ended = true;
+    } else if (zlib_status != Z_OK) {
+      return false;
+    }
+    size_t output_length = kBufferLength - stream->avail_out;
+    if (!loader->parser.ParseChunk(
+            reinterpret_cast<const char *>(loader->inflate_buffer.get()),
+            output_length)) {
+      return false;
+    }
+    // A full buffer may leave decompressed data behind in |stream|.
+  } while (stream->avail_in > 0 || remaining_length > 0 ||
+           stream->avail_out == 0);
+  return true;
+}
+
+// Decides whether the data of |loader| is gzip-compressed from the bytes
+// held back so far, and passes them on.
+bool SetLoaderEncoding(MSCDocumentLoader *loader) {
+  std::string pending_data;
+  pending_data.swap(loader->pending_data);
+  if (!IsGzipData(pending_data.data(), pending_data.size())) {
+    loader->encoding = MSCDocumentLoader::kEncodingNone;
+    return loader->parser.ParseChunk(pending_data.data(),
+                                     pending_data.size());
+  }
+  std::unique_ptr<z_stream> stream(new z_stream);
+  memset(stream.get(), 0, sizeof(*stream));
+  // Adding 16 to the window bits makes zlib expect a gzip header.
+  if (inflateInit2(stream.get(), 16 + MAX_WBITS) != Z_OK) {
+    return false;
+  }
+  loader->gzip_stream = std::move(stream);
+  loader->encoding = MSCDocumentLoader::kEncodingGzip;
+  return InflateLoaderData(loader, pending_data.data(), pending_data.size());
+}
+
+// Passes |data| to the parser of |loader|, decompressing it first if the
+// data of |loader| is gzip-compressed. Until that is known, the leading
+// bytes are held back, so the magic number may be split across chunks.
+bool AppendLoaderData(MSCDocumentLoader *loader,
+                      const char *data,
+                      size_t data_length) {
+  if (loader->encoding == MSCDocumentLoader::kEncodingUnknown) {
+    std::string &pending_data = loader->pending_data;
+    size_t sniffed_length =
+        std::min(data_length, kGzipMagicLength - pending_data.size());
+    pending_data.append(data, sniffed_length);
+    data += sniffed_length;
+    data_length -= sniffed_length;
+    if (pending_data.size() < kGzipMagicLength) {
+      return true;
+    }
+    if (!SetLoaderEncoding(loader)) {
+      return false;
+    }
+  }
+  if (loader->encoding == MSCDocumentLoader::kEncodingGzip) {
+    return InflateLoaderData(loader, data, data_length);
+  }
+  return loader->parser.ParseChunk(data, data_length);
+}
+
+namespace {
+
+std::atomic<MSCRenderingBackend> g_rendering_backend(
+    kMSCRenderingBackendDefault);
+
+}  // namespace
+
+// Returns a canvas of the backend set by MSCSetRenderingBackend that renders
+// into |pixels|, or into pixels of its own if |pixels| is NULL.
+Canvas *CreateCanvas(size_t width,
+                     size_t height,
+                     void *pixels,
+                     size_t bytes_per_row,
+                     MSCPixelFormat format) {
+#if MSC_CORE_GRAPHICS_SUPPORT
+  if (g_rendering_backend.load() != kMSCRenderingBackendSoftware) {
+    if (pixels == NULL) {
+      return new CoreGraphicsCanvas(width, height);
+    }
+    return new CoreGraphicsCanvas(width, height, pixels, bytes_per_row,
+                                  format);
+  }
+#endif
+  if (pixels == NULL) {
+    return new SoftwareCanvas(width, height);
+  }
+  return new SoftwareCanvas(width, height, pixels, bytes_per_row, format);
+}
+
 }  // namespace internal
 }  // namespace metrosvg
 
+using metrosvg::internal::AppendLoaderData;
+using metrosvg::internal::Canvas;
+using metrosvg::internal::CreateCanvas;
+using metrosvg::internal::DeserializeSceneGraph;
+using metrosvg::internal::FloatRect;
+using metrosvg::internal::FloatSize;
+using metrosvg::internal::GetImageMetaDataFromStreamParser;
 using metrosvg::internal::GetImageMetaDataFromSVGData;
+using metrosvg::internal::IsGzipData;
+using metrosvg::internal::ParseSceneGraph;
+using metrosvg::internal::PixelRect;
+using metrosvg::internal::RenderTiles;
 using metrosvg::internal::Renderer;
+using metrosvg::internal::SceneGraph;
+using metrosvg::internal::SceneGraphStreamParser;
+using metrosvg::internal::SerializeSceneGraph;
+using metrosvg::internal::SetLoaderEncoding;
+using metrosvg::internal::ThreadPool;
+
+#if MSC_CORE_GRAPHICS_SUPPORT
+using metrosvg::internal::CoreGraphicsCanvas;
+using metrosvg::internal::PathCache;
+#endif
+
+MSCDocument::~MSCDocument() {
+  const SceneGraph *graph = scene_graph.load();
+  if (graph) {
+#if MSC_CORE_GRAPHICS_SUPPORT
+    // Another graph could later be allocated at the same address.
+    PathCache::Shared()->RemoveSceneGraph(graph);
+#endif
+    delete graph;
+  }
+  if (mapped_data) {
+    munmap(mapped_data, mapped_length);
+  }
+}
+
+MSCDocumentLoader::~MSCDocumentLoader() {
+  if (gzip_stream) {
+    inflateEnd(gzip_stream.get());
+  }
+}
 
 MSCDocument *MSCDocumentCreateFromData(const char *data,
                                        size_t length,
                                        const char *url) {
-  CGSize size = CGSizeZero;
-  CGRect view_box = CGRectNull;
+  if (IsGzipData(data, length)) {
+    // The renderer can't parse compressed data, so parse it right away
+    // rather than keep a decompressed copy.
+    MSCDocumentLoader *loader = MSCDocumentLoaderCreate(url);
+    MSCDocument *document = NULL;
+    if (MSCDocumentLoaderAppendData(loader, data, length)) {
+      document = MSCDocumentLoaderCreateDocument(loader);
+    }
+    MSCDocumentLoaderDelete(loader);
+    return document;
+  }
+
+  FloatSize size;
+  FloatRect view_box = FloatRect::Null();
   if (!GetImageMetaDataFromSVGData(data, length, &size, &view_box)) {
     return NULL;
   }
@@ -105,23 +403,287 @@ MSCDocument *MSCDocumentCreateFromData(const char *data,
   return document;
 }
 
+MSCDocument *MSCDocumentCreateFromFile(const char *path) {
+  if (path == NULL) {
+    return NULL;
+  }
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat file_stat;
+  void *mapped_data = MAP_FAILED;
+  size_t length = 0;
+  // Empty files can't be mapped, and aren't well-formed either.
+  if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+    length = static_cast<size_t>(file_stat.st_size);
+    mapped_data = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  // The mapping stays valid after the file is closed.
+  close(fd);
+  if (mapped_data == MAP_FAILED) {
+    return NULL;
+  }
+
+  const char *data = static_cast<const char *>(mapped_data);
+  MSCDocument *document = MSCDocumentCreateFromData(data, length, path);
+  // A document from gzip-compressed data doesn't refer to it.
+  if (!document || IsGzipData(data, length)) {
+    munmap(mapped_data, length);
+    return document;
+  }
+  // |path| is only valid during the call, but |url| is used when the
+  // document is parsed later.
+  document->file_path = path;
+  document->url = document->file_path.c_str();
+  document->mapped_data = mapped_data;
+  document->mapped_length = length;
+  return document;
+}
+
 void MSCDocumentDelete(MSCDocument *document) {
   delete document;
 }
 
+MSCDocumentLoader *MSCDocumentLoaderCreate(const char *url) {
+  return new MSCDocumentLoader(url);
+}
+
+int MSCDocumentLoaderAppendData(MSCDocumentLoader *loader,
+                                const char *data,
+                                size_t length) {
+  if (loader == NULL || loader->is_finished || loader->has_error) {
+    return 0;
+  }
+  if (!AppendLoaderData(loader, data, length)) {
+    loader->has_error = true;
+    return 0;
+  }
+  return 1;
+}
+
+MSCDocument *MSCDocumentLoaderCreateDocument(MSCDocumentLoader *loader) {
+  if (loader == NULL || loader->is_finished) {
+    return NULL;
+  }
+  loader->is_finished = true;
+  if (loader->encoding == MSCDocumentLoader::kEncodingUnknown &&
+      !loader->has_error && !SetLoaderEncoding(loader)) {
+    loader->has_error = true;
+  }
+  if (loader->has_error ||
+      (loader->encoding == MSCDocumentLoader::kEncodingGzip &&
+       !loader->gzip_stream_ended)) {
+    return NULL;
+  }
+  std::unique_ptr<SceneGraph> scene_graph(loader->parser.Finish());
+  if (!scene_graph) {
+    return NULL;
+  }
+  FloatSize size;
+  FloatRect view_box = FloatRect::Null();
+  if (!GetImageMetaDataFromStreamParser(loader->parser, &size, &view_box)) {
+    return NULL;
+  }
+
+  MSCDocument *document = new MSCDocument;
+  document->size = size;
+  document->view_box = view_box;
+  document->scene_graph.store(scene_graph.release());
+  return document;
+}
+
+void MSCDocumentLoaderDelete(MSCDocumentLoader *loader) {
+  delete loader;
+}
+
+int MSCDocumentPrepareForRendering(MSCDocument *document) {
+  if (document == NULL) {
+    return 0;
+  }
+  if (document->scene_graph.load(std::memory_order_acquire)) {
+    return 1;
+  }
+  std::lock_guard<std::mutex> lock(document->prepare_mutex);
+  if (!document->scene_graph.load(std::memory_order_relaxed)) {
+    document->scene_graph.store(ParseSceneGraph(document->data,
+                                                document->data_length,
+                                                document->url),
+                                std::memory_order_release);
+  }
+  return document->scene_graph.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+int MSCDocumentCopySerializedData(MSCDocument *document,
+                                  char **data,
+                                  size_t *length) {
+  if (!MSCDocumentPrepareForRendering(document)) {
+    return 0;
+  }
+  const SceneGraph *graph =
+      document->scene_graph.load(std::memory_order_acquire);
+  std::string serialized_data;
+  SerializeSceneGraph(*graph,
+                      document->size,
+                      document->view_box,
+                      &serialized_data);
+  *data = static_cast<char *>(malloc(serialized_data.size()));
+  if (!*data) {
+    return 0;
+  }
+  memcpy(*data, serialized_data.data(), serialized_data.size());
+  *length = serialized_data.size();
+  return 1;
+}
+
+MSCDocument *MSCDocumentCreateFromSerializedData(const char *data,
+                                                 size_t length) {
+  FloatSize size;
+  FloatRect view_box = FloatRect::Null();
+  SceneGraph *scene_graph =
+      DeserializeSceneGraph(data, length, &size, &view_box);
+  if (!scene_graph) {
+    return NULL;
+  }
+
+  MSCDocument *document = new MSCDocument;
+  document->size = size;
+  document->view_box = view_box;
+  document->scene_graph.store(scene_graph);
+  return document;
+}
+
+#if MSC_CORE_GRAPHICS_SUPPORT
 CGImageRef MSCDocumentCreateCGImage(MSCDocument *document,
                                     CGSize canvas_size,
                                     const MSCStyleSheet *style_sheet) {
+  if (document == NULL || canvas_size.width < 1 || canvas_size.height < 1) {
+    return NULL;
+  }
+  size_t width = static_cast<size_t>(std::floor(canvas_size.width));
+  size_t height = static_cast<size_t>(std::floor(canvas_size.height));
+  CoreGraphicsCanvas canvas(width, height);
+  Renderer renderer;
+  if (!renderer.RenderMSCDocument(document, style_sheet, &canvas)) {
+    return NULL;
+  }
+  return canvas.CreateCGImage();
+}
+
+CGImageRef MSCDocumentCreateCGImageFromRect(MSCDocument *document,
+                                            CGRect source_rect,
+                                            CGSize canvas_size,
+                                            const MSCStyleSheet *style_sheet) {
+  FloatRect rect(source_rect.origin.x, source_rect.origin.y,
+                 source_rect.size.width, source_rect.size.height);
+  if (document == NULL || canvas_size.width < 1 || canvas_size.height < 1 ||
+      rect.IsEmpty()) {
+    return NULL;
+  }
+  size_t width = static_cast<size_t>(std::floor(canvas_size.width));
+  size_t height = static_cast<size_t>(std::floor(canvas_size.height));
+  CoreGraphicsCanvas canvas(width, height);
+  Renderer renderer;
+  renderer.set_source_rect(rect.Standardized());
+  if (!renderer.RenderMSCDocument(document, style_sheet, &canvas)) {
+    return NULL;
+  }
+  return canvas.CreateCGImage();
+}
+#endif  // MSC_CORE_GRAPHICS_SUPPORT
+
+int MSCDocumentRenderToBuffer(MSCDocument *document,
+                              MSCSize canvas_size,
+                              const MSCStyleSheet *style_sheet,
+                              void *pixels,
+                              size_t bytes_per_row,
+                              MSCPixelFormat format) {
+  if (document == NULL || pixels == NULL ||
+      canvas_size.width < 1 || canvas_size.height < 1) {
+    return 0;
+  }
+  size_t width = static_cast<size_t>(std::floor(canvas_size.width));
+  size_t height = static_cast<size_t>(std::floor(canvas_size.height));
+  if (bytes_per_row < width * 4) {
+    return 0;
+  }
+  if (format != kMSCPixelFormatRGBA8888 && format != kMSCPixelFormatBGRA8888) {
+    return 0;
+  }
+  std::unique_ptr<Canvas> canvas(
+      CreateCanvas(width, height, pixels, bytes_per_row, format));
   Renderer renderer;
-  return renderer.CreateCGImageFromMSCDocument(document,
-                                               canvas_size,
-                                               style_sheet);
+  bool success =
+      renderer.RenderMSCDocument(document, style_sheet, canvas.get());
+  return success ? 1 : 0;
+}
+
+int MSCDocumentRenderTiles(MSCDocument *document,
+                           MSCSize canvas_size,
+                           MSCSize tile_size,
+                           const MSCStyleSheet *style_sheet,
+                           size_t thread_count,
+                           MSCDocumentTileCallback callback,
+                           void *context) {
+  if (document == NULL || callback == NULL ||
+      canvas_size.width < 1 || canvas_size.height < 1 ||
+      tile_size.width < 1 || tile_size.height < 1) {
+    return 0;
+  }
+  if (!MSCDocumentPrepareForRendering(document)) {
+    return 0;
+  }
+  ThreadPool pool(thread_count);
+  bool success = RenderTiles(
+      document,
+      style_sheet,
+      static_cast<size_t>(std::floor(canvas_size.width)),
+      static_cast<size_t>(std::floor(canvas_size.height)),
+      static_cast<size_t>(std::floor(tile_size.width)),
+      static_cast<size_t>(std::floor(tile_size.height)),
+      [](size_t width, size_t height) {
+        return CreateCanvas(width, height, NULL, 0, kMSCPixelFormatRGBA8888);
+      },
+      &pool,
+      [callback, context](const PixelRect &tile,
+                          const uint8_t *pixels,
+                          size_t bytes_per_row) {
+        callback(context, tile.x0, tile.y0, tile.width(), tile.height(),
+                 pixels, bytes_per_row);
+      });
+  return success ? 1 : 0;
+}
+
+MSCSize MSCDocumentGetImageSize(const MSCDocument *document) {
+  MSCSize size;
+  size.width = document->size.width;
+  size.height = document->size.height;
+  return size;
+}
+
+MSCRect MSCDocumentGetImageViewBox(const MSCDocument *document) {
+  MSCRect view_box;
+  view_box.origin.x = document->view_box.origin.x;
+  view_box.origin.y = document->view_box.origin.y;
+  view_box.size.width = document->view_box.size.width;
+  view_box.size.height = document->view_box.size.height;
+  return view_box;
+}
+
+void MSCSetPathCacheByteLimit(size_t byte_limit) {
+#if MSC_CORE_GRAPHICS_SUPPORT
+  PathCache::Shared()->set_byte_limit(byte_limit);
+#endif
 }
 
-CGSize MSCDocumentGetImageSize(const MSCDocument *document) {
-  return document->size;
+size_t MSCGetPathCacheByteSize(void) {
+#if MSC_CORE_GRAPHICS_SUPPORT
+  return PathCache::Shared()->byte_size();
+#else
+  return 0;
+#endif
 }
 
-CGRect MSCDocumentGetImageViewBox(const MSCDocument *document) {
-  return document->view_box;
+void MSCSetRenderingBackend(MSCRenderingBackend backend) {
+  metrosvg::internal::g_rendering_backend.store(backend);
 }
@@ -16,6 +16,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <zlib.h>
+
+#include "MetroSVG/Internal/SceneGraph.h"
 #include "MetroSVG/Public/MSCDocument.h"
 
 // Represents a partially parsed SVG document.
@@ -23,9 +31,74 @@ struct MSCDocument {
   const char *data;
   size_t data_length;
   const char *url;
+  // Set if |data| is a memory-mapped file, which the document unmaps.
+  void *mapped_data;
+  size_t mapped_length;
+  // Path of the mapped file, which |url| points to.
+  std::string file_path;
 
   // Value of the width and height attributes of the outmost svg element.
-  CGSize size;
+  metrosvg::internal::FloatSize size;
   // Value of the viewBox attribute of the outmost svg element.
-  CGRect view_box;
+  metrosvg::internal::FloatRect view_box;
+
+  // Owned by the document. Set at most once, by
+  // MSCDocumentPrepareForRendering, on creation from serialized data or by
+  // an MSCDocumentLoader, and never changed afterwards. If present,
+  // rendering uses it instead of parsing |data|. It is atomic so that the
+  // document can be rendered on some threads while another one prepares it.
+  std::atomic<const metrosvg::internal::SceneGraph *> scene_graph;
+  // Held while preparing the document for rendering.
+  std::mutex prepare_mutex;
+
+  MSCDocument()
+      : data(NULL),
+        data_length(0),
+        url(NULL),
+        mapped_data(NULL),
+        mapped_length(0),
+        size(),
+        view_box(metrosvg::internal::FloatRect::Null()),
+        scene_graph(NULL) {}
+  ~MSCDocument();
+};
+
+// Parses the data of an MSCDocument that arrives in chunks, decompressing
+// it first if it is gzip-compressed.
+struct MSCDocumentLoader {
+  enum Encoding {
+    // Too few bytes have arrived to tell.
+    kEncodingUnknown,
+    kEncodingNone,
+    kEncodingGzip,
+  };
+
+  metrosvg::internal::SceneGraphStreamParser parser;
+  Encoding encoding;
+  // Leading bytes held back while |encoding| is unknown.
+  std::string pending_data;
+  // Set if |encoding| is kEncodingGzip.
+  std::unique_ptr<z_stream> gzip_stream;
+  // Receives decompressed data on its way to |parser|.
+  std::unique_ptr<Bytef[]> inflate_buffer;
+  // Whether |gzip_stream| is at the end of a gzip member, i.e., the data
+  // isn't truncated if no more follows.
+  bool gzip_stream_ended;
+  // Whether zero bytes have followed the last gzip member. Only more zero
+  // bytes may follow them.
+  bool has_gzip_padding;
+  // Set once the data so far has turned out to be corrupt or not
+  // well-formed.
+  bool has_error;
+  // Whether MSCDocumentLoaderCreateDocument has been called.
+  bool is_finished;
+
+  explicit MSCDocumentLoader(const char *url)
+      : parser(url),
+        encoding(kEncodingUnknown),
+        gzip_stream_ended(false),
+        has_gzip_padding(false),
+        has_error(false),
+        is_finished(false) {}
+  ~MSCDocumentLoader();
 };
@@ -14,11 +14,209 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include <unistd.h>
 #import <XCTest/XCTest.h>
+#include <zlib.h>
 
 #include "MetroSVG/Internal/Document.h"
+#include "MetroSVG/Internal/Renderer.h"
+#include "MetroSVG/Internal/SoftwareCanvas.h"
+
+using metrosvg::internal::FloatRect;
+using metrosvg::internal::Renderer;
+using metrosvg::internal::SoftwareCanvas;
+
+static const char kConcurrentRenderingData[] =
+    "<svg width=\"40\" height=\"40\" viewBox=\"0 0 40 40\">"
+    "<linearGradient id=\"g\"><stop offset=\"0\" stop-color=\"red\"/>"
+    "<stop offset=\"1\" stop-color=\"blue\"/></linearGradient>"
+    "<rect x=\"2\" y=\"2\" width=\"36\" height=\"20\" fill=\"url(#g)\"/>"
+    "<g opacity=\"0.5\"><circle cx=\"20\" cy=\"28\" r=\"10\" fill=\"green\""
+    " stroke=\"black\" stroke-dasharray=\"3 1\"/></g>"
+    "</svg>";
+
+// Renders |document| onto a new square canvas and returns the pixels, or
+// an empty vector if rendering fails.
+static std::vector<uint8_t> RenderPixels(const MSCDocument *document,
+                                         size_t size) {
+  SoftwareCanvas canvas(size, size);
+  Renderer renderer;
+  if (!renderer.RenderMSCDocument(document, NULL, &canvas)) {
+    return std::vector<uint8_t>();
+  }
+  return std::vector<uint8_t>(canvas.pixels(),
+                              canvas.pixels() + size * size * 4);
+}
+
+// Renders |document| on several threads at once, each going through
+// canvas sizes in a different order, and returns whether every render
+// matches |expected|, which is indexed by size. |prepare| is run on one
+// more thread while the others render.
+static bool RendersConcurrently(
+    MSCDocument *document,
+    const std::vector<std::vector<uint8_t>> &expected,
+    std::function<void()> prepare) {
+  const int kThreadCount = 8;
+  const int kIterations = 20;
+  std::vector<int> matches(kThreadCount, 1);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([document, &expected, &matches, t]() {
+      for (int i = 0; i < kIterations; ++i) {
+        size_t size = 1 + (t * 7 + i * 3) % (expected.size() - 1);
+        if (RenderPixels(document, size) != expected[size]) {
+          matches[t] = 0;
+        }
+      }
+    });
+  }
+  prepare();
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (int match : matches) {
+    if (!match) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Writes |data| to a new temporary file and returns its path.
+static std::string WriteTemporaryFile(const std::string &data) {
+  const char *directory = getenv("TMPDIR");
+  std::string path = std::string(directory ? directory : "/tmp") +
+                     "/DocumentTestXXXXXX";
+  int fd = mkstemp(&path[0]);
+  if (fd < 0) {
+    return std::string();
+  }
+  ssize_t written_length = write(fd, data.data(), data.size());
+  close(fd);
+  if (written_length != static_cast<ssize_t>(data.size())) {
+    unlink(path.c_str());
+    return std::string();
+  }
+  return path;
+}
+
+// Returns |data| compressed in the gzip format.
+static std::string GzipData(const std::string &data) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8,
+               Z_DEFAULT_STRATEGY);
+  std::string compressed_data(deflateBound(&stream, data.size()), '\0');
+  stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef *>(&compressed_data[0]);
+  stream.avail_out = static_cast<uInt>(compressed_data.size());
+  deflate(&stream, Z_FINISH);
+  compressed_data.resize(stream.total_out);
+  deflateEnd(&stream);
+  return compressed_data;
+}
+
+static void CountTilePixels(void *context,
+                            size_t x,
+                            size_t y,
+                            size_t width,
+                            size_t height,
+                            const void *pixels,
+                            size_t bytes_per_row) {
+  *static_cast<size_t *>(context) += width * height;
+}
+
+// Returns a document of about 1 MB for the loading performance tests.
+static std::string LoadingBenchmarkData() {
+  std::string data = "<svg width=\"100\" height=\"100\">";
+  for (int i = 0; i < 5000; ++i) {
+    data += "<g id=\"g" + std::to_string(i) + "\" fill=\"#336699\">"
+            "<path d=\"M10.5,20.25 C30.125,40.5 50.75,60.375 70,80 Z\"/>"
+            "<rect x=\"12\" y=\"34\" width=\"56\" height=\"78\"/></g>";
+  }
+  data += "</svg>";
+  return data;
+}
+
+// Measures creating and preparing a document from a file with |data|.
+static void MeasureCreateFromFile(XCTestCase *test_case,
+                                  const std::string &data) {
+  std::string path = WriteTemporaryFile(data);
+  const char *file_path = path.c_str();
+  [test_case measureBlock:^{
+    MSCDocument *document = MSCDocumentCreateFromFile(file_path);
+    MSCDocumentPrepareForRendering(document);
+    XCTAssertEqual(document->scene_graph.load()->elements.size(), 15001U);
+    MSCDocumentDelete(document);
+  }];
+  unlink(file_path);
+}
+
+// Measures creating a document from |data| with a loader, appending 64 KB
+// at a time.
+static void MeasureDocumentLoader(XCTestCase *test_case,
+                                  const std::string &data) {
+  const std::string *data_pointer = &data;
+  [test_case measureBlock:^{
+    MSCDocumentLoader *loader = MSCDocumentLoaderCreate(NULL);
+    for (size_t i = 0; i < data_pointer->size(); i += 65536) {
+      size_t length = std::min<size_t>(65536, data_pointer->size() - i);
+      MSCDocumentLoaderAppendData(loader, data_pointer->data() + i, length);
+    }
+    MSCDocument *document = MSCDocumentLoaderCreateDocument(loader);
+    MSCDocumentLoaderDelete(loader);
+    XCTAssertEqual(document->scene_graph.load()->elements.size(), 15001U);
+    MSCDocumentDelete(document);
+  }];
+}
+
+// Measures rendering |data| with one renderer onto a canvas of a single
+// pixel, so that the time goes into walking the scene graph rather than
+// into rasterizing.
+static void MeasureRendering(XCTestCase *test_case, const std::string &data) {
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  MSCDocumentPrepareForRendering(document);
+  Renderer renderer;
+  Renderer *renderer_pointer = &renderer;
+  [test_case measureBlock:^{
+    SoftwareCanvas canvas(1, 1);
+    XCTAssert(renderer_pointer->RenderMSCDocument(document, NULL, &canvas));
+  }];
+  MSCDocumentDelete(document);
+}
+
+// Measures rendering |data| into a buffer of 1024 x 1024 pixels through
+// the public interface with the software backend.
+static void MeasureSoftwareRendering(XCTestCase *test_case,
+                                     const std::string &data) {
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  MSCDocumentPrepareForRendering(document);
+  std::vector<uint8_t> pixels(1024 * 1024 * 4);
+  uint8_t *buffer = pixels.data();
+  MSCSetRenderingBackend(kMSCRenderingBackendSoftware);
+  [test_case measureBlock:^{
+    MSCDocumentRenderToBuffer(document,
+                              CGSizeMake(1024, 1024),
+                              NULL,
+                              buffer,
+                              1024 * 4,
+                              kMSCPixelFormatRGBA8888);
+  }];
+  MSCSetRenderingBackend(kMSCRenderingBackendDefault);
+  MSCDocumentDelete(document);
+}
 
 @interface DocumentTest : XCTestCase
 @end
@@ -38,6 +236,690 @@
   // TODO: What to do when viewBox is not specified?
 }
 
+- (void)testGetImageSize {
+  std::string data =
+      "<?xml version='1.0' encoding='UTF-8'?>\n"
+      "<!-- Comment -->\n"
+      "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\"\n"
+      "  \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n"
+      "<svg width='10' height='20' viewBox='0 0 5 10'><rect/></svg>";
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(document),
+                              CGRectMake(0, 0, 5, 10)));
+  MSCDocumentDelete(document);
+
+  // Data the pull parser doesn't support is read with libxml2.
+  data = "<!DOCTYPE svg [<!ENTITY w '30'>]><svg width='&w;' height='40'/>";
+  document = MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(30, 40)));
+  MSCDocumentDelete(document);
+
+  data = "<svg width='wide'/>";
+  XCTAssert(MSCDocumentCreateFromData(data.c_str(), data.size(), "") == NULL);
+}
+
+- (void)testCreateFromFile {
+  std::string path = WriteTemporaryFile(
+      "<svg width='10' height='20' viewBox='0 0 5 10'><rect/></svg>");
+  XCTAssertFalse(path.empty());
+  MSCDocument *document = MSCDocumentCreateFromFile(path.c_str());
+  XCTAssert(document != NULL);
+  XCTAssert(document->mapped_data != NULL);
+  // The document keeps its own copy of the path as its URL.
+  XCTAssertEqual(std::string(document->url), path);
+  XCTAssert(document->url != path.c_str());
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(document),
+                              CGRectMake(0, 0, 5, 10)));
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  MSCDocumentDelete(document);
+  unlink(path.c_str());
+}
+
+- (void)testCreateFromFile_Gzip {
+  std::string path = WriteTemporaryFile(GzipData(
+      "<svg width='10' height='20' viewBox='0 0 5 10'><rect/></svg>"));
+  XCTAssertFalse(path.empty());
+  MSCDocument *document = MSCDocumentCreateFromFile(path.c_str());
+  XCTAssert(document != NULL);
+  // The document is prepared and doesn't keep the file mapped.
+  XCTAssert(document->scene_graph != nullptr);
+  XCTAssert(document->mapped_data == NULL);
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(document),
+                              CGRectMake(0, 0, 5, 10)));
+  MSCDocumentDelete(document);
+  unlink(path.c_str());
+}
+
+- (void)testCreateFromFile_InvalidFiles {
+  XCTAssert(MSCDocumentCreateFromFile(NULL) == NULL);
+  XCTAssert(MSCDocumentCreateFromFile("/nonexistent/file.svg") == NULL);
+
+  std::string path = WriteTemporaryFile("");
+  XCTAssert(MSCDocumentCreateFromFile(path.c_str()) == NULL);
+  unlink(path.c_str());
+
+  std::string compressed_data = GzipData("<svg><rect/></svg>");
+  compressed_data.resize(compressed_data.size() - 10);
+  path = WriteTemporaryFile(compressed_data);
+  XCTAssert(MSCDocumentCreateFromFile(path.c_str()) == NULL);
+  unlink(path.c_str());
+
+  path = WriteTemporaryFile(GzipData("<svg><rect></svg>"));
+  XCTAssert(MSCDocumentCreateFromFile(path.c_str()) == NULL);
+  unlink(path.c_str());
+}
+
+- (void)testPrepareForRendering {
+  std::string data = "<svg width=\"10\" height=\"10\"><rect/></svg>";
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  XCTAssert(document->scene_graph != nullptr);
+  // Preparing twice is harmless.
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  // The data is no longer accessed.
+  data.assign(data.size(), ' ');
+  CGImageRef image =
+      MSCDocumentCreateCGImage(document, CGSizeMake(10, 10), NULL);
+  XCTAssert(image != NULL);
+  CGImageRelease(image);
+  MSCDocumentDelete(document);
+}
+
+- (void)testDocumentLoader {
+  std::string data =
+      "<svg width='10' height='20' viewBox='0 0 5 10'><rect/></svg>";
+  MSCDocumentLoader *loader = MSCDocumentLoaderCreate(NULL);
+  for (size_t i = 0; i < data.size(); i += 7) {
+    std::string chunk = data.substr(i, 7);
+    XCTAssertEqual(MSCDocumentLoaderAppendData(loader, chunk.data(),
+                                               chunk.size()), 1);
+  }
+  MSCDocument *document = MSCDocumentLoaderCreateDocument(loader);
+  XCTAssert(document != NULL);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  XCTAssert(document->scene_graph != nullptr);
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(document),
+                              CGRectMake(0, 0, 5, 10)));
+  CGImageRef image =
+      MSCDocumentCreateCGImage(document, CGSizeMake(10, 20), NULL);
+  XCTAssert(image != NULL);
+  CGImageRelease(image);
+  MSCDocumentDelete(document);
+}
+
+- (void)testDocumentLoader_MalformedData {
+  std::string data = "<svg width='10' height='10'><rect></svg>";
+  MSCDocumentLoader *loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, data.data(),
+                                             data.size()), 0);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  data = "<svg width='wide'/>";
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, data.data(),
+                                             data.size()), 1);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+}
+
+- (void)testDocumentLoader_Gzip {
+  // Decompresses to more than the loader's 64 KB inflate buffer.
+  std::string data = "<svg width='10' height='20'>";
+  for (int i = 0; i < 5000; ++i) {
+    data += "<rect width='1' height='1'/>";
+  }
+  data += "</svg>";
+  std::string compressed_data = GzipData(data);
+  MSCDocumentLoader *loader = MSCDocumentLoaderCreate(NULL);
+  // Single bytes split the gzip magic number too.
+  for (size_t i = 0; i < compressed_data.size(); ++i) {
+    XCTAssertEqual(MSCDocumentLoaderAppendData(loader, &compressed_data[i],
+                                               1), 1);
+  }
+  MSCDocument *document = MSCDocumentLoaderCreateDocument(loader);
+  MSCDocumentLoaderDelete(loader);
+  XCTAssert(document != NULL);
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssertEqual(document->scene_graph.load()->elements.size(), 5001U);
+  MSCDocumentDelete(document);
+
+  // Concatenated gzip members decompress to the concatenated data.
+  compressed_data = GzipData("<svg width='10' height='20'>") +
+                    GzipData("<rect/></svg>");
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, compressed_data.data(),
+                                             compressed_data.size()), 1);
+  document = MSCDocumentLoaderCreateDocument(loader);
+  MSCDocumentLoaderDelete(loader);
+  XCTAssert(document != NULL);
+  XCTAssertEqual(document->scene_graph.load()->elements.size(), 2U);
+  MSCDocumentDelete(document);
+
+  // Zero bytes after the last member are ignored, as by gzip -d.
+  compressed_data = GzipData("<svg><rect/></svg>") + std::string(512, '\0');
+  loader = MSCDocumentLoaderCreate(NULL);
+  for (size_t i = 0; i < compressed_data.size(); i += 100) {
+    std::string chunk = compressed_data.substr(i, 100);
+    XCTAssertEqual(MSCDocumentLoaderAppendData(loader, chunk.data(),
+                                               chunk.size()), 1);
+  }
+  document = MSCDocumentLoaderCreateDocument(loader);
+  MSCDocumentLoaderDelete(loader);
+  XCTAssert(document != NULL);
+  MSCDocumentDelete(document);
+}
+
+- (void)testDocumentLoader_GzipMalformedData {
+  // Truncated data is only detected at the end.
+  std::string compressed_data = GzipData("<svg><rect/></svg>");
+  compressed_data.resize(compressed_data.size() - 4);
+  MSCDocumentLoader *loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, compressed_data.data(),
+                                             compressed_data.size()), 1);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  // A bad checksum.
+  compressed_data = GzipData("<svg><rect/></svg>");
+  compressed_data[compressed_data.size() - 5] ^= 1;
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, compressed_data.data(),
+                                             compressed_data.size()), 0);
+  // The rest of the data is ignored.
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, "<", 1), 0);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  // Trailing data that isn't another gzip member.
+  compressed_data = GzipData("<svg><rect/></svg>") + "<rect/>";
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, compressed_data.data(),
+                                             compressed_data.size()), 0);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  // Data after zero padding.
+  compressed_data = GzipData("<svg><rect/></svg>") + std::string(4, '\0') +
+                    GzipData("<rect/>");
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, compressed_data.data(),
+                                             compressed_data.size()), 0);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+
+  // Too short to tell the encoding.
+  loader = MSCDocumentLoaderCreate(NULL);
+  XCTAssertEqual(MSCDocumentLoaderAppendData(loader, "\x1f", 1), 1);
+  XCTAssert(MSCDocumentLoaderCreateDocument(loader) == NULL);
+  MSCDocumentLoaderDelete(loader);
+}
+
+- (void)testCreateFromData_Gzip {
+  std::string compressed_data = GzipData(
+      "<svg width='10' height='20' viewBox='0 0 5 10'><rect/></svg>");
+  MSCDocument *document = MSCDocumentCreateFromData(
+      compressed_data.data(), compressed_data.size(), NULL);
+  XCTAssert(document != NULL);
+  // The document is prepared and doesn't refer to the data.
+  XCTAssert(document->scene_graph != nullptr);
+  XCTAssert(document->data == NULL);
+  compressed_data.assign(compressed_data.size(), ' ');
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(document),
+                              CGRectMake(0, 0, 5, 10)));
+  CGImageRef image =
+      MSCDocumentCreateCGImage(document, CGSizeMake(10, 20), NULL);
+  XCTAssert(image != NULL);
+  CGImageRelease(image);
+  MSCDocumentDelete(document);
+
+  compressed_data = GzipData("<svg><rect></svg>");
+  XCTAssert(MSCDocumentCreateFromData(compressed_data.data(),
+                                      compressed_data.size(), NULL) == NULL);
+}
+
+- (void)testPathCache {
+  std::string data =
+      "<svg width=\"10\" height=\"10\"><path d=\"M1,1 L9,9\"/></svg>";
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  size_t initial_byte_size = MSCGetPathCacheByteSize();
+  // Unprepared documents are parsed on every render, so nothing is kept.
+  CGImageRelease(MSCDocumentCreateCGImage(document, CGSizeMake(10, 10), NULL));
+  XCTAssertEqual(MSCGetPathCacheByteSize(), initial_byte_size);
+
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  CGImageRelease(MSCDocumentCreateCGImage(document, CGSizeMake(10, 10), NULL));
+  size_t byte_size = MSCGetPathCacheByteSize();
+  XCTAssertGreaterThan(byte_size, initial_byte_size);
+  // Rendering again at another size reuses the path.
+  CGImageRelease(MSCDocumentCreateCGImage(document, CGSizeMake(20, 20), NULL));
+  XCTAssertEqual(MSCGetPathCacheByteSize(), byte_size);
+
+  MSCDocumentDelete(document);
+  XCTAssertEqual(MSCGetPathCacheByteSize(), initial_byte_size);
+}
+
+- (void)testPrepareForRendering_MalformedData {
+  std::string data = "<svg width=\"10\" height=\"10\"><rect></svg>";
+  // Creating the document only reads up to the end of the root start tag.
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssert(document != NULL);
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 0);
+  MSCDocumentDelete(document);
+}
+
+- (void)testSerializedData {
+  std::string data =
+      "<svg width=\"10\" height=\"20\" viewBox=\"0 0 5 10\"><rect/></svg>";
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  char *serialized_data = NULL;
+  size_t serialized_length = 0;
+  XCTAssertEqual(MSCDocumentCopySerializedData(document,
+                                               &serialized_data,
+                                               &serialized_length), 1);
+  MSCDocumentDelete(document);
+
+  MSCDocument *loaded_document =
+      MSCDocumentCreateFromSerializedData(serialized_data, serialized_length);
+  free(serialized_data);
+  XCTAssert(loaded_document != NULL);
+  XCTAssert(CGSizeEqualToSize(MSCDocumentGetImageSize(loaded_document),
+                              CGSizeMake(10, 20)));
+  XCTAssert(CGRectEqualToRect(MSCDocumentGetImageViewBox(loaded_document),
+                              CGRectMake(0, 0, 5, 10)));
+  CGImageRef image =
+      MSCDocumentCreateCGImage(loaded_document, CGSizeMake(10, 20), NULL);
+  XCTAssert(image != NULL);
+  CGImageRelease(image);
+  MSCDocumentDelete(loaded_document);
+}
+
+- (void)testCreateFromSerializedData_SVGData {
+  std::string data = "<svg></svg>";
+  XCTAssert(MSCDocumentCreateFromSerializedData(data.c_str(),
+                                                data.size()) == NULL);
+}
+
+- (void)testRender_Concurrently {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  std::vector<std::vector<uint8_t>> expected(50);
+  for (size_t size = 1; size < expected.size(); ++size) {
+    expected[size] = RenderPixels(document, size);
+    XCTAssertFalse(expected[size].empty());
+  }
+  XCTAssert(RendersConcurrently(document, expected, []() {}));
+  MSCDocumentDelete(document);
+}
+
+- (void)testRender_ConcurrentlyWhilePreparing {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  std::vector<std::vector<uint8_t>> expected(50);
+  for (size_t size = 1; size < expected.size(); ++size) {
+    expected[size] = RenderPixels(document, size);
+  }
+  // Renders that start before the document is prepared parse the data
+  // themselves; the result is the same.
+  int prepared = 0;
+  XCTAssert(RendersConcurrently(document, expected, [document, &prepared]() {
+    prepared = MSCDocumentPrepareForRendering(document);
+  }));
+  XCTAssertEqual(prepared, 1);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRender_SourceRect {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  // The document is 40 x 40. Render it at twice the size, and its
+  // bottom-right quarter at the same scale.
+  std::vector<uint8_t> expected = RenderPixels(document, 80);
+  SoftwareCanvas canvas(40, 40);
+  Renderer renderer;
+  renderer.set_source_rect(FloatRect(20, 20, 20, 20));
+  XCTAssert(renderer.RenderMSCDocument(document, NULL, &canvas));
+  bool matches = true;
+  for (size_t y = 0; y < 40; ++y) {
+    if (memcmp(canvas.pixels() + y * 40 * 4,
+               &expected[((y + 40) * 80 + 40) * 4],
+               40 * 4) != 0) {
+      matches = false;
+    }
+  }
+  XCTAssert(matches);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRender_ReusesRenderer {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  std::string other_data =
+      "<svg width='40' height='40'>"
+      "<radialGradient id='g'><stop offset='0' stop-color='yellow'/>"
+      "</radialGradient>"
+      "<rect width='40' height='40' stroke='url(#g)'/>"
+      "</svg>";
+  MSCDocument *other_document =
+      MSCDocumentCreateFromData(other_data.c_str(), other_data.size(), "");
+  std::vector<uint8_t> expected = RenderPixels(document, 40);
+  std::vector<uint8_t> other_expected = RenderPixels(other_document, 40);
+
+  // Nothing from a render, like the gradient with the same id, leaks into
+  // the next.
+  Renderer renderer;
+  for (int i = 0; i < 3; ++i) {
+    SoftwareCanvas canvas(40, 40);
+    XCTAssert(renderer.RenderMSCDocument(document, NULL, &canvas));
+    XCTAssertEqual(
+        memcmp(canvas.pixels(), expected.data(), expected.size()), 0);
+    SoftwareCanvas other_canvas(40, 40);
+    XCTAssert(renderer.RenderMSCDocument(other_document, NULL, &other_canvas));
+    XCTAssertEqual(memcmp(other_canvas.pixels(), other_expected.data(),
+                          other_expected.size()), 0);
+  }
+  MSCDocumentDelete(other_document);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRender_RestoresInheritedGraphicsState {
+  // The red fill and the opacity of the inner group don't outlive it. The
+  // rect after the groups gets the default black fill.
+  std::string data =
+      "<svg width='30' height='10'>"
+      "<g fill-opacity='0.5'>"
+      "<g fill='red'><rect x='0' y='0' width='10' height='10'/></g>"
+      "<rect x='10' y='0' width='10' height='10'/>"
+      "</g>"
+      "<rect x='20' y='0' width='10' height='10'/>"
+      "</svg>";
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  SoftwareCanvas canvas(30, 10);
+  Renderer renderer;
+  XCTAssert(renderer.RenderMSCDocument(document, NULL, &canvas));
+  const uint8_t *row = canvas.pixels() + 5 * 30 * 4;
+  const uint8_t *red = row + 5 * 4;
+  const uint8_t *half_black = row + 15 * 4;
+  const uint8_t *black = row + 25 * 4;
+  XCTAssertEqual(red[0], 128);
+  XCTAssertEqual(red[1], 0);
+  XCTAssertEqual(red[3], 128);
+  XCTAssertEqual(half_black[0], 0);
+  XCTAssertEqual(half_black[3], 128);
+  XCTAssertEqual(black[0], 0);
+  XCTAssertEqual(black[3], 255);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRender_CullsElementsOutsideClip {
+  std::string visible_data =
+      "<svg width='40' height='40'>"
+      "<rect x='41' y='10' width='10' height='10' fill='none'"
+      " stroke='black' stroke-width='4'/>"
+      "</svg>";
+  // The same document with two more elements that lie outside the canvas.
+  std::string data =
+      "<svg width='40' height='40'>"
+      "<rect x='50' y='0' width='10' height='10'/>"
+      "<rect x='41' y='10' width='10' height='10' fill='none'"
+      " stroke='black' stroke-width='4'/>"
+      "<path d='M-20 -20 l10 0 l0 10 z' stroke='red'/>"
+      "</svg>";
+  MSCDocument *visible_document =
+      MSCDocumentCreateFromData(visible_data.c_str(), visible_data.size(), "");
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  std::vector<uint8_t> expected = RenderPixels(visible_document, 40);
+
+  SoftwareCanvas canvas(40, 40);
+  Renderer renderer;
+  XCTAssert(renderer.RenderMSCDocument(document, NULL, &canvas));
+  XCTAssertEqual(renderer.culled_element_count(), 2U);
+  // The stroke of the second rect reaches into the canvas.
+  XCTAssertNotEqual(canvas.pixels()[(15 * 40 + 39) * 4 + 3], 0);
+  XCTAssertEqual(memcmp(canvas.pixels(), expected.data(), expected.size()), 0);
+  MSCDocumentDelete(visible_document);
+  MSCDocumentDelete(document);
+}
+
+- (void)testCreateCGImageFromRect {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  CGImageRef image = MSCDocumentCreateCGImageFromRect(
+      document, CGRectMake(10, 10, 5, 5), CGSizeMake(20, 20), NULL);
+  XCTAssert(image != NULL);
+  CGImageRelease(image);
+  XCTAssert(MSCDocumentCreateCGImageFromRect(
+      document, CGRectMake(10, 10, 0, 5), CGSizeMake(20, 20), NULL) == NULL);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderToBuffer {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  std::vector<uint8_t> pixels(48 * 40);
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(10, 40),
+                                           NULL,
+                                           pixels.data(),
+                                           48,
+                                           kMSCPixelFormatBGRA8888), 1);
+  // Rows must fit.
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(13, 40),
+                                           NULL,
+                                           pixels.data(),
+                                           48,
+                                           kMSCPixelFormatRGBA8888), 0);
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(10, 40),
+                                           NULL,
+                                           NULL,
+                                           48,
+                                           kMSCPixelFormatRGBA8888), 0);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderToBuffer_SoftwareBackend {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  std::vector<uint8_t> expected = RenderPixels(document, 40);
+
+  MSCSetRenderingBackend(kMSCRenderingBackendSoftware);
+  // Rows are padded to check that the padding is left alone.
+  std::vector<uint8_t> pixels(44 * 4 * 40, 0xab);
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(40, 40),
+                                           NULL,
+                                           pixels.data(),
+                                           44 * 4,
+                                           kMSCPixelFormatRGBA8888), 1);
+  for (size_t y = 0; y < 40; ++y) {
+    XCTAssertEqual(memcmp(&pixels[y * 44 * 4], &expected[y * 40 * 4], 40 * 4),
+                   0);
+    XCTAssertEqual(pixels[y * 44 * 4 + 40 * 4], 0xab);
+  }
+
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(40, 40),
+                                           NULL,
+                                           pixels.data(),
+                                           44 * 4,
+                                           kMSCPixelFormatBGRA8888), 1);
+  for (size_t y = 0; y < 40; ++y) {
+    for (size_t x = 0; x < 40; ++x) {
+      const uint8_t *pixel = &pixels[y * 44 * 4 + x * 4];
+      const uint8_t *expected_pixel = &expected[(y * 40 + x) * 4];
+      XCTAssertEqual(pixel[0], expected_pixel[2]);
+      XCTAssertEqual(pixel[1], expected_pixel[1]);
+      XCTAssertEqual(pixel[2], expected_pixel[0]);
+      XCTAssertEqual(pixel[3], expected_pixel[3]);
+    }
+  }
+  MSCSetRenderingBackend(kMSCRenderingBackendDefault);
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderTiles {
+  std::string data = kConcurrentRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  size_t pixel_count = 0;
+  XCTAssertEqual(MSCDocumentRenderTiles(document,
+                                        CGSizeMake(100.5, 70),
+                                        CGSizeMake(32, 32),
+                                        NULL,
+                                        3,
+                                        CountTilePixels,
+                                        &pixel_count), 1);
+  XCTAssertEqual(pixel_count, 100U * 70U);
+  XCTAssertEqual(MSCDocumentRenderTiles(document,
+                                        CGSizeMake(100, 70),
+                                        CGSizeMake(0, 32),
+                                        NULL,
+                                        3,
+                                        CountTilePixels,
+                                        &pixel_count), 0);
+  XCTAssertEqual(MSCDocumentRenderTiles(document,
+                                        CGSizeMake(100, 70),
+                                        CGSizeMake(32, 32),
+                                        NULL,
+                                        3,
+                                        NULL,
+                                        &pixel_count), 0);
+  XCTAssertEqual(MSCDocumentRenderTiles(NULL,
+                                        CGSizeMake(100, 70),
+                                        CGSizeMake(32, 32),
+                                        NULL,
+                                        3,
+                                        CountTilePixels,
+                                        &pixel_count), 0);
+  MSCDocumentDelete(document);
+}
+
+- (void)testPerformance_CreateFromFile {
+  MeasureCreateFromFile(self, LoadingBenchmarkData());
+}
+
+- (void)testPerformance_CreateFromFile_Gzip {
+  MeasureCreateFromFile(self, GzipData(LoadingBenchmarkData()));
+}
+
+- (void)testPerformance_DocumentLoader {
+  MeasureDocumentLoader(self, LoadingBenchmarkData());
+}
+
+- (void)testPerformance_DocumentLoader_Gzip {
+  MeasureDocumentLoader(self, GzipData(LoadingBenchmarkData()));
+}
+
+- (void)testPerformance_Render_SiblingsInheritingState {
+  std::string data = "<svg width=\"100\" height=\"100\"><g fill=\"red\">";
+  for (int i = 0; i < 50000; ++i) {
+    data += "<rect width=\"10\" height=\"10\"/>";
+  }
+  data += "</g></svg>";
+  MeasureRendering(self, data);
+}
+
+- (void)testPerformance_Render_SiblingsSettingState {
+  std::string data = "<svg width=\"100\" height=\"100\">";
+  for (int i = 0; i < 50000; ++i) {
+    data += "<rect width=\"10\" height=\"10\" fill=\"red\"/>";
+  }
+  data += "</svg>";
+  MeasureRendering(self, data);
+}
+
+// 100 chains of 200 nested groups, each ending in a rect.
+- (void)testPerformance_Render_NestedGroups {
+  std::string data = "<svg width=\"100\" height=\"100\">";
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 200; ++j) {
+      data += "<g>";
+    }
+    data += "<rect width=\"10\" height=\"10\"/>";
+    for (int j = 0; j < 200; ++j) {
+      data += "</g>";
+    }
+  }
+  data += "</svg>";
+  MeasureRendering(self, data);
+}
+
+// Most of the pixels are covered by several translucent shapes, so the
+// time goes into compositing solid spans.
+- (void)testPerformance_RenderToBuffer_SoftwareBackendTranslucentShapes {
+  std::string data = "<svg width=\"100\" height=\"100\">";
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      data += "<circle cx=\"" + std::to_string(i * 10 + 5) + "\" cy=\"" +
+              std::to_string(j * 10 + 5) + "\" r=\"15\" fill=\"blue\"" +
+              " fill-opacity=\"0.25\"/>";
+    }
+  }
+  data += "</svg>";
+  MeasureSoftwareRendering(self, data);
+}
+
+// Paints a gradient with six stops over every pixel, which is looked up in
+// the gradient's color table.
+- (void)testPerformance_RenderToBuffer_SoftwareBackendLinearGradient {
+  MeasureSoftwareRendering(self, std::string(
+      "<svg width=\"100\" height=\"100\">"
+      "<linearGradient id=\"g\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\">"
+      "<stop offset=\"0\" stop-color=\"red\"/>"
+      "<stop offset=\"0.2\" stop-color=\"yellow\" stop-opacity=\"0.5\"/>"
+      "<stop offset=\"0.4\" stop-color=\"lime\"/>"
+      "<stop offset=\"0.6\" stop-color=\"aqua\" stop-opacity=\"0.75\"/>"
+      "<stop offset=\"0.8\" stop-color=\"blue\"/>"
+      "<stop offset=\"1\" stop-color=\"fuchsia\"/>"
+      "</linearGradient>"
+      "<rect width=\"100\" height=\"100\" fill=\"url(#g)\"/></svg>"));
+}
+
+- (void)testPerformance_RenderToBuffer_SoftwareBackendRadialGradient {
+  MeasureSoftwareRendering(self, std::string(
+      "<svg width=\"100\" height=\"100\">"
+      "<radialGradient id=\"g\" fx=\"0.3\" fy=\"0.3\">"
+      "<stop offset=\"0\" stop-color=\"red\"/>"
+      "<stop offset=\"0.2\" stop-color=\"yellow\" stop-opacity=\"0.5\"/>"
+      "<stop offset=\"0.4\" stop-color=\"lime\"/>"
+      "<stop offset=\"0.6\" stop-color=\"aqua\" stop-opacity=\"0.75\"/>"
+      "<stop offset=\"0.8\" stop-color=\"blue\"/>"
+      "<stop offset=\"1\" stop-color=\"fuchsia\"/>"
+      "</radialGradient>"
+      "<rect width=\"100\" height=\"100\" fill=\"url(#g)\"/></svg>"));
+}
 
 // TODO: Write more tests of SVGDocument* public functions.
 
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Geometry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace metrosvg {
+namespace internal {
+
+FloatRect FloatRect::Null() {
+  Float infinity = std::numeric_limits<Float>::infinity();
+  return FloatRect(infinity, infinity, 0, 0);
+}
+
+bool FloatRect::IsNull() const {
+  return std::isinf(origin.x) || std::isinf(origin.y);
+}
+
+bool FloatRect::IsEmpty() const {
+  return IsNull() || size.width == 0 || size.height == 0;
+}
+
+Float FloatRect::min_x() const {
+  return std::min(origin.x, origin.x + size.width);
+}
+
+Float FloatRect::mid_x() const {
+  return origin.x + size.width / 2;
+}
+
+Float FloatRect::max_x() const {
+  return std::max(origin.x, origin.x + size.width);
+}
+
+Float FloatRect::min_y() const {
+  return std::min(origin.y, origin.y + size.height);
+}
+
+Float FloatRect::mid_y() const {
+  return origin.y + size.height / 2;
+}
+
+Float FloatRect::max_y() const {
+  return std::max(origin.y, origin.y + size.height);
+}
+
+Float FloatRect::width() const {
+  return std::fabs(size.width);
+}
+
+Float FloatRect::height() const {
+  return std::fabs(size.height);
+}
+
+FloatRect FloatRect::Standardized() const {
+  if (IsNull()) {
+    return *this;
+  }
+  return FloatRect(min_x(), min_y(), width(), height());
+}
+
+FloatRect FloatRect::Inset(Float dx, Float dy) const {
+  if (IsNull()) {
+    return *this;
+  }
+  FloatRect rect(min_x() + dx, min_y() + dy,
+                 width() - 2 * dx, height() - 2 * dy);
+  if (rect.size.width < 0 || rect.size.height < 0) {
+    return Null();
+  }
+  return rect;
+}
+
+AffineTransform AffineTransform::MakeRotation(Float angle) {
+  Float cosine = std::cos(angle);
+  Float sine = std::sin(angle);
+  return AffineTransform(cosine, sine, -sine, cosine, 0, 0);
+}
+
+FloatRect ApplyTransform(const FloatRect &rect,
+                         const AffineTransform &transform) {
+  if (rect.IsNull()) {
+    return rect;
+  }
+  FloatPoint corners[4] = {
+    ApplyTransform(FloatPoint(rect.min_x(), rect.min_y()), transform),
+    ApplyTransform(FloatPoint(rect.max_x(), rect.min_y()), transform),
+    ApplyTransform(FloatPoint(rect.min_x(), rect.max_y()), transform),
+    ApplyTransform(FloatPoint(rect.max_x(), rect.max_y()), transform),
+  };
+  Float min_x = corners[0].x;
+  Float max_x = corners[0].x;
+  Float min_y = corners[0].y;
+  Float max_y = corners[0].y;
+  for (int i = 1; i < 4; ++i) {
+    min_x = std::min(min_x, corners[i].x);
+    max_x = std::max(max_x, corners[i].x);
+    min_y = std::min(min_y, corners[i].y);
+    max_y = std::max(max_y, corners[i].y);
+  }
+  return FloatRect(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+AffineTransform ConcatTransforms(const AffineTransform &first,
+                                 const AffineTransform &second) {
+  return AffineTransform(first.a * second.a + first.b * second.c,
+                         first.a * second.b + first.b * second.d,
+                         first.c * second.a + first.d * second.c,
+                         first.c * second.b + first.d * second.d,
+                         first.tx * second.a + first.ty * second.c +
+                             second.tx,
+                         first.tx * second.b + first.ty * second.d +
+                             second.ty);
+}
+
+AffineTransform InvertTransform(const AffineTransform &transform) {
+  Float determinant = transform.a * transform.d - transform.b * transform.c;
+  if (determinant == 0) {
+    return transform;
+  }
+  return AffineTransform(
+      transform.d / determinant,
+      -transform.b / determinant,
+      -transform.c / determinant,
+      transform.a / determinant,
+      (transform.c * transform.ty - transform.d * transform.tx) / determinant,
+      (transform.b * transform.tx - transform.a * transform.ty) / determinant);
+}
+
+AffineTransform ScaleTransform(const AffineTransform &transform,
+                               Float sx,
+                               Float sy) {
+  return ConcatTransforms(AffineTransform::MakeScale(sx, sy), transform);
+}
+
+}  // namespace internal
+}  // namespace metrosvg
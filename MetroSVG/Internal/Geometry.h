@@ -0,0 +1,179 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Geometry types used throughout the library. They have the same layout
+// and semantics as their CoreGraphics counterparts, CGFloat, CGPoint,
+// CGSize, CGRect and CGAffineTransform, so that only the CoreGraphics
+// backend needs to know about the latter.
+
+#pragma once
+
+namespace metrosvg {
+namespace internal {
+
+// Same width as CGFloat.
+#if defined(__LP64__) && __LP64__
+typedef double Float;
+#else
+typedef float Float;
+#endif
+
+struct FloatPoint {
+  Float x;
+  Float y;
+
+  FloatPoint()
+      : x(0), y(0) {}
+  FloatPoint(Float x_in, Float y_in)
+      : x(x_in), y(y_in) {}
+
+  bool operator==(const FloatPoint &other) const {
+    return x == other.x && y == other.y;
+  }
+  bool operator!=(const FloatPoint &other) const {
+    return !(*this == other);
+  }
+};
+
+struct FloatSize {
+  Float width;
+  Float height;
+
+  FloatSize()
+      : width(0), height(0) {}
+  FloatSize(Float width_in, Float height_in)
+      : width(width_in), height(height_in) {}
+
+  bool operator==(const FloatSize &other) const {
+    return width == other.width && height == other.height;
+  }
+  bool operator!=(const FloatSize &other) const {
+    return !(*this == other);
+  }
+};
+
+// Like CGRect, the size of a rectangle can be negative, in which case the
+// rectangle extends to the left of or above its origin. The accessors
+// below all work on the standardized rectangle.
+struct FloatRect {
+  FloatPoint origin;
+  FloatSize size;
+
+  FloatRect() {}
+  FloatRect(Float x, Float y, Float width, Float height)
+      : origin(x, y), size(width, height) {}
+
+  // Returns the null rectangle, which has an infinite origin and stands
+  // for the absence of a rectangle, e.g., the intersection of disjoint
+  // rectangles. Same as CGRectNull.
+  static FloatRect Null();
+
+  bool IsNull() const;
+  // Returns true if the rectangle is null or has no area.
+  bool IsEmpty() const;
+
+  Float min_x() const;
+  Float mid_x() const;
+  Float max_x() const;
+  Float min_y() const;
+  Float mid_y() const;
+  Float max_y() const;
+  Float width() const;
+  Float height() const;
+
+  // Returns the rectangle with a non-negative size.
+  FloatRect Standardized() const;
+  // Returns the rectangle moved in by |dx| on the left and right and |dy| on
+  // the top and bottom, or the null rectangle if nothing remains. Negative
+  // values move the sides out.
+  FloatRect Inset(Float dx, Float dy) const;
+
+  bool operator==(const FloatRect &other) const {
+    return origin == other.origin && size == other.size;
+  }
+  bool operator!=(const FloatRect &other) const {
+    return !(*this == other);
+  }
+};
+
+// The matrix
+//   | a  b  0 |
+//   | c  d  0 |
+//   | tx ty 1 |
+// which maps a row vector (x, y, 1) to (a*x + c*y + tx, b*x + d*y + ty, 1).
+// Default-constructed transforms are the identity.
+struct AffineTransform {
+  Float a;
+  Float b;
+  Float c;
+  Float d;
+  Float tx;
+  Float ty;
+
+  AffineTransform()
+      : a(1), b(0), c(0), d(1), tx(0), ty(0) {}
+  AffineTransform(Float a_in, Float b_in, Float c_in, Float d_in,
+                  Float tx_in, Float ty_in)
+      : a(a_in), b(b_in), c(c_in), d(d_in), tx(tx_in), ty(ty_in) {}
+
+  static AffineTransform MakeTranslation(Float tx, Float ty) {
+    return AffineTransform(1, 0, 0, 1, tx, ty);
+  }
+  static AffineTransform MakeScale(Float sx, Float sy) {
+    return AffineTransform(sx, 0, 0, sy, 0, 0);
+  }
+  // |angle| is in radians. Positive angles rotate from the x axis towards
+  // the y axis.
+  static AffineTransform MakeRotation(Float angle);
+
+  bool operator==(const AffineTransform &other) const {
+    return a == other.a && b == other.b && c == other.c && d == other.d &&
+           tx == other.tx && ty == other.ty;
+  }
+  bool operator!=(const AffineTransform &other) const {
+    return !(*this == other);
+  }
+};
+
+inline FloatPoint ApplyTransform(FloatPoint point,
+                                 const AffineTransform &transform) {
+  return FloatPoint(transform.a * point.x + transform.c * point.y +
+                        transform.tx,
+                    transform.b * point.x + transform.d * point.y +
+                        transform.ty);
+}
+
+// Returns the smallest rectangle that contains |rect| transformed, or the
+// null rectangle if |rect| is null.
+FloatRect ApplyTransform(const FloatRect &rect,
+                         const AffineTransform &transform);
+
+// Returns the transform that applies |first| and then |second|. Same as
+// CGAffineTransformConcat(first, second).
+AffineTransform ConcatTransforms(const AffineTransform &first,
+                                 const AffineTransform &second);
+
+// Returns the inverse of |transform|, or |transform| itself if it can't be
+// inverted. Same as CGAffineTransformInvert.
+AffineTransform InvertTransform(const AffineTransform &transform);
+
+// Returns |transform| preceded by a scale. Same as CGAffineTransformScale.
+AffineTransform ScaleTransform(const AffineTransform &transform,
+                               Float sx,
+                               Float sy);
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Constants.h"
+#include "MetroSVG/Internal/Geometry.h"
+
+using namespace metrosvg::internal;
+
+static const Float kTolerance = 0.001f;
+
+@interface GeometryTest : XCTestCase
+@end
+
+@implementation GeometryTest
+
+- (void)testFloatRect_Null {
+  FloatRect rect = FloatRect::Null();
+  XCTAssert(rect.IsNull());
+  XCTAssert(rect.IsEmpty());
+  XCTAssertFalse(FloatRect().IsNull());
+  XCTAssert(FloatRect().IsEmpty());
+  XCTAssert(rect.Standardized().IsNull());
+  XCTAssert(rect.Inset(-1, -1).IsNull());
+}
+
+- (void)testFloatRect_NegativeSize {
+  FloatRect rect(10, 20, -4, -6);
+  XCTAssertEqual(rect.min_x(), 6);
+  XCTAssertEqual(rect.max_x(), 10);
+  XCTAssertEqual(rect.mid_x(), 8);
+  XCTAssertEqual(rect.min_y(), 14);
+  XCTAssertEqual(rect.max_y(), 20);
+  XCTAssertEqual(rect.width(), 4);
+  XCTAssertEqual(rect.height(), 6);
+  XCTAssert(rect.Standardized() == FloatRect(6, 14, 4, 6));
+}
+
+- (void)testFloatRect_Inset {
+  FloatRect rect(0, 0, 10, 4);
+  XCTAssert(rect.Inset(1, 1) == FloatRect(1, 1, 8, 2));
+  XCTAssert(rect.Inset(-1, 0) == FloatRect(-1, 0, 12, 4));
+  XCTAssert(rect.Inset(1, 2) == FloatRect(1, 2, 8, 0));
+  XCTAssert(rect.Inset(1, 3).IsNull());
+}
+
+- (void)testApplyTransform_Rect {
+  AffineTransform rotation = AffineTransform::MakeRotation(kPi / 2);
+  FloatRect rect = ApplyTransform(FloatRect(1, 2, 3, 4), rotation);
+  XCTAssertEqualWithAccuracy(rect.origin.x, -6, kTolerance);
+  XCTAssertEqualWithAccuracy(rect.origin.y, 1, kTolerance);
+  XCTAssertEqualWithAccuracy(rect.size.width, 4, kTolerance);
+  XCTAssertEqualWithAccuracy(rect.size.height, 3, kTolerance);
+  XCTAssert(ApplyTransform(FloatRect::Null(), rotation).IsNull());
+}
+
+- (void)testConcatTransforms_AppliesFirstThenSecond {
+  AffineTransform scale = AffineTransform::MakeScale(2, 3);
+  AffineTransform translation = AffineTransform::MakeTranslation(5, 7);
+  FloatPoint point =
+      ApplyTransform(FloatPoint(1, 1), ConcatTransforms(scale, translation));
+  XCTAssert(point == FloatPoint(7, 10));
+  point =
+      ApplyTransform(FloatPoint(1, 1), ConcatTransforms(translation, scale));
+  XCTAssert(point == FloatPoint(12, 24));
+  XCTAssert(ScaleTransform(translation, 2, 3) ==
+            ConcatTransforms(scale, translation));
+}
+
+- (void)testInvertTransform {
+  AffineTransform transform(1, 2, 3, 4, 5, 6);
+  AffineTransform identity =
+      ConcatTransforms(transform, InvertTransform(transform));
+  XCTAssertEqualWithAccuracy(identity.a, 1, kTolerance);
+  XCTAssertEqualWithAccuracy(identity.b, 0, kTolerance);
+  XCTAssertEqualWithAccuracy(identity.c, 0, kTolerance);
+  XCTAssertEqualWithAccuracy(identity.d, 1, kTolerance);
+  XCTAssertEqualWithAccuracy(identity.tx, 0, kTolerance);
+  XCTAssertEqualWithAccuracy(identity.ty, 0, kTolerance);
+}
+
+- (void)testInvertTransform_Singular {
+  AffineTransform transform(1, 2, 2, 4, 5, 6);
+  XCTAssert(InvertTransform(transform) == transform);
+}
+
+@end
@@ -16,6 +16,8 @@
 
 #include "MetroSVG/Internal/Gradient.h"
 
+#include <cmath>
+
 #include "MetroSVG/Internal/StringPiece.h"
 #include "MetroSVG/Internal/TransformIterator.h"
 #include "MetroSVG/Internal/Utils.h"
@@ -23,15 +25,50 @@
 namespace metrosvg {
 namespace internal {
 
-Gradient::Gradient(Gradient::Type type_in, const StringMap &attributes)
+namespace {
+
+// Computes the color of the gradient at |t| as an unpremultiplied color.
+void StopColorAt(const std::vector<GradientStop> &stops, Float t,
+                 Float rgba[4]) {
+  size_t count = stops.size();
+  if (!(t > stops[0].offset)) {
+    const GradientStop &stop = stops[0];
+    rgba[0] = stop.color.red();
+    rgba[1] = stop.color.green();
+    rgba[2] = stop.color.blue();
+    rgba[3] = stop.opacity;
+  } else if (t >= stops[count - 1].offset) {
+    const GradientStop &stop = stops[count - 1];
+    rgba[0] = stop.color.red();
+    rgba[1] = stop.color.green();
+    rgba[2] = stop.color.blue();
+    rgba[3] = stop.opacity;
+  } else {
+    size_t i = 1;
+    while (stops[i].offset <= t) {
+      ++i;
+    }
+    const GradientStop &a = stops[i - 1];
+    const GradientStop &b = stops[i];
+    Float f = (t - a.offset) / (b.offset - a.offset);
+    rgba[0] = a.color.red() + (b.color.red() - a.color.red()) * f;
+    rgba[1] = a.color.green() + (b.color.green() - a.color.green()) * f;
+    rgba[2] = a.color.blue() + (b.color.blue() - a.color.blue()) * f;
+    rgba[3] = a.opacity + (b.opacity - a.opacity) * f;
+  }
+}
+
+}  // namespace
+
+Gradient::Gradient(Gradient::Type type_in, const AttributeTable &attributes)
     : type(type_in) {
-  const std::string *id_value = FindValueOrNull(attributes, std::string("id"));
+  const StringPiece *id_value = attributes.Find(kAtomId);
   if (id_value) {
-    id = *id_value;
+    id = id_value->as_std_string();
   }
 
-  const std::string *gradient_transform_value =
-      FindValueOrNull(attributes, std::string("gradientTransform"));
+  const StringPiece *gradient_transform_value =
+      attributes.Find(kAtomGradientTransform);
   if (gradient_transform_value) {
     StringPiece gradient_transform_value_sp(*gradient_transform_value);
     TransformIterator transform_iterator(&gradient_transform_value_sp);
@@ -40,8 +77,8 @@ Gradient::Gradient(Gradient::Type type_in, const StringMap &attributes)
     }
   }
 
-  const std::string *gradient_units_value =
-      FindValueOrNull(attributes, std::string("gradientUnits"));
+  const StringPiece *gradient_units_value =
+      attributes.Find(kAtomGradientUnits);
   if (gradient_units_value != nullptr &&
       *gradient_units_value == "userSpaceOnUse") {
     units = kUnitsUserSpaceOnUse;
@@ -50,26 +87,24 @@ Gradient::Gradient(Gradient::Type type_in, const StringMap &attributes)
   }
 }
 
-CGGradientRef CreateCGGradient(const Gradient &gradient) {
-  size_t stop_count = gradient.stops.size();
-  std::vector<CGFloat> components(stop_count * 4);
-  std::vector<CGFloat> locations(stop_count);
-  for (size_t i = 0; i < stop_count; ++i) {
-    GradientStop stop = gradient.stops[i];
-    components[4 * i] = stop.color.red();
-    components[4 * i + 1] = stop.color.green();
-    components[4 * i + 2] = stop.color.blue();
-    components[4 * i + 3] = stop.opacity;
-    locations[i] = stop.offset;
+const size_t Gradient::kColorTableSize;
+
+const uint8_t *Gradient::ColorTable() const {
+  if (color_table.empty()) {
+    color_table.resize(kColorTableSize * 4);
+    for (size_t i = 0; i < kColorTableSize; ++i) {
+      Float rgba[4];
+      StopColorAt(stops, Float(i) / (kColorTableSize - 1), rgba);
+      uint8_t *color = &color_table[i * 4];
+      Float a = ClampToUnitRange(rgba[3]);
+      for (int j = 0; j < 3; ++j) {
+        color[j] = static_cast<uint8_t>(
+            std::lround(ClampToUnitRange(rgba[j]) * a * 255));
+      }
+      color[3] = static_cast<uint8_t>(std::lround(a * 255));
+    }
   }
-  CGColorSpaceRef color_space = CGColorSpaceCreateDeviceRGB();
-  CGGradientRef cg_gradient =
-      CGGradientCreateWithColorComponents(color_space,
-                                          components.data(),
-                                          locations.data(),
-                                          stop_count);
-  CGColorSpaceRelease(color_space);
-  return cg_gradient;
+  return color_table.data();
 }
 
 }  // namespace internal
@@ -16,26 +16,24 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
-#include <CoreGraphics/CoreGraphics.h>
-
+#include "MetroSVG/Internal/AttributeTable.h"
 #include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
 
-struct Gradient;
-
-CGGradientRef CreateCGGradient(const Gradient &gradient);
-
 struct GradientStop {
-  CGFloat offset;
+  Float offset;
   RgbColor color;
-  CGFloat opacity;
+  Float opacity;
 
-  GradientStop(CGFloat offset_in, RgbColor color_in, CGFloat opacity_in)
+  GradientStop(Float offset_in, RgbColor color_in, Float opacity_in)
       : offset(offset_in), color(color_in), opacity(opacity_in) {}
 };
 
@@ -58,10 +56,14 @@ struct Gradient {
     Length fx, fy, cx, cy, r;
   };
 
+  // The number of entries in the color table. A power of two plus one, so
+  // that offsets 0, 0.5 and 1 fall exactly on entries.
+  static const size_t kColorTableSize = 1025;
+
   Type type;
   std::string id;
   std::vector<GradientStop> stops;
-  std::vector<CGAffineTransform> transforms;
+  std::vector<AffineTransform> transforms;
   Units units;
 
   union {
@@ -69,7 +71,18 @@ struct Gradient {
     Radial radial;
   };
 
-  Gradient(Type type_in, const StringMap &attributes);
+  // Colors at offsets i / (kColorTableSize - 1), built by ColorTable().
+  mutable std::vector<uint8_t> color_table;
+
+  Gradient(Type type_in, const AttributeTable &attributes);
+
+  // Returns the colors of the gradient at kColorTableSize evenly spaced
+  // offsets from 0 to 1 as premultiplied RGBA, 4 bytes per entry. Colors
+  // are interpolated between the stops without premultiplication, and the
+  // first and last stops extend to the ends. The table is built on first
+  // use and kept, so the stops must not change afterwards. |stops| must not
+  // be empty.
+  const uint8_t *ColorTable() const;
 };
 
 }  // namespace internal
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/GradientCache.h"
+
+#include <functional>
+#include <utility>
+
+#include "MetroSVG/Internal/Gradient.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Enough for the gradients of many documents; each entry takes a few
+// hundred bytes at most.
+const size_t kSharedCGGradientCacheCapacity = 256;
+
+}  // namespace
+
+size_t CGGradientCache::KeyHash::operator()(const Key &key) const {
+  std::hash<CGFloat> hash_value;
+  size_t hash = key.size();
+  for (CGFloat value : key) {
+    hash ^= hash_value(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+CGGradientCache::CGGradientCache(size_t capacity)
+    : capacity_(capacity),
+      hit_count_(0),
+      miss_count_(0) {}
+
+CGGradientCache::~CGGradientCache() {
+  ReleaseGradients();
+}
+
+CGGradientCache *CGGradientCache::Shared() {
+  // Never deleted, so that canvases can be used during static destruction.
+  static CGGradientCache *cache =
+      new CGGradientCache(kSharedCGGradientCacheCapacity);
+  return cache;
+}
+
+CGGradientRef CGGradientCache::CreateCGGradient(const Gradient &gradient) {
+  size_t stop_count = gradient.stops.size();
+  Key key(stop_count * 5);
+  for (size_t i = 0; i < stop_count; ++i) {
+    const GradientStop &stop = gradient.stops[i];
+    key[5 * i] = stop.color.red();
+    key[5 * i + 1] = stop.color.green();
+    key[5 * i + 2] = stop.color.blue();
+    key[5 * i + 3] = stop.opacity;
+    key[5 * i + 4] = stop.offset;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = gradients_.find(key);
+    if (iter != gradients_.end()) {
+      ++hit_count_;
+      return CGGradientRetain(iter->second);
+    }
+    ++miss_count_;
+  }
+
+  // Build the gradient without holding the lock. If another thread adds
+  // the same stops in the meantime, its entry is kept.
+  std::vector<CGFloat> components(stop_count * 4);
+  std::vector<CGFloat> locations(stop_count);
+  for (size_t i = 0; i < stop_count; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      components[4 * i + j] = key[5 * i + j];
+    }
+    locations[i] = key[5 * i + 4];
+  }
+  CGColorSpaceRef color_space = CGColorSpaceCreateDeviceRGB();
+  CGGradientRef cg_gradient =
+      CGGradientCreateWithColorComponents(color_space,
+                                          components.data(),
+                                          locations.data(),
+                                          stop_count);
+  CGColorSpaceRelease(color_space);
+  if (cg_gradient == NULL || capacity_ == 0) {
+    return cg_gradient;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (gradients_.size() >= capacity_ && gradients_.count(key) == 0) {
+    ReleaseGradients();
+  }
+  auto result = gradients_.emplace(std::move(key), cg_gradient);
+  if (result.second) {
+    CGGradientRetain(cg_gradient);
+  }
+  return cg_gradient;
+}
+
+void CGGradientCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReleaseGradients();
+}
+
+size_t CGGradientCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return gradients_.size();
+}
+
+size_t CGGradientCache::hit_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hit_count_;
+}
+
+size_t CGGradientCache::miss_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return miss_count_;
+}
+
+void CGGradientCache::ReleaseGradients() {
+  for (const auto &entry : gradients_) {
+    CGGradientRelease(entry.second);
+  }
+  gradients_.clear();
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <CoreGraphics/CoreGraphics.h>
+
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+struct Gradient;
+
+// Keeps the CGGradient objects built for gradients so that paints and
+// renders using the same color ramp share one object. Entries are keyed
+// by the stops alone, so equal gradients with different ids, or in
+// different documents, hit the same entry. Safe to use from multiple
+// threads.
+class CGGradientCache {
+ public:
+  // The cache holds at most |capacity| gradients. When it is full, all
+  // the entries are dropped before adding another one.
+  explicit CGGradientCache(size_t capacity);
+  ~CGGradientCache();
+
+  // Returns the cache used by CoreGraphicsCanvas.
+  static CGGradientCache *Shared();
+
+  // Returns a gradient with the stops of |gradient|, building it if it
+  // isn't in the cache. Caller should release the returned instance.
+  CGGradientRef CreateCGGradient(const Gradient &gradient);
+
+  // Removes all the entries. The counters are kept.
+  void Clear();
+
+  size_t size() const;
+  // Number of CreateCGGradient calls that found or didn't find their
+  // stops in the cache.
+  size_t hit_count() const;
+  size_t miss_count() const;
+
+ private:
+  // Color components followed by the offset for each stop.
+  typedef std::vector<CGFloat> Key;
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  const size_t capacity_;
+
+  // Guards the fields below.
+  mutable std::mutex mutex_;
+  std::unordered_map<Key, CGGradientRef, KeyHash> gradients_;
+  size_t hit_count_;
+  size_t miss_count_;
+
+  // Releases the gradients in the cache. |mutex_| must be held.
+  void ReleaseGradients();
+
+  DISALLOW_COPY_AND_ASSIGN(CGGradientCache);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
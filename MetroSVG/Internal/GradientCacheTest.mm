@@ -0,0 +1,103 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/GradientCache.h"
+
+using namespace metrosvg::internal;
+
+// Returns a linear gradient from opaque black to |end_color|.
+static Gradient MakeGradient(const std::string &id, RgbColor end_color) {
+  AttributeTable attributes;
+  attributes.Set(kAtomId, id);
+  Gradient gradient(Gradient::kTypeLinear, attributes);
+  gradient.stops.push_back(GradientStop(0, RgbColor(0, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(1, end_color, 1));
+  return gradient;
+}
+
+@interface GradientCacheTest : XCTestCase
+@end
+
+@implementation GradientCacheTest
+
+- (void)testCreateCGGradient_ReusesGradientsWithEqualStops {
+  CGGradientCache cache(8);
+  Gradient red = MakeGradient("a", RgbColor(1, 0, 0));
+  Gradient other_red = MakeGradient("b", RgbColor(1, 0, 0));
+  Gradient blue = MakeGradient("a", RgbColor(0, 0, 1));
+
+  CGGradientRef first = cache.CreateCGGradient(red);
+  CGGradientRef second = cache.CreateCGGradient(other_red);
+  CGGradientRef third = cache.CreateCGGradient(blue);
+  XCTAssert(first != NULL);
+  XCTAssertEqual(first, second);
+  XCTAssertNotEqual(first, third);
+  XCTAssertEqual(cache.hit_count(), 1U);
+  XCTAssertEqual(cache.miss_count(), 2U);
+  XCTAssertEqual(cache.size(), 2U);
+  CGGradientRelease(first);
+  CGGradientRelease(second);
+  CGGradientRelease(third);
+
+  cache.Clear();
+  XCTAssertEqual(cache.size(), 0U);
+  CGGradientRelease(cache.CreateCGGradient(red));
+  XCTAssertEqual(cache.miss_count(), 3U);
+}
+
+- (void)testCreateCGGradient_Capacity {
+  CGGradientCache cache(2);
+  for (int i = 0; i < 5; ++i) {
+    CGGradientRelease(
+        cache.CreateCGGradient(MakeGradient("a", RgbColor(i / 4.0, 0, 0))));
+    XCTAssertLessThanOrEqual(cache.size(), 2U);
+  }
+  XCTAssertEqual(cache.miss_count(), 5U);
+
+  CGGradientCache no_cache(0);
+  Gradient gradient = MakeGradient("a", RgbColor(1, 0, 0));
+  CGGradientRelease(no_cache.CreateCGGradient(gradient));
+  CGGradientRelease(no_cache.CreateCGGradient(gradient));
+  XCTAssertEqual(no_cache.size(), 0U);
+  XCTAssertEqual(no_cache.miss_count(), 2U);
+}
+
+- (void)testCreateCGGradient_Concurrently {
+  CGGradientCache cache(4);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&cache, i] () {
+      for (int j = 0; j < 100; ++j) {
+        RgbColor color((i + j) % 6 / 5.0, 0, 0);
+        CGGradientRelease(cache.CreateCGGradient(MakeGradient("a", color)));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  XCTAssertEqual(cache.hit_count() + cache.miss_count(), 400U);
+  XCTAssertLessThanOrEqual(cache.size(), 4U);
+}
+
+@end
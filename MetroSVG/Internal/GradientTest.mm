@@ -0,0 +1,66 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Gradient.h"
+
+using namespace metrosvg::internal;
+
+@interface GradientTest : XCTestCase
+@end
+
+@implementation GradientTest
+
+- (void)testColorTable {
+  Gradient gradient(Gradient::kTypeLinear, AttributeTable());
+  gradient.stops.push_back(GradientStop(0.25, RgbColor(1, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(0.75, RgbColor(0, 0, 1), 0.5));
+  const uint8_t *table = gradient.ColorTable();
+  const size_t last = Gradient::kColorTableSize - 1;
+
+  // The first and last stops extend to the ends.
+  XCTAssertEqual(table[0], 255);
+  XCTAssertEqual(table[2], 0);
+  XCTAssertEqual(table[3], 255);
+  XCTAssertEqual(table[last * 4 + 2], 128);
+  XCTAssertEqual(table[last * 4 + 3], 128);
+
+  // Halfway between the stops, premultiplied by an alpha of 0.75.
+  const uint8_t *middle = &table[last / 2 * 4];
+  XCTAssertEqual(middle[0], 96);
+  XCTAssertEqual(middle[2], 96);
+  XCTAssertEqual(middle[3], 191);
+
+  // The table is built once.
+  XCTAssertEqual(gradient.ColorTable(), table);
+}
+
+- (void)testColorTable_HardStop {
+  Gradient gradient(Gradient::kTypeLinear, AttributeTable());
+  gradient.stops.push_back(GradientStop(0, RgbColor(0, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(0.5, RgbColor(0, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(0.5, RgbColor(1, 1, 1), 1));
+  gradient.stops.push_back(GradientStop(1, RgbColor(1, 1, 1), 1));
+  const uint8_t *table = gradient.ColorTable();
+  const size_t middle = (Gradient::kColorTableSize - 1) / 2;
+  XCTAssertEqual(table[(middle - 1) * 4], 0);
+  XCTAssertEqual(table[middle * 4], 255);
+}
+
+@end
@@ -16,7 +16,7 @@
 
 #include "MetroSVG/Internal/LoggingUtils.h"
 
-#include <CoreGraphics/CoreGraphics.h>
+#include "MetroSVG/Internal/Gradient.h"
 
 namespace metrosvg {
 namespace internal {
@@ -89,7 +89,7 @@ std::string FormatValue(std::nullptr_t value) {
 }
 
 template<>
-std::string FormatValue(const CGAffineTransform value) {
+std::string FormatValue(const AffineTransform value) {
   std::stringstream ss;
   ss << "(" << value.a << ", " << value.b << ", "
      << value.c << ", " << value.d << ", "
@@ -98,19 +98,27 @@ std::string FormatValue(const CGAffineTransform value) {
 }
 
 template<>
-std::string FormatValue(CGAffineTransform *value) {
+std::string FormatValue(AffineTransform *value) {
   return FormatValue(*value);
 }
 
 template<>
-std::string FormatValue(const CGPoint value) {
+std::string FormatValue(const AffineTransform *value) {
+  if (value == nullptr) {
+    return "NULL";
+  }
+  return FormatValue(*value);
+}
+
+template<>
+std::string FormatValue(const FloatPoint value) {
   std::stringstream ss;
   ss << "(" << value.x << ", " << value.y << ")";
   return ss.str();
 }
 
 template<>
-std::string FormatValue(const CGRect value) {
+std::string FormatValue(const FloatRect value) {
   std::stringstream ss;
   ss << "(" << value.origin.x << ", " << value.origin.y << ", "
      << value.size.width << ", " << value.size.height << ")";
@@ -118,27 +126,45 @@ std::string FormatValue(const CGRect value) {
 }
 
 template<>
-std::string FormatValue(CGLineCap value) {
+std::string FormatValue(LineCap value) {
+  switch (value) {
+    case kLineCapButt:
+      return "kLineCapButt";
+    case kLineCapRound:
+      return "kLineCapRound";
+    case kLineCapSquare:
+      return "kLineCapSquare";
+  }
+  return "";
+}
+
+template<>
+std::string FormatValue(LineJoin value) {
   switch (value) {
-    case kCGLineCapButt:
-      return "kCGLineCapButt";
-    case kCGLineCapRound:
-      return "kCGLineCapRound";
-    case kCGLineCapSquare:
-      return "kCGLineCapSquare";
+    case kLineJoinMiter:
+      return "kLineJoinMiter";
+    case kLineJoinRound:
+      return "kLineJoinRound";
+    case kLineJoinBevel:
+      return "kLineJoinBevel";
   }
+  return "";
 }
 
 template<>
-std::string FormatValue(CGLineJoin value) {
+std::string FormatValue(FillRule value) {
   switch (value) {
-    case kCGLineJoinMiter:
-      return "kCGLineJoinMiter";
-    case kCGLineJoinRound:
-      return "kCGLineJoinRound";
-    case kCGLineJoinBevel:
-      return "kCGLineJoinBevel";
+    case kFillRuleNonZero:
+      return "kFillRuleNonZero";
+    case kFillRuleEvenOdd:
+      return "kFillRuleEvenOdd";
   }
+  return "";
+}
+
+template<>
+std::string FormatValue(Gradient value) {
+  return "#" + value.id;
 }
 
 }  // namespace internal
@@ -20,11 +20,13 @@
 #include <sstream>
 #include <string>
 
-#include <CoreGraphics/CoreGraphics.h>
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
 
+struct Gradient;
 class LogArg;
 
 std::string FormatArgs();
@@ -56,22 +58,32 @@ template<>
 std::string FormatValue(std::nullptr_t value);
 
 template<>
-std::string FormatValue(CGAffineTransform value);
+std::string FormatValue(AffineTransform value);
 
 template<>
-std::string FormatValue(CGAffineTransform *value);
+std::string FormatValue(AffineTransform *value);
 
 template<>
-std::string FormatValue(CGPoint value);
+std::string FormatValue(const AffineTransform *value);
 
 template<>
-std::string FormatValue(CGRect value);
+std::string FormatValue(FloatPoint value);
 
 template<>
-std::string FormatValue(CGLineCap value);
+std::string FormatValue(FloatRect value);
 
 template<>
-std::string FormatValue(CGLineJoin value);
+std::string FormatValue(LineCap value);
+
+template<>
+std::string FormatValue(LineJoin value);
+
+template<>
+std::string FormatValue(FillRule value);
+
+// Gradients are identified by their id.
+template<>
+std::string FormatValue(Gradient value);
 
 class LogArg {
  public:
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/PathCache.h"
+
+#include <functional>
+
+#include "MetroSVG/Internal/PathData.h"
+#include "MetroSVG/Internal/SceneGraph.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Enough for the paths of a few hundred typical icons.
+const size_t kSharedPathCacheByteLimit = 4 * 1024 * 1024;
+
+// Estimated fixed cost of a path: the CGPath object and the cache entry.
+const size_t kPathByteOverhead = 128;
+// Estimated cost of a segment on top of its points.
+const size_t kPathSegmentByteOverhead = 8;
+
+// Builds the path of an element with the same segments that
+// Renderer::ProcessPathData adds to a canvas.
+CGPathRef BuildElementPath(const SceneGraph &graph,
+                           const SceneGraph::Element &element) {
+  CGMutablePathRef path = CGPathCreateMutable();
+  const Float *coords = graph.path_coords.data() + element.coord_begin;
+  for (size_t i = element.verb_begin; i < element.verb_end; ++i) {
+    PathVerb verb = static_cast<PathVerb>(graph.path_verbs[i]);
+    switch (verb) {
+      case kPathVerbMoveTo:
+        CGPathMoveToPoint(path, NULL, coords[0], coords[1]);
+        break;
+      case kPathVerbLineTo:
+        CGPathAddLineToPoint(path, NULL, coords[0], coords[1]);
+        break;
+      case kPathVerbCurveTo:
+        CGPathAddCurveToPoint(path, NULL, coords[0], coords[1], coords[2],
+                              coords[3], coords[4], coords[5]);
+        break;
+      case kPathVerbQuadCurveTo:
+        CGPathAddQuadCurveToPoint(path, NULL, coords[0], coords[1],
+                                  coords[2], coords[3]);
+        break;
+      case kPathVerbArcTo: {
+        CGPoint current_point = CGPathGetCurrentPoint(path);
+        CircularArc arc;
+        if (!GetCircularArc(FloatPoint(current_point.x, current_point.y),
+                            coords, &arc)) {
+          return path;
+        }
+        CGAffineTransform transform =
+            CGAffineTransformMake(arc.transform.a, arc.transform.b,
+                                  arc.transform.c, arc.transform.d,
+                                  arc.transform.tx, arc.transform.ty);
+        CGPathAddArc(path, &transform, arc.center.x, arc.center.y,
+                     arc.radius, arc.start_angle, arc.end_angle,
+                     arc.clockwise);
+        break;
+      }
+      case kPathVerbClose:
+        CGPathCloseSubpath(path);
+        break;
+    }
+    coords += PathVerbCoordinateCount(verb);
+  }
+  return path;
+}
+
+}  // namespace
+
+size_t PathCache::KeyHash::operator()(const Key &key) const {
+  size_t hash = std::hash<const SceneGraph *>()(key.graph);
+  hash ^= key.element_index + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+PathCache::PathCache(size_t byte_limit)
+    : byte_limit_(byte_limit),
+      byte_size_(0),
+      hit_count_(0),
+      miss_count_(0) {}
+
+PathCache::~PathCache() {
+  ReleasePaths();
+}
+
+PathCache *PathCache::Shared() {
+  // Never deleted, so that documents can be deleted during static
+  // destruction.
+  static PathCache *cache = new PathCache(kSharedPathCacheByteLimit);
+  return cache;
+}
+
+CGPathRef PathCache::CreatePath(const SceneGraph &graph,
+                                size_t element_index) {
+  Key key = {&graph, element_index};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = paths_.find(key);
+    if (iter != paths_.end()) {
+      ++hit_count_;
+      return CGPathRetain(iter->second.path);
+    }
+    ++miss_count_;
+  }
+
+  // Build the path without holding the lock. If another thread adds the
+  // same element in the meantime, its entry is kept.
+  CGPathRef path = BuildElementPath(graph, graph.elements[element_index]);
+  size_t byte_size = EstimatePathByteSize(graph, element_index);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (byte_size > byte_limit_ || paths_.count(key) != 0) {
+    return path;
+  }
+  if (byte_size_ + byte_size > byte_limit_) {
+    ReleasePaths();
+  }
+  Entry entry = {CGPathRetain(path), byte_size};
+  paths_.emplace(key, entry);
+  byte_size_ += byte_size;
+  return path;
+}
+
+void PathCache::RemoveSceneGraph(const SceneGraph *graph) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto iter = paths_.begin(); iter != paths_.end();) {
+    if (iter->first.graph == graph) {
+      CGPathRelease(iter->second.path);
+      byte_size_ -= iter->second.byte_size;
+      iter = paths_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void PathCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReleasePaths();
+}
+
+void PathCache::set_byte_limit(size_t byte_limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  byte_limit_ = byte_limit;
+  if (byte_size_ > byte_limit_) {
+    ReleasePaths();
+  }
+}
+
+size_t PathCache::byte_limit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return byte_limit_;
+}
+
+size_t PathCache::byte_size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return byte_size_;
+}
+
+size_t PathCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return paths_.size();
+}
+
+size_t PathCache::hit_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return hit_count_;
+}
+
+size_t PathCache::miss_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return miss_count_;
+}
+
+size_t PathCache::EstimatePathByteSize(const SceneGraph &graph,
+                                       size_t element_index) {
+  const SceneGraph::Element &element = graph.elements[element_index];
+  size_t byte_size = kPathByteOverhead;
+  for (size_t i = element.verb_begin; i < element.verb_end; ++i) {
+    PathVerb verb = static_cast<PathVerb>(graph.path_verbs[i]);
+    if (verb == kPathVerbArcTo) {
+      byte_size += 4 * (kPathSegmentByteOverhead + 3 * sizeof(CGPoint));
+    } else {
+      byte_size += kPathSegmentByteOverhead +
+                   PathVerbCoordinateCount(verb) / 2 * sizeof(CGPoint);
+    }
+  }
+  return byte_size;
+}
+
+void PathCache::ReleasePaths() {
+  for (const auto &entry : paths_) {
+    CGPathRelease(entry.second.path);
+  }
+  paths_.clear();
+  byte_size_ = 0;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+#include <CoreGraphics/CoreGraphics.h>
+
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+struct SceneGraph;
+
+// Keeps the CGPath objects built from the path segments of the path,
+// polygon and polyline elements of scene graphs, so that rendering a
+// prepared document again, at any size or with any style sheet, adds each
+// path to the context without building it. Entries are keyed by the graph
+// and the index of the element in it, so a graph must be removed from the
+// cache before it is deleted. Safe to use from multiple threads.
+class PathCache {
+ public:
+  // The paths in the cache take at most |byte_limit| bytes, as estimated
+  // by EstimatePathByteSize. When adding a path would take more, all the
+  // entries are dropped first.
+  explicit PathCache(size_t byte_limit);
+  ~PathCache();
+
+  // Returns the cache used by Renderer for prepared documents.
+  static PathCache *Shared();
+
+  // Returns the path of the element at |element_index| in |graph|,
+  // building it if it isn't in the cache. The element must be a path,
+  // polygon or polyline element. Caller should release the returned
+  // instance.
+  CGPathRef CreatePath(const SceneGraph &graph, size_t element_index);
+
+  // Removes the entries of |graph|.
+  void RemoveSceneGraph(const SceneGraph *graph);
+  // Removes all the entries. The counters are kept.
+  void Clear();
+
+  // Lowering the limit below byte_size() drops all the entries.
+  void set_byte_limit(size_t byte_limit);
+  size_t byte_limit() const;
+  // Estimated memory taken by the paths in the cache.
+  size_t byte_size() const;
+  size_t size() const;
+  // Number of CreatePath calls that found or didn't find their path in
+  // the cache.
+  size_t hit_count() const;
+  size_t miss_count() const;
+
+  // CGPath doesn't report its size. This estimates the memory taken by the
+  // path of an element, counting each arc as the four curves it becomes at
+  // most.
+  static size_t EstimatePathByteSize(const SceneGraph &graph,
+                                     size_t element_index);
+
+ private:
+  struct Key {
+    const SceneGraph *graph;
+    size_t element_index;
+
+    bool operator==(const Key &other) const {
+      return graph == other.graph && element_index == other.element_index;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  struct Entry {
+    CGPathRef path;
+    size_t byte_size;
+  };
+
+  // Guards the fields below.
+  mutable std::mutex mutex_;
+  size_t byte_limit_;
+  size_t byte_size_;
+  std::unordered_map<Key, Entry, KeyHash> paths_;
+  size_t hit_count_;
+  size_t miss_count_;
+
+  // Releases the paths in the cache. |mutex_| must be held.
+  void ReleasePaths();
+
+  DISALLOW_COPY_AND_ASSIGN(PathCache);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
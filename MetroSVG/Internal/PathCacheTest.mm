@@ -0,0 +1,144 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/PathCache.h"
+#include "MetroSVG/Internal/SceneGraph.h"
+
+using namespace metrosvg::internal;
+
+static const char kPathsData[] =
+    "<svg width='20' height='20'>"
+    "<path d='M0,0 L10,20'/>"
+    "<rect width='5' height='5'/>"
+    "<polygon points='0,0 10,0 10,10'/>"
+    "<path d='M0,0 A5,5 0 0,1 10,0 C10,5 5,10 0,10 Z'/>"
+    "</svg>";
+
+static SceneGraph *ParsePaths() {
+  return ParseSceneGraph(kPathsData, sizeof(kPathsData) - 1, NULL);
+}
+
+// Returns the indices of the path, polygon and polyline elements.
+static std::vector<size_t> PathElementIndices(const SceneGraph &graph) {
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < graph.elements.size(); ++i) {
+    ElementType type = graph.elements[i].type;
+    if (type == kElementTypePath || type == kElementTypePolygon ||
+        type == kElementTypePolyline) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+@interface PathCacheTest : XCTestCase
+@end
+
+@implementation PathCacheTest
+
+- (void)testCreatePath_ReusesPaths {
+  std::unique_ptr<SceneGraph> graph(ParsePaths());
+  std::vector<size_t> indices = PathElementIndices(*graph);
+  XCTAssertEqual(indices.size(), 3U);
+  PathCache cache(1024 * 1024);
+
+  CGPathRef first = cache.CreatePath(*graph, indices[0]);
+  CGPathRef second = cache.CreatePath(*graph, indices[0]);
+  CGPathRef third = cache.CreatePath(*graph, indices[1]);
+  XCTAssert(first != NULL);
+  XCTAssertEqual(first, second);
+  XCTAssertNotEqual(first, third);
+  XCTAssertEqual(CGPathGetCurrentPoint(first).x, 10);
+  XCTAssertEqual(CGPathGetCurrentPoint(first).y, 20);
+  XCTAssertEqual(cache.hit_count(), 1U);
+  XCTAssertEqual(cache.miss_count(), 2U);
+  XCTAssertEqual(cache.size(), 2U);
+  XCTAssertEqual(cache.byte_size(),
+                 PathCache::EstimatePathByteSize(*graph, indices[0]) +
+                 PathCache::EstimatePathByteSize(*graph, indices[1]));
+  CGPathRelease(first);
+  CGPathRelease(second);
+  CGPathRelease(third);
+
+  cache.Clear();
+  XCTAssertEqual(cache.size(), 0U);
+  XCTAssertEqual(cache.byte_size(), 0U);
+  CGPathRelease(cache.CreatePath(*graph, indices[0]));
+  XCTAssertEqual(cache.miss_count(), 3U);
+}
+
+- (void)testEstimatePathByteSize {
+  std::unique_ptr<SceneGraph> graph(ParsePaths());
+  std::vector<size_t> indices = PathElementIndices(*graph);
+  size_t line_size = PathCache::EstimatePathByteSize(*graph, indices[0]);
+  size_t polygon_size = PathCache::EstimatePathByteSize(*graph, indices[1]);
+  size_t arc_size = PathCache::EstimatePathByteSize(*graph, indices[2]);
+  XCTAssertGreaterThan(line_size, 2 * sizeof(CGPoint));
+  XCTAssertGreaterThan(polygon_size, line_size);
+  XCTAssertGreaterThan(arc_size, polygon_size);
+}
+
+- (void)testCreatePath_ByteLimit {
+  std::unique_ptr<SceneGraph> graph(ParsePaths());
+  std::vector<size_t> indices = PathElementIndices(*graph);
+  size_t arc_size = PathCache::EstimatePathByteSize(*graph, indices[2]);
+  PathCache cache(arc_size);
+  XCTAssertEqual(cache.byte_limit(), arc_size);
+
+  CGPathRelease(cache.CreatePath(*graph, indices[0]));
+  CGPathRelease(cache.CreatePath(*graph, indices[1]));
+  XCTAssertEqual(cache.size(), 2U);
+  // Adding the arc drops the others.
+  CGPathRelease(cache.CreatePath(*graph, indices[2]));
+  XCTAssertEqual(cache.size(), 1U);
+  XCTAssertEqual(cache.byte_size(), arc_size);
+
+  cache.set_byte_limit(arc_size - 1);
+  XCTAssertEqual(cache.size(), 0U);
+  CGPathRelease(cache.CreatePath(*graph, indices[2]));
+  XCTAssertEqual(cache.size(), 0U);
+
+  cache.set_byte_limit(0);
+  CGPathRelease(cache.CreatePath(*graph, indices[0]));
+  XCTAssertEqual(cache.size(), 0U);
+  XCTAssertEqual(cache.byte_size(), 0U);
+}
+
+- (void)testRemoveSceneGraph {
+  std::unique_ptr<SceneGraph> graph(ParsePaths());
+  std::unique_ptr<SceneGraph> other_graph(ParsePaths());
+  std::vector<size_t> indices = PathElementIndices(*graph);
+  PathCache cache(1024 * 1024);
+  for (size_t index : indices) {
+    CGPathRelease(cache.CreatePath(*graph, index));
+  }
+  CGPathRelease(cache.CreatePath(*other_graph, indices[0]));
+  XCTAssertEqual(cache.size(), 4U);
+
+  cache.RemoveSceneGraph(graph.get());
+  XCTAssertEqual(cache.size(), 1U);
+  XCTAssertEqual(cache.byte_size(),
+                 PathCache::EstimatePathByteSize(*other_graph, indices[0]));
+  CGPathRelease(cache.CreatePath(*other_graph, indices[0]));
+  XCTAssertEqual(cache.hit_count(), 1U);
+}
+
+@end
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/PathData.h"
+
+#include <cmath>
+
+#include "MetroSVG/Internal/BasicValueParsers.h"
+#include "MetroSVG/Internal/Constants.h"
+#include "MetroSVG/Internal/Macros.h"
+#include "MetroSVG/Internal/StringPiece.h"
+#include "MetroSVG/Internal/Utils.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Decodes path data straight into the verb and coordinate arrays. Only
+// the state that later commands depend on is kept between commands.
+class PathDataDecoder {
+ public:
+  PathDataDecoder(const StringPiece &data,
+                  std::vector<uint8_t> *verbs,
+                  std::vector<Float> *coords)
+      : s_(data),
+        verbs_(verbs),
+        coords_(coords),
+        point_(),
+        subpath_start_point_(),
+        control_point_(),
+        previous_command_(0) {}
+
+  bool DecodePath();
+  bool DecodePoints(bool implicit_close);
+
+ private:
+  // Consumes the arguments of one segment of |command|, which is the
+  // lowercase command character.
+  bool DecodeSegment(char command, bool absolute);
+  bool DecodeArcSegment(Float origin_x, Float origin_y);
+
+  // The following add a segment that ends at the current point.
+  void AddPointSegment(PathVerb verb) {
+    verbs_->push_back(verb);
+    coords_->insert(coords_->end(), {point_.x, point_.y});
+  }
+
+  void AddCurveSegment(FloatPoint control_point1) {
+    verbs_->push_back(kPathVerbCurveTo);
+    coords_->insert(coords_->end(), {
+      control_point1.x, control_point1.y,
+      control_point_.x, control_point_.y,
+      point_.x, point_.y,
+    });
+  }
+
+  void AddQuadCurveSegment() {
+    verbs_->push_back(kPathVerbQuadCurveTo);
+    coords_->insert(coords_->end(), {
+      control_point_.x, control_point_.y,
+      point_.x, point_.y,
+    });
+  }
+
+  // Returns the reflection of the last control point about the current
+  // point if the previous command was one of |command1| and |command2|,
+  // or the current point otherwise.
+  FloatPoint ReflectedControlPoint(char command1, char command2) const {
+    if (previous_command_ != command1 && previous_command_ != command2) {
+      return point_;
+    }
+    return FloatPoint(point_.x + (point_.x - control_point_.x),
+                      point_.y + (point_.y - control_point_.y));
+  }
+
+  StringPiece s_;
+  std::vector<uint8_t> *verbs_;
+  std::vector<Float> *coords_;
+  FloatPoint point_;
+  FloatPoint subpath_start_point_;
+  // The last control point of the previous curve, for shorthand curves.
+  FloatPoint control_point_;
+  char previous_command_;
+
+  DISALLOW_COPY_AND_ASSIGN(PathDataDecoder);
+};
+
+bool PathDataDecoder::DecodePath() {
+  char command = 0;
+  bool absolute = false;
+  while (true) {
+    ConsumeWhitespace(&s_);
+    if (s_.length() == 0) {
+      return true;
+    }
+    char c = s_[0];
+    if (('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')) {
+      s_.Advance(1);
+      absolute = c <= 'Z';
+      command = absolute ? c - ('A' - 'a') : c;
+    } else {
+      // All commands but ClosePath can repeat their arguments. Repeated
+      // MoveTo arguments are LineTo segments (see SVG 1.1 Section 8.3.2).
+      if (command == 0 || command == 'z') {
+        return false;
+      }
+      if (command == 'm') {
+        command = 'l';
+      }
+      ConsumeNumberDelimiter(&s_);
+    }
+    if (!DecodeSegment(command, absolute)) {
+      return false;
+    }
+    previous_command_ = command;
+  }
+}
+
+bool PathDataDecoder::DecodeSegment(char command, bool absolute) {
+  Float origin_x = absolute ? 0 : point_.x;
+  Float origin_y = absolute ? 0 : point_.y;
+  Float values[6];
+  switch (command) {
+    case 'm':
+      if (!ConsumeFloats(&s_, 2, values)) {
+        return false;
+      }
+      point_ = FloatPoint(origin_x + values[0], origin_y + values[1]);
+      subpath_start_point_ = point_;
+      AddPointSegment(kPathVerbMoveTo);
+      return true;
+    case 'l':
+      if (!ConsumeFloats(&s_, 2, values)) {
+        return false;
+      }
+      point_ = FloatPoint(origin_x + values[0], origin_y + values[1]);
+      AddPointSegment(kPathVerbLineTo);
+      return true;
+    case 'h':
+      if (!ConsumeFloat(&s_, values)) {
+        return false;
+      }
+      point_.x = origin_x + values[0];
+      AddPointSegment(kPathVerbLineTo);
+      return true;
+    case 'v':
+      if (!ConsumeFloat(&s_, values)) {
+        return false;
+      }
+      point_.y = origin_y + values[0];
+      AddPointSegment(kPathVerbLineTo);
+      return true;
+    case 'c': {
+      if (!ConsumeFloats(&s_, 6, values)) {
+        return false;
+      }
+      FloatPoint control_point1(origin_x + values[0],
+                                origin_y + values[1]);
+      control_point_ = FloatPoint(origin_x + values[2], origin_y + values[3]);
+      point_ = FloatPoint(origin_x + values[4], origin_y + values[5]);
+      AddCurveSegment(control_point1);
+      return true;
+    }
+    case 's': {
+      if (!ConsumeFloats(&s_, 4, values)) {
+        return false;
+      }
+      FloatPoint control_point1 = ReflectedControlPoint('c', 's');
+      control_point_ = FloatPoint(origin_x + values[0], origin_y + values[1]);
+      point_ = FloatPoint(origin_x + values[2], origin_y + values[3]);
+      AddCurveSegment(control_point1);
+      return true;
+    }
+    case 'q':
+      if (!ConsumeFloats(&s_, 4, values)) {
+        return false;
+      }
+      control_point_ = FloatPoint(origin_x + values[0], origin_y + values[1]);
+      point_ = FloatPoint(origin_x + values[2], origin_y + values[3]);
+      AddQuadCurveSegment();
+      return true;
+    case 't':
+      if (!ConsumeFloats(&s_, 2, values)) {
+        return false;
+      }
+      control_point_ = ReflectedControlPoint('q', 't');
+      point_ = FloatPoint(origin_x + values[0], origin_y + values[1]);
+      AddQuadCurveSegment();
+      return true;
+    case 'a':
+      return DecodeArcSegment(origin_x, origin_y);
+    case 'z':
+      // The default start point of the next subpath is the same as
+      // the current subpath. SVG (see SVG 1.1 Section 8.3.3) and
+      // Core Graphics share this behavior.
+      point_ = subpath_start_point_;
+      verbs_->push_back(kPathVerbClose);
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool PathDataDecoder::DecodeArcSegment(Float origin_x, Float origin_y) {
+  Float values[3];
+  if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
+    return false;
+  }
+  // Take absolute values per spec.
+  // http://www.w3.org/TR/SVG11/implnote.html#ArcImplementationNotes
+  Float radius_x = std::fabs(values[0]);
+  Float radius_y = std::fabs(values[1]);
+  if (radius_x == 0 || radius_y == 0) {
+    return false;
+  }
+  bool large_arc, sweep;
+  ConsumeNumberDelimiter(&s_);
+  if (!ConsumeFlag(&s_, &large_arc)) {
+    return false;
+  }
+  ConsumeNumberDelimiter(&s_);
+  if (!ConsumeFlag(&s_, &sweep)) {
+    return false;
+  }
+  ConsumeNumberDelimiter(&s_);
+  Float point_coords[2];
+  if (!ConsumeFloats(&s_, ARRAYSIZE(point_coords), point_coords)) {
+    return false;
+  }
+  point_ = FloatPoint(origin_x + point_coords[0], origin_y + point_coords[1]);
+  verbs_->push_back(kPathVerbArcTo);
+  coords_->insert(coords_->end(), {
+    radius_x, radius_y, values[2],
+    Float(large_arc ? 1 : 0), Float(sweep ? 1 : 0),
+    point_.x, point_.y,
+  });
+  return true;
+}
+
+bool PathDataDecoder::DecodePoints(bool implicit_close) {
+  bool is_first_point = true;
+  while (true) {
+    ConsumeWhitespace(&s_);
+    if (s_.length() == 0) {
+      break;
+    }
+    if (!is_first_point) {
+      ConsumeNumberDelimiter(&s_);
+    }
+    Float coords[2];
+    if (!ConsumeFloats(&s_, ARRAYSIZE(coords), coords)) {
+      return false;
+    }
+    point_ = FloatPoint(coords[0], coords[1]);
+    AddPointSegment(is_first_point ? kPathVerbMoveTo : kPathVerbLineTo);
+    is_first_point = false;
+  }
+  if (implicit_close) {
+    verbs_->push_back(kPathVerbClose);
+  }
+  return true;
+}
+
+}  // namespace
+
+int PathVerbCoordinateCount(PathVerb verb) {
+  switch (verb) {
+    case kPathVerbMoveTo:
+    case kPathVerbLineTo:
+      return 2;
+    case kPathVerbQuadCurveTo:
+      return 4;
+    case kPathVerbCurveTo:
+      return 6;
+    case kPathVerbArcTo:
+      return 7;
+    case kPathVerbClose:
+      return 0;
+  }
+  return 0;
+}
+
+bool GetCircularArc(FloatPoint current_point,
+                    const Float *coords,
+                    CircularArc *arc) {
+  Float radius_x = coords[0];
+  Float radius_y = coords[1];
+  Float rotation = coords[2];
+  bool large_arc = coords[3] != 0;
+  bool sweep = coords[4] != 0;
+  // Maps the ellipse to the unit circle.
+  AffineTransform transform_rotation =
+      AffineTransform::MakeRotation(-rotation * kPi / 180.f);
+  AffineTransform transform_scale =
+      AffineTransform::MakeScale(1 / radius_x, 1 / radius_y);
+  AffineTransform transform =
+      ConcatTransforms(transform_rotation, transform_scale);
+  FloatPoint start_point = ApplyTransform(current_point, transform);
+  FloatPoint end_point =
+      ApplyTransform(FloatPoint(coords[5], coords[6]), transform);
+  arc->center = FloatPoint();
+  arc->radius = 1;
+  arc->start_angle = 0;
+  arc->end_angle = 0;
+  if (!SvgArcToCgArc(start_point, end_point, large_arc, sweep, &arc->radius,
+                     &arc->center, &arc->start_angle, &arc->end_angle)) {
+    return false;
+  }
+  arc->transform = InvertTransform(transform);
+  arc->clockwise = !sweep;
+  return true;
+}
+
+bool DecodePathData(const StringPiece &data,
+                    PathDataFormat format,
+                    bool implicit_close,
+                    std::vector<uint8_t> *verbs,
+                    std::vector<Float> *coords) {
+  PathDataDecoder decoder(data, verbs, coords);
+  if (format == kPathDataFormatPoints) {
+    return decoder.DecodePoints(implicit_close);
+  }
+  return decoder.DecodePath();
+}
+
+}  // namespace internal
+}  // namespace metrosvg
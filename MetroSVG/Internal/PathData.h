@@ -0,0 +1,85 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MetroSVG/Internal/Geometry.h"
+
+namespace metrosvg {
+namespace internal {
+
+class StringPiece;
+
+enum PathDataFormat {
+  kPathDataFormatPoints = 0,  // polyline or polygon
+  kPathDataFormatPath = 1,  // path
+};
+
+// Path segments are stored as a verb array and a coordinate array.
+// Each verb consumes a fixed number of coordinates, all of which are
+// absolute.
+enum PathVerb {
+  kPathVerbMoveTo,  // x, y
+  kPathVerbLineTo,  // x, y
+  kPathVerbQuadCurveTo,  // cx, cy, x, y
+  kPathVerbCurveTo,  // c1x, c1y, c2x, c2y, x, y
+  kPathVerbArcTo,  // rx, ry, rotation, large_arc, sweep, x, y
+  kPathVerbClose,
+};
+
+// Returns the number of coordinates that follow a given verb.
+int PathVerbCoordinateCount(PathVerb verb);
+
+// An elliptical arc segment in the form that CGPathAddArc takes: a circular
+// arc in the space given by |transform|.
+struct CircularArc {
+  AffineTransform transform;
+  FloatPoint center;
+  Float radius;
+  Float start_angle;
+  Float end_angle;
+  bool clockwise;
+};
+
+// Converts the coordinates of a kPathVerbArcTo segment that starts at
+// |current_point| to a circular arc. Returns false if the arc can't be
+// drawn, in which case the rest of the path should be dropped.
+bool GetCircularArc(FloatPoint current_point,
+                    const Float *coords,
+                    CircularArc *arc);
+
+// Decodes the d attribute of a path element, or the points attribute of a
+// polygon or polyline element, in a single pass and appends the segments
+// to |verbs| and |coords|. Relative coordinates, shorthand curves and
+// horizontal and vertical lines all become absolute segments of the
+// verbs above. implicit_close appends a ClosePath segment after the
+// points, as polygon elements need.
+//
+// Decoding stops at the first error, keeping the segments before it as
+// SVG 1.1 Section F.2 requires, and returns false. Returns true if the
+// whole of |data| was decoded. The segments are the same as those that
+// PathDataIterator produces.
+bool DecodePathData(const StringPiece &data,
+                    PathDataFormat format,
+                    bool implicit_close,
+                    std::vector<uint8_t> *verbs,
+                    std::vector<Float> *coords);
+
+}  // namespace internal
+}  // namespace metrosvg
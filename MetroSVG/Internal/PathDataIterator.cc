@@ -35,7 +35,7 @@ PathDataIterator::PathDataIterator(const char *data,
       absolute_(format == kPathDataFormatPoints),
       shown_close_path_(false),
       last_command_type_(kPathCommandTypeClosePath) {
-  point_ = CGPointMake(0.0, 0.0);
+  point_ = FloatPoint(0.0, 0.0);
 }
 
 bool PathDataIterator::Next() {
@@ -168,7 +168,7 @@ bool PathDataIterator::ParseMoveAndLineCommand(
     enum PathCommandType command_type) {
   bool change_x = false;
   bool change_y = false;
-  CGFloat values[2] = {point_.x , point_.y};
+  Float values[2] = {point_.x , point_.y};
   switch (command_type) {
     case kPathCommandTypeHorizontalLineTo:
       if (!ConsumeFloat(&s_, values)) {
@@ -201,86 +201,86 @@ bool PathDataIterator::ParseMoveAndLineCommand(
   }
   if (absolute_) {
     if (change_x) {
-      point_ = CGPointMake(values[0], point_.y);
+      point_ = FloatPoint(values[0], point_.y);
     }
     if (change_y) {
-      point_ = CGPointMake(point_.x, values[1]);
+      point_ = FloatPoint(point_.x, values[1]);
     }
   } else {
     if (change_x) {
-      point_ = CGPointMake(point_.x + values[0], point_.y);
+      point_ = FloatPoint(point_.x + values[0], point_.y);
     }
     if (change_y) {
-      point_ = CGPointMake(point_.x, point_.y + values[1]);
+      point_ = FloatPoint(point_.x, point_.y + values[1]);
     }
   }
   return true;
 }
 
 bool PathDataIterator::ParseCubicBezierCommand() {
-  CGFloat values[6];
+  Float values[6];
   if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
     return false;
   }
-  control_point1_ = CGPointMake(values[0] + (absolute_ ? 0 : point_.x),
-                                values[1] + (absolute_ ? 0 : point_.y));
-  control_point2_ = CGPointMake(values[2] + (absolute_ ? 0 : point_.x),
-                                values[3] + (absolute_ ? 0 : point_.y));
-  point_ = CGPointMake(values[4] + (absolute_ ? 0 : point_.x),
-                       values[5] + (absolute_ ? 0 : point_.y));
+  control_point1_ = FloatPoint(values[0] + (absolute_ ? 0 : point_.x),
+                               values[1] + (absolute_ ? 0 : point_.y));
+  control_point2_ = FloatPoint(values[2] + (absolute_ ? 0 : point_.x),
+                               values[3] + (absolute_ ? 0 : point_.y));
+  point_ = FloatPoint(values[4] + (absolute_ ? 0 : point_.x),
+                      values[5] + (absolute_ ? 0 : point_.y));
   return true;
 }
 
 bool PathDataIterator::ParseShorthandCubicBezierCommand() {
-  CGFloat values[4];
+  Float values[4];
   if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
     return false;
   }
   if (last_command_type_ == kPathCommandTypeCubicBezier ||
       last_command_type_ == kPathCommandTypeShorthandCubicBezier) {
-    control_point1_ = CGPointMake(point_.x + (point_.x - control_point2_.x),
-                                  point_.y + (point_.y - control_point2_.y));
+    control_point1_ = FloatPoint(point_.x + (point_.x - control_point2_.x),
+                                 point_.y + (point_.y - control_point2_.y));
   } else {
     control_point1_ = point_;
   }
-  control_point2_ = CGPointMake(values[0] + (absolute_ ? 0 : point_.x),
-                                values[1] + (absolute_ ? 0 : point_.y));
-  point_ = CGPointMake(values[2] + (absolute_ ? 0 : point_.x),
-                       values[3] + (absolute_ ? 0 : point_.y));
+  control_point2_ = FloatPoint(values[0] + (absolute_ ? 0 : point_.x),
+                               values[1] + (absolute_ ? 0 : point_.y));
+  point_ = FloatPoint(values[2] + (absolute_ ? 0 : point_.x),
+                      values[3] + (absolute_ ? 0 : point_.y));
   return true;
 }
 
 bool PathDataIterator::ParseQuadBezierCommand() {
-  CGFloat values[4];
+  Float values[4];
   if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
     return false;
   }
-  control_point1_ = CGPointMake(values[0] + (absolute_ ? 0 : point_.x),
-                                values[1] + (absolute_ ? 0 : point_.y));
-  point_ = CGPointMake(values[2] + (absolute_ ? 0 : point_.x),
-                       values[3] + (absolute_ ? 0 : point_.y));
+  control_point1_ = FloatPoint(values[0] + (absolute_ ? 0 : point_.x),
+                               values[1] + (absolute_ ? 0 : point_.y));
+  point_ = FloatPoint(values[2] + (absolute_ ? 0 : point_.x),
+                      values[3] + (absolute_ ? 0 : point_.y));
   return true;
 }
 
 bool PathDataIterator::ParseShorthandQuadBezierCommand() {
-  CGFloat values[2];
+  Float values[2];
   if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
     return false;
   }
   if (last_command_type_ == kPathCommandTypeQuadBezier ||
       last_command_type_ == kPathCommandTypeShorthandQuadBezier) {
-    control_point1_ = CGPointMake(point_.x + (point_.x - control_point1_.x),
-                                  point_.y + (point_.y - control_point1_.y));
+    control_point1_ = FloatPoint(point_.x + (point_.x - control_point1_.x),
+                                 point_.y + (point_.y - control_point1_.y));
   } else {
     control_point1_ = point_;
   }
-  point_ = CGPointMake(values[0] + (absolute_ ? 0 : point_.x),
-                       values[1] + (absolute_ ? 0 : point_.y));
+  point_ = FloatPoint(values[0] + (absolute_ ? 0 : point_.x),
+                      values[1] + (absolute_ ? 0 : point_.y));
   return true;
 }
 
 bool PathDataIterator::ParseEllipticalArcCommand() {
-  CGFloat values[3];
+  Float values[3];
   if (!ConsumeFloats(&s_, ARRAYSIZE(values), values)) {
     return false;
   }
@@ -304,12 +304,12 @@ bool PathDataIterator::ParseEllipticalArcCommand() {
   }
 
   ConsumeNumberDelimiter(&s_);
-  CGFloat point_coords[2];
+  Float point_coords[2];
   if (!ConsumeFloats(&s_, ARRAYSIZE(point_coords), point_coords)) {
     return false;
   }
-  point_ = CGPointMake(point_coords[0] + (absolute_ ? 0 : point_.x),
-                       point_coords[1] + (absolute_ ? 0 : point_.y));
+  point_ = FloatPoint(point_coords[0] + (absolute_ ? 0 : point_.x),
+                      point_coords[1] + (absolute_ ? 0 : point_.y));
   return true;
 }
 
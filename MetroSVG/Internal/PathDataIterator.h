@@ -16,8 +16,8 @@
 
 #pragma once
 
-#include <CoreGraphics/CoreGraphics.h>
-
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/PathData.h"
 #include "MetroSVG/Internal/StringPiece.h"
 
 namespace metrosvg {
@@ -44,11 +44,6 @@ enum PathCommandType {
   kPathCommandTypeClosePath = 9,
 };
 
-enum PathDataFormat {
-  kPathDataFormatPoints = 0,  // polyline or polygon
-  kPathDataFormatPath = 1,  // path
-};
-
 class PathDataIterator {
  public:
   // format defines whether is a path with full path commands, or a points
@@ -61,31 +56,31 @@ class PathDataIterator {
   bool Next();
 
   PathCommandType command_type() const { return command_type_; }
-  CGPoint point() const { return point_; }
-  CGPoint control_point1() const { return control_point1_; }
-  CGPoint control_point2() const { return control_point2_; }
+  FloatPoint point() const { return point_; }
+  FloatPoint control_point1() const { return control_point1_; }
+  FloatPoint control_point2() const { return control_point2_; }
   // Those four functions are for drawing arcs.
-  CGFloat arc_radius_x() const { return arc_radius_x_; }
-  CGFloat arc_radius_y() const { return arc_radius_y_; }
+  Float arc_radius_x() const { return arc_radius_x_; }
+  Float arc_radius_y() const { return arc_radius_y_; }
   bool large_arc() const { return large_arc_; }
   bool sweep() const { return sweep_; }
-  CGFloat rotation() const { return rotation_; }
+  Float rotation() const { return rotation_; }
 
  private:
   StringPiece s_;
   bool implicit_close_, large_arc_, sweep_;
   PathDataFormat format_;
   PathCommandType command_type_;
-  CGPoint point_, control_point1_, control_point2_;
-  CGFloat arc_radius_x_;
-  CGFloat arc_radius_y_;
-  CGFloat rotation_;
+  FloatPoint point_, control_point1_, control_point2_;
+  Float arc_radius_x_;
+  Float arc_radius_y_;
+  Float rotation_;
 
   // For interpreting paths.
   bool is_first_command_;
   bool absolute_;  // Always true for polygon/polyline.
   bool shown_close_path_;  // Always true for polygon/polyline.
-  CGPoint subpath_start_point_;
+  FloatPoint subpath_start_point_;
   // This has a valid value only when is_first_command_ is true.
   PathCommandType last_command_type_;
 
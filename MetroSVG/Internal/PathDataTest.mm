@@ -0,0 +1,269 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/PathData.h"
+#include "MetroSVG/Internal/PathDataIterator.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+using namespace metrosvg::internal;
+
+struct DecodedPath {
+  std::vector<uint8_t> verbs;
+  std::vector<Float> coords;
+
+  bool operator==(const DecodedPath &other) const {
+    return verbs == other.verbs && coords == other.coords;
+  }
+};
+
+static bool Decode(const char *data,
+                   PathDataFormat format,
+                   bool implicit_close,
+                   DecodedPath *path) {
+  return DecodePathData(StringPiece(data), format, implicit_close,
+                        &path->verbs, &path->coords);
+}
+
+// Decodes |data| one command at a time with PathDataIterator.
+static DecodedPath Iterate(const char *data,
+                           PathDataFormat format,
+                           bool implicit_close) {
+  DecodedPath path;
+  PathDataIterator iter(data, format, implicit_close);
+  while (iter.Next()) {
+    switch (iter.command_type()) {
+      case kPathCommandTypeMoveTo:
+        path.verbs.push_back(kPathVerbMoveTo);
+        break;
+      case kPathCommandTypeLineTo:
+      case kPathCommandTypeHorizontalLineTo:
+      case kPathCommandTypeVerticalLineTo:
+        path.verbs.push_back(kPathVerbLineTo);
+        break;
+      case kPathCommandTypeCubicBezier:
+      case kPathCommandTypeShorthandCubicBezier:
+        path.verbs.push_back(kPathVerbCurveTo);
+        path.coords.insert(path.coords.end(), {
+          iter.control_point1().x, iter.control_point1().y,
+          iter.control_point2().x, iter.control_point2().y,
+        });
+        break;
+      case kPathCommandTypeQuadBezier:
+      case kPathCommandTypeShorthandQuadBezier:
+        path.verbs.push_back(kPathVerbQuadCurveTo);
+        path.coords.insert(path.coords.end(), {
+          iter.control_point1().x, iter.control_point1().y,
+        });
+        break;
+      case kPathCommandTypeEllipticalArc:
+        path.verbs.push_back(kPathVerbArcTo);
+        path.coords.insert(path.coords.end(), {
+          iter.arc_radius_x(), iter.arc_radius_y(), iter.rotation(),
+          Float(iter.large_arc() ? 1 : 0), Float(iter.sweep() ? 1 : 0),
+        });
+        break;
+      case kPathCommandTypeClosePath:
+        path.verbs.push_back(kPathVerbClose);
+        continue;
+    }
+    path.coords.insert(path.coords.end(), {iter.point().x, iter.point().y});
+  }
+  return path;
+}
+
+// Returns path data of random commands, separators and numbers, which is
+// sometimes malformed.
+static std::string RandomPathData(std::mt19937 *random) {
+  static const char kCommands[] = "MmLlHhVvCcSsQqTtAaZz";
+  static const char *kSeparators[] = {"", " ", ",", " , ", "\n\t", ",,"};
+  std::string data;
+  int command_count = 1 + (*random)() % 12;
+  for (int i = 0; i < command_count; ++i) {
+    char command = kCommands[(*random)() % (sizeof(kCommands) - 1)];
+    if (i == 0 || (*random)() % 4 != 0) {
+      data += command;
+    }
+    int arg_count = 1 + (*random)() % 7;
+    for (int j = 0; j < arg_count; ++j) {
+      data += kSeparators[(*random)() % 6];
+      if (command == 'A' || command == 'a') {
+        if (j == 3 || j == 4) {
+          data += (*random)() % 8 == 0 ? '2' : '0' + (*random)() % 2;
+          continue;
+        }
+      }
+      if ((*random)() % 2) {
+        data += '-';
+      }
+      data += std::to_string((*random)() % 1000);
+      if ((*random)() % 2) {
+        data += '.' + std::to_string((*random)() % 100);
+      }
+    }
+    if ((*random)() % 40 == 0) {
+      data += '#';
+    }
+  }
+  return data;
+}
+
+@interface PathDataTest : XCTestCase
+@end
+
+@implementation PathDataTest
+
+- (void)testDecodePathData_Absolute {
+  DecodedPath path;
+  XCTAssertTrue(Decode("M1,2 L3,4 C5,6 7,8 9,10 Q11,12 13,14 Z",
+                       kPathDataFormatPath, false, &path));
+  std::vector<uint8_t> verbs = {
+    kPathVerbMoveTo, kPathVerbLineTo, kPathVerbCurveTo,
+    kPathVerbQuadCurveTo, kPathVerbClose,
+  };
+  std::vector<Float> coords = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+  };
+  XCTAssert(path.verbs == verbs);
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_Relative {
+  DecodedPath path;
+  XCTAssertTrue(Decode("m10,10 l5,5 h10 v-10 H0 V0 c1,1 2,2 3,3 z l1,1",
+                       kPathDataFormatPath, false, &path));
+  std::vector<Float> coords = {
+    10, 10,
+    15, 15,
+    25, 15,
+    25, 5,
+    0, 5,
+    0, 0,
+    1, 1, 2, 2, 3, 3,
+    // The close path goes back to (10, 10).
+    11, 11,
+  };
+  XCTAssertEqual(path.verbs.size(), 9U);
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_RepeatedArguments {
+  DecodedPath path;
+  XCTAssertTrue(Decode("M0,0 10,10 l5,0 5,0", kPathDataFormatPath, false,
+                       &path));
+  std::vector<uint8_t> verbs = {
+    kPathVerbMoveTo, kPathVerbLineTo, kPathVerbLineTo, kPathVerbLineTo,
+  };
+  std::vector<Float> coords = {0, 0, 10, 10, 15, 10, 20, 10};
+  XCTAssert(path.verbs == verbs);
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_ShorthandCurves {
+  DecodedPath path;
+  XCTAssertTrue(Decode("M0,0 C0,10 10,10 10,0 S20,-10 20,0 "
+                       "M0,0 S5,5 10,0 "
+                       "M0,0 Q5,10 10,0 T20,0 "
+                       "M0,0 T10,0",
+                       kPathDataFormatPath, false, &path));
+  std::vector<Float> coords = {
+    0, 0, 0, 10, 10, 10, 10, 0,
+    // The first control point reflects the previous second one.
+    10, -10, 20, -10, 20, 0,
+    // Without a previous curve, it is the current point.
+    0, 0, 0, 0, 5, 5, 10, 0,
+    0, 0, 5, 10, 10, 0,
+    15, -10, 20, 0,
+    0, 0, 0, 0, 10, 0,
+  };
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_Arc {
+  DecodedPath path;
+  XCTAssertTrue(Decode("M10,10 a-5,5 30 1,0 10,0", kPathDataFormatPath, false,
+                       &path));
+  std::vector<uint8_t> verbs = {kPathVerbMoveTo, kPathVerbArcTo};
+  std::vector<Float> coords = {10, 10, 5, 5, 30, 1, 0, 20, 10};
+  XCTAssert(path.verbs == verbs);
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_ErrorKeepsPrecedingSegments {
+  DecodedPath path;
+  XCTAssertFalse(Decode("M0,0 L10,10 L20", kPathDataFormatPath, false,
+                        &path));
+  std::vector<Float> coords = {0, 0, 10, 10};
+  XCTAssertEqual(path.verbs.size(), 2U);
+  XCTAssert(path.coords == coords);
+
+  for (const char *data : {"10,10", "M0,0 z 10,10", "M0,0 X",
+                           "M0,0 A0,5 0 0,0 1,1", "M0,0 A5,5 0 2,0 1,1"}) {
+    DecodedPath path;
+    XCTAssertFalse(Decode(data, kPathDataFormatPath, false, &path), @"%s",
+                   data);
+  }
+}
+
+- (void)testDecodePathData_Points {
+  DecodedPath path;
+  XCTAssertTrue(Decode(" 1,2 3 4, 5,6 ", kPathDataFormatPoints, true, &path));
+  std::vector<uint8_t> verbs = {
+    kPathVerbMoveTo, kPathVerbLineTo, kPathVerbLineTo, kPathVerbClose,
+  };
+  std::vector<Float> coords = {1, 2, 3, 4, 5, 6};
+  XCTAssert(path.verbs == verbs);
+  XCTAssert(path.coords == coords);
+
+  DecodedPath odd_path;
+  XCTAssertFalse(Decode("1,2 3", kPathDataFormatPoints, true, &odd_path));
+  XCTAssertEqual(odd_path.verbs.size(), 1U);
+}
+
+- (void)testDecodePathData_Appends {
+  DecodedPath path;
+  XCTAssertTrue(Decode("M1,1", kPathDataFormatPath, false, &path));
+  XCTAssertTrue(Decode("M2,2", kPathDataFormatPath, false, &path));
+  std::vector<Float> coords = {1, 1, 2, 2};
+  XCTAssertEqual(path.verbs.size(), 2U);
+  XCTAssert(path.coords == coords);
+}
+
+- (void)testDecodePathData_MatchesIterator {
+  std::mt19937 random(1);
+  for (int i = 0; i < 20000; ++i) {
+    std::string data = RandomPathData(&random);
+    DecodedPath path;
+    Decode(data.c_str(), kPathDataFormatPath, false, &path);
+    XCTAssert(path == Iterate(data.c_str(), kPathDataFormatPath, false),
+              @"%s", data.c_str());
+  }
+  for (const char *data : {"", " ", "1,2", "1,2 3,4", "1 2 3 4 5"}) {
+    for (bool implicit_close : {false, true}) {
+      DecodedPath path;
+      Decode(data, kPathDataFormatPoints, implicit_close, &path);
+      XCTAssert(path == Iterate(data, kPathDataFormatPoints, implicit_close),
+                @"%s", data);
+    }
+  }
+}
+
+@end
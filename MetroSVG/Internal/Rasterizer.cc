@@ -0,0 +1,367 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Edges are clipped to [-kMaxCoordinate, kMaxCoordinate] in both
+// directions before they are converted to floats, and so are the bounds
+// of the rasterized area. The parts of an edge outside that range have the
+// same effect as their projections onto it, or none at all.
+const double kMaxCoordinate = 1 << 20;
+
+// Returns the x coordinate at |y| of the line through (|xa|, |ya|) and
+// (|xb|, |yb|), which must have different y coordinates. It doesn't
+// overflow for any finite coordinates. Also used with x and y swapped.
+double InterpolateX(double xa, double ya, double xb, double yb, double y) {
+  double t = (y * 0.5 - ya * 0.5) / (yb * 0.5 - ya * 0.5);
+  return xa * (1 - t) + xb * t;
+}
+
+// Returns the column of the pixel that contains |x|, clamped to |bounds|.
+// Clamping comes first because converting a float that is out of the range
+// of int, or NaN, is undefined.
+int PixelColumn(float x, const PixelRect &bounds) {
+  float column = std::floor(x);
+  column = std::fmax(column, static_cast<float>(bounds.x0));
+  column = std::fmin(column, static_cast<float>(bounds.x1 - 1));
+  return static_cast<int>(column);
+}
+
+// Converts the accumulated area of a pixel, weighted by the winding of
+// its edges, to a coverage value according to |fill_rule|.
+uint8_t CoverageValue(float winding_area, FillRule fill_rule) {
+  float coverage = std::fabs(winding_area);
+  if (fill_rule == kFillRuleEvenOdd) {
+    coverage -= 2 * std::floor(coverage * 0.5f);
+    if (coverage > 1) {
+      coverage = 2 - coverage;
+    }
+  } else {
+    coverage = std::min(coverage, 1.f);
+  }
+  return static_cast<uint8_t>(coverage * 255 + 0.5f);
+}
+
+}  // namespace
+
+PixelRect PixelRect::Intersection(const PixelRect &other) const {
+  PixelRect result(std::max(x0, other.x0), std::max(y0, other.y0),
+                   std::min(x1, other.x1), std::min(y1, other.y1));
+  if (result.IsEmpty()) {
+    return PixelRect();
+  }
+  return result;
+}
+
+PixelRect PixelRect::Union(const PixelRect &other) const {
+  if (IsEmpty()) {
+    return other.IsEmpty() ? PixelRect() : other;
+  }
+  if (other.IsEmpty()) {
+    return *this;
+  }
+  return PixelRect(std::min(x0, other.x0), std::min(y0, other.y0),
+                   std::max(x1, other.x1), std::max(y1, other.y1));
+}
+
+Rasterizer::Rasterizer() {}
+
+void Rasterizer::Reset() {
+  edges_.clear();
+}
+
+void Rasterizer::AddEdge(FloatPoint from, FloatPoint to) {
+  if (!std::isfinite(from.x) || !std::isfinite(from.y) ||
+      !std::isfinite(to.x) || !std::isfinite(to.y)) {
+    return;
+  }
+  // Horizontal edges don't cover any area.
+  if (from.y == to.y) {
+    return;
+  }
+  int winding = 1;
+  if (from.y > to.y) {
+    winding = -1;
+    std::swap(from, to);
+  }
+  double x0 = from.x;
+  double y0 = from.y;
+  double x1 = to.x;
+  double y1 = to.y;
+  // Rows outside the range are never rasterized.
+  if (y1 <= -kMaxCoordinate || y0 >= kMaxCoordinate) {
+    return;
+  }
+  if (y0 < -kMaxCoordinate) {
+    x0 = InterpolateX(x0, y0, x1, y1, -kMaxCoordinate);
+    y0 = -kMaxCoordinate;
+  }
+  if (y1 > kMaxCoordinate) {
+    x1 = InterpolateX(x0, y0, x1, y1, kMaxCoordinate);
+    y1 = kMaxCoordinate;
+  }
+  // The edge is split where it crosses the sides of the range, so that
+  // the parts outside can be moved onto the sides as vertical edges. Like
+  // the original parts, they cover either all pixels in the range to their
+  // right or none.
+  // The sides are visited in the order the edge crosses them, which the
+  // interpolated y coordinates may not tell apart.
+  double first_side = x0 < x1 ? -kMaxCoordinate : kMaxCoordinate;
+  double original_x0 = x0;
+  double original_y0 = y0;
+  for (double side : {first_side, -first_side}) {
+    if ((x0 < side && x1 > side) || (x0 > side && x1 < side)) {
+      double y = InterpolateX(original_y0, original_x0, y1, x1, side);
+      AddClippedEdge(x0, y0, side, y, winding);
+      x0 = side;
+      y0 = y;
+    }
+  }
+  AddClippedEdge(x0, y0, x1, y1, winding);
+}
+
+void Rasterizer::AddClippedEdge(double x0, double y0, double x1, double y1,
+                                int winding) {
+  x0 = std::fmin(std::fmax(x0, -kMaxCoordinate), kMaxCoordinate);
+  x1 = std::fmin(std::fmax(x1, -kMaxCoordinate), kMaxCoordinate);
+  Edge edge;
+  edge.x0 = static_cast<float>(x0);
+  edge.y0 = static_cast<float>(y0);
+  edge.x1 = static_cast<float>(x1);
+  edge.y1 = static_cast<float>(y1);
+  edge.dxdy = static_cast<float>((x1 - x0) / (y1 - y0));
+  edge.winding = winding;
+  // Nearly horizontal edges don't cover any area either.
+  if (!(edge.y0 < edge.y1) || !std::isfinite(edge.dxdy)) {
+    return;
+  }
+  edges_.push_back(edge);
+}
+
+void Rasterizer::AddPolygon(const FloatPoint *points, size_t count) {
+  if (count < 2) {
+    return;
+  }
+  for (size_t i = 0; i + 1 < count; ++i) {
+    AddEdge(points[i], points[i + 1]);
+  }
+  AddEdge(points[count - 1], points[0]);
+}
+
+void Rasterizer::Rasterize(FillRule fill_rule,
+                           const PixelRect &requested_bounds,
+                           const RowCallback &emit_row) {
+  const PixelRect bounds = requested_bounds.Intersection(
+      PixelRect(0, 0, static_cast<int>(kMaxCoordinate),
+                static_cast<int>(kMaxCoordinate)));
+  if (edges_.empty() || bounds.IsEmpty()) {
+    return;
+  }
+  std::sort(edges_.begin(), edges_.end(),
+            [](const Edge &a, const Edge &b) { return a.y0 < b.y0; });
+  float max_y = edges_.front().y1;
+  for (const Edge &edge : edges_) {
+    max_y = std::max(max_y, edge.y1);
+  }
+  int y_begin = bounds.y0;
+  if (edges_.front().y0 > y_begin) {
+    y_begin = static_cast<int>(std::min(std::floor(edges_.front().y0),
+                                        static_cast<float>(bounds.y1)));
+  }
+  int y_end = bounds.y1;
+  if (max_y < y_end) {
+    y_end = static_cast<int>(std::max(std::ceil(max_y),
+                                      static_cast<float>(bounds.y0)));
+  }
+
+  // The cells are all zero between rows.
+  size_t buffer_size = static_cast<size_t>(bounds.x1) + 1;
+  if (cells_.size() < buffer_size) {
+    cells_.assign(buffer_size, Cell());
+  }
+  coverage_.resize(bounds.x1 - bounds.x0);
+
+  active_edges_.clear();
+  size_t next_edge = 0;
+  for (int y = y_begin; y < y_end; ++y) {
+    if (active_edges_.empty()) {
+      if (next_edge == edges_.size() || edges_[next_edge].y0 >= y_end) {
+        break;
+      }
+      // Skip the rows above the next edge.
+      if (edges_[next_edge].y0 >= y + 1) {
+        y = static_cast<int>(std::floor(edges_[next_edge].y0));
+      }
+    }
+    float row_top = y;
+    float row_bottom = y + 1;
+    while (next_edge < edges_.size() &&
+           edges_[next_edge].y0 < row_bottom) {
+      active_edges_.push_back(&edges_[next_edge]);
+      ++next_edge;
+    }
+
+    size_t active_count = 0;
+    for (size_t i = 0; i < active_edges_.size(); ++i) {
+      const Edge *edge = active_edges_[i];
+      if (edge->y1 <= row_top) {
+        continue;
+      }
+      active_edges_[active_count++] = edge;
+      // The part of the edge inside this row.
+      float ya = edge->y0;
+      float xa = edge->x0;
+      if (ya < row_top) {
+        ya = row_top;
+        xa = edge->x0 + (row_top - edge->y0) * edge->dxdy;
+      }
+      float yb = edge->y1;
+      float xb = edge->x1;
+      if (yb > row_bottom) {
+        yb = row_bottom;
+        xb = edge->x0 + (row_bottom - edge->y0) * edge->dxdy;
+      }
+      AddRowSegment(xa, ya - row_top, xb, yb - row_top, edge->winding,
+                    bounds);
+    }
+    active_edges_.resize(active_count);
+
+    if (!touched_cells_.empty()) {
+      EmitRow(y, fill_rule, bounds, emit_row);
+    }
+  }
+}
+
+void Rasterizer::AddRowSegment(float xa, float ya, float xb, float yb,
+                               float winding, const PixelRect &bounds) {
+  const float left = bounds.x0;
+  const float right = bounds.x1;
+  // The part left of the bounds covers the pixels from the left edge of
+  // the bounds, so it's moved onto that edge. The part right of the bounds
+  // doesn't cover any pixel inside the bounds.
+  if ((xa < left && xb > left) || (xa > left && xb < left)) {
+    float y = ya + (left - xa) * (yb - ya) / (xb - xa);
+    AddRowSegment(xa, ya, left, y, winding, bounds);
+    AddRowSegment(left, y, xb, yb, winding, bounds);
+    return;
+  }
+  if ((xa < right && xb > right) || (xa > right && xb < right)) {
+    float y = ya + (right - xa) * (yb - ya) / (xb - xa);
+    AddRowSegment(xa, ya, right, y, winding, bounds);
+    AddRowSegment(right, y, xb, yb, winding, bounds);
+    return;
+  }
+  if (std::min(xa, xb) >= right) {
+    return;
+  }
+  if (std::max(xa, xb) <= left) {
+    xa = xb = left;
+  }
+
+  // A segment ending on the right edge of the bounds reaches the cell
+  // beyond it, but doesn't cover any of it.
+  int x = PixelColumn(xa, bounds);
+  int x_last = PixelColumn(xb, bounds);
+  if (x == x_last) {
+    AddCellSegment(x, xa, ya, xb, yb, winding);
+    return;
+  }
+  // Splits the segment at the pixel boundaries it crosses.
+  float dydx = (yb - ya) / (xb - xa);
+  int step = x_last > x ? 1 : -1;
+  float x_from = xa;
+  float y_from = ya;
+  while (x != x_last) {
+    float x_to = static_cast<float>(step > 0 ? x + 1 : x);
+    float y_to = ya + (x_to - xa) * dydx;
+    AddCellSegment(x, x_from, y_from, x_to, y_to, winding);
+    x += step;
+    x_from = x_to;
+    y_from = y_to;
+  }
+  AddCellSegment(x, x_from, y_from, xb, yb, winding);
+}
+
+void Rasterizer::AddCellSegment(int x, float xa, float ya, float xb,
+                                float yb, float winding) {
+  float height = (yb - ya) * winding;
+  float mid_x = (xa + xb) * 0.5f - x;
+  Cell *cell = &cells_[x];
+  if (!cell->touched) {
+    cell->touched = true;
+    touched_cells_.push_back(x);
+  }
+  cell->area += height * (1 - mid_x);
+  cell->cover += height;
+}
+
+void Rasterizer::EmitRow(int y,
+                         FillRule fill_rule,
+                         const PixelRect &bounds,
+                         const RowCallback &emit_row) {
+  std::sort(touched_cells_.begin(), touched_cells_.end());
+  // The coverage is constant between touched cells. Runs are emitted
+  // separately where the coverage drops to zero between them.
+  int run_begin = touched_cells_[0];
+  int next_x = run_begin;
+  float cover = 0;
+  for (int x : touched_cells_) {
+    if (x > next_x) {
+      uint8_t value = CoverageValue(cover, fill_rule);
+      if (value == 0) {
+        EmitRun(y, run_begin, next_x, bounds, emit_row);
+        run_begin = x;
+      } else {
+        memset(&coverage_[next_x - bounds.x0], value, x - next_x);
+      }
+    }
+    Cell &cell = cells_[x];
+    coverage_[x - bounds.x0] = CoverageValue(cover + cell.area, fill_rule);
+    cover += cell.cover;
+    cell = Cell();
+    next_x = x + 1;
+  }
+  // The edges right of the bounds aren't added, so the coverage may
+  // extend to the right edge.
+  uint8_t value = CoverageValue(cover, fill_rule);
+  if (value != 0 && next_x < bounds.x1) {
+    memset(&coverage_[next_x - bounds.x0], value, bounds.x1 - next_x);
+    next_x = bounds.x1;
+  }
+  EmitRun(y, run_begin, next_x, bounds, emit_row);
+  touched_cells_.clear();
+}
+
+void Rasterizer::EmitRun(int y, int x0, int x1,
+                         const PixelRect &bounds,
+                         const RowCallback &emit_row) {
+  x1 = std::min(x1, bounds.x1);
+  if (x1 > x0) {
+    emit_row(y, x0, x1 - x0, &coverage_[x0 - bounds.x0]);
+  }
+}
+
+}  // namespace internal
+}  // namespace metrosvg
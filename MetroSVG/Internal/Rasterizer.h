@@ -0,0 +1,140 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+// A rectangle of pixels, [x0, x1) x [y0, y1).
+struct PixelRect {
+  int x0;
+  int y0;
+  int x1;
+  int y1;
+
+  PixelRect()
+      : x0(0), y0(0), x1(0), y1(0) {}
+  PixelRect(int x0_in, int y0_in, int x1_in, int y1_in)
+      : x0(x0_in), y0(y0_in), x1(x1_in), y1(y1_in) {}
+
+  bool IsEmpty() const { return x0 >= x1 || y0 >= y1; }
+  int width() const { return x1 - x0; }
+  int height() const { return y1 - y0; }
+  // Both return an empty rectangle at the origin if the result is empty.
+  PixelRect Intersection(const PixelRect &other) const;
+  PixelRect Union(const PixelRect &other) const;
+};
+
+// Rasterizer computes the anti-aliased coverage of a set of polygons in
+// device space. The coverage of a pixel is the exact area of the pixel
+// inside the polygons, except where edges cross each other inside the
+// pixel. There the fill rule is applied to the area accumulated from the
+// edges, which is a close approximation.
+class Rasterizer {
+ public:
+  // Called with the coverage of the pixels [x, x + count) of row |y| as
+  // values from 0 to 255. A row may be reported in several runs, in
+  // increasing order of x, and pixels outside the runs have no coverage.
+  typedef std::function<void(int y, int x, int count,
+                             const uint8_t *coverage)> RowCallback;
+
+  Rasterizer();
+
+  // Removes all edges.
+  void Reset();
+
+  // Edges with coordinates that aren't finite are ignored. Very large
+  // coordinates are clipped.
+  void AddEdge(FloatPoint from, FloatPoint to);
+  // Adds the edges of a polygon. The polygon is implicitly closed.
+  void AddPolygon(const FloatPoint *points, size_t count);
+
+  bool empty() const { return edges_.empty(); }
+
+  // Computes the coverage of the area enclosed by the edges according to
+  // |fill_rule|, within |bounds|. Rows are reported top to bottom.
+  // Only the part of |bounds| within 2^20 pixels of the origin, and not at
+  // negative coordinates, is rasterized.
+  void Rasterize(FillRule fill_rule,
+                 const PixelRect &bounds,
+                 const RowCallback &emit_row);
+
+ private:
+  // y0 < y1. |winding| is 1 if the edge goes down, -1 otherwise.
+  struct Edge {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    float dxdy;
+    int winding;
+  };
+
+  // Area accumulated for a pixel of the current row, weighted by the
+  // winding of the edges. |area| is the area covered in the pixel itself,
+  // and |cover| the area covered in each pixel to the right of it, i.e.,
+  // the height of the edges inside the pixel. |touched| is true if the
+  // cell is in |touched_cells_|.
+  struct Cell {
+    float area;
+    float cover;
+    bool touched;
+
+    Cell() : area(0), cover(0), touched(false) {}
+  };
+
+  std::vector<Edge> edges_;
+  std::vector<const Edge *> active_edges_;
+  // Cells of the current row, indexed by x. Only the cells listed in
+  // |touched_cells_| may be nonzero.
+  std::vector<Cell> cells_;
+  std::vector<int> touched_cells_;
+  std::vector<uint8_t> coverage_;
+
+  // Adds an edge that is already clipped, from top to bottom.
+  void AddClippedEdge(double x0, double y0, double x1, double y1,
+                      int winding);
+  // Adds a segment of an edge inside a row. The y coordinates are
+  // relative to the top of the row.
+  void AddRowSegment(float xa, float ya, float xb, float yb,
+                     float winding, const PixelRect &bounds);
+  // Adds a segment of an edge inside the cell at |x|.
+  void AddCellSegment(int x, float xa, float ya, float xb, float yb,
+                      float winding);
+  // Reports the coverage of the touched cells and resets them.
+  void EmitRow(int y,
+               FillRule fill_rule,
+               const PixelRect &bounds,
+               const RowCallback &emit_row);
+  void EmitRun(int y, int x0, int x1,
+               const PixelRect &bounds,
+               const RowCallback &emit_row);
+
+  DISALLOW_COPY_AND_ASSIGN(Rasterizer);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
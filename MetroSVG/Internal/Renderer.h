@@ -18,44 +18,68 @@
 
 #include <map>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
-#include <libxml/xmlreader.h>
-
+#include "MetroSVG/Internal/Arena.h"
 #include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/SceneGraph.h"
+#include "MetroSVG/Internal/StringPiece.h"
 #include "MetroSVG/MetroSVG.h"
 
-struct CGContext;
-
 namespace metrosvg {
 namespace internal {
 
+class Canvas;
 struct Gradient;
-class PathDataIterator;
-class StringPiece;
 
 class Renderer {
  public:
   Renderer();
   ~Renderer();
-  CGImageRef CreateCGImageFromMSCDocument(MSCDocument *document,
-                                          CGSize canvas_size,
-                                          const MSCStyleSheet *style_sheet);
+
+  // Paints the document onto the canvas. The whole canvas is the viewport
+  // of the outermost svg element. Returns false if the document couldn't
+  // be parsed. A renderer holds the state of one render at a time, but
+  // renderers on different threads can render the same document and
+  // style sheet concurrently, since those are only read.
+  // The transient state of a render comes from an arena that is reset
+  // when the render ends, so a renderer that is used for several renders
+  // stops allocating memory for it.
+  bool RenderMSCDocument(const MSCDocument *document,
+                         const MSCStyleSheet *style_sheet,
+                         Canvas *canvas);
+  // Same as above, but the viewport is |viewport_size| at the origin of
+  // the current user space of the canvas. The canvas can be transformed
+  // beforehand to render part of the viewport, e.g., a tile.
+  bool RenderMSCDocument(const MSCDocument *document,
+                         const MSCStyleSheet *style_sheet,
+                         FloatSize viewport_size,
+                         Canvas *canvas);
+
+  // Makes the render cover only |source_rect| of the user space established
+  // by the outermost svg element, i.e., in the coordinates of its viewBox,
+  // scaled to fill the viewport. Nothing outside the rect is rasterized.
+  // The null rectangle, the default, renders the whole element as usual.
+  void set_source_rect(FloatRect source_rect) { source_rect_ = source_rect; }
+
+  // Number of elements that weren't painted in the last render because
+  // they lay entirely outside the clip.
+  size_t culled_element_count() const { return culled_element_count_; }
 
  private:
-  typedef void (Renderer::*BeginElementHandler)(const StringMap &attributes,
-                                                const StringMap &styles);
+  typedef void (Renderer::*BeginElementHandler)(
+      const SceneGraph::Element &element);
   typedef void (Renderer::*EndElementHandler)();
 
   // As part of the explicit GraphicsState below, we keep whether to
   // paint or not, and whether to paint with a gradient, for each
   // possible paint operation (fill and stroke).
+  // The iri points into a declaration, which outlives the render.
   struct PaintState {
     bool should_paint;
     RgbColor color;
-    std::string iri;
-    CGFloat opacity;
+    StringPiece iri;
+    Float opacity;
 
     explicit PaintState(bool paint_default, const RgbColor color_default)
         : should_paint(paint_default),
@@ -66,35 +90,45 @@ class Renderer {
     void set_should_paint(bool new_should_paint) {
       should_paint = new_should_paint;
       if (!new_should_paint) {
-        iri.clear();
+        iri = StringPiece();
       }
     }
 
     void set_color(RgbColor new_color) {
       should_paint = true;
       color = new_color;
-      iri.clear();
+      iri = StringPiece();
     }
 
-    void set_iri(const std::string &new_iri) {
+    void set_iri(const StringPiece &new_iri) {
       should_paint = true;
       iri = new_iri;
     }
 
-    void ApplyOpacity(CGFloat additional_opacity) {
+    void ApplyOpacity(Float additional_opacity) {
       opacity *= additional_opacity;
     }
   };
 
-  // Most paint state is maintained directly on the CoreGraphics
-  // GState stack.  However, we need to specifically know the value
-  // of some items that cannot be read back out of the CGState,
+  // Most paint state is maintained directly on the graphics state
+  // stack of the canvas.  However, we need to specifically know the value
+  // of some items that cannot be read back out of the canvas,
   // so we maintain a local version of a few graphics state items.
+  // It only refers to memory that outlives the render, so that saving it
+  // for each element doesn't allocate.
   struct GraphicsState {
     PaintState fill;
     FillRule fill_rule;
     PaintState stroke;
-    LineDash line_dash;
+    // Stroke attributes needed to bound the area that strokes paint.
+    Float line_width;
+    Float miter_limit;
+    LineCap line_cap;
+    LineJoin line_join;
+    // The dash array points into the dash values of the scene graph.
+    const Float *dash_values;
+    size_t dash_count;
+    Float dash_phase;
     // This tracks the value of the "display" attribute.
     bool display;
     // This tracks the value of the "visibility" attribute,
@@ -104,13 +138,20 @@ class Renderer {
 
     // States related to gradients.
     RgbColor stop_color;
-    CGFloat stop_opacity;
+    Float stop_opacity;
 
     // The default value of fill is black, but for stroke it's none.
     GraphicsState()
         : fill(true, RgbColor(0.0f, 0.0f, 0.0f)),
           fill_rule(kFillRuleNonZero),
           stroke(false, RgbColor(0.0f, 0.0f, 0.0f)),
+          line_width(1),
+          miter_limit(10),
+          line_cap(kLineCapButt),
+          line_join(kLineJoinMiter),
+          dash_values(NULL),
+          dash_count(0),
+          dash_phase(0),
           display(true),
           visibility(true),
           stop_color(0, 0, 0),
@@ -127,147 +168,152 @@ class Renderer {
     SVGElementDefinition element_definition;
     int element_line_number;
     int element_column_number;
-    GraphicsState graphics;
+    // The scene graph element, or NULL for the root.
+    const SceneGraph::Element *element;
+    // Whether the element changed the graphics state, after saving the
+    // inherited one on saved_graphics_.
+    bool saves_graphics;
     bool defines_transparency_layer;
-    std::string style_text_;
-    std::string style_type_;
-
-    State(SVGElementDefinition element,
-          int line_number,
-          int column_number,
-          GraphicsState this_graphics)
-        : element_definition(element),
-          element_line_number(line_number),
-          element_column_number(column_number),
-          graphics(this_graphics),
+
+    State(SVGElementDefinition element_def,
+          const SceneGraph::Element *this_element)
+        : element_definition(element_def),
+          element_line_number(this_element ? this_element->line_number : 0),
+          element_column_number(
+              this_element ? this_element->column_number : 0),
+          element(this_element),
+          saves_graphics(false),
           defines_transparency_layer(false) {}
   };
 
+  // Orders gradient ids without copying them.
+  struct StringPieceLess {
+    bool operator()(const StringPiece &a, const StringPiece &b) const;
+  };
+
+  typedef std::map<StringPiece, const Gradient *, StringPieceLess,
+                   ArenaAllocator<std::pair<const StringPiece,
+                                            const Gradient *>>> GradientMap;
+
   // Internal constants.
   static const SVGElementDefinition kSvgElementRoot;
   static const SVGElementDefinition kSvgElementUnknown;
 
   // Internal variables.
-  const std::unordered_set<std::string> supported_styles_;
-  CGContext *context_;
-  CGSize canvas_size_;
-  CGFloat x_scale_;
-  CGFloat y_scale_;
-  xmlTextReader *reader_;
+  Canvas *canvas_;
+  FloatSize viewport_size_;
+  FloatRect source_rect_;
+  size_t culled_element_count_;
+  Float x_scale_;
+  Float y_scale_;
+  const SceneGraph *graph_;
+  // Whether |graph_| belongs to a prepared document, so that the canvas
+  // can keep the paths of its elements across renders.
+  bool graph_is_prepared_;
   std::vector<State> state_stack_;
-  std::unique_ptr<Gradient> pending_gradient_;
-  std::map<std::string, Gradient *> gradients_;
+  // Holds the gradients and the gradient map of the current render.
+  Arena arena_;
+  Gradient *pending_gradient_;
+  // Gradients by id. The ids point into the gradients.
+  GradientMap gradients_;
+  // The graphics state of the innermost element. Elements share the state
+  // they inherit, and only save it when they change it, since most leave
+  // it alone.
   GraphicsState graphics_;
-  std::unique_ptr<MSCStyleSheet> style_sheet_;
+  std::vector<GraphicsState> saved_graphics_;
+  const MSCStyleSheet *style_sheet_;
+  // Declarations of the client style sheet, parsed on first use for each
+  // class name.
+  std::map<std::string, std::vector<Declaration>> class_declarations_;
 
+  // Indexed by ElementType.
   // TODO: Make this a constant.
   std::vector<SVGElementDefinition> svg_element_definitions_;
 
-  void BeginElement(const char *name,
-                    const StringMap &attributes,
-                    const StringMap &styles);
-  void EndElement(const char *name);
-
-  void ProcessCircleElement(const StringMap &attributes,
-                            const StringMap &styles);
-  void ProcessEllipseElement(const StringMap &attributes,
-                             const StringMap &styles);
-  void ProcessGElement(const StringMap &attributes,
-                       const StringMap &styles);
-  void ProcessLineElement(const StringMap &attributes,
-                          const StringMap &styles);
-
-  void BeginLinearGradientElement(const StringMap &attributes,
-                                  const StringMap &styles);
+  // Releases the state of the last render.
+  void EndRender();
+
+  // Renders the elements of the graph in document order.
+  void RenderSceneGraph(const SceneGraph &graph);
+  void BeginElement(const SceneGraph::Element &element);
+  void EndElement();
+  // Saves the inherited graphics state, once per element, before the
+  // element changes it.
+  void SaveGraphicsState();
+
+  void ProcessCircleElement(const SceneGraph::Element &element);
+  void ProcessEllipseElement(const SceneGraph::Element &element);
+  void ProcessGElement(const SceneGraph::Element &element);
+  void ProcessLineElement(const SceneGraph::Element &element);
+
+  void BeginLinearGradientElement(const SceneGraph::Element &element);
   void EndLinearGradientElement();
 
-  void ProcessPathElement(const StringMap &attributes,
-                          const StringMap &styles);
-  void ProcessPolygonElement(const StringMap &attributes,
-                             const StringMap &styles);
-  void ProcessPolylineElement(const StringMap &attributes,
-                              const StringMap &styles);
+  void ProcessPathElement(const SceneGraph::Element &element);
+  void ProcessPolygonElement(const SceneGraph::Element &element);
+  void ProcessPolylineElement(const SceneGraph::Element &element);
 
-  void BeginRadialGradientElement(const StringMap &attributes,
-                                  const StringMap &styles);
+  void BeginRadialGradientElement(const SceneGraph::Element &element);
   void EndRadialGradientElement();
 
-  void ProcessRectElement(const StringMap &attributes,
-                          const StringMap &styles);
-  void ProcessStopElement(const StringMap &attributes,
-                          const StringMap &styles);
-
-  void BeginStyleElement(const StringMap &attributes,
-                         const StringMap &styles);
-  void EndStyleElement();
-
-  void ProcessSvgElement(const StringMap &attributes,
-                         const StringMap &styles);
-
-  // Attempts to process the given name and value that can be specified
-  // as an attribute and a style.
-  //
-  // It returns whether the given name/value pair was a
-  // known style (in which case it will have been processed).
-  bool ProcessStyle(const std::string &name,
-                    const std::string &value);
+  void ProcessRectElement(const SceneGraph::Element &element);
+  void ProcessStopElement(const SceneGraph::Element &element);
+  void ProcessSvgElement(const SceneGraph::Element &element);
+
+  // Applies a parsed attribute or style to the graphics state.
+  void ProcessDeclaration(const Declaration &declaration);
   // This is a helper function to process the value of a fill
   // or stroke attribute.
-  void ProcessFillOrStrokeValue(const std::string &value, bool is_fill);
+  void ProcessFillOrStrokeValue(const Declaration &declaration, bool is_fill);
 
-  // Set the current fill or stroke color in the current context
+  // Set the current fill or stroke color of the canvas
   // based on the graphics state.
   void CallCGSetColor(bool is_fill);
 
-  void ProcessDisplayValue(const std::string &value);
-  void ProcessVisibilityValue(const std::string &value);
-  void ProcessOpacityValue(const std::string &value);
-  void ProcessFillRuleValue(const std::string &value);
-  void ProcessDashArrayValue(const std::string &value);
-  void ProcessDashOffsetValue(const std::string &value);
-
-  // Returns true if all attributes and styles are processed successfully.
-  // Returns false if there was an any error.
-  bool ProcessCommonAttributes(StringMap *unprocessed_attributes,
-                               StringMap *unprocessed_styles);
-
-  // Iterates through all the elements returned by the given
-  // iterator and defines the result as the path in the current
-  // graphics context.
-  void ProcessPathData(PathDataIterator *iter);
-
-  // Takes an path data iterator that points to an arc
-  // and add the arc to a path.
-  // If an error(Out-of-range etc) occured,
+  void ProcessOpacityValue(Float opacity);
+  void ProcessDashArrayValue(const Declaration &declaration);
+  void ProcessDashOffsetValue(Float phase);
+
+  // Applies the declarations of the element, and the rules of the client
+  // style sheet that match its class, in cascade order.
+  void ProcessCommonAttributes(const SceneGraph::Element &element);
+
+  // Returns the declarations of the client style sheet for a class name.
+  const std::vector<Declaration> &ClientClassDeclarations(
+      const std::string &class_name);
+
+  // Defines the path segments of the element as the current path of the
+  // canvas, or lets the canvas add the path it keeps for the element.
+  void ProcessPathData(const SceneGraph::Element &element);
+
+  // Takes the coordinates of an arc segment and adds the arc to the
+  // current path. If an error(Out-of-range etc) occured,
   // returns false without mutating the path.
-  bool AddEllipticalArcToPath(const PathDataIterator &iter,
-                              CGMutablePathRef *path);
+  bool AddEllipticalArcToPath(const Float *coords);
 
   // Called to handle a paintable element with a points= attribute
   // (either polygon or polyline).
-  void PaintPolyElement(const StringMap &attributes, bool implicit_close);
+  void PaintPolyElement(const SceneGraph::Element &element);
 
   // This routine should be called to handle the painting of
   // any element based on previously set fill/stroke options.
-  // The callback takes a context and should
-  // set the path to be painted into the context.
+  // The callback should set the path to be painted as the current
+  // path of the canvas.
   // The |is_fillable| parameter may be false to indicate that the
   // type of element being painted is not logically fillable
   // (line and polyline).
-  void PaintElement(std::function<void(CGContextRef context)> define_path,
-                    bool is_fillable);
+  // |bounds| contains the path in user space. The fill and the stroke are
+  // skipped without defining the path if they can't reach the clip.
+  // The callback is a template parameter, rather than a std::function,
+  // so that its captures stay on the stack.
+  template<typename DefinePath>
+  void PaintElement(const DefinePath &define_path,
+                    bool is_fillable,
+                    FloatRect bounds);
 
   // This routine is a helper which will draw the gradient referenced
   // by the given iri clipped by the current path.
-  void DrawClippedGradient(const std::string &iri);
-
-  // Helper functions.
-  void InitializeCGContext();
-  SVGElementDefinition FindElementDefinition(const char *name);
-
-  // Merge css into class variable style_sheet_, create an instance
-  // if style_sheet_ is a nullptr.
-  void MergeStyleSheet(const MSCStyleSheet &style_sheet);
+  void DrawClippedGradient(const StringPiece &iri);
 };
 
 }  // namespace internal
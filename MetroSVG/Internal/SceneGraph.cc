@@ -0,0 +1,1229 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/SceneGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+#include <libxml/parser.h>
+#include <libxml/SAX2.h>
+#include <libxml/xmlreader.h>
+
+#include "MetroSVG/Internal/Atom.h"
+#include "MetroSVG/Internal/AttributeTable.h"
+#include "MetroSVG/Internal/BasicValueParsers.h"
+#include "MetroSVG/Internal/PathData.h"
+#include "MetroSVG/Internal/StringPiece.h"
+#include "MetroSVG/Internal/StyleIterator.h"
+#include "MetroSVG/Internal/StyleSheet.h"
+#include "MetroSVG/Internal/TransformIterator.h"
+#include "MetroSVG/Internal/Utils.h"
+#include "MetroSVG/Internal/XMLPullParser.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Indexed by ElementType.
+const char *const kElementTypeNames[] = {
+  "__UNKNOWN__",
+  "circle",
+  "ellipse",
+  "g",
+  "line",
+  "linearGradient",
+  "path",
+  "polygon",
+  "polyline",
+  "radialGradient",
+  "rect",
+  "stop",
+  "style",
+  "svg",
+};
+
+ElementType ElementTypeForAtom(Atom atom) {
+  switch (atom) {
+    case kAtomCircle: return kElementTypeCircle;
+    case kAtomEllipse: return kElementTypeEllipse;
+    case kAtomG: return kElementTypeG;
+    case kAtomLine: return kElementTypeLine;
+    case kAtomLinearGradient: return kElementTypeLinearGradient;
+    case kAtomPath: return kElementTypePath;
+    case kAtomPolygon: return kElementTypePolygon;
+    case kAtomPolyline: return kElementTypePolyline;
+    case kAtomRadialGradient: return kElementTypeRadialGradient;
+    case kAtomRect: return kElementTypeRect;
+    case kAtomStop: return kElementTypeStop;
+    case kAtomStyle: return kElementTypeStyle;
+    case kAtomSvg: return kElementTypeSvg;
+    default: return kElementTypeUnknown;
+  }
+}
+
+// Properties that can be specified in style sheets and style attributes.
+bool StylePropertyForAtom(Atom atom, Property *property) {
+  switch (atom) {
+    case kAtomFill: *property = kPropertyFill; return true;
+    case kAtomStroke: *property = kPropertyStroke; return true;
+    case kAtomStrokeLinecap: *property = kPropertyStrokeLinecap; return true;
+    case kAtomStrokeLinejoin: *property = kPropertyStrokeLinejoin; return true;
+    case kAtomStrokeMiterlimit:
+      *property = kPropertyStrokeMiterlimit;
+      return true;
+    case kAtomStrokeWidth: *property = kPropertyStrokeWidth; return true;
+    case kAtomFillOpacity: *property = kPropertyFillOpacity; return true;
+    case kAtomStrokeOpacity: *property = kPropertyStrokeOpacity; return true;
+    case kAtomStopColor: *property = kPropertyStopColor; return true;
+    case kAtomStopOpacity: *property = kPropertyStopOpacity; return true;
+    default: return false;
+  }
+}
+
+// Properties that can only be specified as attributes.
+bool AttributePropertyForAtom(Atom atom, Property *property) {
+  switch (atom) {
+    case kAtomTransform: *property = kPropertyTransform; return true;
+    case kAtomDisplay: *property = kPropertyDisplay; return true;
+    case kAtomVisibility: *property = kPropertyVisibility; return true;
+    case kAtomOpacity: *property = kPropertyOpacity; return true;
+    case kAtomFillRule: *property = kPropertyFillRule; return true;
+    case kAtomStrokeDasharray:
+      *property = kPropertyStrokeDasharray;
+      return true;
+    case kAtomStrokeDashoffset:
+      *property = kPropertyStrokeDashoffset;
+      return true;
+    default: return false;
+  }
+}
+
+bool ParsePaintValue(const StringPiece &value, Declaration *declaration) {
+  RgbColor rgb;
+  StringPiece iri;
+  if (value == "none") {
+    declaration->keyword = kPaintTypeNone;
+  } else if (ParseRgbColor(value, &rgb)) {
+    declaration->keyword = kPaintTypeColor;
+    declaration->color = rgb;
+  } else if (ParseIri(value, &iri)) {
+    declaration->keyword = kPaintTypeIri;
+    declaration->iri = iri.as_std_string();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Builds a SceneGraph from the nodes returned by an XMLPullParser or an
+// xmlTextReader. It isn't in the anonymous namespace because
+// SceneGraphStreamParser::Handler holds one.
+class SceneGraphBuilder {
+ public:
+  typedef XMLPullParser::Attribute Attribute;
+
+  explicit SceneGraphBuilder(SceneGraph *graph);
+
+  // Returns false if the parser doesn't support the data.
+  bool Build(XMLPullParser *parser);
+  // Returns false if the reader reports an error.
+  bool Build(xmlTextReader *reader);
+
+  // The following take the nodes from parsers that push them, in document
+  // order. The names and values of |xml_attributes| only need to be valid
+  // during the call.
+  void BeginElement(const StringPiece &name,
+                    int line_number,
+                    int column_number,
+                    const std::vector<Attribute> &xml_attributes);
+  void EndElement(bool has_end_tag);
+  void ProcessText(const StringPiece &text);
+
+ private:
+  struct OpenElement {
+    size_t index;
+    std::string style_type;
+    std::string style_text;
+
+    explicit OpenElement(size_t index_in)
+        : index(index_in) {}
+  };
+
+  const std::unordered_set<std::string> supported_styles_;
+  SceneGraph *graph_;
+  std::vector<OpenElement> open_elements_;
+  // Merged style sheets of the style elements seen so far.
+  std::unique_ptr<MSCStyleSheet> style_sheet_;
+  std::map<std::string, size_t> string_indices_;
+  // The attributes of the element the reader is on.
+  std::vector<Attribute> reader_attributes_;
+  // Copies of the attribute values of the current element that the reader
+  // doesn't keep for us.
+  std::vector<std::unique_ptr<std::string>> attribute_value_copies_;
+
+  // Collects the attributes of the element the reader is on into
+  // |reader_attributes_|. Returns false if the reader reports an error.
+  bool ReadAttributes(xmlTextReader *reader);
+  // Returns the value of the attribute the reader is on, making sure that
+  // it stays valid until the reader moves to the next node.
+  StringPiece StableAttributeValue(xmlTextReader *reader,
+                                   const xmlChar *value);
+
+  // Turns the attributes that can also be specified as styles, and the
+  // style sheet rules and style attribute that apply to the element, into
+  // declarations. Other attributes with a known name are returned in
+  // |attributes|.
+  void ProcessCommonAttributes(const std::vector<Attribute> &xml_attributes,
+                               SceneGraph::Element *element,
+                               AttributeTable *attributes);
+  void AddDeclaration(Property property, const StringPiece &value);
+
+  void ProcessCircleElement(const AttributeTable &attributes,
+                            SceneGraph::Element *element);
+  void ProcessEllipseElement(const AttributeTable &attributes,
+                             SceneGraph::Element *element);
+  void ProcessLineElement(const AttributeTable &attributes,
+                          SceneGraph::Element *element);
+  void ProcessGradientElement(Gradient::Type type,
+                              const AttributeTable &attributes,
+                              SceneGraph::Element *element);
+  void ProcessPathElement(const AttributeTable &attributes,
+                          SceneGraph::Element *element);
+  void ProcessPolyElement(const AttributeTable &attributes,
+                          bool implicit_close,
+                          SceneGraph::Element *element);
+  void ProcessRectElement(const AttributeTable &attributes,
+                          SceneGraph::Element *element);
+  void ProcessStopElement(const AttributeTable &attributes,
+                          SceneGraph::Element *element);
+  void ProcessSvgElement(const AttributeTable &attributes,
+                         SceneGraph::Element *element);
+
+  // Decodes |data| into the path tables.
+  void AddPathData(const StringPiece &data,
+                   PathDataFormat format,
+                   bool implicit_close,
+                   SceneGraph::Element *element);
+
+  size_t AddString(const std::string &string);
+};
+
+SceneGraphBuilder::SceneGraphBuilder(SceneGraph *graph)
+    : supported_styles_({
+        std::string("fill"),
+        std::string("stop-color"),
+        std::string("stroke"),
+      }),
+      graph_(graph) {}
+
+bool SceneGraphBuilder::Build(XMLPullParser *parser) {
+  XMLPullParser::Status status;
+  while ((status = parser->Next()) == XMLPullParser::kStatusNode) {
+    switch (parser->node_type()) {
+      case XMLPullParser::kNodeTypeStartElement:
+        BeginElement(parser->name(), parser->line_number(),
+                     parser->column_number(), parser->attributes());
+        if (parser->is_empty_element()) {
+          EndElement(false);
+        }
+        break;
+      case XMLPullParser::kNodeTypeEndElement:
+        EndElement(true);
+        break;
+      case XMLPullParser::kNodeTypeText:
+        ProcessText(parser->text());
+        break;
+      case XMLPullParser::kNodeTypeCDATA:
+        break;
+    }
+  }
+  return status == XMLPullParser::kStatusEnd;
+}
+
+bool SceneGraphBuilder::Build(xmlTextReader *reader) {
+  int last_xml_status;
+  while ((last_xml_status = xmlTextReaderRead(reader)) > 0) {
+    int node_type = xmlTextReaderNodeType(reader);
+    if (node_type == XML_READER_TYPE_ELEMENT) {
+      bool is_empty_element = xmlTextReaderIsEmptyElement(reader);
+      // The name is interned by the reader, so it stays valid when the
+      // reader moves to the attributes.
+      const char *name =
+          reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+      int line_number = xmlTextReaderGetParserLineNumber(reader);
+      int column_number = xmlTextReaderGetParserColumnNumber(reader);
+      if (!ReadAttributes(reader)) {
+        return false;
+      }
+      BeginElement(name, line_number, column_number, reader_attributes_);
+      if (is_empty_element) {
+        EndElement(false);
+      }
+    } else if (node_type == XML_READER_TYPE_END_ELEMENT) {
+      EndElement(true);
+    } else if (node_type == XML_READER_TYPE_TEXT) {
+      auto text = MakeUniquePtr(xmlTextReaderReadString(reader), xmlFree);
+      ProcessText(reinterpret_cast<const char *>(text.get()));
+    }
+  }
+  return last_xml_status == 0;
+}
+
+bool SceneGraphBuilder::ReadAttributes(xmlTextReader *reader) {
+  reader_attributes_.clear();
+  attribute_value_copies_.clear();
+  while (true) {
+    int xml_status = xmlTextReaderMoveToNextAttribute(reader);
+    if (xml_status == 0) {
+      return true;
+    } else if (xml_status < 0) {
+      return false;
+    }
+    const xmlChar *value = xmlTextReaderConstValue(reader);
+    if (!value) {
+      continue;
+    }
+    Attribute attribute;
+    attribute.name =
+        reinterpret_cast<const char *>(xmlTextReaderConstName(reader));
+    attribute.value = StableAttributeValue(reader, value);
+    reader_attributes_.push_back(attribute);
+  }
+}
+
+void SceneGraphBuilder::BeginElement(
+    const StringPiece &name,
+    int line_number,
+    int column_number,
+    const std::vector<Attribute> &xml_attributes) {
+  SceneGraph::Element element;
+  element.type = ElementTypeForAtom(FindAtom(name));
+  element.line_number = line_number;
+  element.column_number = column_number;
+  element.is_empty = false;
+  element.end = 0;
+  element.is_valid = true;
+  std::fill(element.parameters, element.parameters + 6, 0);
+  element.verb_begin = 0;
+  element.verb_end = 0;
+  element.coord_begin = 0;
+  element.index = 0;
+
+  AttributeTable attributes;
+  ProcessCommonAttributes(xml_attributes, &element, &attributes);
+  switch (element.type) {
+    case kElementTypeCircle:
+      ProcessCircleElement(attributes, &element);
+      break;
+    case kElementTypeEllipse:
+      ProcessEllipseElement(attributes, &element);
+      break;
+    case kElementTypeLine:
+      ProcessLineElement(attributes, &element);
+      break;
+    case kElementTypeLinearGradient:
+      ProcessGradientElement(Gradient::kTypeLinear, attributes,
+                             &element);
+      break;
+    case kElementTypePath:
+      ProcessPathElement(attributes, &element);
+      break;
+    case kElementTypePolygon:
+      ProcessPolyElement(attributes, true, &element);
+      break;
+    case kElementTypePolyline:
+      ProcessPolyElement(attributes, false, &element);
+      break;
+    case kElementTypeRadialGradient:
+      ProcessGradientElement(Gradient::kTypeRadial, attributes,
+                             &element);
+      break;
+    case kElementTypeRect:
+      ProcessRectElement(attributes, &element);
+      break;
+    case kElementTypeStop:
+      ProcessStopElement(attributes, &element);
+      break;
+    case kElementTypeSvg:
+      ProcessSvgElement(attributes, &element);
+      break;
+    case kElementTypeG:
+    case kElementTypeStyle:
+    case kElementTypeUnknown:
+      break;
+  }
+
+  open_elements_.emplace_back(graph_->elements.size());
+  if (element.type == kElementTypeStyle) {
+    const StringPiece *style_type = attributes.Find(kAtomType);
+    if (style_type != NULL) {
+      open_elements_.back().style_type = style_type->as_std_string();
+    }
+  }
+  graph_->elements.push_back(element);
+}
+
+void SceneGraphBuilder::EndElement(bool has_end_tag) {
+  if (open_elements_.empty()) {
+    return;
+  }
+  const OpenElement &open_element = open_elements_.back();
+  SceneGraph::Element *element = &graph_->elements[open_element.index];
+  element->is_empty = !has_end_tag;
+  element->end = graph_->elements.size();
+
+  // Style sheets apply to the elements that follow them.
+  if (has_end_tag && element->type == kElementTypeStyle &&
+      open_element.style_type == "text/css") {
+    std::unique_ptr<MSCStyleSheet> style_sheet(
+        ParseStyleSheetData(open_element.style_text.c_str(),
+                            open_element.style_text.length()));
+    if (style_sheet) {
+      if (!style_sheet_) {
+        style_sheet_.reset(new MSCStyleSheet);
+      }
+      MSCStyleSheetMerge(*style_sheet, style_sheet_.get());
+    }
+  }
+  open_elements_.pop_back();
+}
+
+void SceneGraphBuilder::ProcessText(const StringPiece &text) {
+  if (!open_elements_.empty() &&
+      graph_->elements[open_elements_.back().index].type ==
+          kElementTypeStyle) {
+    open_elements_.back().style_text = text.as_std_string();
+  }
+}
+
+void SceneGraphBuilder::ProcessCommonAttributes(
+    const std::vector<Attribute> &xml_attributes,
+    SceneGraph::Element *element,
+    AttributeTable *attributes) {
+  StringPiece class_attr_value("");
+  StringPiece style_attr_value("");
+
+  element->declaration_begin = graph_->declarations.size();
+  for (const Attribute &xml_attribute : xml_attributes) {
+    Atom atom = FindAtom(xml_attribute.name);
+    Property property;
+    if (StylePropertyForAtom(atom, &property) ||
+        AttributePropertyForAtom(atom, &property)) {
+      AddDeclaration(property, xml_attribute.value);
+    } else if (atom == kAtomStyle) {
+      style_attr_value = xml_attribute.value;
+    } else if (atom == kAtomClass) {
+      class_attr_value = xml_attribute.value;
+    } else if (atom != kAtomUnknown) {
+      attributes->Set(atom, xml_attribute.value);
+    }
+  }
+
+  element->class_declaration_begin = graph_->declarations.size();
+  std::string class_name = class_attr_value.as_std_string();
+  element->class_name = AddString(class_name);
+  if (style_sheet_) {
+    const std::vector<std::pair<std::string, std::string>> *class_data =
+        FindValueOrNull(style_sheet_->entry, class_name);
+    if (class_data != NULL) {
+      for (size_t i = 0; i < class_data->size(); ++i) {
+        Property property;
+        if (FindStyleProperty((*class_data)[i].first, &property)) {
+          AddDeclaration(property, (*class_data)[i].second);
+        }
+      }
+    }
+  }
+
+  element->style_declaration_begin = graph_->declarations.size();
+  if (style_attr_value.length() > 0) {
+    StringPiece sp = style_attr_value;
+    StyleIterator style_iter(&sp, supported_styles_);
+    while (style_iter.Next()) {
+      Property property;
+      if (FindStyleProperty(style_iter.property(), &property)) {
+        AddDeclaration(property, style_iter.value());
+      }
+    }
+  }
+  element->declaration_end = graph_->declarations.size();
+}
+
+StringPiece SceneGraphBuilder::StableAttributeValue(xmlTextReader *reader,
+                                                   const xmlChar *value) {
+  // Values made of a single text node point into the node, which the
+  // reader keeps until it moves on. Others, e.g., with entity references,
+  // are assembled in a buffer that the reader reuses for the next value.
+  xmlNode *node = xmlTextReaderCurrentNode(reader);
+  if (node != NULL && node->type == XML_ATTRIBUTE_NODE &&
+      node->children != NULL && node->children->content == value) {
+    return StringPiece(reinterpret_cast<const char *>(value));
+  }
+  attribute_value_copies_.emplace_back(
+      new std::string(reinterpret_cast<const char *>(value)));
+  return StringPiece(*attribute_value_copies_.back());
+}
+
+void SceneGraphBuilder::AddDeclaration(Property property,
+                                       const StringPiece &value) {
+  Declaration declaration(property);
+  if (ParseDeclarationValue(value, graph_, &declaration)) {
+    graph_->declarations.push_back(declaration);
+  }
+}
+
+void SceneGraphBuilder::ProcessCircleElement(const AttributeTable &attributes,
+                                             SceneGraph::Element *element) {
+  Float cx = 0.0, cy = 0.0, r = 0.0;
+  attributes.FloatValue(kAtomCx, &cx);
+  attributes.FloatValue(kAtomCy, &cy);
+  attributes.FloatValue(kAtomR, &r);
+  if (r <= 0.0) {
+    // TODO: Signal error if value is less than 0.
+    element->is_valid = false;
+    return;
+  }
+  element->parameters[0] = cx;
+  element->parameters[1] = cy;
+  element->parameters[2] = r;
+}
+
+void SceneGraphBuilder::ProcessEllipseElement(const AttributeTable &attributes,
+                                              SceneGraph::Element *element) {
+  Float cx = 0.0, cy = 0.0, rx = 0.0, ry = 0.0;
+  attributes.FloatValue(kAtomCx, &cx);
+  attributes.FloatValue(kAtomCy, &cy);
+  attributes.FloatValue(kAtomRx, &rx);
+  attributes.FloatValue(kAtomRy, &ry);
+  if (rx <= 0.0 || ry <= 0.0) {
+    // TODO: Signal error if value is less than 0.
+    element->is_valid = false;
+    return;
+  }
+  element->parameters[0] = cx;
+  element->parameters[1] = cy;
+  element->parameters[2] = rx;
+  element->parameters[3] = ry;
+}
+
+void SceneGraphBuilder::ProcessLineElement(const AttributeTable &attributes,
+                                           SceneGraph::Element *element) {
+  attributes.FloatValue(kAtomX1, &element->parameters[0]);
+  attributes.FloatValue(kAtomY1, &element->parameters[1]);
+  attributes.FloatValue(kAtomX2, &element->parameters[2]);
+  attributes.FloatValue(kAtomY2, &element->parameters[3]);
+}
+
+void SceneGraphBuilder::ProcessGradientElement(Gradient::Type type,
+                                               const AttributeTable &attributes,
+                                               SceneGraph::Element *element) {
+  Gradient gradient(type, attributes);
+  if (type == Gradient::kTypeLinear) {
+    Gradient::Linear *linear_gradient = &gradient.linear;
+
+    Length x1(0, Length::kUnitPercent);
+    attributes.LengthValue(kAtomX1, &x1);
+    linear_gradient->x1 = x1;
+
+    Length y1(0, Length::kUnitPercent);
+    attributes.LengthValue(kAtomY1, &y1);
+    linear_gradient->y1 = y1;
+
+    Length x2(100, Length::kUnitPercent);
+    attributes.LengthValue(kAtomX2, &x2);
+    linear_gradient->x2 = x2;
+
+    Length y2(0, Length::kUnitPercent);
+    attributes.LengthValue(kAtomY2, &y2);
+    linear_gradient->y2 = y2;
+  } else {
+    Gradient::Radial *radial_gradient = &gradient.radial;
+
+    Length cx(50, Length::kUnitPercent);
+    attributes.LengthValue(kAtomCx, &cx);
+    radial_gradient->cx = cx;
+
+    Length cy(50, Length::kUnitPercent);
+    attributes.LengthValue(kAtomCy, &cy);
+    radial_gradient->cy = cy;
+
+    Length r(50, Length::kUnitPercent);
+    attributes.LengthValue(kAtomR, &r);
+    radial_gradient->r = r;
+
+    Length fx = cx;
+    attributes.LengthValue(kAtomFx, &fx);
+    radial_gradient->fx = fx;
+
+    Length fy = cy;
+    attributes.LengthValue(kAtomFy, &fy);
+    radial_gradient->fy = fy;
+  }
+  element->index = graph_->gradients.size();
+  graph_->gradients.push_back(gradient);
+}
+
+void SceneGraphBuilder::ProcessPathElement(const AttributeTable &attributes,
+                                           SceneGraph::Element *element) {
+  const StringPiece *d_value = attributes.Find(kAtomD);
+  if (!d_value) {
+    element->is_valid = false;
+    return;
+  }
+  AddPathData(*d_value, kPathDataFormatPath, false, element);
+}
+
+void SceneGraphBuilder::ProcessPolyElement(const AttributeTable &attributes,
+                                           bool implicit_close,
+                                           SceneGraph::Element *element) {
+  const StringPiece *points = attributes.Find(kAtomPoints);
+  if (!points) {
+    element->is_valid = false;
+    return;
+  }
+  AddPathData(*points, kPathDataFormatPoints, implicit_close, element);
+}
+
+void SceneGraphBuilder::ProcessRectElement(const AttributeTable &attributes,
+                                           SceneGraph::Element *element) {
+  Float x = 0.0, y = 0.0;
+  attributes.FloatValue(kAtomX, &x);
+  attributes.FloatValue(kAtomY, &y);
+
+  Float width = 0.0, height = 0.0;
+  attributes.FloatValue(kAtomWidth, &width);
+  attributes.FloatValue(kAtomHeight, &height);
+  if (width <= 0.0 || height <= 0.0) {
+    element->is_valid = false;
+    return;
+  }
+
+  Float rx = 0.0, ry = 0.0;
+  bool has_valid_rx = attributes.FloatValue(kAtomRx, &rx);
+  bool has_valid_ry = attributes.FloatValue(kAtomRy, &ry);
+  if (rx < 0.0 || ry < 0.0) {
+    element->is_valid = false;
+    return;
+  }
+  if (has_valid_rx && !has_valid_ry) {
+    ry = rx;
+  } else if (!has_valid_rx && has_valid_ry) {
+    rx = ry;
+  }
+  if (rx > width / 2) {
+    rx = width / 2;
+  }
+  if (ry > height / 2) {
+    ry = height / 2;
+  }
+
+  element->parameters[0] = x;
+  element->parameters[1] = y;
+  element->parameters[2] = width;
+  element->parameters[3] = height;
+  element->parameters[4] = rx;
+  element->parameters[5] = ry;
+}
+
+void SceneGraphBuilder::ProcessStopElement(const AttributeTable &attributes,
+                                           SceneGraph::Element *element) {
+  element->is_valid = false;
+  Length offset_length;
+  if (!attributes.LengthValue(kAtomOffset, &offset_length)) {
+    // TODO: Signal error.
+    return;
+  }
+  Float offset;
+  if (offset_length.unit == Length::kUnitNone) {
+    offset = ClampToUnitRange(offset_length.value);
+  } else if (offset_length.unit == Length::kUnitPercent) {
+    offset = ClampToUnitRange(offset_length.value / 100);
+  } else {
+    return;
+  }
+  element->is_valid = true;
+  element->parameters[0] = offset;
+}
+
+void SceneGraphBuilder::ProcessSvgElement(const AttributeTable &attributes,
+                                          SceneGraph::Element *element) {
+  SceneGraph::Viewport viewport;
+  element->is_valid = false;
+
+  // TODO: Parse x and y too.
+  const StringPiece *width_str = attributes.Find(kAtomWidth);
+  if (width_str) {
+    if (!ParseLength(*width_str, &viewport.width) ||
+        viewport.width.value < 0) {
+      return;  // TODO: Signal error.
+    }
+    if (viewport.width.value == 0) {
+      return;  // TODO: Disable rendering per spec.
+    }
+  } else {
+    viewport.width = Length(100, Length::kUnitPercent);
+  }
+
+  const StringPiece *height_str = attributes.Find(kAtomHeight);
+  if (height_str) {
+    if (!ParseLength(*height_str, &viewport.height) ||
+        viewport.height.value < 0) {
+      return;  // TODO: Signal error.
+    }
+    if (viewport.height.value == 0) {
+      return;  // TODO: Disable rendering per spec.
+    }
+  } else {
+    viewport.height = Length(100, Length::kUnitPercent);
+  }
+
+  viewport.has_view_box = false;
+  viewport.view_box = FloatRect::Null();
+  const StringPiece *viewbox_str = attributes.Find(kAtomViewBox);
+  Float values[4];
+  if (viewbox_str && ParseFloats(*viewbox_str, 4, values)) {
+    viewport.view_box = FloatRect(values[0], values[1], values[2], values[3]);
+    viewport.has_view_box = true;
+  }
+
+  const StringPiece *aspect_ratio_str =
+      attributes.Find(kAtomPreserveAspectRatio);
+  if (!aspect_ratio_str ||
+      !ParsePreserveAspectRatio(*aspect_ratio_str, &viewport.aspect_ratio)) {
+    viewport.aspect_ratio = PreserveAspectRatio::default_value();
+  }
+
+  element->is_valid = true;
+  element->index = graph_->viewports.size();
+  graph_->viewports.push_back(viewport);
+}
+
+void SceneGraphBuilder::AddPathData(const StringPiece &data,
+                                    PathDataFormat format,
+                                    bool implicit_close,
+                                    SceneGraph::Element *element) {
+  element->verb_begin = graph_->path_verbs.size();
+  element->coord_begin = graph_->path_coords.size();
+  DecodePathData(data, format, implicit_close,
+                 &graph_->path_verbs, &graph_->path_coords);
+  element->verb_end = graph_->path_verbs.size();
+}
+
+size_t SceneGraphBuilder::AddString(const std::string &string) {
+  auto iter = string_indices_.find(string);
+  if (iter != string_indices_.end()) {
+    return iter->second;
+  }
+  size_t index = graph_->strings.size();
+  graph_->strings.push_back(string);
+  string_indices_[string] = index;
+  return index;
+}
+
+const char *ElementTypeName(ElementType type) {
+  return kElementTypeNames[type];
+}
+
+FloatRect GetPathBounds(const SceneGraph &graph,
+                        const SceneGraph::Element &element) {
+  Float min_x = INFINITY;
+  Float min_y = INFINITY;
+  Float max_x = -INFINITY;
+  Float max_y = -INFINITY;
+  auto add_point = [&](Float x, Float y, Float margin) {
+    min_x = std::min(min_x, x - margin);
+    min_y = std::min(min_y, y - margin);
+    max_x = std::max(max_x, x + margin);
+    max_y = std::max(max_y, y + margin);
+  };
+
+  const Float *coords = graph.path_coords.data() + element.coord_begin;
+  FloatPoint current_point;
+  FloatPoint subpath_start;
+  for (size_t i = element.verb_begin; i < element.verb_end; ++i) {
+    PathVerb verb = static_cast<PathVerb>(graph.path_verbs[i]);
+    int coord_count = PathVerbCoordinateCount(verb);
+    if (verb == kPathVerbClose) {
+      current_point = subpath_start;
+      continue;
+    }
+    if (verb == kPathVerbArcTo) {
+      // The arc lies on an ellipse through both of its end points, so it
+      // doesn't go further from its end point than the diameter. Radii
+      // that are too small for the end points are scaled up as in
+      // SVG 1.1 Appendix F.6.6.
+      Float rx = std::fabs(coords[0]);
+      Float ry = std::fabs(coords[1]);
+      Float margin = 0;
+      if (rx > 0 && ry > 0) {
+        Float angle = ToRadians(coords[2]);
+        Float dx = (current_point.x - coords[5]) / 2;
+        Float dy = (current_point.y - coords[6]) / 2;
+        Float x1 = std::cos(angle) * dx + std::sin(angle) * dy;
+        Float y1 = -std::sin(angle) * dx + std::cos(angle) * dy;
+        Float lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+        Float scale = std::max(Float(1), std::sqrt(lambda));
+        margin = 2 * std::max(rx, ry) * scale;
+      }
+      add_point(coords[5], coords[6], margin);
+    } else {
+      for (int j = 0; j < coord_count; j += 2) {
+        add_point(coords[j], coords[j + 1], 0);
+      }
+    }
+    current_point = FloatPoint(coords[coord_count - 2],
+                               coords[coord_count - 1]);
+    if (verb == kPathVerbMoveTo) {
+      subpath_start = current_point;
+    }
+    coords += coord_count;
+  }
+  if (min_x > max_x) {
+    return FloatRect::Null();
+  }
+  return FloatRect(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+SceneGraph *ParseSceneGraph(const char *data,
+                            size_t data_length,
+                            const char *url) {
+  {
+    std::unique_ptr<SceneGraph> graph(new SceneGraph);
+    XMLPullParser parser(data, data_length);
+    SceneGraphBuilder builder(graph.get());
+    if (builder.Build(&parser)) {
+      return graph.release();
+    }
+  }
+
+  // The data uses XML that the pull parser doesn't handle, or isn't
+  // well-formed, which libxml2 reports.
+  InitializeXMLParser();
+  int options = XML_PARSE_NOENT | XML_PARSE_NONET;
+  xmlTextReader *reader = xmlReaderForMemory(data,
+                                             static_cast<int>(data_length),
+                                             url,
+                                             NULL,
+                                             options);
+  if (!reader) {
+    return NULL;
+  }
+  auto delete_reader = MakeUniquePtr(reader, xmlFreeTextReader);
+
+  std::unique_ptr<SceneGraph> graph(new SceneGraph);
+  SceneGraphBuilder builder(graph.get());
+  if (!builder.Build(reader)) {
+    return NULL;
+  }
+  return graph.release();
+}
+
+// Drives a SceneGraphBuilder from the SAX callbacks of a libxml2 push
+// parser. The callbacks that aren't overridden are the default ones, which
+// keep the document type declaration and entities in ctxt_->myDoc.
+class SceneGraphStreamParser::Handler {
+ public:
+  explicit Handler(const char *url);
+  ~Handler();
+
+  bool ParseChunk(const char *data, size_t length);
+  SceneGraph *Finish();
+
+  bool has_svg_element() const { return has_svg_element_; }
+  const std::vector<std::pair<std::string, std::string>> &svg_attributes()
+      const {
+    return svg_attributes_;
+  }
+
+ private:
+  static Handler *FromContext(void *context);
+  static void StartElement(void *context,
+                           const xmlChar *local_name,
+                           const xmlChar *prefix,
+                           const xmlChar *uri,
+                           int namespace_count,
+                           const xmlChar **namespaces,
+                           int attribute_count,
+                           int defaulted_count,
+                           const xmlChar **attributes);
+  static void EndElement(void *context,
+                         const xmlChar *local_name,
+                         const xmlChar *prefix,
+                         const xmlChar *uri);
+  static void Characters(void *context, const xmlChar *text, int length);
+  // Ends a run of text; used for the nodes that separate text nodes.
+  static void Comment(void *context, const xmlChar *value);
+  static void ProcessingInstruction(void *context,
+                                    const xmlChar *target,
+                                    const xmlChar *data);
+  static void CDATABlock(void *context, const xmlChar *value, int length);
+
+  // Passes the text since the last node to the builder. Like the
+  // xmlTextReader, whitespace-only text isn't a text node.
+  void FlushText();
+
+  std::unique_ptr<SceneGraph> graph_;
+  SceneGraphBuilder builder_;
+  xmlParserCtxt *ctxt_;
+  std::string text_;
+  // Qualified names, which the builder expects, and attributes of the
+  // current element.
+  std::string name_;
+  std::vector<std::string> attribute_names_;
+  std::vector<SceneGraphBuilder::Attribute> attributes_;
+  // Whether the last node was the start of an empty-element tag.
+  bool is_empty_element_;
+  bool has_svg_element_;
+  std::vector<std::pair<std::string, std::string>> svg_attributes_;
+
+  DISALLOW_COPY_AND_ASSIGN(Handler);
+};
+
+SceneGraphStreamParser::Handler::Handler(const char *url)
+    : graph_(new SceneGraph),
+      builder_(graph_.get()),
+      ctxt_(NULL),
+      is_empty_element_(false),
+      has_svg_element_(false) {
+  InitializeXMLParser();
+  xmlSAXHandler sax_handler;
+  xmlSAXVersion(&sax_handler, 2);
+  sax_handler.startElementNs = StartElement;
+  sax_handler.endElementNs = EndElement;
+  sax_handler.characters = Characters;
+  sax_handler.ignorableWhitespace = Characters;
+  sax_handler.comment = Comment;
+  sax_handler.processingInstruction = ProcessingInstruction;
+  sax_handler.cdataBlock = CDATABlock;
+  // The default callbacks expect the context as user data, so the handler
+  // is found through ctxt_->_private.
+  ctxt_ = xmlCreatePushParserCtxt(&sax_handler, NULL, NULL, 0, url);
+  if (ctxt_) {
+    ctxt_->_private = this;
+    xmlCtxtUseOptions(ctxt_, XML_PARSE_NOENT | XML_PARSE_NONET);
+  }
+}
+
+SceneGraphStreamParser::Handler::~Handler() {
+  if (ctxt_) {
+    if (ctxt_->myDoc) {
+      xmlFreeDoc(ctxt_->myDoc);
+    }
+    xmlFreeParserCtxt(ctxt_);
+  }
+}
+
+bool SceneGraphStreamParser::Handler::ParseChunk(const char *data,
+                                                 size_t length) {
+  if (!ctxt_ || !graph_) {
+    return false;
+  }
+  // xmlParseChunk takes an int size.
+  const size_t kMaxChunkLength = 1 << 30;
+  do {
+    size_t chunk_length = std::min(length, kMaxChunkLength);
+    if (!ctxt_->wellFormed) {
+      return false;
+    }
+    xmlParseChunk(ctxt_, data, static_cast<int>(chunk_length), 0);
+    data += chunk_length;
+    length -= chunk_length;
+  } while (length > 0);
+  return ctxt_->wellFormed;
+}
+
+SceneGraph *SceneGraphStreamParser::Handler::Finish() {
+  if (!ctxt_ || !graph_) {
+    return NULL;
+  }
+  xmlParseChunk(ctxt_, NULL, 0, 1);
+  if (!ctxt_->wellFormed) {
+    return NULL;
+  }
+  return graph_.release();
+}
+
+SceneGraphStreamParser::Handler *SceneGraphStreamParser::Handler::FromContext(
+    void *context) {
+  return static_cast<Handler *>(static_cast<xmlParserCtxt *>(context)
+                                    ->_private);
+}
+
+void SceneGraphStreamParser::Handler::StartElement(
+    void *context,
+    const xmlChar *local_name,
+    const xmlChar *prefix,
+    const xmlChar *uri,
+    int namespace_count,
+    const xmlChar **namespaces,
+    int attribute_count,
+    int defaulted_count,
+    const xmlChar **attributes) {
+  Handler *handler = FromContext(context);
+  handler->FlushText();
+
+  auto qualified_name = [](const xmlChar *local_name,
+                           const xmlChar *prefix,
+                           std::string *name) {
+    name->clear();
+    if (prefix) {
+      name->append(reinterpret_cast<const char *>(prefix));
+      name->append(1, ':');
+    }
+    name->append(reinterpret_cast<const char *>(local_name));
+  };
+  qualified_name(local_name, prefix, &handler->name_);
+
+  // As with the xmlTextReader, attributes defaulted by the DTD are left
+  // out. Each attribute is given by its local name, prefix, URI, value and
+  // the end of the value.
+  attribute_count -= defaulted_count;
+  handler->attribute_names_.resize(attribute_count);
+  handler->attributes_.resize(attribute_count);
+  for (int i = 0; i < attribute_count; ++i) {
+    const xmlChar **attribute = attributes + i * 5;
+    qualified_name(attribute[0], attribute[1],
+                   &handler->attribute_names_[i]);
+    handler->attributes_[i].name = handler->attribute_names_[i].c_str();
+    handler->attributes_[i].value =
+        StringPiece(reinterpret_cast<const char *>(attribute[3]),
+                    reinterpret_cast<const char *>(attribute[4]));
+  }
+
+  if (!handler->has_svg_element_ && handler->name_ == "svg") {
+    handler->has_svg_element_ = true;
+    for (const SceneGraphBuilder::Attribute &attribute :
+         handler->attributes_) {
+      handler->svg_attributes_.emplace_back(attribute.name.as_std_string(),
+                                            attribute.value.as_std_string());
+    }
+  }
+
+  handler->builder_.BeginElement(
+      handler->name_.c_str(),
+      xmlSAX2GetLineNumber(context),
+      xmlSAX2GetColumnNumber(context),
+      handler->attributes_);
+  // SAX doesn't tell empty-element tags from start tags, but the parser is
+  // still before the end of the tag. The xmlTextReader does the same.
+  const xmlChar *tag_end = static_cast<xmlParserCtxt *>(context)->input->cur;
+  handler->is_empty_element_ =
+      tag_end && tag_end[0] == '/' && tag_end[1] == '>';
+}
+
+void SceneGraphStreamParser::Handler::EndElement(void *context,
+                                                 const xmlChar *local_name,
+                                                 const xmlChar *prefix,
+                                                 const xmlChar *uri) {
+  Handler *handler = FromContext(context);
+  bool has_end_tag = !handler->is_empty_element_;
+  handler->FlushText();
+  handler->builder_.EndElement(has_end_tag);
+}
+
+void SceneGraphStreamParser::Handler::Characters(void *context,
+                                                 const xmlChar *text,
+                                                 int length) {
+  Handler *handler = FromContext(context);
+  handler->is_empty_element_ = false;
+  handler->text_.append(reinterpret_cast<const char *>(text), length);
+}
+
+void SceneGraphStreamParser::Handler::Comment(void *context,
+                                              const xmlChar *value) {
+  FromContext(context)->FlushText();
+}
+
+void SceneGraphStreamParser::Handler::ProcessingInstruction(
+    void *context,
+    const xmlChar *target,
+    const xmlChar *data) {
+  FromContext(context)->FlushText();
+}
+
+void SceneGraphStreamParser::Handler::CDATABlock(void *context,
+                                                 const xmlChar *value,
+                                                 int length) {
+  FromContext(context)->FlushText();
+}
+
+void SceneGraphStreamParser::Handler::FlushText() {
+  is_empty_element_ = false;
+  for (char c : text_) {
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+      builder_.ProcessText(text_);
+      break;
+    }
+  }
+  text_.clear();
+}
+
+SceneGraphStreamParser::SceneGraphStreamParser(const char *url)
+    : handler_(new Handler(url)) {}
+
+SceneGraphStreamParser::~SceneGraphStreamParser() {}
+
+bool SceneGraphStreamParser::ParseChunk(const char *data, size_t length) {
+  return handler_->ParseChunk(data, length);
+}
+
+SceneGraph *SceneGraphStreamParser::Finish() {
+  return handler_->Finish();
+}
+
+bool SceneGraphStreamParser::has_svg_element() const {
+  return handler_->has_svg_element();
+}
+
+const std::vector<std::pair<std::string, std::string>> &
+SceneGraphStreamParser::svg_attributes() const {
+  return handler_->svg_attributes();
+}
+
+bool FindStyleProperty(const StringPiece &name, Property *property) {
+  return StylePropertyForAtom(FindAtom(name), property);
+}
+
+bool ParseDeclarationValue(const StringPiece &value,
+                           SceneGraph *graph,
+                           Declaration *declaration) {
+  switch (declaration->property) {
+    case kPropertyFill:
+    case kPropertyStroke:
+      return ParsePaintValue(value, declaration);
+    case kPropertyStrokeLinecap:
+      if (value == "butt") {
+        declaration->keyword = kLineCapButt;
+      } else if (value == "round") {
+        declaration->keyword = kLineCapRound;
+      } else if (value == "square") {
+        declaration->keyword = kLineCapSquare;
+      } else {
+        // Other values have no effect.
+        return false;
+      }
+      return true;
+    case kPropertyStrokeLinejoin:
+      if (value == "miter") {
+        declaration->keyword = kLineJoinMiter;
+      } else if (value == "round") {
+        declaration->keyword = kLineJoinRound;
+      } else if (value == "bevel") {
+        declaration->keyword = kLineJoinBevel;
+      } else {
+        // Other values have no effect.
+        return false;
+      }
+      return true;
+    case kPropertyStrokeMiterlimit:
+    case kPropertyStrokeWidth:
+    case kPropertyFillOpacity:
+    case kPropertyStrokeOpacity:
+    case kPropertyStopOpacity:
+    case kPropertyOpacity:
+      // TODO: Report an error.
+      return ParseFloat(value, &declaration->number);
+    case kPropertyStopColor:
+      return ParseRgbColor(value, &declaration->color);
+    case kPropertyTransform: {
+      if (!graph) {
+        return false;
+      }
+      StringPiece transform_value(value);
+      TransformIterator iter(&transform_value);
+      bool has_transform = false;
+      AffineTransform transform;
+      while (iter.Next()) {
+        // Transforms in the list are applied from right to left.
+        transform = ConcatTransforms(iter.transform(), transform);
+        has_transform = true;
+      }
+      if (!has_transform) {
+        return false;
+      }
+      declaration->index = graph->transforms.size();
+      graph->transforms.push_back(transform);
+      return true;
+    }
+    case kPropertyDisplay:
+      // We do not explicitly process values other than none,
+      // because a parent node with display=none makes all child
+      // nodes invisible.  See SVG 1.1 Section 11.5.
+      return value == "none";
+    case kPropertyVisibility:
+      if (value == "visible") {
+        declaration->keyword = 1;
+      } else if (value == "hidden" || value == "collapse") {
+        declaration->keyword = 0;
+      } else {
+        // There is also an "inherit" value, which should do nothing.
+        return false;
+      }
+      return true;
+    case kPropertyFillRule:
+      if (value == "evenodd") {
+        declaration->keyword = kFillRuleEvenOdd;
+      } else if (value == "nonzero") {
+        declaration->keyword = kFillRuleNonZero;
+      } else {
+        return false;
+      }
+      return true;
+    case kPropertyStrokeDasharray: {
+      if (!graph) {
+        return false;
+      }
+      std::vector<Length> lengths;
+      declaration->index = graph->dash_values.size();
+      declaration->count = 0;
+      if (ParseLengths(value, &lengths)) {
+        bool has_non_zero_element = false;
+        for (Length l : lengths) {
+          if (l.value != 0) {
+            has_non_zero_element = true;
+          }
+        }
+        if (has_non_zero_element) {
+          for (Length l : lengths) {
+            graph->dash_values.push_back(l.value);
+          }
+          declaration->count = lengths.size();
+        }
+        return true;
+      }
+      return value == "none";
+    }
+    case kPropertyStrokeDashoffset: {
+      Length phase;
+      if (!ParseLength(value, &phase)) {
+        return false;
+      }
+      declaration->number = phase.value;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
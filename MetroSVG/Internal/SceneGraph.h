@@ -0,0 +1,247 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/Macros.h"
+#include "MetroSVG/Internal/PathData.h"
+
+namespace metrosvg {
+namespace internal {
+
+class StringPiece;
+
+// The SVG elements the renderer knows about. Any other element is
+// kElementTypeUnknown; it doesn't paint anything but its attributes
+// still apply to its descendants.
+enum ElementType {
+  kElementTypeUnknown = 0,
+  kElementTypeCircle,
+  kElementTypeEllipse,
+  kElementTypeG,
+  kElementTypeLine,
+  kElementTypeLinearGradient,
+  kElementTypePath,
+  kElementTypePolygon,
+  kElementTypePolyline,
+  kElementTypeRadialGradient,
+  kElementTypeRect,
+  kElementTypeStop,
+  kElementTypeStyle,
+  kElementTypeSvg,
+};
+
+// Returns the tag name of a given element type, or "__UNKNOWN__".
+const char *ElementTypeName(ElementType type);
+
+// Properties that can be specified as presentation attributes. The ones
+// up to kPropertyStopOpacity can also be specified in style sheets and
+// style attributes.
+enum Property {
+  kPropertyFill,
+  kPropertyStroke,
+  kPropertyStrokeLinecap,
+  kPropertyStrokeLinejoin,
+  kPropertyStrokeMiterlimit,
+  kPropertyStrokeWidth,
+  kPropertyFillOpacity,
+  kPropertyStrokeOpacity,
+  kPropertyStopColor,
+  kPropertyStopOpacity,
+
+  kPropertyTransform,
+  kPropertyDisplay,
+  kPropertyVisibility,
+  kPropertyOpacity,
+  kPropertyFillRule,
+  kPropertyStrokeDasharray,
+  kPropertyStrokeDashoffset,
+};
+
+// Values of Declaration::keyword for fill and stroke.
+enum PaintType {
+  kPaintTypeNone,
+  kPaintTypeColor,
+  kPaintTypeIri,
+};
+
+// A parsed property value. Which fields are meaningful depends on
+// |property|:
+// - fill, stroke: |keyword| is a PaintType; |color| or |iri|.
+// - stroke-linecap, stroke-linejoin: |keyword| is a LineCap or LineJoin.
+// - fill-rule: |keyword| is a FillRule.
+// - visibility: |keyword| is non-zero for visible.
+// - display: always "none"; other values are not recorded.
+// - stop-color: |color|.
+// - transform: |index| into SceneGraph::transforms.
+// - stroke-dasharray: |count| values from |index| in SceneGraph::dash_values.
+//   A zero count means no dashes.
+// - all others: |number|.
+struct Declaration {
+  Property property;
+  int keyword;
+  Float number;
+  RgbColor color;
+  size_t index;
+  size_t count;
+  std::string iri;
+
+  explicit Declaration(Property property_in)
+      : property(property_in), keyword(0), number(0), index(0), count(0) {}
+};
+
+// SceneGraph is an immutable, fully parsed representation of an SVG
+// document. Everything that doesn't depend on the canvas size or the
+// client style sheet is resolved when the graph is built, so rendering
+// it doesn't involve any XML or text parsing.
+//
+// Elements are stored in document order. Variable-length data is kept in
+// flat tables on the graph and referred to by index.
+struct SceneGraph {
+  // Parsed attributes of an svg element.
+  struct Viewport {
+    Length width;
+    Length height;
+    bool has_view_box;
+    FloatRect view_box;
+    PreserveAspectRatio aspect_ratio;
+  };
+
+  struct Element {
+    ElementType type;
+    int line_number;
+    int column_number;
+    // Whether the element was written as an empty-element tag, e.g.,
+    // <linearGradient/>. End handlers don't run for those.
+    bool is_empty;
+    // Index of the first element after this one that is not a descendant.
+    size_t end;
+
+    // Declarations that apply to this element are stored in |declarations|
+    // in the order they should be applied:
+    // [declaration_begin, class_declaration_begin) presentation attributes,
+    // [class_declaration_begin, style_declaration_begin) rules of the style
+    // sheets in the document that match the class attribute, and
+    // [style_declaration_begin, declaration_end) the style attribute.
+    size_t declaration_begin;
+    size_t class_declaration_begin;
+    size_t style_declaration_begin;
+    size_t declaration_end;
+    // Index in |strings| of the value of the class attribute. The client
+    // style sheet is matched against it at render time.
+    size_t class_name;
+
+    // False if required attributes are missing or invalid. Such an element
+    // doesn't paint anything, and a stop doesn't add a gradient stop.
+    bool is_valid;
+    // Element-specific parameters:
+    // - circle: cx, cy, r.
+    // - ellipse: cx, cy, rx, ry.
+    // - line: x1, y1, x2, y2.
+    // - rect: x, y, width, height, rx, ry.
+    // - stop: offset.
+    Float parameters[6];
+    // path, polygon and polyline: ranges in |path_verbs| and |path_coords|.
+    size_t verb_begin;
+    size_t verb_end;
+    size_t coord_begin;
+    // linearGradient and radialGradient: index in |gradients|.
+    // svg: index in |viewports|.
+    size_t index;
+  };
+
+  std::vector<Element> elements;
+  std::vector<Declaration> declarations;
+  std::vector<AffineTransform> transforms;
+  std::vector<Float> dash_values;
+  std::vector<std::string> strings;
+  std::vector<uint8_t> path_verbs;
+  std::vector<Float> path_coords;
+  // Gradients have no stops here; the stops are taken from the stop
+  // elements at render time because stop-color can come from the client
+  // style sheet.
+  std::vector<Gradient> gradients;
+  std::vector<Viewport> viewports;
+};
+
+// Returns a rectangle that contains the path segments of a path, polygon
+// or polyline element, including the curves and arcs, or the null rectangle
+// if the element has no segments. The rectangle is not necessarily the
+// smallest one; control points are included, for example.
+FloatRect GetPathBounds(const SceneGraph &graph,
+                        const SceneGraph::Element &element);
+
+// Fully parses UTF-8-encoded SVG data. Returns NULL if the data is not
+// well-formed. Caller should release the returned instance.
+SceneGraph *ParseSceneGraph(const char *data,
+                            size_t data_length,
+                            const char *url);
+
+// Parses UTF-8-encoded SVG data that arrives in chunks, e.g., from a pipe
+// or a decompressor, into a SceneGraph. Each chunk is parsed as far as it
+// goes when it's given, so only the data of an unfinished node is kept.
+class SceneGraphStreamParser {
+ public:
+  // |url| can be NULL.
+  explicit SceneGraphStreamParser(const char *url);
+  ~SceneGraphStreamParser();
+
+  // Parses the next chunk of data, which isn't accessed after this returns.
+  // Returns false if the data so far is not well-formed, after which the
+  // rest of the data is ignored.
+  bool ParseChunk(const char *data, size_t length);
+
+  // Ends the data. Returns the graph, which the caller should release, or
+  // NULL if the data is not well-formed. Must be called at most once.
+  SceneGraph *Finish();
+
+  // Whether the parser has reached the first svg element, in which case
+  // svg_attributes() holds the names and values of its attributes.
+  bool has_svg_element() const;
+  const std::vector<std::pair<std::string, std::string>> &svg_attributes()
+      const;
+
+ private:
+  class Handler;
+
+  std::unique_ptr<Handler> handler_;
+
+  DISALLOW_COPY_AND_ASSIGN(SceneGraphStreamParser);
+};
+
+// Looks up a property that can be specified in style sheets and style
+// attributes by name. Returns false if the name is not such a property.
+bool FindStyleProperty(const StringPiece &name, Property *property);
+
+// Parses the value of a property. Returns false if the value is invalid
+// for the property, in which case the declaration has no effect.
+// |graph| receives values that are stored in tables and may be NULL for
+// properties that don't need any, i.e., style properties.
+bool ParseDeclarationValue(const StringPiece &value,
+                           SceneGraph *graph,
+                           Declaration *declaration);
+
+}  // namespace internal
+}  // namespace metrosvg
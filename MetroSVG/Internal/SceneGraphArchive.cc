@@ -0,0 +1,641 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/SceneGraphArchive.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace metrosvg {
+namespace internal {
+
+const uint32_t kSceneGraphArchiveVersion = 1;
+
+namespace {
+
+const char kArchiveMagic[4] = {'M', 'S', 'V', 'G'};
+
+class ArchiveWriter {
+ public:
+  explicit ArchiveWriter(std::string *output)
+      : output_(output) {}
+
+  void WriteBytes(const void *bytes, size_t size) {
+    // |bytes| is NULL for the data of an empty table.
+    if (size == 0) {
+      return;
+    }
+    output_->append(reinterpret_cast<const char *>(bytes), size);
+  }
+
+  void WriteUint32(uint32_t value) {
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void WriteFloat(Float value) {
+    double double_value = value;
+    WriteBytes(&double_value, sizeof(double_value));
+  }
+
+  void WriteString(const std::string &value) {
+    WriteUint32(static_cast<uint32_t>(value.size()));
+    WriteBytes(value.data(), value.size());
+  }
+
+  void WriteColor(const RgbColor &color) {
+    WriteFloat(color.red());
+    WriteFloat(color.green());
+    WriteFloat(color.blue());
+  }
+
+  void WriteLength(const Length &length) {
+    WriteFloat(length.value);
+    WriteUint32(length.unit);
+  }
+
+  void WriteRect(const FloatRect &rect) {
+    WriteFloat(rect.origin.x);
+    WriteFloat(rect.origin.y);
+    WriteFloat(rect.size.width);
+    WriteFloat(rect.size.height);
+  }
+
+  void WriteTransform(const AffineTransform &transform) {
+    WriteFloat(transform.a);
+    WriteFloat(transform.b);
+    WriteFloat(transform.c);
+    WriteFloat(transform.d);
+    WriteFloat(transform.tx);
+    WriteFloat(transform.ty);
+  }
+
+ private:
+  std::string *output_;
+};
+
+// All Read* functions return false without consuming anything if the
+// remaining data is too short.
+class ArchiveReader {
+ public:
+  ArchiveReader(const char *data, size_t data_length)
+      : data_(data), remaining_(data_length) {}
+
+  bool ReadBytes(void *bytes, size_t size) {
+    if (remaining_ < size) {
+      return false;
+    }
+    // |bytes| is NULL for the data of an empty table.
+    if (size == 0) {
+      return true;
+    }
+    memcpy(bytes, data_, size);
+    data_ += size;
+    remaining_ -= size;
+    return true;
+  }
+
+  bool ReadUint32(uint32_t *value) {
+    return ReadBytes(value, sizeof(*value));
+  }
+
+  // Reads a uint32 into a size_t.
+  bool ReadIndex(size_t *value) {
+    uint32_t index;
+    if (!ReadUint32(&index)) {
+      return false;
+    }
+    *value = index;
+    return true;
+  }
+
+  // Reads the number of records in a table, rejecting counts that can't
+  // fit in the remaining data so that a corrupt count doesn't cause a huge
+  // allocation.
+  bool ReadCount(size_t min_record_size, size_t *count) {
+    if (!ReadIndex(count)) {
+      return false;
+    }
+    return *count <= remaining_ / min_record_size;
+  }
+
+  bool ReadFloat(Float *value) {
+    double double_value;
+    if (!ReadBytes(&double_value, sizeof(double_value))) {
+      return false;
+    }
+    *value = static_cast<Float>(double_value);
+    return true;
+  }
+
+  bool ReadString(std::string *value) {
+    size_t size;
+    if (!ReadCount(1, &size)) {
+      return false;
+    }
+    value->assign(data_, size);
+    data_ += size;
+    remaining_ -= size;
+    return true;
+  }
+
+  bool ReadColor(RgbColor *color) {
+    Float red, green, blue;
+    if (!ReadFloat(&red) || !ReadFloat(&green) || !ReadFloat(&blue)) {
+      return false;
+    }
+    *color = RgbColor(red, green, blue);
+    return true;
+  }
+
+  bool ReadLength(Length *length) {
+    uint32_t unit;
+    if (!ReadFloat(&length->value) || !ReadUint32(&unit) ||
+        unit > Length::kUnitPx) {
+      return false;
+    }
+    length->unit = static_cast<Length::Unit>(unit);
+    return true;
+  }
+
+  bool ReadRect(FloatRect *rect) {
+    return ReadFloat(&rect->origin.x) &&
+           ReadFloat(&rect->origin.y) &&
+           ReadFloat(&rect->size.width) &&
+           ReadFloat(&rect->size.height);
+  }
+
+  bool ReadTransform(AffineTransform *transform) {
+    return ReadFloat(&transform->a) &&
+           ReadFloat(&transform->b) &&
+           ReadFloat(&transform->c) &&
+           ReadFloat(&transform->d) &&
+           ReadFloat(&transform->tx) &&
+           ReadFloat(&transform->ty);
+  }
+
+  size_t remaining() const { return remaining_; }
+
+ private:
+  const char *data_;
+  size_t remaining_;
+};
+
+// Flags of SceneGraph::Element.
+enum {
+  kElementFlagIsEmpty = 1 << 0,
+  kElementFlagIsValid = 1 << 1,
+};
+
+void WriteElement(const SceneGraph::Element &element, ArchiveWriter *writer) {
+  writer->WriteUint32(element.type);
+  writer->WriteUint32(static_cast<uint32_t>(element.line_number));
+  writer->WriteUint32(static_cast<uint32_t>(element.column_number));
+  writer->WriteUint32((element.is_empty ? kElementFlagIsEmpty : 0) |
+                      (element.is_valid ? kElementFlagIsValid : 0));
+  writer->WriteUint32(static_cast<uint32_t>(element.end));
+  writer->WriteUint32(static_cast<uint32_t>(element.declaration_begin));
+  writer->WriteUint32(static_cast<uint32_t>(element.class_declaration_begin));
+  writer->WriteUint32(static_cast<uint32_t>(element.style_declaration_begin));
+  writer->WriteUint32(static_cast<uint32_t>(element.declaration_end));
+  writer->WriteUint32(static_cast<uint32_t>(element.class_name));
+  for (Float parameter : element.parameters) {
+    writer->WriteFloat(parameter);
+  }
+  writer->WriteUint32(static_cast<uint32_t>(element.verb_begin));
+  writer->WriteUint32(static_cast<uint32_t>(element.verb_end));
+  writer->WriteUint32(static_cast<uint32_t>(element.coord_begin));
+  writer->WriteUint32(static_cast<uint32_t>(element.index));
+}
+
+bool ReadElement(ArchiveReader *reader, SceneGraph::Element *element) {
+  uint32_t type, line_number, column_number, flags;
+  if (!reader->ReadUint32(&type) || type > kElementTypeSvg ||
+      !reader->ReadUint32(&line_number) ||
+      !reader->ReadUint32(&column_number) ||
+      !reader->ReadUint32(&flags)) {
+    return false;
+  }
+  element->type = static_cast<ElementType>(type);
+  element->line_number = static_cast<int>(line_number);
+  element->column_number = static_cast<int>(column_number);
+  element->is_empty = (flags & kElementFlagIsEmpty) != 0;
+  element->is_valid = (flags & kElementFlagIsValid) != 0;
+  if (!reader->ReadIndex(&element->end) ||
+      !reader->ReadIndex(&element->declaration_begin) ||
+      !reader->ReadIndex(&element->class_declaration_begin) ||
+      !reader->ReadIndex(&element->style_declaration_begin) ||
+      !reader->ReadIndex(&element->declaration_end) ||
+      !reader->ReadIndex(&element->class_name)) {
+    return false;
+  }
+  for (Float &parameter : element->parameters) {
+    if (!reader->ReadFloat(&parameter)) {
+      return false;
+    }
+  }
+  return reader->ReadIndex(&element->verb_begin) &&
+         reader->ReadIndex(&element->verb_end) &&
+         reader->ReadIndex(&element->coord_begin) &&
+         reader->ReadIndex(&element->index);
+}
+
+void WriteDeclaration(const Declaration &declaration, ArchiveWriter *writer) {
+  writer->WriteUint32(declaration.property);
+  writer->WriteUint32(static_cast<uint32_t>(declaration.keyword));
+  writer->WriteFloat(declaration.number);
+  writer->WriteColor(declaration.color);
+  writer->WriteUint32(static_cast<uint32_t>(declaration.index));
+  writer->WriteUint32(static_cast<uint32_t>(declaration.count));
+  writer->WriteString(declaration.iri);
+}
+
+bool ReadDeclaration(ArchiveReader *reader, Declaration *declaration) {
+  uint32_t property, keyword;
+  if (!reader->ReadUint32(&property) ||
+      property > kPropertyStrokeDashoffset ||
+      !reader->ReadUint32(&keyword)) {
+    return false;
+  }
+  declaration->property = static_cast<Property>(property);
+  declaration->keyword = static_cast<int>(keyword);
+  return reader->ReadFloat(&declaration->number) &&
+         reader->ReadColor(&declaration->color) &&
+         reader->ReadIndex(&declaration->index) &&
+         reader->ReadIndex(&declaration->count) &&
+         reader->ReadString(&declaration->iri);
+}
+
+void WriteGradient(const Gradient &gradient, ArchiveWriter *writer) {
+  writer->WriteUint32(gradient.type);
+  writer->WriteString(gradient.id);
+  writer->WriteUint32(gradient.units);
+  writer->WriteUint32(static_cast<uint32_t>(gradient.transforms.size()));
+  for (const AffineTransform &transform : gradient.transforms) {
+    writer->WriteTransform(transform);
+  }
+  if (gradient.type == Gradient::kTypeLinear) {
+    writer->WriteLength(gradient.linear.x1);
+    writer->WriteLength(gradient.linear.y1);
+    writer->WriteLength(gradient.linear.x2);
+    writer->WriteLength(gradient.linear.y2);
+  } else {
+    writer->WriteLength(gradient.radial.fx);
+    writer->WriteLength(gradient.radial.fy);
+    writer->WriteLength(gradient.radial.cx);
+    writer->WriteLength(gradient.radial.cy);
+    writer->WriteLength(gradient.radial.r);
+  }
+}
+
+bool ReadGradient(ArchiveReader *reader, std::vector<Gradient> *gradients) {
+  uint32_t type;
+  if (!reader->ReadUint32(&type) || type > Gradient::kTypeRadial) {
+    return false;
+  }
+  gradients->emplace_back(static_cast<Gradient::Type>(type), AttributeTable());
+  Gradient *gradient = &gradients->back();
+
+  uint32_t units;
+  size_t transform_count;
+  if (!reader->ReadString(&gradient->id) ||
+      !reader->ReadUint32(&units) ||
+      units > Gradient::kUnitsUserSpaceOnUse ||
+      !reader->ReadCount(6 * sizeof(double), &transform_count)) {
+    return false;
+  }
+  gradient->units = static_cast<Gradient::Units>(units);
+  gradient->transforms.resize(transform_count);
+  for (AffineTransform &transform : gradient->transforms) {
+    if (!reader->ReadTransform(&transform)) {
+      return false;
+    }
+  }
+  if (gradient->type == Gradient::kTypeLinear) {
+    return reader->ReadLength(&gradient->linear.x1) &&
+           reader->ReadLength(&gradient->linear.y1) &&
+           reader->ReadLength(&gradient->linear.x2) &&
+           reader->ReadLength(&gradient->linear.y2);
+  } else {
+    return reader->ReadLength(&gradient->radial.fx) &&
+           reader->ReadLength(&gradient->radial.fy) &&
+           reader->ReadLength(&gradient->radial.cx) &&
+           reader->ReadLength(&gradient->radial.cy) &&
+           reader->ReadLength(&gradient->radial.r);
+  }
+}
+
+void WriteViewport(const SceneGraph::Viewport &viewport,
+                   ArchiveWriter *writer) {
+  writer->WriteLength(viewport.width);
+  writer->WriteLength(viewport.height);
+  writer->WriteUint32(viewport.has_view_box);
+  writer->WriteRect(viewport.view_box);
+  const PreserveAspectRatio &aspect_ratio = viewport.aspect_ratio;
+  writer->WriteUint32(aspect_ratio.defer);
+  writer->WriteUint32(aspect_ratio.no_alignment);
+  writer->WriteUint32(aspect_ratio.x_alignment);
+  writer->WriteUint32(aspect_ratio.y_alignment);
+  writer->WriteUint32(aspect_ratio.meet_or_slice);
+}
+
+bool ReadViewport(ArchiveReader *reader, SceneGraph::Viewport *viewport) {
+  uint32_t has_view_box;
+  if (!reader->ReadLength(&viewport->width) ||
+      !reader->ReadLength(&viewport->height) ||
+      !reader->ReadUint32(&has_view_box) ||
+      !reader->ReadRect(&viewport->view_box)) {
+    return false;
+  }
+  viewport->has_view_box = has_view_box != 0;
+
+  uint32_t defer, no_alignment, x_alignment, y_alignment, meet_or_slice;
+  if (!reader->ReadUint32(&defer) ||
+      !reader->ReadUint32(&no_alignment) ||
+      !reader->ReadUint32(&x_alignment) ||
+      x_alignment > PreserveAspectRatio::kMax ||
+      !reader->ReadUint32(&y_alignment) ||
+      y_alignment > PreserveAspectRatio::kMax ||
+      !reader->ReadUint32(&meet_or_slice) ||
+      meet_or_slice > PreserveAspectRatio::kSlice) {
+    return false;
+  }
+  PreserveAspectRatio *aspect_ratio = &viewport->aspect_ratio;
+  aspect_ratio->defer = defer != 0;
+  aspect_ratio->no_alignment = no_alignment != 0;
+  aspect_ratio->x_alignment =
+      static_cast<PreserveAspectRatio::Alignment>(x_alignment);
+  aspect_ratio->y_alignment =
+      static_cast<PreserveAspectRatio::Alignment>(y_alignment);
+  aspect_ratio->meet_or_slice =
+      static_cast<PreserveAspectRatio::MeetOrSlice>(meet_or_slice);
+  return true;
+}
+
+// Reads a table written as a count followed by records.
+template <typename T, typename ReadRecord>
+bool ReadTable(ArchiveReader *reader,
+               size_t min_record_size,
+               ReadRecord read_record,
+               std::vector<T> *table) {
+  size_t count;
+  if (!reader->ReadCount(min_record_size, &count)) {
+    return false;
+  }
+  table->reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (!read_record(reader, table)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsValidDeclaration(const SceneGraph &graph,
+                        const Declaration &declaration) {
+  switch (declaration.property) {
+    case kPropertyFill:
+    case kPropertyStroke:
+      return declaration.keyword >= kPaintTypeNone &&
+             declaration.keyword <= kPaintTypeIri;
+    case kPropertyStrokeLinecap:
+      return declaration.keyword >= kLineCapButt &&
+             declaration.keyword <= kLineCapSquare;
+    case kPropertyStrokeLinejoin:
+      return declaration.keyword >= kLineJoinMiter &&
+             declaration.keyword <= kLineJoinBevel;
+    case kPropertyFillRule:
+      return declaration.keyword == kFillRuleNonZero ||
+             declaration.keyword == kFillRuleEvenOdd;
+    case kPropertyTransform:
+      return declaration.index < graph.transforms.size();
+    case kPropertyStrokeDasharray:
+      return declaration.index <= graph.dash_values.size() &&
+             declaration.count <=
+                 graph.dash_values.size() - declaration.index;
+    default:
+      return true;
+  }
+}
+
+// Checks that all indexes in the graph refer to existing records, so that
+// the renderer can use them without checking.
+bool IsValidSceneGraph(const SceneGraph &graph) {
+  for (const Declaration &declaration : graph.declarations) {
+    if (!IsValidDeclaration(graph, declaration)) {
+      return false;
+    }
+  }
+  for (uint8_t verb : graph.path_verbs) {
+    if (verb > kPathVerbClose) {
+      return false;
+    }
+  }
+
+  // Ends of the open ancestors of the current element.
+  std::vector<size_t> ancestor_ends;
+  for (size_t i = 0; i < graph.elements.size(); ++i) {
+    const SceneGraph::Element &element = graph.elements[i];
+    while (!ancestor_ends.empty() && ancestor_ends.back() <= i) {
+      ancestor_ends.pop_back();
+    }
+    if (element.end <= i ||
+        element.end > graph.elements.size() ||
+        (!ancestor_ends.empty() && element.end > ancestor_ends.back())) {
+      return false;
+    }
+    ancestor_ends.push_back(element.end);
+
+    if (element.declaration_begin > element.class_declaration_begin ||
+        element.class_declaration_begin > element.style_declaration_begin ||
+        element.style_declaration_begin > element.declaration_end ||
+        element.declaration_end > graph.declarations.size() ||
+        element.class_name >= graph.strings.size()) {
+      return false;
+    }
+
+    switch (element.type) {
+      case kElementTypePath:
+      case kElementTypePolygon:
+      case kElementTypePolyline: {
+        if (element.verb_begin > element.verb_end ||
+            element.verb_end > graph.path_verbs.size() ||
+            element.coord_begin > graph.path_coords.size()) {
+          return false;
+        }
+        size_t coord_count = 0;
+        for (size_t v = element.verb_begin; v < element.verb_end; ++v) {
+          coord_count += PathVerbCoordinateCount(
+              static_cast<PathVerb>(graph.path_verbs[v]));
+        }
+        if (coord_count > graph.path_coords.size() - element.coord_begin) {
+          return false;
+        }
+        break;
+      }
+      case kElementTypeLinearGradient:
+      case kElementTypeRadialGradient:
+        if (element.index >= graph.gradients.size()) {
+          return false;
+        }
+        break;
+      case kElementTypeSvg:
+        if (element.is_valid && element.index >= graph.viewports.size()) {
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+void SerializeSceneGraph(const SceneGraph &graph,
+                         FloatSize image_size,
+                         FloatRect view_box,
+                         std::string *output) {
+  ArchiveWriter writer(output);
+  writer.WriteBytes(kArchiveMagic, sizeof(kArchiveMagic));
+  writer.WriteUint32(kSceneGraphArchiveVersion);
+
+  writer.WriteFloat(image_size.width);
+  writer.WriteFloat(image_size.height);
+  writer.WriteRect(view_box);
+
+  writer.WriteUint32(static_cast<uint32_t>(graph.elements.size()));
+  for (const SceneGraph::Element &element : graph.elements) {
+    WriteElement(element, &writer);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.declarations.size()));
+  for (const Declaration &declaration : graph.declarations) {
+    WriteDeclaration(declaration, &writer);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.transforms.size()));
+  for (const AffineTransform &transform : graph.transforms) {
+    writer.WriteTransform(transform);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.dash_values.size()));
+  for (Float dash_value : graph.dash_values) {
+    writer.WriteFloat(dash_value);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.strings.size()));
+  for (const std::string &string : graph.strings) {
+    writer.WriteString(string);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.path_verbs.size()));
+  writer.WriteBytes(graph.path_verbs.data(), graph.path_verbs.size());
+  writer.WriteUint32(static_cast<uint32_t>(graph.path_coords.size()));
+  for (Float coord : graph.path_coords) {
+    writer.WriteFloat(coord);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.gradients.size()));
+  for (const Gradient &gradient : graph.gradients) {
+    WriteGradient(gradient, &writer);
+  }
+  writer.WriteUint32(static_cast<uint32_t>(graph.viewports.size()));
+  for (const SceneGraph::Viewport &viewport : graph.viewports) {
+    WriteViewport(viewport, &writer);
+  }
+}
+
+SceneGraph *DeserializeSceneGraph(const char *data,
+                                  size_t data_length,
+                                  FloatSize *image_size,
+                                  FloatRect *view_box) {
+  ArchiveReader reader(data, data_length);
+  char magic[sizeof(kArchiveMagic)];
+  uint32_t version;
+  if (!reader.ReadBytes(magic, sizeof(magic)) ||
+      memcmp(magic, kArchiveMagic, sizeof(magic)) != 0 ||
+      !reader.ReadUint32(&version) ||
+      version != kSceneGraphArchiveVersion) {
+    return NULL;
+  }
+
+  FloatSize size;
+  FloatRect box;
+  if (!reader.ReadFloat(&size.width) ||
+      !reader.ReadFloat(&size.height) ||
+      !reader.ReadRect(&box)) {
+    return NULL;
+  }
+
+  std::unique_ptr<SceneGraph> graph(new SceneGraph);
+  bool success =
+      ReadTable(&reader, 4, [](ArchiveReader *reader,
+                               std::vector<SceneGraph::Element> *elements) {
+        elements->emplace_back();
+        return ReadElement(reader, &elements->back());
+      }, &graph->elements) &&
+      ReadTable(&reader, 4, [](ArchiveReader *reader,
+                               std::vector<Declaration> *declarations) {
+        declarations->emplace_back(kPropertyFill);
+        return ReadDeclaration(reader, &declarations->back());
+      }, &graph->declarations) &&
+      ReadTable(&reader, 6 * sizeof(double), [](
+          ArchiveReader *reader, std::vector<AffineTransform> *transforms) {
+        transforms->emplace_back();
+        return reader->ReadTransform(&transforms->back());
+      }, &graph->transforms) &&
+      ReadTable(&reader, sizeof(double), [](ArchiveReader *reader,
+                                            std::vector<Float> *values) {
+        values->emplace_back();
+        return reader->ReadFloat(&values->back());
+      }, &graph->dash_values) &&
+      ReadTable(&reader, 4, [](ArchiveReader *reader,
+                               std::vector<std::string> *strings) {
+        strings->emplace_back();
+        return reader->ReadString(&strings->back());
+      }, &graph->strings);
+  if (!success) {
+    return NULL;
+  }
+
+  size_t verb_count;
+  if (!reader.ReadCount(1, &verb_count)) {
+    return NULL;
+  }
+  graph->path_verbs.resize(verb_count);
+  if (!reader.ReadBytes(graph->path_verbs.data(), verb_count)) {
+    return NULL;
+  }
+
+  success =
+      ReadTable(&reader, sizeof(double), [](ArchiveReader *reader,
+                                            std::vector<Float> *values) {
+        values->emplace_back();
+        return reader->ReadFloat(&values->back());
+      }, &graph->path_coords) &&
+      ReadTable(&reader, 4, ReadGradient, &graph->gradients) &&
+      ReadTable(&reader, 4, [](ArchiveReader *reader,
+                               std::vector<SceneGraph::Viewport> *viewports) {
+        viewports->emplace_back();
+        return ReadViewport(reader, &viewports->back());
+      }, &graph->viewports);
+  if (!success || reader.remaining() != 0 || !IsValidSceneGraph(*graph)) {
+    return NULL;
+  }
+
+  *image_size = size;
+  *view_box = box;
+  return graph.release();
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/SceneGraph.h"
+
+namespace metrosvg {
+namespace internal {
+
+// Version of the serialized form written by SerializeSceneGraph. It must be
+// incremented whenever the layout of the data or the meaning of any stored
+// value changes, e.g., when an enum used in SceneGraph is reordered.
+extern const uint32_t kSceneGraphArchiveVersion;
+
+// The serialized form consists of a header with a magic number and the
+// version, the image metadata of the document, and then each table of the
+// graph as a count followed by fixed-size records. Values are stored in host
+// byte order, and floating-point values are always stored as doubles. The
+// records are read with memcpy, so the data doesn't need to be aligned and
+// can be read directly from a memory-mapped file.
+
+// Appends the serialized form of a graph, along with the image size and
+// viewBox of the document it came from, to |output|.
+void SerializeSceneGraph(const SceneGraph &graph,
+                         FloatSize image_size,
+                         FloatRect view_box,
+                         std::string *output);
+
+// Reads data written by SerializeSceneGraph. Returns NULL if the data is
+// truncated or malformed, or was written with a different version.
+// Caller should release the returned instance.
+SceneGraph *DeserializeSceneGraph(const char *data,
+                                  size_t data_length,
+                                  FloatSize *image_size,
+                                  FloatRect *view_box);
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/SceneGraph.h"
+#include "MetroSVG/Internal/SceneGraphArchive.h"
+
+using namespace metrosvg::internal;
+
+static const char kTestData[] =
+    "<svg width='20' height='10' viewBox='0 0 40 20'>"
+    "<linearGradient id='g' x2='50%'><stop offset='1'/></linearGradient>"
+    "<g transform='rotate(30)' stroke-dasharray='1 2' class='c'>"
+    "<path d='M0 0 L10 10 A5 5 0 0 1 20 20 z' fill='url(#g)'/>"
+    "</g></svg>";
+
+static std::string SerializeTestData() {
+  std::unique_ptr<SceneGraph> graph(
+      ParseSceneGraph(kTestData, sizeof(kTestData) - 1, NULL));
+  std::string data;
+  SerializeSceneGraph(*graph, FloatSize(20, 10), FloatRect(0, 0, 40, 20),
+                      &data);
+  return data;
+}
+
+@interface SceneGraphArchiveTest : XCTestCase
+@end
+
+@implementation SceneGraphArchiveTest
+
+- (void)testDeserializeSceneGraph_RoundTrip {
+  std::unique_ptr<SceneGraph> graph(
+      ParseSceneGraph(kTestData, sizeof(kTestData) - 1, NULL));
+  std::string data = SerializeTestData();
+
+  FloatSize size;
+  FloatRect view_box;
+  std::unique_ptr<SceneGraph> loaded_graph(
+      DeserializeSceneGraph(data.data(), data.size(), &size, &view_box));
+  XCTAssert(loaded_graph != NULL);
+  XCTAssert((size == FloatSize(20, 10)));
+  XCTAssert((view_box == FloatRect(0, 0, 40, 20)));
+
+  XCTAssertEqual(loaded_graph->elements.size(), graph->elements.size());
+  for (size_t i = 0; i < graph->elements.size(); ++i) {
+    XCTAssertEqual(loaded_graph->elements[i].type, graph->elements[i].type);
+    XCTAssertEqual(loaded_graph->elements[i].end, graph->elements[i].end);
+    XCTAssertEqual(loaded_graph->elements[i].is_empty,
+                   graph->elements[i].is_empty);
+  }
+  XCTAssertEqual(loaded_graph->declarations.size(),
+                 graph->declarations.size());
+  XCTAssertEqual(loaded_graph->declarations.back().iri, "#g");
+  XCTAssertEqual(loaded_graph->transforms.size(), graph->transforms.size());
+  XCTAssert((loaded_graph->transforms[0] == graph->transforms[0]));
+  XCTAssert(loaded_graph->dash_values == graph->dash_values);
+  XCTAssert(loaded_graph->strings == graph->strings);
+  XCTAssert(loaded_graph->path_verbs == graph->path_verbs);
+  XCTAssert(loaded_graph->path_coords == graph->path_coords);
+  XCTAssertEqual(loaded_graph->gradients.size(), 1U);
+  XCTAssertEqual(loaded_graph->gradients[0].id, "g");
+  XCTAssertEqual(loaded_graph->gradients[0].linear.x2.value, 50);
+  XCTAssertEqual(loaded_graph->gradients[0].linear.x2.unit,
+                 Length::kUnitPercent);
+  XCTAssertEqual(loaded_graph->viewports.size(), 1U);
+  XCTAssert((loaded_graph->viewports[0].view_box == FloatRect(0, 0, 40, 20)));
+}
+
+- (void)testDeserializeSceneGraph_EmptyTables {
+  const char kData[] = "<svg/>";
+  std::unique_ptr<SceneGraph> graph(
+      ParseSceneGraph(kData, sizeof(kData) - 1, NULL));
+  std::string data;
+  SerializeSceneGraph(*graph, FloatSize(100, 100), FloatRect::Null(), &data);
+
+  FloatSize size;
+  FloatRect view_box;
+  std::unique_ptr<SceneGraph> loaded_graph(
+      DeserializeSceneGraph(data.data(), data.size(), &size, &view_box));
+  XCTAssert(loaded_graph != NULL);
+  XCTAssertEqual(loaded_graph->elements.size(), 1U);
+  XCTAssert(loaded_graph->declarations.empty());
+  XCTAssert(loaded_graph->path_coords.empty());
+}
+
+- (void)testDeserializeSceneGraph_Truncated {
+  std::string data = SerializeTestData();
+  FloatSize size;
+  FloatRect view_box;
+  for (size_t length = 0; length < data.size(); ++length) {
+    std::unique_ptr<SceneGraph> graph(
+        DeserializeSceneGraph(data.data(), length, &size, &view_box));
+    XCTAssert(graph == NULL);
+  }
+}
+
+- (void)testDeserializeSceneGraph_WrongVersion {
+  std::string data = SerializeTestData();
+  uint32_t version = kSceneGraphArchiveVersion + 1;
+  memcpy(&data[4], &version, sizeof(version));
+  FloatSize size;
+  FloatRect view_box;
+  std::unique_ptr<SceneGraph> graph(
+      DeserializeSceneGraph(data.data(), data.size(), &size, &view_box));
+  XCTAssert(graph == NULL);
+}
+
+- (void)testDeserializeSceneGraph_NotAnArchive {
+  FloatSize size;
+  FloatRect view_box;
+  std::unique_ptr<SceneGraph> graph(
+      DeserializeSceneGraph(kTestData, sizeof(kTestData) - 1,
+                            &size, &view_box));
+  XCTAssert(graph == NULL);
+}
+
+- (void)testDeserializeSceneGraph_CorruptIndex {
+  std::unique_ptr<SceneGraph> graph(
+      ParseSceneGraph(kTestData, sizeof(kTestData) - 1, NULL));
+  // Points past the end of the element table.
+  graph->elements[0].end = graph->elements.size() + 1;
+  std::string data;
+  SerializeSceneGraph(*graph, FloatSize(), FloatRect::Null(), &data);
+  FloatSize size;
+  FloatRect view_box;
+  std::unique_ptr<SceneGraph> loaded_graph(
+      DeserializeSceneGraph(data.data(), data.size(), &size, &view_box));
+  XCTAssert(loaded_graph == NULL);
+}
+
+@end
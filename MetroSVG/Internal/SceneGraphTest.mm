@@ -0,0 +1,231 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/SceneGraph.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+using namespace metrosvg::internal;
+
+static SceneGraph *ParseString(const std::string &data) {
+  return ParseSceneGraph(data.c_str(), data.size(), NULL);
+}
+
+@interface SceneGraphTest : XCTestCase
+@end
+
+@implementation SceneGraphTest
+
+- (void)testParseSceneGraph_ElementTree {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><g><rect width='1' height='2'/><foo/></g><circle r='3'/></svg>"));
+  XCTAssert(graph != NULL);
+  XCTAssertEqual(graph->elements.size(), 5U);
+  XCTAssertEqual(graph->elements[0].type, kElementTypeSvg);
+  XCTAssertEqual(graph->elements[0].end, 5U);
+  XCTAssertEqual(graph->elements[1].type, kElementTypeG);
+  XCTAssertEqual(graph->elements[1].end, 4U);
+  XCTAssertEqual(graph->elements[2].type, kElementTypeRect);
+  XCTAssertEqual(graph->elements[2].end, 3U);
+  XCTAssertTrue(graph->elements[2].is_empty);
+  XCTAssertEqual(graph->elements[3].type, kElementTypeUnknown);
+  XCTAssertEqual(graph->elements[4].type, kElementTypeCircle);
+  XCTAssertEqual(graph->elements[4].parameters[2], 3);
+  XCTAssertFalse(graph->elements[0].is_empty);
+}
+
+- (void)testParseSceneGraph_MalformedData {
+  std::unique_ptr<SceneGraph> graph(ParseString("<svg><rect></svg>"));
+  XCTAssert(graph == NULL);
+}
+
+- (void)testParseSceneGraph_InvalidElement {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><circle r='-1'/><rect width='10'/></svg>"));
+  XCTAssert(graph != NULL);
+  XCTAssertFalse(graph->elements[1].is_valid);
+  XCTAssertFalse(graph->elements[2].is_valid);
+}
+
+- (void)testParseSceneGraph_AttributesWithEntityReferences {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<!DOCTYPE svg [<!ENTITY w '10'><!ENTITY h '20'>]>"
+      "<svg><rect x='1&#32;' width='&w;' height='&h;'/></svg>"));
+  XCTAssert(graph != NULL);
+  const SceneGraph::Element &rect = graph->elements[1];
+  XCTAssertTrue(rect.is_valid);
+  XCTAssertEqual(rect.parameters[0], 1);
+  XCTAssertEqual(rect.parameters[2], 10);
+  XCTAssertEqual(rect.parameters[3], 20);
+}
+
+- (void)testParseSceneGraph_DeclarationOrder {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><style type='text/css'>.a { stroke: blue; }</style>"
+      "<rect class='a' style='fill: green' fill='red' opacity='0.5'/></svg>"));
+  XCTAssert(graph != NULL);
+  const SceneGraph::Element &rect = graph->elements[2];
+  XCTAssertEqual(rect.class_declaration_begin - rect.declaration_begin, 2U);
+  XCTAssertEqual(rect.style_declaration_begin - rect.class_declaration_begin,
+                 1U);
+  XCTAssertEqual(rect.declaration_end - rect.style_declaration_begin, 1U);
+  XCTAssertEqual(graph->declarations[rect.declaration_begin].property,
+                 kPropertyFill);
+  XCTAssertEqual(graph->declarations[rect.class_declaration_begin].property,
+                 kPropertyStroke);
+  XCTAssertEqual(graph->declarations[rect.style_declaration_begin].property,
+                 kPropertyFill);
+  XCTAssertEqual(graph->strings[rect.class_name], "a");
+}
+
+- (void)testParseSceneGraph_StyleSheetAppliesToFollowingElements {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><rect class='a'/>"
+      "<style type='text/css'>.a { fill: blue; }</style>"
+      "<rect class='a'/></svg>"));
+  XCTAssert(graph != NULL);
+  const SceneGraph::Element &first = graph->elements[1];
+  const SceneGraph::Element &second = graph->elements[3];
+  XCTAssertEqual(first.style_declaration_begin, first.class_declaration_begin);
+  XCTAssertEqual(second.style_declaration_begin - second.class_declaration_begin,
+                 1U);
+}
+
+- (void)testParseSceneGraph_PathData {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><path d='M1 2 l3 4 z'/><polygon points='0 0 1 1'/></svg>"));
+  XCTAssert(graph != NULL);
+  const SceneGraph::Element &path = graph->elements[1];
+  XCTAssertEqual(path.verb_end - path.verb_begin, 3U);
+  XCTAssertEqual(graph->path_verbs[path.verb_begin], kPathVerbMoveTo);
+  XCTAssertEqual(graph->path_verbs[path.verb_begin + 1], kPathVerbLineTo);
+  XCTAssertEqual(graph->path_verbs[path.verb_begin + 2], kPathVerbClose);
+  XCTAssertEqual(graph->path_coords[path.coord_begin + 2], 4);
+  XCTAssertEqual(graph->path_coords[path.coord_begin + 3], 6);
+
+  const SceneGraph::Element &polygon = graph->elements[2];
+  XCTAssertEqual(polygon.verb_end - polygon.verb_begin, 3U);
+  XCTAssertEqual(graph->path_verbs[polygon.verb_end - 1], kPathVerbClose);
+}
+
+- (void)testSceneGraphStreamParser {
+  std::string data =
+      "<!DOCTYPE svg [<!ENTITY w '10'>]>\n"
+      "<svg width='&w;' height='20'>\n"
+      "  <style type='text/css'>.a { fill: blue; }</style>\n"
+      "  <linearGradient id='g'/>\n"
+      "  <g><rect class='a' width='&w;' height='5'></rect></g>\n"
+      "</svg>";
+  std::unique_ptr<SceneGraph> expected_graph(ParseString(data));
+  XCTAssert(expected_graph != NULL);
+  // Chunks end anywhere, including within names and references.
+  for (size_t chunk_length : {1, 5, 1000}) {
+    SceneGraphStreamParser parser(NULL);
+    for (size_t i = 0; i < data.size(); i += chunk_length) {
+      std::string chunk = data.substr(i, chunk_length);
+      XCTAssert(parser.ParseChunk(chunk.data(), chunk.size()));
+    }
+    XCTAssert(parser.has_svg_element());
+    XCTAssertEqual(parser.svg_attributes().size(), 2U);
+    XCTAssertEqual(parser.svg_attributes()[0].first, "width");
+    XCTAssertEqual(parser.svg_attributes()[0].second, "10");
+    std::unique_ptr<SceneGraph> graph(parser.Finish());
+    XCTAssert(graph != NULL);
+    XCTAssertEqual(graph->elements.size(), expected_graph->elements.size());
+    for (size_t i = 0; i < graph->elements.size(); ++i) {
+      const SceneGraph::Element &element = graph->elements[i];
+      const SceneGraph::Element &expected_element =
+          expected_graph->elements[i];
+      XCTAssertEqual(element.type, expected_element.type);
+      XCTAssertEqual(element.end, expected_element.end);
+      XCTAssertEqual(element.is_empty, expected_element.is_empty);
+      XCTAssertEqual(element.declaration_end - element.declaration_begin,
+                     expected_element.declaration_end -
+                         expected_element.declaration_begin);
+    }
+    XCTAssertEqual(graph->elements[4].parameters[2], 10);
+  }
+}
+
+- (void)testSceneGraphStreamParser_MalformedData {
+  SceneGraphStreamParser parser(NULL);
+  XCTAssert(parser.ParseChunk("<svg><rect>", 11));
+  XCTAssertFalse(parser.ParseChunk("</svg>", 6));
+  XCTAssertFalse(parser.ParseChunk("</rect>", 7));
+  XCTAssert(parser.Finish() == NULL);
+
+  SceneGraphStreamParser truncated_parser(NULL);
+  XCTAssert(truncated_parser.ParseChunk("<svg><rect/>", 12));
+  XCTAssert(truncated_parser.Finish() == NULL);
+}
+
+- (void)testGetPathBounds {
+  std::unique_ptr<SceneGraph> graph(ParseString(
+      "<svg><path d='M1 2 l3 4 Q 10 0 5 5 z m1 -1 h2'/>"
+      "<path d='M0 0 A 2 2 0 0 1 4 0'/><path d=''/></svg>"));
+  XCTAssert(graph != NULL);
+  FloatRect bounds = GetPathBounds(*graph, graph->elements[1]);
+  XCTAssertTrue(bounds == FloatRect(1, 0, 9, 6));
+
+  // The arc bulges 2 units above its end points.
+  bounds = GetPathBounds(*graph, graph->elements[2]);
+  XCTAssertLessThanOrEqual(bounds.min_y(), -2);
+  XCTAssertLessThanOrEqual(bounds.min_x(), 0);
+  XCTAssertGreaterThanOrEqual(bounds.max_x(), 4);
+
+  XCTAssertTrue((GetPathBounds(*graph, graph->elements[3])).IsNull());
+}
+
+- (void)testParseDeclarationValue_Paint {
+  Declaration declaration(kPropertyFill);
+  XCTAssertTrue(ParseDeclarationValue("none", NULL, &declaration));
+  XCTAssertEqual(declaration.keyword, kPaintTypeNone);
+  XCTAssertTrue(ParseDeclarationValue("#ff0000", NULL, &declaration));
+  XCTAssertEqual(declaration.keyword, kPaintTypeColor);
+  XCTAssertEqual(declaration.color.red(), 1);
+  XCTAssertTrue(ParseDeclarationValue("url(#grad)", NULL, &declaration));
+  XCTAssertEqual(declaration.keyword, kPaintTypeIri);
+  XCTAssertEqual(declaration.iri, "#grad");
+  XCTAssertFalse(ParseDeclarationValue("bogus(", NULL, &declaration));
+}
+
+- (void)testParseDeclarationValue_Transform {
+  SceneGraph graph;
+  Declaration declaration(kPropertyTransform);
+  XCTAssertTrue(ParseDeclarationValue("translate(10 20) scale(2)", &graph,
+                                      &declaration));
+  XCTAssertEqual(graph.transforms.size(), 1U);
+  AffineTransform transform = graph.transforms[declaration.index];
+  XCTAssert((transform == AffineTransform(2, 0, 0, 2, 10, 20)));
+}
+
+- (void)testParseDeclarationValue_Dasharray {
+  SceneGraph graph;
+  Declaration declaration(kPropertyStrokeDasharray);
+  XCTAssertTrue(ParseDeclarationValue("1 2", &graph, &declaration));
+  XCTAssertEqual(declaration.count, 2U);
+  XCTAssertEqual(graph.dash_values[declaration.index + 1], 2);
+  XCTAssertTrue(ParseDeclarationValue("0 0", &graph, &declaration));
+  XCTAssertEqual(declaration.count, 0U);
+  XCTAssertTrue(ParseDeclarationValue("none", &graph, &declaration));
+  XCTAssertEqual(declaration.count, 0U);
+}
+
+@end
@@ -0,0 +1,819 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/SoftwareCanvas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "MetroSVG/Internal/Compositing.h"
+#include "MetroSVG/Internal/Constants.h"
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/Utils.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Maximum distance in pixels between a curve and the line segments that
+// approximate it.
+const Float kFlatteningTolerance = 0.1;
+
+// Returns an upper bound of how much |transform| scales lengths.
+Float MaxScaleOfTransform(const AffineTransform &transform) {
+  return std::max(std::hypot(transform.a, transform.b),
+                  std::hypot(transform.c, transform.d));
+}
+
+bool IsInvertible(const AffineTransform &transform) {
+  Float determinant = transform.a * transform.d - transform.b * transform.c;
+  return determinant != 0 && std::isfinite(determinant);
+}
+
+// Number of line segments needed to approximate a curve whose second
+// differences of control points are at most |second_difference| long.
+int CurveSegmentCount(Float second_difference, Float factor) {
+  Float count = std::ceil(std::sqrt(second_difference * factor /
+                                    kFlatteningTolerance));
+  if (!(count >= 1)) {
+    return 1;
+  }
+  return static_cast<int>(std::min(count, Float(256)));
+}
+
+void ToPremultipliedColor(const Float rgba[4], Float alpha,
+                          uint8_t color[4]) {
+  Float a = ClampToUnitRange(rgba[3]) * alpha;
+  for (int i = 0; i < 3; ++i) {
+    color[i] = static_cast<uint8_t>(
+        std::lround(ClampToUnitRange(rgba[i]) * a * 255));
+  }
+  color[3] = static_cast<uint8_t>(std::lround(a * 255));
+}
+
+// Swaps the red and blue channels of |count| pixels, converting them
+// between RGBA and BGRA.
+void SwapRedAndBlue(uint8_t *pixels, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    std::swap(pixels[i * 4], pixels[i * 4 + 2]);
+  }
+}
+
+// Maps gradient parameters to entries of a gradient color table, clamping
+// them to [0, 1] first. NaN maps to the first entry. The loop is kept
+// simple so that compilers vectorize it.
+void ColorTableIndices(const float *t, size_t count, int32_t *indices) {
+  const float scale = Gradient::kColorTableSize - 1;
+  for (size_t i = 0; i < count; ++i) {
+    float value = t[i] > 0 ? t[i] : 0;
+    value = value < 1 ? value : 1;
+    indices[i] = static_cast<int32_t>(value * scale + 0.5f);
+  }
+}
+
+}  // namespace
+
+SoftwareCanvas::SoftwareCanvas(size_t width, size_t height)
+    : width_(width),
+      height_(height),
+      owned_pixels_(width * height * 4, 0),
+      pixels_(owned_pixels_.data()),
+      bytes_per_row_(width * 4),
+      swaps_red_and_blue_(false) {
+  Initialize();
+}
+
+SoftwareCanvas::SoftwareCanvas(size_t width,
+                               size_t height,
+                               void *pixels,
+                               size_t bytes_per_row,
+                               MSCPixelFormat format)
+    : width_(width),
+      height_(height),
+      pixels_(static_cast<uint8_t *>(pixels)),
+      bytes_per_row_(bytes_per_row),
+      swaps_red_and_blue_(format == kMSCPixelFormatBGRA8888) {
+  for (size_t y = 0; y < height; ++y) {
+    memset(pixels_ + y * bytes_per_row, 0, width * 4);
+  }
+  Initialize();
+}
+
+SoftwareCanvas::~SoftwareCanvas() {}
+
+void SoftwareCanvas::Initialize() {
+  GraphicsState initial_state;
+  initial_state.ctm = AffineTransform();
+  initial_state.alpha = 1;
+  for (int i = 0; i < 3; ++i) {
+    initial_state.fill_color[i] = 0;
+    initial_state.stroke_color[i] = 0;
+  }
+  initial_state.fill_color[3] = 1;
+  initial_state.stroke_color[3] = 1;
+  initial_state.clip.bounds =
+      PixelRect(0, 0, static_cast<int>(width_), static_cast<int>(height_));
+  state_stack_.push_back(initial_state);
+  coverage_row_.resize(width_);
+}
+
+void SoftwareCanvas::SaveGState() {
+  state_stack_.push_back(state_stack_.back());
+}
+
+void SoftwareCanvas::RestoreGState() {
+  // Like CoreGraphics, ignore unbalanced calls.
+  if (state_stack_.size() > 1) {
+    state_stack_.pop_back();
+  }
+}
+
+void SoftwareCanvas::ConcatCTM(const AffineTransform &transform) {
+  state().ctm = ConcatTransforms(transform, state().ctm);
+}
+
+void SoftwareCanvas::SetAlpha(Float alpha) {
+  state().alpha = ClampToUnitRange(alpha);
+}
+
+void SoftwareCanvas::SetRGBFillColor(Float red,
+                                     Float green,
+                                     Float blue,
+                                     Float alpha) {
+  Float *color = state().fill_color;
+  color[0] = red;
+  color[1] = green;
+  color[2] = blue;
+  color[3] = alpha;
+}
+
+void SoftwareCanvas::SetRGBStrokeColor(Float red,
+                                       Float green,
+                                       Float blue,
+                                       Float alpha) {
+  Float *color = state().stroke_color;
+  color[0] = red;
+  color[1] = green;
+  color[2] = blue;
+  color[3] = alpha;
+}
+
+void SoftwareCanvas::SetLineWidth(Float width) {
+  state().stroke_style.width = width;
+}
+
+void SoftwareCanvas::SetLineCap(LineCap cap) {
+  state().stroke_style.cap = cap;
+}
+
+void SoftwareCanvas::SetLineJoin(LineJoin join) {
+  state().stroke_style.join = join;
+}
+
+void SoftwareCanvas::SetMiterLimit(Float limit) {
+  state().stroke_style.miter_limit = limit;
+}
+
+void SoftwareCanvas::SetLineDash(Float phase,
+                                 const Float *lengths,
+                                 size_t count) {
+  LineDash *line_dash = &state().stroke_style.line_dash;
+  line_dash->dash_values.assign(lengths, lengths + count);
+  line_dash->phase = phase;
+}
+
+void SoftwareCanvas::ClipToRect(FloatRect rect) {
+  const AffineTransform &ctm = state().ctm;
+  if (ctm.b == 0 && ctm.c == 0) {
+    // Rectangles that are aligned to pixels only shrink the clip bounds.
+    FloatRect device_rect = ApplyTransform(rect, ctm);
+    Float edges[4] = {
+      device_rect.min_x(), device_rect.min_y(),
+      device_rect.max_x(), device_rect.max_y(),
+    };
+    bool is_aligned = true;
+    for (Float edge : edges) {
+      is_aligned = is_aligned && std::fabs(edge - std::round(edge)) < 1e-6;
+    }
+    if (is_aligned) {
+      Float limits[4] = {
+        0, 0, static_cast<Float>(width_), static_cast<Float>(height_),
+      };
+      int values[4];
+      for (int i = 0; i < 4; ++i) {
+        values[i] = static_cast<int>(std::round(
+            std::min(std::max(edges[i], Float(0)), limits[i % 2 + 2])));
+      }
+      ClipState &clip = state().clip;
+      clip.bounds = clip.bounds.Intersection(
+          PixelRect(values[0], values[1], values[2], values[3]));
+      return;
+    }
+  }
+  FloatPoint corners[4] = {
+    ApplyTransform(FloatPoint(rect.min_x(), rect.min_y()), ctm),
+    ApplyTransform(FloatPoint(rect.max_x(), rect.min_y()), ctm),
+    ApplyTransform(FloatPoint(rect.max_x(), rect.max_y()), ctm),
+    ApplyTransform(FloatPoint(rect.min_x(), rect.max_y()), ctm),
+  };
+  rasterizer_.Reset();
+  rasterizer_.AddPolygon(corners, 4);
+  IntersectClip(kFillRuleNonZero);
+}
+
+void SoftwareCanvas::BeginTransparencyLayer() {
+  Layer layer;
+  layer.bounds = PaintBounds();
+  layer.pixels.assign(
+      static_cast<size_t>(layer.bounds.width()) * layer.bounds.height() * 4,
+      0);
+  layer.alpha = state().alpha;
+  layer.clip = state().clip;
+  layers_.push_back(std::move(layer));
+  SaveGState();
+  state().alpha = 1;
+}
+
+void SoftwareCanvas::EndTransparencyLayer() {
+  if (layers_.empty()) {
+    return;
+  }
+  Layer layer = std::move(layers_.back());
+  layers_.pop_back();
+  RestoreGState();
+
+  // Only the painted pixels of the layer need to be composited.
+  PixelRect bounds =
+      layer.painted_bounds.Intersection(layer.clip.bounds).Intersection(
+          PaintBounds());
+  if (bounds.IsEmpty()) {
+    return;
+  }
+  uint8_t alpha = static_cast<uint8_t>(std::lround(layer.alpha * 255));
+  size_t count = bounds.width();
+  for (int y = bounds.y0; y < bounds.y1; ++y) {
+    const uint8_t *mask = layer.clip.MaskRow(bounds.x0, y);
+    if (mask) {
+      for (size_t i = 0; i < count; ++i) {
+        coverage_row_[i] = static_cast<uint8_t>(DivideBy255(mask[i] * alpha));
+      }
+    } else {
+      std::fill(coverage_row_.begin(), coverage_row_.begin() + count, alpha);
+    }
+    size_t layer_offset =
+        static_cast<size_t>(y - layer.bounds.y0) * layer.bounds.width() +
+        (bounds.x0 - layer.bounds.x0);
+    CompositeSpan(PixelAddress(bounds.x0, y),
+                  layer.pixels.data() + layer_offset * 4,
+                  coverage_row_.data(), count);
+  }
+  MarkPainted(bounds);
+}
+
+void SoftwareCanvas::BeginPath() {
+  path_.clear();
+}
+
+void SoftwareCanvas::MoveToPoint(Float x, Float y) {
+  Subpath subpath;
+  subpath.closed = false;
+  path_.push_back(std::move(subpath));
+  AddPathPoint(FloatPoint(x, y));
+}
+
+void SoftwareCanvas::AddLineToPoint(Float x, Float y) {
+  AddPathPoint(FloatPoint(x, y));
+}
+
+void SoftwareCanvas::AddCurveToPoint(Float cp1x, Float cp1y,
+                                     Float cp2x, Float cp2y,
+                                     Float x, Float y) {
+  if (path_.empty()) {
+    AddPathPoint(FloatPoint(x, y));
+    return;
+  }
+  const AffineTransform &ctm = state().ctm;
+  FloatPoint p0 = CurrentDevicePoint();
+  FloatPoint p1 = ApplyTransform(FloatPoint(cp1x, cp1y), ctm);
+  FloatPoint p2 = ApplyTransform(FloatPoint(cp2x, cp2y), ctm);
+  FloatPoint p3 = ApplyTransform(FloatPoint(x, y), ctm);
+  Float second_difference = std::max(
+      std::hypot(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y),
+      std::hypot(p1.x - 2 * p2.x + p3.x, p1.y - 2 * p2.y + p3.y));
+  int segment_count = CurveSegmentCount(second_difference, 0.75);
+  for (int i = 1; i <= segment_count; ++i) {
+    Float t = static_cast<Float>(i) / segment_count;
+    Float u = 1 - t;
+    Float w0 = u * u * u;
+    Float w1 = 3 * u * u * t;
+    Float w2 = 3 * u * t * t;
+    Float w3 = t * t * t;
+    AddDevicePoint(
+        FloatPoint(w0 * p0.x + w1 * p1.x + w2 * p2.x + w3 * p3.x,
+                   w0 * p0.y + w1 * p1.y + w2 * p2.y + w3 * p3.y));
+  }
+}
+
+void SoftwareCanvas::AddQuadCurveToPoint(Float cpx, Float cpy,
+                                         Float x, Float y) {
+  if (path_.empty()) {
+    AddPathPoint(FloatPoint(x, y));
+    return;
+  }
+  const AffineTransform &ctm = state().ctm;
+  FloatPoint p0 = CurrentDevicePoint();
+  FloatPoint p1 = ApplyTransform(FloatPoint(cpx, cpy), ctm);
+  FloatPoint p2 = ApplyTransform(FloatPoint(x, y), ctm);
+  Float second_difference =
+      std::hypot(p0.x - 2 * p1.x + p2.x, p0.y - 2 * p1.y + p2.y);
+  int segment_count = CurveSegmentCount(second_difference, 0.25);
+  for (int i = 1; i <= segment_count; ++i) {
+    Float t = static_cast<Float>(i) / segment_count;
+    Float u = 1 - t;
+    AddDevicePoint(
+        FloatPoint(u * u * p0.x + 2 * u * t * p1.x + t * t * p2.x,
+                   u * u * p0.y + 2 * u * t * p1.y + t * t * p2.y));
+  }
+}
+
+void SoftwareCanvas::AddArc(const AffineTransform *transform,
+                            Float x, Float y, Float radius,
+                            Float start_angle, Float end_angle,
+                            bool clockwise) {
+  // Same as CoreGraphics, angles increase counterclockwise in a coordinate
+  // system whose y axis points up, and a difference of a full turn or more
+  // makes a full circle.
+  Float sweep = end_angle - start_angle;
+  if (std::fabs(sweep) >= 2 * kPi) {
+    sweep = clockwise ? -2 * kPi : 2 * kPi;
+  } else if (clockwise && sweep > 0) {
+    sweep -= 2 * kPi;
+  } else if (!clockwise && sweep < 0) {
+    sweep += 2 * kPi;
+  }
+  AffineTransform arc_transform(radius, 0, 0, radius, x, y);
+  if (transform) {
+    arc_transform = ConcatTransforms(arc_transform, *transform);
+  }
+  AddArcPoints(arc_transform, start_angle, sweep);
+}
+
+void SoftwareCanvas::AddEllipseInRect(FloatRect rect) {
+  AffineTransform transform(rect.width() / 2, 0,
+                            0, rect.height() / 2,
+                            rect.mid_x(), rect.mid_y());
+  MoveToPoint(rect.max_x(), rect.mid_y());
+  AddArcPoints(transform, 0, 2 * kPi);
+  ClosePath();
+}
+
+void SoftwareCanvas::AddRoundedRect(FloatRect rect,
+                                    Float corner_width,
+                                    Float corner_height) {
+  rect = rect.Standardized();
+  Float min_x = rect.min_x();
+  Float min_y = rect.min_y();
+  Float max_x = rect.max_x();
+  Float max_y = rect.max_y();
+  if (corner_width <= 0 || corner_height <= 0) {
+    MoveToPoint(min_x, min_y);
+    AddLineToPoint(max_x, min_y);
+    AddLineToPoint(max_x, max_y);
+    AddLineToPoint(min_x, max_y);
+    ClosePath();
+    return;
+  }
+  MoveToPoint(max_x, min_y + corner_height);
+  Float corner_x[4] = {max_x - corner_width, min_x + corner_width,
+                         min_x + corner_width, max_x - corner_width};
+  Float corner_y[4] = {max_y - corner_height, max_y - corner_height,
+                         min_y + corner_height, min_y + corner_height};
+  for (int i = 0; i < 4; ++i) {
+    AffineTransform transform =
+        AffineTransform(corner_width, 0, 0, corner_height,
+                        corner_x[i], corner_y[i]);
+    AddArcPoints(transform, i * kPi / 2, kPi / 2);
+  }
+  ClosePath();
+}
+
+void SoftwareCanvas::ClosePath() {
+  if (!path_.empty()) {
+    path_.back().closed = true;
+  }
+}
+
+FloatPoint SoftwareCanvas::GetPathCurrentPoint() {
+  if (path_.empty() || !IsInvertible(state().ctm)) {
+    return FloatPoint();
+  }
+  return ApplyTransform(CurrentDevicePoint(), InvertTransform(state().ctm));
+}
+
+FloatRect SoftwareCanvas::GetPathBoundingBox() {
+  if (path_.empty() || !IsInvertible(state().ctm)) {
+    return FloatRect::Null();
+  }
+  AffineTransform inverse = InvertTransform(state().ctm);
+  FloatPoint first_point = ApplyTransform(path_[0].points[0], inverse);
+  Float min_x = first_point.x;
+  Float min_y = first_point.y;
+  Float max_x = first_point.x;
+  Float max_y = first_point.y;
+  for (const Subpath &subpath : path_) {
+    for (FloatPoint device_point : subpath.points) {
+      FloatPoint point = ApplyTransform(device_point, inverse);
+      min_x = std::min(min_x, point.x);
+      min_y = std::min(min_y, point.y);
+      max_x = std::max(max_x, point.x);
+      max_y = std::max(max_y, point.y);
+    }
+  }
+  return FloatRect(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+FloatRect SoftwareCanvas::GetClipBoundingBox() {
+  const PixelRect &bounds = state().clip.bounds;
+  if (bounds.IsEmpty() || !IsInvertible(state().ctm)) {
+    return FloatRect::Null();
+  }
+  FloatRect device_rect(bounds.x0, bounds.y0,
+                        bounds.width(), bounds.height());
+  return ApplyTransform(device_rect, InvertTransform(state().ctm));
+}
+
+void SoftwareCanvas::FillPath(FillRule fill_rule) {
+  rasterizer_.Reset();
+  for (const Subpath &subpath : path_) {
+    rasterizer_.AddPolygon(subpath.points.data(), subpath.points.size());
+  }
+  path_.clear();
+  uint8_t color[4];
+  GetDeviceColor(state().fill_color, color);
+  PaintRasterizedArea(fill_rule, color);
+}
+
+void SoftwareCanvas::StrokePath() {
+  rasterizer_.Reset();
+  StrokeCurrentPath([this](const FloatPoint *points, size_t count) {
+    rasterizer_.AddPolygon(points, count);
+  });
+  path_.clear();
+  uint8_t color[4];
+  GetDeviceColor(state().stroke_color, color);
+  PaintRasterizedArea(kFillRuleNonZero, color);
+}
+
+void SoftwareCanvas::ReplacePathWithStrokedPath() {
+  std::vector<Subpath> stroked_path;
+  StrokeCurrentPath([&stroked_path](const FloatPoint *points, size_t count) {
+    Subpath subpath;
+    subpath.points.assign(points, points + count);
+    subpath.closed = true;
+    stroked_path.push_back(std::move(subpath));
+  });
+  path_.swap(stroked_path);
+}
+
+void SoftwareCanvas::Clip() {
+  rasterizer_.Reset();
+  for (const Subpath &subpath : path_) {
+    rasterizer_.AddPolygon(subpath.points.data(), subpath.points.size());
+  }
+  path_.clear();
+  IntersectClip(kFillRuleNonZero);
+}
+
+void SoftwareCanvas::DrawLinearGradient(const Gradient &gradient,
+                                        FloatPoint start_point,
+                                        FloatPoint end_point) {
+  Float dx = end_point.x - start_point.x;
+  Float dy = end_point.y - start_point.y;
+  Float length_squared = dx * dx + dy * dy;
+  if (length_squared == 0) {
+    return;
+  }
+  DrawGradient(gradient, [&](FloatPoint point, FloatPoint step, size_t count,
+                              float *t) {
+    // The parameter changes by the same amount from pixel to pixel.
+    Float t0 = ((point.x - start_point.x) * dx +
+                (point.y - start_point.y) * dy) / length_squared;
+    Float dt = (step.x * dx + step.y * dy) / length_squared;
+    for (size_t i = 0; i < count; ++i) {
+      t[i] = static_cast<float>(t0 + i * dt);
+    }
+  });
+}
+
+void SoftwareCanvas::DrawRadialGradient(const Gradient &gradient,
+                                        FloatPoint focal_point,
+                                        FloatPoint center_point,
+                                        Float radius) {
+  // The gradient is made of the circles interpolated between a circle of
+  // radius 0 at |focal_point| (t = 0) and the circle of |radius| at
+  // |center_point| (t = 1). A point takes the largest t of the circles
+  // through it, which is a root of a * t^2 - 2 * b * t + c = 0.
+  Float cdx = center_point.x - focal_point.x;
+  Float cdy = center_point.y - focal_point.y;
+  Float a = cdx * cdx + cdy * cdy - radius * radius;
+  const float kNotPainted = std::numeric_limits<float>::quiet_NaN();
+  DrawGradient(gradient, [&](FloatPoint point, FloatPoint step, size_t count,
+                              float *t) {
+    for (size_t i = 0; i < count; ++i) {
+      Float pdx = point.x + i * step.x - focal_point.x;
+      Float pdy = point.y + i * step.y - focal_point.y;
+      Float b = pdx * cdx + pdy * cdy;
+      Float c = pdx * pdx + pdy * pdy;
+      Float root_t;
+      if (a == 0) {
+        if (b == 0) {
+          t[i] = kNotPainted;
+          continue;
+        }
+        root_t = c / (2 * b);
+      } else {
+        Float discriminant = b * b - a * c;
+        if (discriminant < 0) {
+          t[i] = kNotPainted;
+          continue;
+        }
+        Float root = std::sqrt(discriminant);
+        root_t = std::max((b + root) / a, (b - root) / a);
+      }
+      // Circles with negative radii aren't painted.
+      t[i] = root_t >= 0 ? static_cast<float>(root_t) : kNotPainted;
+    }
+  });
+}
+
+void SoftwareCanvas::ReadPixels(void *pixels, size_t bytes_per_row) {
+  for (size_t y = 0; y < height_; ++y) {
+    uint8_t *row = static_cast<uint8_t *>(pixels) + y * bytes_per_row;
+    memcpy(row, pixels_ + y * bytes_per_row_, width_ * 4);
+    if (swaps_red_and_blue_) {
+      SwapRedAndBlue(row, width_);
+    }
+  }
+}
+
+const uint8_t *SoftwareCanvas::ClipState::MaskRow(int x, int y) const {
+  if (!mask) {
+    return NULL;
+  }
+  size_t offset =
+      static_cast<size_t>(y - mask_bounds.y0) * mask_bounds.width() +
+      (x - mask_bounds.x0);
+  return mask->data() + offset;
+}
+
+void SoftwareCanvas::GetDeviceColor(const Float rgba[4], uint8_t color[4]) {
+  ToPremultipliedColor(rgba, state().alpha, color);
+  if (swaps_red_and_blue_) {
+    SwapRedAndBlue(color, 1);
+  }
+}
+
+uint8_t *SoftwareCanvas::PixelAddress(int x, int y) {
+  if (layers_.empty()) {
+    return pixels_ + static_cast<size_t>(y) * bytes_per_row_ + x * 4;
+  }
+  Layer &layer = layers_.back();
+  size_t offset =
+      static_cast<size_t>(y - layer.bounds.y0) * layer.bounds.width() +
+      (x - layer.bounds.x0);
+  return layer.pixels.data() + offset * 4;
+}
+
+PixelRect SoftwareCanvas::PaintBounds() {
+  const PixelRect &clip_bounds = state().clip.bounds;
+  if (layers_.empty()) {
+    return clip_bounds;
+  }
+  // The clip can only be larger than the layer if the graphics states
+  // aren't balanced within the layer.
+  return clip_bounds.Intersection(layers_.back().bounds);
+}
+
+void SoftwareCanvas::MarkPainted(const PixelRect &rect) {
+  if (!layers_.empty()) {
+    Layer &layer = layers_.back();
+    layer.painted_bounds = layer.painted_bounds.Union(rect);
+  }
+}
+
+void SoftwareCanvas::AddPathPoint(FloatPoint point) {
+  AddDevicePoint(ApplyTransform(point, state().ctm));
+}
+
+void SoftwareCanvas::AddDevicePoint(FloatPoint point) {
+  if (path_.empty() || path_.back().closed) {
+    // A segment after a closed subpath starts from its first point, and
+    // a segment without a current point starts at its end.
+    Subpath subpath;
+    subpath.closed = false;
+    if (!path_.empty()) {
+      subpath.points.push_back(path_.back().points[0]);
+    }
+    path_.push_back(std::move(subpath));
+  }
+  path_.back().points.push_back(point);
+}
+
+void SoftwareCanvas::AddArcPoints(const AffineTransform &transform,
+                                  Float start_angle,
+                                  Float sweep) {
+  AffineTransform device_transform = ConcatTransforms(transform, state().ctm);
+  Float radius = MaxScaleOfTransform(device_transform);
+  Float step_angle = kPi / 2;
+  if (radius > kFlatteningTolerance) {
+    step_angle = std::min(step_angle,
+                          2 * std::acos(1 - kFlatteningTolerance / radius));
+  }
+  // The number of steps is a multiple of 4 so that the points of full
+  // ellipses include their extreme points.
+  Float quarter_step_count = std::ceil(std::fabs(sweep) / step_angle / 4);
+  if (!(quarter_step_count >= 1)) {
+    quarter_step_count = 1;
+  }
+  int step_count =
+      static_cast<int>(std::min(quarter_step_count, Float(256))) * 4;
+  for (int i = 0; i <= step_count; ++i) {
+    Float angle = start_angle + sweep * i / step_count;
+    AddPathPoint(ApplyTransform(
+        FloatPoint(std::cos(angle), std::sin(angle)), transform));
+  }
+}
+
+FloatPoint SoftwareCanvas::CurrentDevicePoint() const {
+  if (path_.empty()) {
+    return FloatPoint();
+  }
+  const Subpath &subpath = path_.back();
+  return subpath.closed ? subpath.points.front() : subpath.points.back();
+}
+
+void SoftwareCanvas::StrokeCurrentPath(const PolygonCallback &add_polygon) {
+  const GraphicsState &current_state = state();
+  const AffineTransform &ctm = current_state.ctm;
+  if (!IsInvertible(ctm)) {
+    return;
+  }
+  // Strokes are computed in user space, where the pen is round, and then
+  // transformed to device space.
+  AffineTransform inverse = InvertTransform(ctm);
+  Float tolerance = kFlatteningTolerance / MaxScaleOfTransform(ctm);
+  std::vector<FloatPoint> device_polygon;
+  PolygonCallback add_device_polygon =
+      [&ctm, &device_polygon, &add_polygon](const FloatPoint *polygon,
+                                             size_t count) {
+    device_polygon.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      device_polygon[i] = ApplyTransform(polygon[i], ctm);
+    }
+    add_polygon(device_polygon.data(), count);
+  };
+  std::vector<std::vector<FloatPoint>> user_subpaths(path_.size());
+  Float total_length = 0;
+  for (size_t i = 0; i < path_.size(); ++i) {
+    const Subpath &subpath = path_[i];
+    std::vector<FloatPoint> &points = user_subpaths[i];
+    points.resize(subpath.points.size());
+    for (size_t j = 0; j < points.size(); ++j) {
+      points[j] = ApplyTransform(subpath.points[j], inverse);
+    }
+    total_length += PolylineLength(points.data(), points.size(),
+                                   subpath.closed);
+  }
+  // The number of dashes is bounded for the whole path.
+  StrokeStyle solid_style;
+  const StrokeStyle *style = &current_state.stroke_style;
+  if (!ShouldDashPolylines(*style, total_length, tolerance)) {
+    solid_style = *style;
+    solid_style.line_dash = LineDash();
+    style = &solid_style;
+  }
+  for (size_t i = 0; i < path_.size(); ++i) {
+    const std::vector<FloatPoint> &points = user_subpaths[i];
+    StrokeDashedPolyline(points.data(), points.size(), path_[i].closed,
+                         *style, tolerance, add_device_polygon);
+  }
+}
+
+void SoftwareCanvas::PaintRasterizedArea(FillRule fill_rule,
+                                         const uint8_t color[4]) {
+  if (color[3] == 0) {
+    return;
+  }
+  const ClipState &clip = state().clip;
+  rasterizer_.Rasterize(
+      fill_rule, PaintBounds(),
+      [this, &clip, color](int y, int x, int count,
+                           const uint8_t *coverage) {
+    const uint8_t *mask = clip.MaskRow(x, y);
+    if (mask) {
+      for (int i = 0; i < count; ++i) {
+        coverage_row_[i] =
+            static_cast<uint8_t>(DivideBy255(coverage[i] * mask[i]));
+      }
+      coverage = coverage_row_.data();
+    }
+    CompositeSolidSpan(PixelAddress(x, y), coverage, count, color);
+    MarkPainted(PixelRect(x, y, x + count, y + 1));
+  });
+}
+
+void SoftwareCanvas::IntersectClip(FillRule fill_rule) {
+  // The new mask covers the current clip bounds, which is where the
+  // rasterized area can be inside the new clip.
+  ClipState &clip = state().clip;
+  PixelRect mask_bounds = clip.bounds;
+  std::shared_ptr<std::vector<uint8_t>> mask =
+      std::make_shared<std::vector<uint8_t>>(
+          static_cast<size_t>(mask_bounds.width()) * mask_bounds.height(),
+          0);
+  PixelRect bounds;
+  rasterizer_.Rasterize(
+      fill_rule, clip.bounds,
+      [&clip, &mask, &mask_bounds, &bounds](int y, int x, int count,
+                                           const uint8_t *coverage) {
+    size_t offset =
+        static_cast<size_t>(y - mask_bounds.y0) * mask_bounds.width() +
+        (x - mask_bounds.x0);
+    uint8_t *row = mask->data() + offset;
+    const uint8_t *old_row = clip.MaskRow(x, y);
+    if (old_row) {
+      for (int i = 0; i < count; ++i) {
+        row[i] = static_cast<uint8_t>(DivideBy255(coverage[i] * old_row[i]));
+      }
+    } else {
+      memcpy(row, coverage, count);
+    }
+    bounds = bounds.Union(PixelRect(x, y, x + count, y + 1));
+  });
+  clip.bounds = bounds;
+  clip.mask = mask;
+  clip.mask_bounds = mask_bounds;
+}
+
+template<typename ParameterFunction>
+void SoftwareCanvas::DrawGradient(const Gradient &gradient,
+                                  const ParameterFunction &parameter_row) {
+  const GraphicsState &current_state = state();
+  PixelRect bounds = PaintBounds();
+  if (gradient.stops.empty() || bounds.IsEmpty() ||
+      !IsInvertible(current_state.ctm)) {
+    return;
+  }
+  AffineTransform inverse = InvertTransform(current_state.ctm);
+  uint8_t alpha =
+      static_cast<uint8_t>(std::lround(current_state.alpha * 255));
+  const ClipState &clip = current_state.clip;
+  const uint8_t *color_table = gradient.ColorTable();
+  size_t count = bounds.width();
+  std::vector<float> parameters(count);
+  std::vector<int32_t> indices(count);
+  std::vector<uint8_t> colors(count * 4);
+  // The centers of the pixels are stepped through in user space.
+  FloatPoint step(inverse.a, inverse.b);
+  for (int y = bounds.y0; y < bounds.y1; ++y) {
+    const uint8_t *mask = clip.MaskRow(bounds.x0, y);
+    FloatPoint point = ApplyTransform(
+        FloatPoint(bounds.x0 + 0.5, y + 0.5), inverse);
+    parameter_row(point, step, count, parameters.data());
+    ColorTableIndices(parameters.data(), count, indices.data());
+    for (size_t i = 0; i < count; ++i) {
+      memcpy(&colors[i * 4], color_table + indices[i] * 4, 4);
+      if (std::isnan(parameters[i])) {
+        coverage_row_[i] = 0;
+      } else {
+        coverage_row_[i] = mask ?
+            static_cast<uint8_t>(DivideBy255(mask[i] * alpha)) : alpha;
+      }
+    }
+    if (swaps_red_and_blue_) {
+      SwapRedAndBlue(colors.data(), count);
+    }
+    CompositeSpan(PixelAddress(bounds.x0, y), colors.data(),
+                  coverage_row_.data(), count);
+  }
+  MarkPainted(bounds);
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "MetroSVG/Internal/Canvas.h"
+#include "MetroSVG/Internal/Geometry.h"
+#include "MetroSVG/Internal/Macros.h"
+#include "MetroSVG/Internal/Rasterizer.h"
+#include "MetroSVG/Internal/Stroker.h"
+#include "MetroSVG/Public/MSCDocument.h"
+
+namespace metrosvg {
+namespace internal {
+
+// A canvas that renders with the built-in rasterizer into a pixel buffer in
+// memory. It doesn't depend on any graphics library.
+class SoftwareCanvas : public Canvas {
+ public:
+  SoftwareCanvas(size_t width, size_t height);
+  // Renders into |pixels| instead of memory owned by the canvas. |pixels|
+  // must hold |height| rows of |bytes_per_row| bytes, which is at least
+  // 4 * |width|, and outlive the canvas. The pixels are cleared.
+  SoftwareCanvas(size_t width,
+                 size_t height,
+                 void *pixels,
+                 size_t bytes_per_row,
+                 MSCPixelFormat format);
+  virtual ~SoftwareCanvas();
+
+  // The pixels of the canvas, top row first, each row bytes_per_row()
+  // bytes apart. They are in the layout described for ReadPixels unless
+  // the canvas was created with another format.
+  const uint8_t *pixels() const { return pixels_; }
+  size_t bytes_per_row() const { return bytes_per_row_; }
+
+  virtual size_t width() const { return width_; }
+  virtual size_t height() const { return height_; }
+
+  virtual void SaveGState();
+  virtual void RestoreGState();
+  virtual void ConcatCTM(const AffineTransform &transform);
+  virtual void SetAlpha(Float alpha);
+  virtual void SetRGBFillColor(Float red,
+                               Float green,
+                               Float blue,
+                               Float alpha);
+  virtual void SetRGBStrokeColor(Float red,
+                                 Float green,
+                                 Float blue,
+                                 Float alpha);
+  virtual void SetLineWidth(Float width);
+  virtual void SetLineCap(LineCap cap);
+  virtual void SetLineJoin(LineJoin join);
+  virtual void SetMiterLimit(Float limit);
+  virtual void SetLineDash(Float phase,
+                           const Float *lengths,
+                           size_t count);
+  virtual void ClipToRect(FloatRect rect);
+
+  virtual void BeginTransparencyLayer();
+  virtual void EndTransparencyLayer();
+
+  virtual void BeginPath();
+  virtual void MoveToPoint(Float x, Float y);
+  virtual void AddLineToPoint(Float x, Float y);
+  virtual void AddCurveToPoint(Float cp1x, Float cp1y,
+                               Float cp2x, Float cp2y,
+                               Float x, Float y);
+  virtual void AddQuadCurveToPoint(Float cpx, Float cpy,
+                                   Float x, Float y);
+  virtual void AddArc(const AffineTransform *transform,
+                      Float x, Float y, Float radius,
+                      Float start_angle, Float end_angle,
+                      bool clockwise);
+  virtual void AddEllipseInRect(FloatRect rect);
+  virtual void AddRoundedRect(FloatRect rect,
+                              Float corner_width,
+                              Float corner_height);
+  virtual void ClosePath();
+  virtual FloatPoint GetPathCurrentPoint();
+  virtual FloatRect GetPathBoundingBox();
+  virtual FloatRect GetClipBoundingBox();
+
+  virtual void FillPath(FillRule fill_rule);
+  virtual void StrokePath();
+  virtual void ReplacePathWithStrokedPath();
+  virtual void Clip();
+  virtual void DrawLinearGradient(const Gradient &gradient,
+                                  FloatPoint start_point,
+                                  FloatPoint end_point);
+  virtual void DrawRadialGradient(const Gradient &gradient,
+                                  FloatPoint focal_point,
+                                  FloatPoint center_point,
+                                  Float radius);
+
+  virtual void ReadPixels(void *pixels, size_t bytes_per_row);
+
+ private:
+  struct ClipState {
+    // Pixels outside |bounds| are clipped out.
+    PixelRect bounds;
+    // Coverage of the clip for the pixels of |mask_bounds|, which contains
+    // |bounds|, or NULL if all the pixels in |bounds| are fully inside the
+    // clip. Masks are shared between graphics states, and never modified
+    // once set.
+    std::shared_ptr<const std::vector<uint8_t>> mask;
+    PixelRect mask_bounds;
+
+    // Returns the mask values of row |y| from |x| on, or NULL if there's
+    // no mask.
+    const uint8_t *MaskRow(int x, int y) const;
+  };
+
+  struct GraphicsState {
+    AffineTransform ctm;
+    Float alpha;
+    // Unpremultiplied RGBA.
+    Float fill_color[4];
+    Float stroke_color[4];
+    StrokeStyle stroke_style;
+    ClipState clip;
+  };
+
+  // The offscreen pixels of a transparency layer only cover the clip at
+  // the time the layer began.
+  struct Layer {
+    std::vector<uint8_t> pixels;
+    PixelRect bounds;
+    // Bounds of the pixels painted so far.
+    PixelRect painted_bounds;
+    Float alpha;
+    ClipState clip;
+  };
+
+  // Points of the current path are kept in device space, with curves
+  // flattened into line segments.
+  struct Subpath {
+    std::vector<FloatPoint> points;
+    bool closed;
+  };
+
+  size_t width_;
+  size_t height_;
+  // Empty if the pixels are provided by the caller.
+  std::vector<uint8_t> owned_pixels_;
+  uint8_t *pixels_;
+  size_t bytes_per_row_;
+  // Set for kMSCPixelFormatBGRA8888. Pixels, including those of layers,
+  // are then stored with the red and blue channels swapped, which the
+  // compositing kernels don't need to know about.
+  bool swaps_red_and_blue_;
+  std::vector<GraphicsState> state_stack_;
+  std::vector<Layer> layers_;
+  std::vector<Subpath> path_;
+  Rasterizer rasterizer_;
+  // Scratch buffer for a row of coverage values.
+  std::vector<uint8_t> coverage_row_;
+
+  void Initialize();
+
+  GraphicsState &state() { return state_stack_.back(); }
+  // Stores |rgba| in the pixel format of the canvas, premultiplied by its
+  // alpha and the alpha of the graphics state.
+  void GetDeviceColor(const Float rgba[4], uint8_t color[4]);
+  // Returns the address of a pixel of the layer or canvas that drawing
+  // currently goes to.
+  uint8_t *PixelAddress(int x, int y);
+  // Returns the pixels that can be painted, i.e., the clip bounds limited
+  // to the current layer.
+  PixelRect PaintBounds();
+  // Records that |rect| has been painted on the current layer.
+  void MarkPainted(const PixelRect &rect);
+
+  // Appends a point in user space to the current subpath, starting a new
+  // subpath if there's none.
+  void AddPathPoint(FloatPoint point);
+  void AddDevicePoint(FloatPoint point);
+  // Appends the points of an arc. |transform| maps the unit circle to the
+  // ellipse of the arc in user space.
+  void AddArcPoints(const AffineTransform &transform,
+                    Float start_angle,
+                    Float sweep);
+  FloatPoint CurrentDevicePoint() const;
+
+  // Computes the outline of the current path stroked with the current
+  // graphics state, in device space.
+  void StrokeCurrentPath(const PolygonCallback &add_polygon);
+
+  // Paints the area computed by |rasterizer_| with |color|, a
+  // premultiplied color.
+  void PaintRasterizedArea(FillRule fill_rule, const uint8_t color[4]);
+  // Intersects the clip with the area computed by |rasterizer_|.
+  void IntersectClip(FillRule fill_rule);
+
+  // Paints the clip with a gradient, a row of pixels at a time. For each
+  // row, |parameter_row|(point, step, count, t) stores in t[i] the gradient
+  // parameter at |point| + i * |step| in user space, or NaN if the point
+  // isn't painted. Colors are looked up in the color table of |gradient|.
+  template<typename ParameterFunction>
+  void DrawGradient(const Gradient &gradient,
+                    const ParameterFunction &parameter_row);
+
+  DISALLOW_COPY_AND_ASSIGN(SoftwareCanvas);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,400 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Gradient.h"
+#include "MetroSVG/Internal/Renderer.h"
+#include "MetroSVG/Internal/SoftwareCanvas.h"
+#include "MetroSVG/Internal/Utils.h"
+
+using namespace metrosvg::internal;
+
+// Returns the channel |channel| of the pixel at (|x|, |y|).
+static uint8_t PixelValue(const SoftwareCanvas &canvas,
+                          int x, int y, int channel) {
+  return canvas.pixels()[(y * canvas.width() + x) * 4 + channel];
+}
+
+static void AddRect(SoftwareCanvas *canvas, Float x, Float y,
+                    Float width, Float height) {
+  canvas->MoveToPoint(x, y);
+  canvas->AddLineToPoint(x + width, y);
+  canvas->AddLineToPoint(x + width, y + height);
+  canvas->AddLineToPoint(x, y + height);
+  canvas->ClosePath();
+}
+
+// Renders the SVG document |data| onto |canvas|.
+static bool RenderDocument(const std::string &data, SoftwareCanvas *canvas) {
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.data(), data.size(), NULL);
+  Renderer renderer;
+  bool result = renderer.RenderMSCDocument(document, NULL, canvas);
+  MSCDocumentDelete(document);
+  return result;
+}
+
+// Returns the number of pixels of |canvas| that aren't transparent.
+static int PaintedPixelCount(const SoftwareCanvas &canvas) {
+  int count = 0;
+  for (size_t y = 0; y < canvas.height(); ++y) {
+    for (size_t x = 0; x < canvas.width(); ++x) {
+      count += PixelValue(canvas, x, y, 3) != 0;
+    }
+  }
+  return count;
+}
+
+@interface SoftwareCanvasTest : XCTestCase
+@end
+
+@implementation SoftwareCanvasTest
+
+- (void)testFillPath_FillRules {
+  for (FillRule fill_rule : {kFillRuleNonZero, kFillRuleEvenOdd}) {
+    SoftwareCanvas canvas(10, 10);
+    canvas.BeginPath();
+    AddRect(&canvas, 0, 0, 10, 10);
+    AddRect(&canvas, 2, 2, 6, 6);
+    canvas.FillPath(fill_rule);
+    XCTAssertEqual(PixelValue(canvas, 1, 1, 3), 255);
+    XCTAssertEqual(PixelValue(canvas, 5, 5, 3),
+                   fill_rule == kFillRuleNonZero ? 255 : 0);
+  }
+}
+
+- (void)testFillPath_AntiAliasing {
+  SoftwareCanvas canvas(4, 4);
+  canvas.SetRGBFillColor(1, 0, 0, 1);
+  canvas.BeginPath();
+  AddRect(&canvas, 0.5, 0, 3, 4);
+  canvas.FillPath(kFillRuleNonZero);
+  XCTAssertEqual(PixelValue(canvas, 0, 1, 0), 128);
+  XCTAssertEqual(PixelValue(canvas, 0, 1, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 1, 1, 0), 255);
+  XCTAssertEqual(PixelValue(canvas, 3, 1, 3), 128);
+
+  // A triangle covering half of each pixel of the diagonal.
+  SoftwareCanvas triangle_canvas(4, 4);
+  triangle_canvas.BeginPath();
+  triangle_canvas.MoveToPoint(0, 0);
+  triangle_canvas.AddLineToPoint(4, 4);
+  triangle_canvas.AddLineToPoint(0, 4);
+  triangle_canvas.FillPath(kFillRuleNonZero);
+  for (int i = 0; i < 4; ++i) {
+    XCTAssertEqual(PixelValue(triangle_canvas, i, i, 3), 128);
+  }
+  XCTAssertEqual(PixelValue(triangle_canvas, 0, 3, 3), 255);
+  XCTAssertEqual(PixelValue(triangle_canvas, 3, 0, 3), 0);
+}
+
+- (void)testFillPath_OutsideCanvas {
+  SoftwareCanvas canvas(4, 4);
+  canvas.BeginPath();
+  AddRect(&canvas, -100, 1, 102, 2);
+  AddRect(&canvas, 3, -100, 100, 200);
+  canvas.FillPath(kFillRuleNonZero);
+  XCTAssertEqual(PixelValue(canvas, 0, 1, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 1, 2, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 2, 2, 3), 0);
+  XCTAssertEqual(PixelValue(canvas, 3, 0, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 0);
+}
+
+- (void)testFillPath_HugeCoordinates {
+  // The edges reach far beyond the range of floats in device space.
+  SoftwareCanvas canvas(4, 4);
+  canvas.ConcatCTM(AffineTransform::MakeScale(100, 100));
+  canvas.BeginPath();
+  canvas.MoveToPoint(1e38, 0);
+  canvas.AddLineToPoint(-1e38, 0.02);
+  canvas.AddLineToPoint(0, 0.04);
+  canvas.FillPath(kFillRuleNonZero);
+  // The first edge crosses the canvas at y = 1.
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 0);
+  XCTAssertEqual(PixelValue(canvas, 3, 0, 3), 0);
+  XCTAssertEqual(PixelValue(canvas, 0, 1, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 3, 3, 3), 255);
+
+  SoftwareCanvas document_canvas(40, 40);
+  XCTAssert(RenderDocument(
+      "<svg width='40' height='40'>"
+      "<path d='M 1e38 0 L -1e38 10 L 0 20 z' transform='scale(100)'/>"
+      "</svg>", &document_canvas));
+  XCTAssertEqual(PaintedPixelCount(document_canvas), 0);
+}
+
+- (void)testFillPath_Alpha {
+  SoftwareCanvas canvas(2, 2);
+  canvas.SetRGBFillColor(1, 1, 1, 0.5);
+  canvas.SetAlpha(0.5);
+  canvas.BeginPath();
+  AddRect(&canvas, 0, 0, 2, 2);
+  canvas.FillPath(kFillRuleNonZero);
+  // Premultiplied.
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 0), 64);
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 64);
+}
+
+- (void)testStrokePath_LineCaps {
+  for (LineCap cap : {kLineCapButt, kLineCapSquare, kLineCapRound}) {
+    SoftwareCanvas canvas(10, 4);
+    canvas.SetLineWidth(2);
+    canvas.SetLineCap(cap);
+    canvas.BeginPath();
+    canvas.MoveToPoint(3, 2);
+    canvas.AddLineToPoint(7, 2);
+    canvas.StrokePath();
+    XCTAssertEqual(PixelValue(canvas, 5, 1, 3), 255);
+    XCTAssertEqual(PixelValue(canvas, 5, 0, 3), 0);
+    if (cap == kLineCapButt) {
+      XCTAssertEqual(PixelValue(canvas, 2, 1, 3), 0);
+    } else if (cap == kLineCapSquare) {
+      XCTAssertEqual(PixelValue(canvas, 2, 1, 3), 255);
+    } else {
+      uint8_t value = PixelValue(canvas, 2, 1, 3);
+      XCTAssert(value > 0 && value < 255);
+    }
+  }
+}
+
+- (void)testStrokePath_LineJoins {
+  // The outer corner of a right angle.
+  for (LineJoin join : {kLineJoinMiter, kLineJoinBevel}) {
+    SoftwareCanvas canvas(10, 10);
+    canvas.SetLineWidth(4);
+    canvas.SetLineJoin(join);
+    canvas.BeginPath();
+    canvas.MoveToPoint(2, 8);
+    canvas.AddLineToPoint(8, 8);
+    canvas.AddLineToPoint(8, 2);
+    canvas.StrokePath();
+    XCTAssertEqual(PixelValue(canvas, 9, 9, 3),
+                   join == kLineJoinMiter ? 255 : 0);
+    XCTAssertEqual(PixelValue(canvas, 7, 7, 3), 255);
+  }
+
+  // The miter of a right angle is sqrt(2) times the line width.
+  SoftwareCanvas canvas(10, 10);
+  canvas.SetLineWidth(4);
+  canvas.SetMiterLimit(1.4);
+  canvas.BeginPath();
+  canvas.MoveToPoint(2, 8);
+  canvas.AddLineToPoint(8, 8);
+  canvas.AddLineToPoint(8, 2);
+  canvas.StrokePath();
+  XCTAssertEqual(PixelValue(canvas, 9, 9, 3), 0);
+}
+
+- (void)testStrokePath_Dashes {
+  SoftwareCanvas canvas(12, 2);
+  canvas.SetLineWidth(2);
+  Float lengths[] = {2, 1};
+  canvas.SetLineDash(1, lengths, 2);
+  canvas.BeginPath();
+  canvas.MoveToPoint(0, 1);
+  canvas.AddLineToPoint(12, 1);
+  canvas.StrokePath();
+  // The pattern starts 1 unit into the first dash.
+  uint8_t expected[] = {255, 0, 255, 255, 0, 255, 255, 0, 255, 255, 0, 255};
+  for (int x = 0; x < 12; ++x) {
+    XCTAssertEqual(PixelValue(canvas, x, 0, 3), expected[x]);
+  }
+}
+
+- (void)testStrokePath_DegenerateArc {
+  // The arc is scaled up to radii that overflow.
+  SoftwareCanvas canvas(40, 40);
+  XCTAssert(RenderDocument(
+      "<svg width='40' height='40'>"
+      "<path d='M 0 0 A 1e-30 1e30 0 0 1 20 10' stroke='black'/>"
+      "</svg>", &canvas));
+}
+
+- (void)testStrokePath_TinyDashes {
+  // Patterns shorter than the tolerance are stroked solid.
+  SoftwareCanvas solid_canvas(40, 4);
+  XCTAssert(RenderDocument(
+      "<svg width='40' height='4'>"
+      "<path d='M 9 2 L 31 2' stroke='black'/></svg>", &solid_canvas));
+  SoftwareCanvas canvas(40, 4);
+  XCTAssert(RenderDocument(
+      "<svg width='40' height='4'>"
+      "<path d='M 9 2 L 31 2' stroke='black' stroke-dasharray='1e-30 1e-30'/>"
+      "</svg>", &canvas));
+  XCTAssert(memcmp(canvas.pixels(), solid_canvas.pixels(), 40 * 4 * 4) == 0);
+
+  // So are paths that would take too many dashes.
+  SoftwareCanvas long_canvas(40, 4);
+  XCTAssert(RenderDocument(
+      "<svg width='40' height='4'>"
+      "<path d='M 9 2.5 L 1e7 2.5' stroke='black' stroke-dasharray='0.5'/>"
+      "</svg>", &long_canvas));
+  XCTAssertEqual(PixelValue(long_canvas, 10, 2, 3), 255);
+  XCTAssertEqual(PixelValue(long_canvas, 39, 2, 3), 255);
+}
+
+- (void)testStrokePath_Transformed {
+  // Strokes are computed in user space.
+  SoftwareCanvas canvas(10, 10);
+  canvas.ConcatCTM(AffineTransform::MakeScale(1, 4));
+  canvas.BeginPath();
+  canvas.MoveToPoint(5, 0);
+  canvas.AddLineToPoint(5, 2);
+  canvas.MoveToPoint(0, 2);
+  canvas.AddLineToPoint(3, 2);
+  canvas.StrokePath();
+  XCTAssertEqual(PixelValue(canvas, 4, 4, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 1, 6, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 1, 5, 3), 0);
+}
+
+- (void)testClip {
+  SoftwareCanvas canvas(4, 4);
+  canvas.BeginPath();
+  canvas.MoveToPoint(0, 0);
+  canvas.AddLineToPoint(4, 0);
+  canvas.AddLineToPoint(0, 4);
+  canvas.Clip();
+  canvas.ClipToRect(FloatRect(0, 1, 4, 3));
+  canvas.BeginPath();
+  AddRect(&canvas, 0, 0, 4, 4);
+  canvas.FillPath(kFillRuleNonZero);
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 0);
+  XCTAssertEqual(PixelValue(canvas, 0, 1, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 1, 2, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 3, 3, 3), 0);
+
+  canvas.SaveGState();
+  canvas.ClipToRect(FloatRect(3, 3, 1, 1));
+  canvas.RestoreGState();
+  canvas.BeginPath();
+  AddRect(&canvas, 0, 0, 4, 4);
+  canvas.FillPath(kFillRuleNonZero);
+  XCTAssertEqual(PixelValue(canvas, 1, 2, 3), 192);
+}
+
+- (void)testTransparencyLayer {
+  SoftwareCanvas canvas(4, 1);
+  canvas.SetAlpha(0.5);
+  canvas.BeginTransparencyLayer();
+  canvas.BeginPath();
+  AddRect(&canvas, 0, 0, 3, 1);
+  canvas.FillPath(kFillRuleNonZero);
+  canvas.BeginPath();
+  AddRect(&canvas, 1, 0, 1, 1);
+  canvas.FillPath(kFillRuleNonZero);
+  canvas.EndTransparencyLayer();
+  // The layer is composited as a whole.
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 1, 0, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 3, 0, 3), 0);
+
+  // The alpha is restored after the layer.
+  canvas.BeginPath();
+  AddRect(&canvas, 3, 0, 1, 1);
+  canvas.FillPath(kFillRuleNonZero);
+  XCTAssertEqual(PixelValue(canvas, 3, 0, 3), 128);
+}
+
+- (void)testExternalPixels {
+  // Rows are padded to check that the padding is left alone.
+  std::vector<uint8_t> pixels(12 * 2, 0xab);
+  SoftwareCanvas canvas(2, 2, pixels.data(), 12, kMSCPixelFormatBGRA8888);
+  XCTAssertEqual(canvas.pixels(), pixels.data());
+  XCTAssertEqual(pixels[0], 0);
+  canvas.SetRGBFillColor(1, 0, 0, 1);
+  canvas.BeginPath();
+  AddRect(&canvas, 0, 0, 2, 1);
+  canvas.FillPath(kFillRuleNonZero);
+
+  XCTAssertEqual(pixels[0], 0);
+  XCTAssertEqual(pixels[2], 0xff);
+  XCTAssertEqual(pixels[3], 0xff);
+  XCTAssertEqual(pixels[8], 0xab);
+  XCTAssertEqual(pixels[12], 0);
+  XCTAssertEqual(pixels[15], 0);
+
+  // ReadPixels still returns RGBA.
+  std::vector<uint8_t> rgba_pixels(8 * 2);
+  canvas.ReadPixels(rgba_pixels.data(), 8);
+  XCTAssertEqual(rgba_pixels[0], 0xff);
+  XCTAssertEqual(rgba_pixels[2], 0);
+  XCTAssertEqual(rgba_pixels[3], 0xff);
+}
+
+- (void)testExternalPixels_BGRAGradient {
+  Gradient gradient(Gradient::kTypeLinear, AttributeTable());
+  gradient.stops.push_back(GradientStop(0, RgbColor(1, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(1, RgbColor(1, 0, 0), 1));
+  std::vector<uint8_t> pixels(4);
+  SoftwareCanvas canvas(1, 1, pixels.data(), 4, kMSCPixelFormatBGRA8888);
+  canvas.DrawLinearGradient(gradient, FloatPoint(0, 0), FloatPoint(1, 0));
+  XCTAssertEqual(pixels[0], 0);
+  XCTAssertEqual(pixels[2], 0xff);
+  XCTAssertEqual(pixels[3], 0xff);
+}
+
+- (void)testDrawLinearGradient {
+  Gradient gradient(Gradient::kTypeLinear, AttributeTable());
+  gradient.stops.push_back(GradientStop(0, RgbColor(1, 0, 0), 1));
+  gradient.stops.push_back(GradientStop(1, RgbColor(0, 0, 1), 1));
+  SoftwareCanvas canvas(10, 1);
+  canvas.ClipToRect(FloatRect(1, 0, 9, 1));
+  canvas.DrawLinearGradient(gradient, FloatPoint(2.5, 0),
+                            FloatPoint(6.5, 0));
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 0);
+  // Extended at both ends.
+  XCTAssertEqual(PixelValue(canvas, 1, 0, 0), 255);
+  XCTAssertEqual(PixelValue(canvas, 9, 0, 2), 255);
+  // The pixel centered at x = 4.5 is halfway.
+  XCTAssertEqual(PixelValue(canvas, 4, 0, 0), 128);
+  XCTAssertEqual(PixelValue(canvas, 4, 0, 2), 128);
+  XCTAssertEqual(PixelValue(canvas, 4, 0, 3), 255);
+}
+
+- (void)testDrawRadialGradient {
+  Gradient gradient(Gradient::kTypeRadial, AttributeTable());
+  gradient.stops.push_back(GradientStop(0, RgbColor(1, 1, 1), 1));
+  gradient.stops.push_back(GradientStop(1, RgbColor(0, 0, 0), 0));
+  SoftwareCanvas canvas(9, 9);
+  canvas.DrawRadialGradient(gradient, FloatPoint(4.5, 4.5),
+                            FloatPoint(4.5, 4.5), 4);
+  XCTAssertEqual(PixelValue(canvas, 4, 4, 3), 255);
+  XCTAssertEqual(PixelValue(canvas, 6, 4, 3), 128);
+  XCTAssertEqual(PixelValue(canvas, 6, 4, 0), 64);
+  XCTAssertEqual(PixelValue(canvas, 0, 0, 3), 0);
+}
+
+- (void)testGetPathBoundingBox {
+  SoftwareCanvas canvas(10, 10);
+  canvas.ConcatCTM(AffineTransform::MakeScale(2, 2));
+  canvas.BeginPath();
+  XCTAssert(canvas.GetPathBoundingBox().IsNull());
+  canvas.AddEllipseInRect(FloatRect(1, 1, 2, 2));
+  FloatRect box = canvas.GetPathBoundingBox();
+  XCTAssertEqualWithAccuracy(box.min_x(), 1, 1e-6);
+  XCTAssertEqualWithAccuracy(box.max_y(), 3, 1e-6);
+  XCTAssert((canvas.GetPathCurrentPoint() == FloatPoint(3, 2)));
+}
+
+@end
@@ -0,0 +1,383 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/Stroker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "MetroSVG/Internal/Constants.h"
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+// Emits a polygon after making its signed area positive. Polygons without
+// area are dropped.
+void EmitOrientedPolygon(std::vector<FloatPoint> *polygon,
+                         const PolygonCallback &add_polygon) {
+  Float area = 0;
+  size_t count = polygon->size();
+  for (size_t i = 0; i < count; ++i) {
+    const FloatPoint &a = (*polygon)[i];
+    const FloatPoint &b = (*polygon)[(i + 1) % count];
+    area += a.x * b.y - b.x * a.y;
+  }
+  if (area == 0) {
+    return;
+  }
+  if (area < 0) {
+    std::reverse(polygon->begin(), polygon->end());
+  }
+  add_polygon(polygon->data(), count);
+}
+
+// Returns the sum of the values of |line_dash|, or 0 if any of them is
+// negative or not a number.
+Float DashPatternLength(const LineDash &line_dash) {
+  Float pattern_length = 0;
+  for (Float dash : line_dash.dash_values) {
+    if (!(dash >= 0)) {
+      return 0;
+    }
+    pattern_length += dash;
+  }
+  return pattern_length;
+}
+
+// Returns the largest angle that an arc of |radius| can span while staying
+// within |tolerance| of its chord.
+Float MaxArcStepAngle(Float radius, Float tolerance) {
+  if (radius <= tolerance) {
+    return kPi / 2;
+  }
+  return std::max(2 * std::acos(1 - tolerance / radius), Float(kPi / 512));
+}
+
+// Emits |center| and the points of the arc from |offset| rotated by
+// |sweep| radians.
+void EmitWedge(FloatPoint center,
+               FloatPoint offset,
+               Float sweep,
+               Float radius,
+               Float tolerance,
+               const PolygonCallback &add_polygon) {
+  int step_count = std::max(
+      1, static_cast<int>(std::ceil(std::fabs(sweep) /
+                                    MaxArcStepAngle(radius, tolerance))));
+  std::vector<FloatPoint> polygon;
+  polygon.reserve(step_count + 2);
+  polygon.push_back(center);
+  Float start_angle = std::atan2(offset.y, offset.x);
+  for (int i = 0; i <= step_count; ++i) {
+    Float angle = start_angle + sweep * i / step_count;
+    polygon.push_back(FloatPoint(center.x + radius * std::cos(angle),
+                                 center.y + radius * std::sin(angle)));
+  }
+  EmitOrientedPolygon(&polygon, add_polygon);
+}
+
+void EmitDot(FloatPoint center,
+             const StrokeStyle &style,
+             Float tolerance,
+             const PolygonCallback &add_polygon) {
+  Float half_width = style.width / 2;
+  switch (style.cap) {
+    case kLineCapButt:
+      break;
+    case kLineCapRound:
+      EmitWedge(center, FloatPoint(half_width, 0), 2 * kPi, half_width,
+                tolerance, add_polygon);
+      break;
+    case kLineCapSquare: {
+      std::vector<FloatPoint> polygon = {
+        FloatPoint(center.x - half_width, center.y - half_width),
+        FloatPoint(center.x + half_width, center.y - half_width),
+        FloatPoint(center.x + half_width, center.y + half_width),
+        FloatPoint(center.x - half_width, center.y + half_width),
+      };
+      EmitOrientedPolygon(&polygon, add_polygon);
+      break;
+    }
+  }
+}
+
+// |direction| is the unit vector pointing away from the line.
+void EmitCap(FloatPoint point,
+             FloatPoint direction,
+             const StrokeStyle &style,
+             Float tolerance,
+             const PolygonCallback &add_polygon) {
+  Float half_width = style.width / 2;
+  FloatPoint normal(-direction.y * half_width,
+                    direction.x * half_width);
+  switch (style.cap) {
+    case kLineCapButt:
+      break;
+    case kLineCapRound:
+      // Half a turn from |normal| through |direction|.
+      EmitWedge(point, normal, -kPi, half_width, tolerance, add_polygon);
+      break;
+    case kLineCapSquare: {
+      FloatPoint extension(direction.x * half_width,
+                           direction.y * half_width);
+      std::vector<FloatPoint> polygon = {
+        FloatPoint(point.x + normal.x, point.y + normal.y),
+        FloatPoint(point.x + normal.x + extension.x,
+                   point.y + normal.y + extension.y),
+        FloatPoint(point.x - normal.x + extension.x,
+                   point.y - normal.y + extension.y),
+        FloatPoint(point.x - normal.x, point.y - normal.y),
+      };
+      EmitOrientedPolygon(&polygon, add_polygon);
+      break;
+    }
+  }
+}
+
+// |in| and |out| are the unit directions of the segments that meet at
+// |point|.
+void EmitJoin(FloatPoint point,
+              FloatPoint in,
+              FloatPoint out,
+              const StrokeStyle &style,
+              Float tolerance,
+              const PolygonCallback &add_polygon) {
+  Float cross = in.x * out.y - in.y * out.x;
+  Float dot = in.x * out.x + in.y * out.y;
+  if (cross == 0 && dot > 0) {
+    return;
+  }
+  // The joint is filled on the outer side of the turn, where the edges of
+  // the two segments leave a gap.
+  Float half_width = style.width / 2;
+  Float side = cross > 0 ? -half_width : half_width;
+  FloatPoint in_offset(-in.y * side, in.x * side);
+  FloatPoint out_offset(-out.y * side, out.x * side);
+  FloatPoint in_corner(point.x + in_offset.x,
+                       point.y + in_offset.y);
+  FloatPoint out_corner(point.x + out_offset.x,
+                        point.y + out_offset.y);
+
+  if (style.join == kLineJoinRound) {
+    EmitWedge(point, in_offset, std::atan2(cross, dot), half_width,
+              tolerance, add_polygon);
+    return;
+  }
+  if (style.join == kLineJoinMiter) {
+    FloatPoint bisector(in_offset.x + out_offset.x,
+                        in_offset.y + out_offset.y);
+    Float bisector_length = std::hypot(bisector.x, bisector.y);
+    if (bisector_length > 0) {
+      // Cosine of half the angle between the offsets. The ratio of the
+      // miter length to the stroke width is its inverse.
+      Float cos_half = bisector_length / (2 * half_width);
+      if (1 / cos_half <= style.miter_limit) {
+        Float scale = half_width / cos_half / bisector_length;
+        std::vector<FloatPoint> polygon = {
+          point,
+          in_corner,
+          FloatPoint(point.x + bisector.x * scale,
+                     point.y + bisector.y * scale),
+          out_corner,
+        };
+        EmitOrientedPolygon(&polygon, add_polygon);
+        return;
+      }
+    }
+  }
+  std::vector<FloatPoint> polygon = {point, in_corner, out_corner};
+  EmitOrientedPolygon(&polygon, add_polygon);
+}
+
+}  // namespace
+
+void StrokePolyline(const FloatPoint *points,
+                    size_t count,
+                    bool closed,
+                    const StrokeStyle &style,
+                    Float tolerance,
+                    const PolygonCallback &add_polygon) {
+  Float half_width = style.width / 2;
+  if (!(half_width > 0) || count == 0) {
+    return;
+  }
+
+  std::vector<FloatPoint> polyline;
+  polyline.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    if (polyline.empty() ||
+        polyline.back() != points[i]) {
+      polyline.push_back(points[i]);
+    }
+  }
+  if (closed && polyline.size() > 1 &&
+      (polyline.front() == polyline.back())) {
+    polyline.pop_back();
+  }
+  size_t point_count = polyline.size();
+  if (point_count == 1) {
+    EmitDot(polyline[0], style, tolerance, add_polygon);
+    return;
+  }
+
+  size_t segment_count = closed ? point_count : point_count - 1;
+  std::vector<FloatPoint> directions(segment_count);
+  std::vector<FloatPoint> quad(4);
+  for (size_t i = 0; i < segment_count; ++i) {
+    FloatPoint a = polyline[i];
+    FloatPoint b = polyline[(i + 1) % point_count];
+    Float length = std::hypot(b.x - a.x, b.y - a.y);
+    FloatPoint direction((b.x - a.x) / length,
+                         (b.y - a.y) / length);
+    directions[i] = direction;
+    FloatPoint normal(-direction.y * half_width,
+                      direction.x * half_width);
+    quad[0] = FloatPoint(a.x + normal.x, a.y + normal.y);
+    quad[1] = FloatPoint(b.x + normal.x, b.y + normal.y);
+    quad[2] = FloatPoint(b.x - normal.x, b.y - normal.y);
+    quad[3] = FloatPoint(a.x - normal.x, a.y - normal.y);
+    EmitOrientedPolygon(&quad, add_polygon);
+  }
+
+  if (closed) {
+    for (size_t i = 0; i < point_count; ++i) {
+      EmitJoin(polyline[i], directions[(i + segment_count - 1) % segment_count],
+               directions[i], style, tolerance, add_polygon);
+    }
+  } else {
+    for (size_t i = 1; i + 1 < point_count; ++i) {
+      EmitJoin(polyline[i], directions[i - 1], directions[i], style,
+               tolerance, add_polygon);
+    }
+    FloatPoint start_direction(-directions[0].x,
+                               -directions[0].y);
+    EmitCap(polyline[0], start_direction, style, tolerance, add_polygon);
+    EmitCap(polyline[point_count - 1], directions[segment_count - 1], style,
+            tolerance, add_polygon);
+  }
+}
+
+Float PolylineLength(const FloatPoint *points, size_t count, bool closed) {
+  Float length = 0;
+  size_t segment_count = closed ? count : count - 1;
+  for (size_t i = 0; i < segment_count && count > 0; ++i) {
+    FloatPoint a = points[i];
+    FloatPoint b = points[(i + 1) % count];
+    length += std::hypot(b.x - a.x, b.y - a.y);
+  }
+  return length;
+}
+
+bool ShouldDashPolylines(const StrokeStyle &style,
+                         Float total_length,
+                         Float tolerance) {
+  Float pattern_length = DashPatternLength(style.line_dash);
+  if (!(pattern_length > 0) || !std::isfinite(pattern_length) ||
+      pattern_length < tolerance) {
+    return false;
+  }
+  // Every two values of the pattern make a dash.
+  Float dash_count = total_length / pattern_length *
+                       style.line_dash.dash_values.size() / 2;
+  return dash_count <= kMaxDashCount;
+}
+
+void StrokeDashedPolyline(const FloatPoint *points,
+                          size_t count,
+                          bool closed,
+                          const StrokeStyle &style,
+                          Float tolerance,
+                          const PolygonCallback &add_polygon) {
+  if (count == 0 ||
+      !ShouldDashPolylines(style, PolylineLength(points, count, closed),
+                           tolerance)) {
+    StrokePolyline(points, count, closed, style, tolerance, add_polygon);
+    return;
+  }
+  const std::vector<Float> &dashes = style.line_dash.dash_values;
+  Float pattern_length = DashPatternLength(style.line_dash);
+
+  // With an odd number of values, dashes and gaps swap on every repetition
+  // of the pattern.
+  if (dashes.size() % 2 == 1) {
+    pattern_length *= 2;
+  }
+  Float phase = std::fmod(style.line_dash.phase, pattern_length);
+  if (phase < 0) {
+    phase += pattern_length;
+  }
+  size_t index = 0;
+  bool is_dash = true;
+  Float remaining = dashes[0];
+  while (phase > 0) {
+    if (phase >= remaining) {
+      phase -= remaining;
+      index = (index + 1) % dashes.size();
+      is_dash = !is_dash;
+      remaining = dashes[index];
+    } else {
+      remaining -= phase;
+      phase = 0;
+    }
+  }
+
+  std::vector<FloatPoint> dash;
+  if (is_dash) {
+    dash.push_back(points[0]);
+  }
+  // ShouldDashPolylines bounds the number of dashes, but rounding can make
+  // a tiny dash fail to advance |position|, so the loop is bounded too.
+  size_t split_count = 0;
+  const size_t kMaxSplitCount = 4 * kMaxDashCount;
+  size_t segment_count = closed ? count : count - 1;
+  for (size_t i = 0; i < segment_count; ++i) {
+    FloatPoint a = points[i];
+    FloatPoint b = points[(i + 1) % count];
+    Float length = std::hypot(b.x - a.x, b.y - a.y);
+    Float position = 0;
+    while (length - position > remaining && split_count < kMaxSplitCount) {
+      ++split_count;
+      position += remaining;
+      Float t = position / length;
+      FloatPoint point(a.x + (b.x - a.x) * t,
+                       a.y + (b.y - a.y) * t);
+      if (is_dash) {
+        dash.push_back(point);
+        StrokePolyline(dash.data(), dash.size(), false, style, tolerance,
+                       add_polygon);
+        dash.clear();
+      } else {
+        dash.assign(1, point);
+      }
+      is_dash = !is_dash;
+      index = (index + 1) % dashes.size();
+      remaining = dashes[index];
+    }
+    remaining -= length - position;
+    if (is_dash) {
+      dash.push_back(b);
+    }
+  }
+  if (is_dash && !dash.empty()) {
+    StrokePolyline(dash.data(), dash.size(), false, style, tolerance,
+                   add_polygon);
+  }
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "MetroSVG/Internal/BasicTypes.h"
+#include "MetroSVG/Internal/Geometry.h"
+
+namespace metrosvg {
+namespace internal {
+
+struct StrokeStyle {
+  Float width;
+  LineCap cap;
+  LineJoin join;
+  Float miter_limit;
+  LineDash line_dash;
+
+  StrokeStyle()
+      : width(1), cap(kLineCapButt), join(kLineJoinMiter), miter_limit(10) {}
+};
+
+// Called with each polygon of a stroke outline.
+typedef std::function<void(const FloatPoint *points, size_t count)>
+    PolygonCallback;
+
+// Computes the outline of a stroked polyline. The outline is reported as
+// polygons whose union is the stroke: a quadrilateral for each segment, and
+// a polygon for each join and cap. All the polygons have the same
+// orientation, so filling them together with the nonzero rule paints
+// the union. |tolerance| is the maximum error allowed when approximating
+// round joins and caps, in the same units as the points.
+void StrokePolyline(const FloatPoint *points,
+                    size_t count,
+                    bool closed,
+                    const StrokeStyle &style,
+                    Float tolerance,
+                    const PolygonCallback &add_polygon);
+
+// Dash patterns that would split the polylines of a path into more dashes
+// than this are ignored, and the path is stroked solid. This bounds the
+// time a stroke takes.
+const size_t kMaxDashCount = 1 << 16;
+
+// Returns the length of a polyline, including the closing segment if
+// |closed| is true.
+Float PolylineLength(const FloatPoint *points, size_t count, bool closed);
+
+// Returns whether polylines of |total_length| should be dashed with the
+// dash pattern of |style|. They shouldn't be if the pattern is empty or
+// invalid, if it is shorter than |tolerance|, where the dashes can't be
+// told from a solid line, or if it would take more than kMaxDashCount
+// dashes.
+bool ShouldDashPolylines(const StrokeStyle &style,
+                         Float total_length,
+                         Float tolerance);
+
+// Splits a polyline into the dashes of |line_dash|, and strokes each of
+// them with StrokePolyline. A solid line, or one that ShouldDashPolylines
+// says not to dash, is stroked as is.
+void StrokeDashedPolyline(const FloatPoint *points,
+                          size_t count,
+                          bool closed,
+                          const StrokeStyle &style,
+                          Float tolerance,
+                          const PolygonCallback &add_polygon);
+
+}  // namespace internal
+}  // namespace metrosvg
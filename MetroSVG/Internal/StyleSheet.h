@@ -17,9 +17,10 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 
-#include "MetroSVG/Public/MSCStylesheet.h"
+#include "MetroSVG/Public/MSCStyleSheet.h"
 
 struct MSCStyleSheet {
   std::map<std::string, std::vector<std::pair<std::string, std::string>>> entry;
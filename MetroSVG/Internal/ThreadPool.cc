@@ -0,0 +1,143 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/ThreadPool.h"
+
+namespace metrosvg {
+namespace internal {
+
+ThreadPool::ThreadPool(size_t thread_count)
+    : batch_(0),
+      task_(NULL),
+      busy_threads_(0),
+      stopping_(false) {
+  if (thread_count == 0) {
+    thread_count = std::thread::hardware_concurrency();
+    if (thread_count == 0) {
+      thread_count = 1;
+    }
+  }
+  for (size_t i = 0; i < thread_count; ++i) {
+    ranges_.emplace_back(new TaskRange);
+  }
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads_.emplace_back(&ThreadPool::ThreadMain, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  batch_started_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Run(size_t task_count, const Task &task) {
+  size_t thread_count = ranges_.size();
+  for (size_t i = 0; i < thread_count; ++i) {
+    std::lock_guard<std::mutex> lock(ranges_[i]->mutex);
+    ranges_[i]->begin = task_count * i / thread_count;
+    ranges_[i]->end = task_count * (i + 1) / thread_count;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    busy_threads_ = threads_.size();
+    ++batch_;
+  }
+  batch_started_.notify_all();
+
+  RunTasks(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  batch_finished_.wait(lock, [this]() { return busy_threads_ == 0; });
+  task_ = NULL;
+}
+
+void ThreadPool::ThreadMain(size_t thread_index) {
+  size_t last_batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      batch_started_.wait(lock, [this, last_batch]() {
+        return stopping_ || batch_ != last_batch;
+      });
+      if (stopping_) {
+        return;
+      }
+      last_batch = batch_;
+    }
+    RunTasks(thread_index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_threads_;
+    }
+    batch_finished_.notify_one();
+  }
+}
+
+void ThreadPool::RunTasks(size_t thread_index) {
+  size_t task_index;
+  while (TakeTask(thread_index, &task_index) ||
+         StealTasks(thread_index, &task_index)) {
+    (*task_)(task_index, thread_index);
+  }
+}
+
+bool ThreadPool::TakeTask(size_t thread_index, size_t *task_index) {
+  TaskRange &range = *ranges_[thread_index];
+  std::lock_guard<std::mutex> lock(range.mutex);
+  if (range.begin == range.end) {
+    return false;
+  }
+  *task_index = range.begin++;
+  return true;
+}
+
+bool ThreadPool::StealTasks(size_t thread_index, size_t *task_index) {
+  size_t thread_count = ranges_.size();
+  for (size_t i = 1; i < thread_count; ++i) {
+    TaskRange &victim = *ranges_[(thread_index + i) % thread_count];
+    size_t stolen_begin;
+    size_t stolen_end;
+    {
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      size_t remaining = victim.end - victim.begin;
+      if (remaining == 0) {
+        continue;
+      }
+      // The victim keeps taking tasks from the front, so take the back.
+      stolen_end = victim.end;
+      stolen_begin = stolen_end - (remaining + 1) / 2;
+      victim.end = stolen_begin;
+    }
+    // Only this thread adds tasks to its own range, and it's empty.
+    TaskRange &range = *ranges_[thread_index];
+    std::lock_guard<std::mutex> lock(range.mutex);
+    *task_index = stolen_begin;
+    range.begin = stolen_begin + 1;
+    range.end = stolen_end;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MetroSVG/Internal/Macros.h"
+
+namespace metrosvg {
+namespace internal {
+
+// ThreadPool runs batches of independent tasks on a fixed set of threads.
+// The tasks of a batch are divided evenly between the threads up front.
+// A thread that runs out of tasks steals half of the remaining tasks of
+// another thread, so the threads stay busy even when some tasks take much
+// longer than others.
+class ThreadPool {
+ public:
+  // Called with the index of a task and the index of the thread running it,
+  // which is less than thread_count(). No two tasks run on the same thread
+  // index at the same time, so tasks can use per-thread resources.
+  typedef std::function<void(size_t task_index,
+                             size_t thread_index)> Task;
+
+  // |thread_count| includes the thread calling Run, so the pool starts
+  // |thread_count| - 1 threads of its own. If |thread_count| is 0, the
+  // number of CPUs is used.
+  explicit ThreadPool(size_t thread_count);
+  ~ThreadPool();
+
+  size_t thread_count() const { return ranges_.size(); }
+
+  // Runs |task| for each task index in [0, |task_count|) and returns when
+  // all of them have finished. The calling thread runs tasks as thread 0.
+  // Must not be called from a task or from several threads at once.
+  void Run(size_t task_count, const Task &task);
+
+ private:
+  // The task indices [begin, end) that are yet to run on a thread.
+  struct TaskRange {
+    std::mutex mutex;
+    size_t begin;
+    size_t end;
+
+    TaskRange() : begin(0), end(0) {}
+  };
+
+  std::vector<std::unique_ptr<TaskRange>> ranges_;
+  std::vector<std::thread> threads_;
+
+  // Guard the fields below.
+  std::mutex mutex_;
+  std::condition_variable batch_started_;
+  std::condition_variable batch_finished_;
+  // Incremented when Run starts a batch.
+  size_t batch_;
+  const Task *task_;
+  // Number of pool threads that haven't finished the current batch.
+  size_t busy_threads_;
+  bool stopping_;
+
+  void ThreadMain(size_t thread_index);
+  // Runs tasks until there are none left to run or steal.
+  void RunTasks(size_t thread_index);
+  bool TakeTask(size_t thread_index, size_t *task_index);
+  // Moves tasks of another thread to |thread_index| and takes the first.
+  bool StealTasks(size_t thread_index, size_t *task_index);
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadPool);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
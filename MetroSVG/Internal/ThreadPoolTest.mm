@@ -0,0 +1,97 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/ThreadPool.h"
+
+using namespace metrosvg::internal;
+
+@interface ThreadPoolTest : XCTestCase
+@end
+
+@implementation ThreadPoolTest
+
+- (void)testRun_RunsEachTaskOnce {
+  for (size_t thread_count : {1, 2, 3, 8}) {
+    ThreadPool pool(thread_count);
+    XCTAssertEqual(pool.thread_count(), thread_count);
+    for (size_t task_count : {0, 1, 7, 1000}) {
+      std::vector<std::atomic<int>> runs(task_count);
+      for (std::atomic<int> &run : runs) {
+        run = 0;
+      }
+      std::atomic<bool> valid_thread_indices(true);
+      pool.Run(task_count, [&](size_t task_index, size_t thread_index) {
+        ++runs[task_index];
+        if (thread_index >= thread_count) {
+          valid_thread_indices = false;
+        }
+      });
+      for (std::atomic<int> &run : runs) {
+        XCTAssertEqual(run.load(), 1);
+      }
+      XCTAssert(valid_thread_indices);
+    }
+  }
+}
+
+- (void)testRun_DefaultThreadCount {
+  ThreadPool pool(0);
+  XCTAssert(pool.thread_count() >= 1);
+}
+
+- (void)testRun_ThreadIndicesAreExclusive {
+  ThreadPool pool(4);
+  std::vector<std::atomic<bool>> busy(pool.thread_count());
+  for (std::atomic<bool> &thread_busy : busy) {
+    thread_busy = false;
+  }
+  std::atomic<bool> overlapped(false);
+  pool.Run(200, [&](size_t task_index, size_t thread_index) {
+    if (busy[thread_index].exchange(true)) {
+      overlapped = true;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    busy[thread_index] = false;
+  });
+  XCTAssertFalse(overlapped);
+}
+
+- (void)testRun_StealsTasks {
+  // All the slow tasks are initially given to thread 0. The other threads
+  // run out of tasks at once and should steal some of them.
+  ThreadPool pool(4);
+  std::mutex mutex;
+  std::set<size_t> slow_task_threads;
+  pool.Run(32, [&](size_t task_index, size_t thread_index) {
+    if (task_index < 8) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      std::lock_guard<std::mutex> lock(mutex);
+      slow_task_threads.insert(thread_index);
+    }
+  });
+  XCTAssert(slow_task_threads.size() > 1);
+}
+
+@end
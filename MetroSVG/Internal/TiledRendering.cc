@@ -0,0 +1,88 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/TiledRendering.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "MetroSVG/Internal/Renderer.h"
+#include "MetroSVG/Internal/ThreadPool.h"
+
+namespace metrosvg {
+namespace internal {
+
+bool RenderTiles(const MSCDocument *document,
+                 const MSCStyleSheet *style_sheet,
+                 size_t width,
+                 size_t height,
+                 size_t tile_width,
+                 size_t tile_height,
+                 const CanvasFactory &create_canvas,
+                 ThreadPool *pool,
+                 const TileCallback &callback) {
+  if (tile_width == 0 || tile_height == 0) {
+    return false;
+  }
+  size_t columns = (width + tile_width - 1) / tile_width;
+  size_t rows = (height + tile_height - 1) / tile_height;
+  FloatSize viewport_size(width, height);
+
+  // Tiles are numbered in row-major order, so that each thread starts with
+  // a band of neighboring tiles.
+  std::vector<std::vector<uint8_t>> thread_pixels(pool->thread_count());
+  // Each thread reuses one renderer, and its arena, for all its tiles.
+  std::vector<Renderer> thread_renderers(pool->thread_count());
+  std::mutex callback_mutex;
+  std::atomic<bool> success(true);
+  pool->Run(columns * rows, [&](size_t task_index, size_t thread_index) {
+    size_t x = task_index % columns * tile_width;
+    size_t y = task_index / columns * tile_height;
+    PixelRect tile(static_cast<int>(x),
+                   static_cast<int>(y),
+                   static_cast<int>(std::min(x + tile_width, width)),
+                   static_cast<int>(std::min(y + tile_height, height)));
+
+    std::unique_ptr<Canvas> canvas(
+        create_canvas(tile.width(), tile.height()));
+    canvas->ConcatCTM(AffineTransform::MakeTranslation(-Float(x), -Float(y)));
+    Renderer &renderer = thread_renderers[thread_index];
+    if (!renderer.RenderMSCDocument(document,
+                                    style_sheet,
+                                    viewport_size,
+                                    canvas.get())) {
+      success = false;
+      return;
+    }
+
+    size_t bytes_per_row = tile.width() * 4;
+    std::vector<uint8_t> &pixels = thread_pixels[thread_index];
+    pixels.resize(bytes_per_row * tile.height());
+    canvas->ReadPixels(pixels.data(), bytes_per_row);
+    // Release the canvas before waiting for other tiles' callbacks.
+    canvas.reset();
+
+    std::lock_guard<std::mutex> lock(callback_mutex);
+    callback(tile, pixels.data(), bytes_per_row);
+  });
+  return success;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
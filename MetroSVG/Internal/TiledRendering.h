@@ -0,0 +1,67 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "MetroSVG/Internal/Canvas.h"
+#include "MetroSVG/Internal/Rasterizer.h"
+#include "MetroSVG/MetroSVG.h"
+
+namespace metrosvg {
+namespace internal {
+
+class ThreadPool;
+
+// Returns a new canvas of the given size. Caller should release the
+// returned instance.
+typedef std::function<Canvas *(size_t width, size_t height)> CanvasFactory;
+
+// Called with the pixels of a tile in the layout described for
+// Canvas::ReadPixels. |tile| is the area of the whole canvas that the tile
+// covers. The pixels are only valid during the call.
+typedef std::function<void(const PixelRect &tile,
+                           const uint8_t *pixels,
+                           size_t bytes_per_row)> TileCallback;
+
+// Renders |document| the same way as onto a |width| x |height| canvas, but
+// in tiles of |tile_width| x |tile_height| pixels, or smaller at the right
+// and bottom edges. Each tile is rendered onto its own canvas, created
+// with |create_canvas|, whose user space is translated to the position of
+// the tile, so that only the part of the document inside the tile is
+// rasterized. The tiles are rendered in parallel on |pool| and passed to
+// |callback| as soon as each is done, one at a time but in no particular
+// order. At most one tile per thread of |pool| exists at once, however
+// large the whole canvas is.
+//
+// Returns false if any tile couldn't be rendered, i.e., if the document
+// couldn't be parsed. Tiles that were rendered are still passed to
+// |callback|.
+bool RenderTiles(const MSCDocument *document,
+                 const MSCStyleSheet *style_sheet,
+                 size_t width,
+                 size_t height,
+                 size_t tile_width,
+                 size_t tile_height,
+                 const CanvasFactory &create_canvas,
+                 ThreadPool *pool,
+                 const TileCallback &callback);
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,244 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/Document.h"
+#include "MetroSVG/Internal/Renderer.h"
+#include "MetroSVG/Internal/SoftwareCanvas.h"
+#include "MetroSVG/Internal/ThreadPool.h"
+#include "MetroSVG/Internal/TiledRendering.h"
+
+using namespace metrosvg::internal;
+
+static const char kTiledRenderingData[] =
+    "<svg width=\"70\" height=\"50\" viewBox=\"0 0 70 50\">"
+    "<linearGradient id=\"g\"><stop offset=\"0\" stop-color=\"red\"/>"
+    "<stop offset=\"1\" stop-color=\"blue\"/></linearGradient>"
+    "<rect x=\"3.5\" y=\"2\" width=\"60\" height=\"20\" fill=\"url(#g)\"/>"
+    "<g opacity=\"0.5\"><circle cx=\"35\" cy=\"30\" r=\"15.3\" fill=\"green\""
+    " stroke=\"black\" stroke-width=\"3\"/></g>"
+    "<path d=\"M0 50 L70 25\" stroke=\"orange\" stroke-dasharray=\"4 2\"/>"
+    "</svg>";
+
+// Shapes at fractional positions, gradients, dashes and a rotated group.
+static const char kRotatedGroupData[] =
+    "<svg width=\"100\" height=\"75\" viewBox=\"0 0 100 75\">"
+    "<linearGradient id=\"l\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\">"
+    "<stop offset=\"0\" stop-color=\"red\"/>"
+    "<stop offset=\"0.5\" stop-color=\"yellow\"/>"
+    "<stop offset=\"1\" stop-color=\"blue\"/></linearGradient>"
+    "<radialGradient id=\"r\" fx=\"0.3\">"
+    "<stop offset=\"0\" stop-color=\"white\"/>"
+    "<stop offset=\"1\" stop-color=\"green\"/></radialGradient>"
+    "<rect x=\"3.3\" y=\"2.7\" width=\"60\" height=\"40\" fill=\"url(#l)\"/>"
+    "<g transform=\"rotate(17 50 37)\" opacity=\"0.7\">"
+    "<ellipse cx=\"55\" cy=\"40\" rx=\"30\" ry=\"18\" fill=\"url(#r)\""
+    " stroke=\"black\" stroke-width=\"2.5\" stroke-dasharray=\"5 3\"/></g>"
+    "<path d=\"M0 75 C30 10 60 90 100 5\" fill=\"none\" stroke=\"orange\""
+    " stroke-width=\"3\" stroke-dasharray=\"7 2 1 2\"/>"
+    "</svg>";
+
+// The largest difference allowed between a channel of a tiled render and
+// the same channel of a render of the whole canvas. Each tile is drawn
+// with its own translation, which rounds coordinates differently, so
+// antialiased edges and gradients can be off by a level or two.
+static const int kTileTolerance = 2;
+
+// Returns whether every channel of |pixels| is within kTileTolerance of
+// the same channel of |expected|.
+static bool MatchesWithinTileTolerance(const std::vector<uint8_t> &pixels,
+                                       const std::vector<uint8_t> &expected) {
+  if (pixels.size() != expected.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < pixels.size(); ++i) {
+    if (abs(pixels[i] - expected[i]) > kTileTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The pixels of a whole canvas, assembled from tiles by AssembleTile.
+struct TileAssembly {
+  size_t width;
+  std::vector<uint8_t> pixels;
+};
+
+// An MSCDocumentTileCallback that copies the tile into the TileAssembly
+// that |context| points to.
+static void AssembleTile(void *context,
+                         size_t x,
+                         size_t y,
+                         size_t width,
+                         size_t height,
+                         const void *pixels,
+                         size_t bytes_per_row) {
+  TileAssembly *assembly = static_cast<TileAssembly *>(context);
+  for (size_t row = 0; row < height; ++row) {
+    memcpy(&assembly->pixels[((y + row) * assembly->width + x) * 4],
+           static_cast<const uint8_t *>(pixels) + row * bytes_per_row,
+           width * 4);
+  }
+}
+
+static Canvas *CreateSoftwareCanvas(size_t width, size_t height) {
+  return new SoftwareCanvas(width, height);
+}
+
+// Renders |document| in tiles and assembles them into |pixels|. Returns
+// false if rendering fails or if any pixel is covered by no tile or by
+// more than one.
+static bool RenderAndAssembleTiles(const MSCDocument *document,
+                                   size_t width,
+                                   size_t height,
+                                   size_t tile_size,
+                                   size_t thread_count,
+                                   std::vector<uint8_t> *pixels) {
+  pixels->assign(width * height * 4, 0);
+  std::vector<int> tile_counts(width * height);
+  ThreadPool pool(thread_count);
+  bool success = RenderTiles(
+      document, NULL, width, height, tile_size, tile_size,
+      CreateSoftwareCanvas, &pool,
+      [&](const PixelRect &tile,
+          const uint8_t *tile_pixels,
+          size_t bytes_per_row) {
+        for (int y = tile.y0; y < tile.y1; ++y) {
+          memcpy(&(*pixels)[(y * width + tile.x0) * 4],
+                 tile_pixels + (y - tile.y0) * bytes_per_row,
+                 tile.width() * 4);
+          for (int x = tile.x0; x < tile.x1; ++x) {
+            ++tile_counts[y * width + x];
+          }
+        }
+      });
+  for (int tile_count : tile_counts) {
+    if (tile_count != 1) {
+      return false;
+    }
+  }
+  return success;
+}
+
+@interface TiledRenderingTest : XCTestCase
+@end
+
+@implementation TiledRenderingTest
+
+- (void)testRenderTiles_MatchesWholeCanvas {
+  std::string data = kTiledRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  XCTAssertEqual(MSCDocumentPrepareForRendering(document), 1);
+  const size_t kWidth = 140;
+  const size_t kHeight = 100;
+  SoftwareCanvas canvas(kWidth, kHeight);
+  Renderer renderer;
+  XCTAssert(renderer.RenderMSCDocument(document, NULL, &canvas));
+  std::vector<uint8_t> expected(canvas.pixels(),
+                                canvas.pixels() + kWidth * kHeight * 4);
+
+  for (size_t tile_size : {16, 33, 200}) {
+    for (size_t thread_count : {1, 4}) {
+      std::vector<uint8_t> pixels;
+      XCTAssert(RenderAndAssembleTiles(document, kWidth, kHeight, tile_size,
+                                       thread_count, &pixels));
+      XCTAssert(MatchesWithinTileTolerance(pixels, expected));
+    }
+  }
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderTiles_MatchesRenderToBuffer {
+  std::string data = kRotatedGroupData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  const size_t kWidth = 401;
+  const size_t kHeight = 301;
+  std::vector<uint8_t> expected(kWidth * kHeight * 4);
+  XCTAssertEqual(MSCDocumentRenderToBuffer(document,
+                                           CGSizeMake(kWidth, kHeight),
+                                           NULL,
+                                           expected.data(),
+                                           kWidth * 4,
+                                           kMSCPixelFormatRGBA8888), 1);
+  TileAssembly assembly;
+  assembly.width = kWidth;
+  assembly.pixels.resize(kWidth * kHeight * 4);
+  XCTAssertEqual(MSCDocumentRenderTiles(document,
+                                        CGSizeMake(kWidth, kHeight),
+                                        CGSizeMake(37, 53),
+                                        NULL,
+                                        3,
+                                        AssembleTile,
+                                        &assembly), 1);
+  XCTAssert(MatchesWithinTileTolerance(assembly.pixels, expected));
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderTiles_TileSizes {
+  std::string data = kTiledRenderingData;
+  MSCDocument *document =
+      MSCDocumentCreateFromData(data.c_str(), data.size(), "");
+  ThreadPool pool(2);
+  std::vector<PixelRect> tiles;
+  std::vector<size_t> tile_bytes_per_row;
+  XCTAssert(RenderTiles(document, NULL, 50, 30, 20, 16,
+                        CreateSoftwareCanvas, &pool,
+                        [&](const PixelRect &tile,
+                            const uint8_t *pixels,
+                            size_t bytes_per_row) {
+                          tiles.push_back(tile);
+                          tile_bytes_per_row.push_back(bytes_per_row);
+                        }));
+  XCTAssertEqual(tiles.size(), 6U);
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    const PixelRect &tile = tiles[i];
+    XCTAssertEqual(tile_bytes_per_row[i], tile.width() * 4U);
+    XCTAssertEqual(tile.x0 % 20, 0);
+    XCTAssertEqual(tile.y0 % 16, 0);
+    XCTAssertEqual(tile.width(), tile.x0 == 40 ? 10 : 20);
+    XCTAssertEqual(tile.height(), tile.y0 == 16 ? 14 : 16);
+  }
+  MSCDocumentDelete(document);
+}
+
+- (void)testRenderTiles_MalformedData {
+  std::string data = "<svg width=\"10\" height=\"10\"><rect></svg>";
+  MSCDocument document;
+  document.data = data.c_str();
+  document.data_length = data.size();
+  ThreadPool pool(2);
+  int tile_count = 0;
+  XCTAssertFalse(RenderTiles(&document, NULL, 10, 10, 4, 4,
+                             CreateSoftwareCanvas, &pool,
+                             [&](const PixelRect &tile,
+                                 const uint8_t *pixels,
+                                 size_t bytes_per_row) {
+                               ++tile_count;
+                             }));
+  XCTAssertEqual(tile_count, 0);
+}
+
+@end
@@ -39,62 +39,60 @@ bool TransformIterator::Next() {
     return false;
   }
   if (ConsumeString(&s_copy, "matrix", true)) {
-    CGFloat elements[6];
+    Float elements[6];
     if (!ConsumeParenthesizedFloats(&s_copy, 6, elements)) {
       return false;
     }
-    transform_ = CGAffineTransformMake(elements[0], elements[1], elements[2],
-                                       elements[3], elements[4], elements[5]);
+    transform_ = AffineTransform(elements[0], elements[1], elements[2],
+                                 elements[3], elements[4], elements[5]);
   } else if (ConsumeString(&s_copy, "translate", true)) {
-    CGFloat elements[2];
+    Float elements[2];
     if (ConsumeParenthesizedFloats(&s_copy, 2, elements)) {
-      transform_ = CGAffineTransformMakeTranslation(elements[0], elements[1]);
+      transform_ = AffineTransform::MakeTranslation(elements[0], elements[1]);
     } else if (ConsumeParenthesizedFloats(&s_copy, 1, elements)) {
-        transform_ = CGAffineTransformMakeTranslation(elements[0], 0.);
+        transform_ = AffineTransform::MakeTranslation(elements[0], 0.);
     } else {
       return false;
     }
   } else if (ConsumeString(&s_copy, "scale", true)) {
-    CGFloat elements[2];
+    Float elements[2];
     if (ConsumeParenthesizedFloats(&s_copy, 2, elements)) {
-      transform_ = CGAffineTransformMakeScale(elements[0], elements[1]);
+      transform_ = AffineTransform::MakeScale(elements[0], elements[1]);
     } else if (ConsumeParenthesizedFloats(&s_copy, 1, elements)) {
-      transform_ = CGAffineTransformMakeScale(elements[0], elements[0]);
+      transform_ = AffineTransform::MakeScale(elements[0], elements[0]);
     } else {
       return false;
     }
   } else if (ConsumeString(&s_copy, "rotate", true)) {
-    CGFloat elements[3];
+    Float elements[3];
     if (ConsumeParenthesizedFloats(&s_copy, 3, elements)) {
-      CGAffineTransform translate =
-          CGAffineTransformMakeTranslation(elements[1], elements[2]);
-      CGAffineTransform rotate =
-          CGAffineTransformMakeRotation(ToRadians(elements[0]));
-      CGAffineTransform translate_back =
-          CGAffineTransformMakeTranslation(-elements[1], -elements[2]);
-      transform_ =
-          CGAffineTransformConcat(translate,
-                                  CGAffineTransformConcat(rotate,
-                                                          translate_back));
+      AffineTransform translate =
+          AffineTransform::MakeTranslation(elements[1], elements[2]);
+      AffineTransform rotate =
+          AffineTransform::MakeRotation(ToRadians(elements[0]));
+      AffineTransform translate_back =
+          AffineTransform::MakeTranslation(-elements[1], -elements[2]);
+      transform_ = ConcatTransforms(translate,
+                                    ConcatTransforms(rotate, translate_back));
     } else if (ConsumeParenthesizedFloats(&s_copy, 1, elements)) {
-      transform_ = CGAffineTransformMakeRotation(ToRadians(elements[0]));
+      transform_ = AffineTransform::MakeRotation(ToRadians(elements[0]));
     } else {
       return false;
     }
   } else if (ConsumeString(&s_copy, "skewX", true)) {
-    CGFloat skew_angle;
+    Float skew_angle;
     if (!ConsumeParenthesizedFloats(&s_copy, 1, &skew_angle)) {
       return false;
     }
-    CGFloat skew_angle_radians = ToRadians(skew_angle);
-    transform_ = CGAffineTransformMake(1, 0, tan(skew_angle_radians), 1, 0, 0);
+    Float skew_angle_radians = ToRadians(skew_angle);
+    transform_ = AffineTransform(1, 0, tan(skew_angle_radians), 1, 0, 0);
   } else if (ConsumeString(&s_copy, "skewY", true)) {
-    CGFloat skew_angle;
+    Float skew_angle;
     if (!ConsumeParenthesizedFloats(&s_copy, 1, &skew_angle)) {
       return false;
     }
-    CGFloat skew_angle_radians = ToRadians(skew_angle);
-    transform_ = CGAffineTransformMake(1, tan(skew_angle_radians), 0, 1, 0, 0);
+    Float skew_angle_radians = ToRadians(skew_angle);
+    transform_ = AffineTransform(1, tan(skew_angle_radians), 0, 1, 0, 0);
   } else {
     return false;
   }
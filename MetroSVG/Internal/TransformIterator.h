@@ -16,7 +16,7 @@
 
 #pragma once
 
-#include <CoreGraphics/CoreGraphics.h>
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
@@ -28,13 +28,13 @@ class TransformIterator {
   explicit TransformIterator(StringPiece *s);
 
   bool Next();
-  const CGAffineTransform &transform() const { return transform_; }
+  const AffineTransform &transform() const { return transform_; }
 
  private:
   void ConsumeTransformDelimeters(StringPiece *s) const;
 
   StringPiece *s_;
-  CGAffineTransform transform_;
+  AffineTransform transform_;
   bool is_first;
 };
 
@@ -24,7 +24,7 @@
 
 using namespace metrosvg::internal;
 
-static const CGFloat kTolerance = 0.0001f;
+static const Float kTolerance = 0.0001f;
 
 @interface TransformIteratorTest : XCTestCase
 @end
@@ -43,7 +43,7 @@ static const CGFloat kTolerance = 0.0001f;
   TransformIterator iter(new StringPiece("matrix(10,20,30,40,50,60)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 10., kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 20., kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 30., kTolerance);
@@ -67,7 +67,7 @@ static const CGFloat kTolerance = 0.0001f;
   TransformIterator iter(new StringPiece("translate(10,20)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 1., kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 0., kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 0., kTolerance);
@@ -82,7 +82,7 @@ static const CGFloat kTolerance = 0.0001f;
   TransformIterator iter(new StringPiece("translate(10)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 1., kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 0., kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 0., kTolerance);
@@ -115,7 +115,7 @@ static const CGFloat kTolerance = 0.0001f;
   TransformIterator iter(new StringPiece("scale(10,20)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 10., kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 0., kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 0., kTolerance);
@@ -130,7 +130,7 @@ static const CGFloat kTolerance = 0.0001f;
   TransformIterator iter(new StringPiece("scale(15 )"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 15., kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 0., kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 0., kTolerance);
@@ -160,11 +160,11 @@ static const CGFloat kTolerance = 0.0001f;
 }
 
 - (void)testRotate_SuccessNoCenter {
-  const CGFloat OneOverRoot2 = 1.f / std::sqrt(2.f);
+  const Float OneOverRoot2 = 1.f / std::sqrt(2.f);
   TransformIterator iter(new StringPiece("rotate(45)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, OneOverRoot2, kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, OneOverRoot2, kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, -OneOverRoot2, kTolerance);
@@ -176,12 +176,12 @@ static const CGFloat kTolerance = 0.0001f;
 }
 
 - (void)testRotate_SuccessCenter {
-  const CGFloat Root2 = std::sqrt(2.f);
-  const CGFloat OneOverRoot2 = 1.f / std::sqrt(2.f);
+  const Float Root2 = std::sqrt(2.f);
+  const Float OneOverRoot2 = 1.f / std::sqrt(2.f);
   TransformIterator iter(new StringPiece("rotate(45,1 1)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, OneOverRoot2, kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, OneOverRoot2, kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, -OneOverRoot2, kTolerance);
@@ -211,11 +211,11 @@ static const CGFloat kTolerance = 0.0001f;
 }
 
 - (void)testSkewX {
-  const CGFloat tan45 = std::tan(ToRadians(45.f));
+  const Float tan45 = std::tan(ToRadians(45.f));
   TransformIterator iter(new StringPiece("skewX(45)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 1.0, kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, 0.0, kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, tan45, kTolerance);
@@ -236,11 +236,11 @@ static const CGFloat kTolerance = 0.0001f;
 }
 
 - (void)testSkewY {
-  const CGFloat tan45 = std::tan(ToRadians(45.f));
+  const Float tan45 = std::tan(ToRadians(45.f));
   TransformIterator iter(new StringPiece("skewY(45)"));
 
   XCTAssertTrue(iter.Next());
-  const CGAffineTransform &transform = iter.transform();
+  const AffineTransform &transform = iter.transform();
   XCTAssertEqualWithAccuracy(transform.a, 1.0, kTolerance);
   XCTAssertEqualWithAccuracy(transform.b, tan45, kTolerance);
   XCTAssertEqualWithAccuracy(transform.c, 0.0, kTolerance);
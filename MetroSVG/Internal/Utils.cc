@@ -17,46 +17,27 @@
 #include "MetroSVG/Internal/Utils.h"
 
 #include <cmath>
+#include <mutex>
+
+#include <libxml/parser.h>
 
-#include "MetroSVG/Internal/BasicValueParsers.h"
 #include "MetroSVG/Internal/Constants.h"
-#include "MetroSVG/Internal/StringPiece.h"
 
 namespace metrosvg {
 namespace internal {
 
-bool FloatValueForKey(const StringMap &map,
-                      const std::string &key,
-                      CGFloat *out_float) {
-  const std::string *value = FindValueOrNull(map, key);
-  if (value) {
-    return ParseFloat(StringPiece(*value), out_float);
-  }
-  return false;
-}
-
-bool LengthValueForKey(const StringMap &map,
-                       const std::string &key,
-                       Length *out_length) {
-  const std::string *value = FindValueOrNull(map, key);
-  if (value) {
-    return ParseLength(StringPiece(*value), out_length);
-  }
-  return false;
-}
-
-bool SvgArcToCgArc(CGPoint start_point,
-                   CGPoint end_point,
+bool SvgArcToCgArc(FloatPoint start_point,
+                   FloatPoint end_point,
                    bool large_arc,
                    bool sweep,
-                   CGFloat *radius,
-                   CGPoint *center,
-                   CGFloat *start_angle,
-                   CGFloat *end_angle) {
-  if (CGPointEqualToPoint(start_point, end_point) || *radius <= 0) {
+                   Float *radius,
+                   FloatPoint *center,
+                   Float *start_angle,
+                   Float *end_angle) {
+  if (start_point == end_point || *radius <= 0) {
     return false;
   }
-  CGFloat horizontal_length =
+  Float horizontal_length =
       std::sqrt(std::pow(start_point.x - end_point.x, 2.f)
           + std::pow(start_point.y - end_point.y, 2.f));
   // If vertical_length has no solution,
@@ -65,7 +46,7 @@ bool SvgArcToCgArc(CGPoint start_point,
   while (pow(*radius, 2) - pow(horizontal_length / 2, 2) < 0) {
     *radius = horizontal_length / 2;
   }
-  CGFloat vertical_length =
+  Float vertical_length =
       std::sqrt(std::pow(*radius, 2.f) - std::pow(horizontal_length / 2, 2.f));
   if (large_arc != sweep) vertical_length = -vertical_length;
   center->x = (start_point.x + end_point.x) / 2
@@ -78,25 +59,23 @@ bool SvgArcToCgArc(CGPoint start_point,
   return true;
 }
 
-bool AreAnglesClose(CGFloat a1, CGFloat a2, CGFloat accuracy) {
+bool AreAnglesClose(Float a1, Float a2, Float accuracy) {
   int round_count = static_cast<int>(std::round((a2 - a1) / (2 * kPi)));
   a1 += 2 * kPi * round_count;
   return (std::fabs(a1 - a2) < accuracy);
 }
 
-CGAffineTransform CGAffineTransformToNormalizeRect(CGRect rect) {
-  CGAffineTransform transform =
-      CGAffineTransformMakeTranslation(CGRectGetMinX(rect),
-                                       CGRectGetMinY(rect));
-  transform = CGAffineTransformScale(transform, CGRectGetWidth(rect),
-                                     CGRectGetHeight(rect));
+AffineTransform TransformToNormalizeRect(FloatRect rect) {
+  AffineTransform transform =
+      AffineTransform::MakeTranslation(rect.min_x(), rect.min_y());
+  transform = ScaleTransform(transform, rect.width(), rect.height());
   return transform;
 }
 
 namespace {
-CGFloat OffsetForAlignment(PreserveAspectRatio::Alignment alignment,
-                           CGFloat viewport_dimention,
-                           CGFloat object_dimention) {
+Float OffsetForAlignment(PreserveAspectRatio::Alignment alignment,
+                         Float viewport_dimention,
+                         Float object_dimention) {
   switch (alignment) {
     case PreserveAspectRatio::kMin:
       return 0;
@@ -108,16 +87,14 @@ CGFloat OffsetForAlignment(PreserveAspectRatio::Alignment alignment,
 }
 }  // namespace
 
-CGAffineTransform
-CGAffineTransformForPreserveAspectRatio(PreserveAspectRatio aspect_ratio,
-                                        CGRect view_box,
-                                        CGRect target_viewport) {
-  CGFloat x_scale =
-      CGRectGetWidth(target_viewport) / CGRectGetWidth(view_box);
-  CGFloat y_scale =
-      CGRectGetHeight(target_viewport) / CGRectGetHeight(view_box);
+AffineTransform TransformForPreserveAspectRatio(
+    PreserveAspectRatio aspect_ratio,
+    FloatRect view_box,
+    FloatRect target_viewport) {
+  Float x_scale = target_viewport.width() / view_box.width();
+  Float y_scale = target_viewport.height() / view_box.height();
   if (!aspect_ratio.no_alignment) {
-    CGFloat scale =
+    Float scale =
         (aspect_ratio.meet_or_slice == PreserveAspectRatio::kMeet) ?
         std::fmin(x_scale, y_scale) :
         std::fmax(x_scale, y_scale);
@@ -125,23 +102,30 @@ CGAffineTransformForPreserveAspectRatio(PreserveAspectRatio aspect_ratio,
     y_scale = scale;
   }
 
-  CGFloat scaled_width = x_scale * CGRectGetWidth(view_box);
-  CGFloat x_offset = OffsetForAlignment(aspect_ratio.x_alignment,
-                                        CGRectGetWidth(target_viewport),
-                                        scaled_width);
-  CGFloat scaled_height = y_scale * CGRectGetHeight(view_box);
-  CGFloat y_offset = OffsetForAlignment(aspect_ratio.y_alignment,
-                                        CGRectGetHeight(target_viewport),
-                                        scaled_height);
-
-  CGAffineTransform transform =
-      CGAffineTransformMakeTranslation(x_offset, y_offset);
-  transform = CGAffineTransformScale(transform, x_scale, y_scale);
+  Float scaled_width = x_scale * view_box.width();
+  Float x_offset = OffsetForAlignment(aspect_ratio.x_alignment,
+                                      target_viewport.width(),
+                                      scaled_width);
+  Float scaled_height = y_scale * view_box.height();
+  Float y_offset = OffsetForAlignment(aspect_ratio.y_alignment,
+                                      target_viewport.height(),
+                                      scaled_height);
+
+  AffineTransform transform =
+      AffineTransform::MakeTranslation(x_offset, y_offset);
+  transform = ScaleTransform(transform, x_scale, y_scale);
   return transform;
 }
 
-CGFloat EvaluateLength(Length length) {
-  CGFloat scale = 1.f;
+void InitializeXMLParser() {
+  // xmlInitParser sets up global state and isn't thread-safe in older
+  // versions of libxml2.
+  static std::once_flag once;
+  std::call_once(once, xmlInitParser);
+}
+
+Float EvaluateLength(Length length) {
+  Float scale = 1.f;
   if (length.unit == Length::kUnitPercent) {
     scale = 0.01f;
   }
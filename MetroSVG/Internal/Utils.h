@@ -19,11 +19,9 @@
 #include <cmath>
 #include <map>
 
-#include <CoreGraphics/CoreGraphics.h>
-
 #include "MetroSVG/Internal/BasicTypes.h"
 #include "MetroSVG/Internal/Constants.h"
-#include "MetroSVG/MetroSVG.h"
+#include "MetroSVG/Internal/Geometry.h"
 
 namespace metrosvg {
 namespace internal {
@@ -46,27 +44,11 @@ const ValueType *FindValueOrNull(const std::map<KeyType, ValueType> &map,
   }
 }
 
-// This function will look for the given key in the given map.
-// If it is present, it will attempt to parse the value of the
-// key as a floating-point number.
-// If the key is present and the parse is successful, it will
-// set the value pointed to by |out_float| and return true.
-// If the key is not present or if the value does not represent
-// a floating-point number, it will return false and the value
-// pointed to by |out_float| will be unchanged.
-bool FloatValueForKey(const StringMap &map,
-                      const std::string &key,
-                      CGFloat *out_float);
-
-bool LengthValueForKey(const StringMap &map,
-                       const std::string &key,
-                       Length *out_length);
-
-static inline CGFloat ToRadians(CGFloat degrees) {
+static inline Float ToRadians(Float degrees) {
   return degrees * kPi / 180.f;
 }
 
-static inline CGFloat ClampToUnitRange(CGFloat value) {
+static inline Float ClampToUnitRange(Float value) {
   return std::fmin(std::fmax(value, 0.f), 1.f);
 }
 
@@ -75,23 +57,23 @@ static inline CGFloat ClampToUnitRange(CGFloat value) {
 // Radius, start angle and end angle that is used by Core Graphics.
 // Angles are in radians.
 // Returns false in case of bad input.
-bool SvgArcToCgArc(CGPoint start_point,
-                   CGPoint end_point,
+bool SvgArcToCgArc(FloatPoint start_point,
+                   FloatPoint end_point,
                    bool large_arc,
                    bool sweep,
-                   CGFloat *radius,
-                   CGPoint *center,
-                   CGFloat *start_angle,
-                   CGFloat *end_angle);
+                   Float *radius,
+                   FloatPoint *center,
+                   Float *start_angle,
+                   Float *end_angle);
 
 // Test that angle a1 is close to angle a2.
 // When the difference between a1 and a2 is more than 2 * pi,
 // a1 is shifted to a point near a2 by multiples of 2 * pi.
-bool AreAnglesClose(CGFloat a1, CGFloat a2, CGFloat accuracy);
+bool AreAnglesClose(Float a1, Float a2, Float accuracy);
 
 // Returns an affine transform that maps a given rectangle to
 // a unit rectangle located at the origin ((0, 0), (1, 1)).
-CGAffineTransform CGAffineTransformToNormalizeRect(CGRect rect);
+AffineTransform TransformToNormalizeRect(FloatRect rect);
 
 // Returns a transform to establish a new coordinate system
 // as specified by |aspect_ratio| and |view_box| within the |target_viewport|
@@ -99,15 +81,19 @@ CGAffineTransform CGAffineTransformToNormalizeRect(CGRect rect);
 // NOTE: This method currently only supports view box and viewport
 // place at the origin.
 // TODO: Implement this missing feature.
-CGAffineTransform
-CGAffineTransformForPreserveAspectRatio(PreserveAspectRatio aspect_ratio,
-                                        CGRect view_box,
-                                        CGRect target_viewport);
+AffineTransform TransformForPreserveAspectRatio(
+    PreserveAspectRatio aspect_ratio,
+    FloatRect view_box,
+    FloatRect target_viewport);
+
+// Initializes libxml2 the first time it's called. Must be called before
+// parsing XML, which may then happen on multiple threads at once.
+void InitializeXMLParser();
 
 // Returns a unit-less length value measured in the user space evaluating
 // a given length value with a unit. Currently, only conversion from a
 // percentage, e.g., 65% -> 0.65, is supported.
-CGFloat EvaluateLength(Length length);
+Float EvaluateLength(Length length);
 
 }  // namespace internal
 }  // namespace metrosvg
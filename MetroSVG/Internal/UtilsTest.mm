@@ -16,31 +16,29 @@
 
 #import <XCTest/XCTest.h>
 
-#import <CoreGraphics/CoreGraphics.h>
-
 #include "MetroSVG/Internal/Constants.h"
 #include "MetroSVG/Internal/Utils.h"
 
 using namespace metrosvg::internal;
 
-static const CGFloat kTolerance = 0.001f;
+static const Float kTolerance = 0.001f;
 
-#define AssertCGPointEqualWithAccurary(point1, point2, tolerance) { \
+#define AssertFloatPointEqualWithAccurary(point1, point2, tolerance) { \
   XCTAssertEqualWithAccuracy(point1.x, point2.x, tolerance); \
   XCTAssertEqualWithAccuracy(point1.y, point2.y, tolerance); \
 }
 
-#define AssertCGSizeEqualWithAccurary(size1, size2, tolerance) { \
+#define AssertFloatSizeEqualWithAccurary(size1, size2, tolerance) { \
   XCTAssertEqualWithAccuracy(size1.width, size2.width, tolerance); \
   XCTAssertEqualWithAccuracy(size1.height, size2.height, tolerance); \
 }
 
-#define AssertCGRectEqualWithAccurary(rect1, rect2, tolerance) { \
-  AssertCGPointEqualWithAccurary(rect1.origin, rect2.origin, tolerance); \
-  AssertCGSizeEqualWithAccurary(rect1.size, rect2.size, tolerance); \
+#define AssertFloatRectEqualWithAccurary(rect1, rect2, tolerance) { \
+  AssertFloatPointEqualWithAccurary(rect1.origin, rect2.origin, tolerance); \
+  AssertFloatSizeEqualWithAccurary(rect1.size, rect2.size, tolerance); \
 }
 
-#define AssertCGAffineTransformEqual(transform1, transform2) { \
+#define AssertAffineTransformEqual(transform1, transform2) { \
   XCTAssertEqualWithAccuracy(transform1.a, transform2.a, kTolerance); \
   XCTAssertEqualWithAccuracy(transform1.b, transform2.b, kTolerance); \
   XCTAssertEqualWithAccuracy(transform1.c, transform2.c, kTolerance); \
@@ -49,11 +47,11 @@ static const CGFloat kTolerance = 0.001f;
   XCTAssertEqualWithAccuracy(transform1.ty, transform2.ty, kTolerance); \
 }
 
-static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
-                                                   CGFloat tx,
-                                                   CGFloat ty) {
-  return CGAffineTransformScale(
-      CGAffineTransformMakeTranslation(tx, ty), scale, scale);
+static AffineTransform UniformScaleThenTranslate(Float scale,
+                                                 Float tx,
+                                                 Float ty) {
+  return ScaleTransform(AffineTransform::MakeTranslation(tx, ty),
+                        scale, scale);
 }
 
 @interface UtilsTest : XCTestCase
@@ -62,42 +60,42 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 @implementation UtilsTest
 
 - (void)testClampToUnitRange_TooLow {
-  CGFloat value = -55.0;
-  CGFloat clampedValue = ClampToUnitRange(value);
+  Float value = -55.0;
+  Float clampedValue = ClampToUnitRange(value);
   XCTAssertEqualWithAccuracy(clampedValue, 0.0, kTolerance);
 }
 
 - (void)testClampToUnitRange_Bottom {
-  CGFloat value = 0.0;
-  CGFloat clampedValue = ClampToUnitRange(value);
+  Float value = 0.0;
+  Float clampedValue = ClampToUnitRange(value);
   XCTAssertEqualWithAccuracy(value, clampedValue, kTolerance);
 }
 
 - (void)testClampToUnitRange_Mid {
-  CGFloat value = 0.5;
-  CGFloat clampedValue = ClampToUnitRange(value);
+  Float value = 0.5;
+  Float clampedValue = ClampToUnitRange(value);
   XCTAssertEqualWithAccuracy(value, clampedValue, kTolerance);
 }
 
 - (void)testClampToUnitRange_Top {
-  CGFloat value = 1.0;
-  CGFloat clampedValue = ClampToUnitRange(value);
+  Float value = 1.0;
+  Float clampedValue = ClampToUnitRange(value);
   XCTAssertEqualWithAccuracy(value, clampedValue, kTolerance);
 }
 
 - (void)testClampToUnitRange_TooHigh {
-  CGFloat value = 5.0;
-  CGFloat clampedValue = ClampToUnitRange(value);
+  Float value = 5.0;
+  Float clampedValue = ClampToUnitRange(value);
   XCTAssertEqualWithAccuracy(clampedValue, 1.0, kTolerance);
 }
 
 - (void)testSvgArcToCgArc_Large1Sweep0 {
-  CGPoint start_point = CGPointMake(40.0, 0.0);
-  CGPoint end_point = CGPointMake(60.0, 20.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 0.0);
+  FloatPoint end_point(60.0, 20.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, true, false,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 40.0, kTolerance);
@@ -107,12 +105,12 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArc_Large1Sweep1 {
-  CGPoint start_point = CGPointMake(40.0, 0.0);
-  CGPoint end_point = CGPointMake(60.0, 20.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 0.0);
+  FloatPoint end_point(60.0, 20.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, true, true,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 60.0, kTolerance);
@@ -122,12 +120,12 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArc_Large0Sweep0 {
-  CGPoint start_point = CGPointMake(40.0, 0.0);
-  CGPoint end_point = CGPointMake(60.0, 20.0);
-  CGFloat radius= 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 0.0);
+  FloatPoint end_point(60.0, 20.0);
+  Float radius= 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, false, false,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 60.0, kTolerance);
@@ -137,12 +135,12 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArc_Large0Sweep1 {
-  CGPoint start_point = CGPointMake(40.0, 0.0);
-  CGPoint end_point = CGPointMake(60.0, 20.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 0.0);
+  FloatPoint end_point(60.0, 20.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, false, true,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 40.0, kTolerance);
@@ -152,12 +150,12 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArcVertical_Large0Sweep1 {
-  CGPoint start_point = CGPointMake(20.0, 40.0);
-  CGPoint end_point = CGPointMake(60.0, 40.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(20.0, 40.0);
+  FloatPoint end_point(60.0, 40.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, false, true,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 40.0, kTolerance);
@@ -167,12 +165,12 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArcHorizontal_Large0Sweep1 {
-  CGPoint start_point = CGPointMake(40.0, 20.0);
-  CGPoint end_point = CGPointMake(40.0, 60.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 20.0);
+  FloatPoint end_point(40.0, 60.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertTrue(SvgArcToCgArc(start_point, end_point, false, true,
                               &radius, &center, &start_angle, &end_angle));
   XCTAssertEqualWithAccuracy(center.x, 40.0, kTolerance);
@@ -182,23 +180,23 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
 }
 
 - (void)testSvgArcToCgArc_ErrorSamePoint {
-  CGPoint start_point = CGPointMake(40.0, 60.0);
-  CGPoint end_point = CGPointMake(40.0, 60.0);
-  CGFloat radius = 20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(40.0, 60.0);
+  FloatPoint end_point(40.0, 60.0);
+  Float radius = 20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertFalse(SvgArcToCgArc(start_point, end_point, false, true,
                                &radius, &center, &start_angle, &end_angle));
 }
 
 - (void)testSvgArcToCgArc_ErrorNegativeRadius {
-  CGPoint start_point = CGPointMake(20.0, 60.0);
-  CGPoint end_point = CGPointMake(40.0, 40.0);
-  CGFloat radius = -20.0;
-  CGPoint center = CGPointZero;
-  CGFloat start_angle = 0.0;
-  CGFloat end_angle = 0.0;
+  FloatPoint start_point(20.0, 60.0);
+  FloatPoint end_point(40.0, 40.0);
+  Float radius = -20.0;
+  FloatPoint center;
+  Float start_angle = 0.0;
+  Float end_angle = 0.0;
   XCTAssertFalse(SvgArcToCgArc(start_point, end_point, false, true,
                                &radius, &center, &start_angle, &end_angle));
 }
@@ -227,9 +225,9 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
   XCTAssertFalse(AreAnglesClose(kPi / 2, kPi, kTolerance));
 }
 
-- (void)testCGAffineTransformToNormalizeRect {
-  CGRect rect = CGRectMake(30, 50, 120, 390);
-  CGAffineTransform transform = CGAffineTransformToNormalizeRect(rect);
+- (void)testToNormalizeRect {
+  FloatRect rect(30, 50, 120, 390);
+  AffineTransform transform = TransformToNormalizeRect(rect);
   XCTAssertEqual(transform.a, 120);
   XCTAssertEqual(transform.b, 0);
   XCTAssertEqual(transform.c, 0);
@@ -238,121 +236,121 @@ static CGAffineTransform UniformScaleThenTranslate(CGFloat scale,
   XCTAssertEqual(transform.ty, 50);
 }
 
-- (void)testCGAffineTransformForPreserveAspectRatio_Nonuniform {
-  CGRect target_viewport = CGRectMake(0, 0, 100, 100);
-  CGRect view_box = CGRectMake(0, 0, 20, 10);
+- (void)testForPreserveAspectRatio_Nonuniform {
+  FloatRect target_viewport(0, 0, 100, 100);
+  FloatRect view_box(0, 0, 20, 10);
   PreserveAspectRatio r = PreserveAspectRatio::default_value();
   r.no_alignment = true;
-  CGAffineTransform t =
-      CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, CGAffineTransformMakeScale(5, 10));
+  AffineTransform t =
+      TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, AffineTransform::MakeScale(5, 10));
 }
 
-- (void)testCGAffineTransformForPreserveAspectRatio_Meet_LandscapeViewBox {
-  CGRect target_viewport = CGRectMake(0, 0, 100, 100);
+- (void)testForPreserveAspectRatio_Meet_LandscapeViewBox {
+  FloatRect target_viewport(0, 0, 100, 100);
   // The object is uniformly scaled to 100 x 50.
-  CGRect view_box = CGRectMake(0, 0, 20, 10);
+  FloatRect view_box(0, 0, 20, 10);
   PreserveAspectRatio r = PreserveAspectRatio::default_value();
   r.meet_or_slice = PreserveAspectRatio::kMeet;
 
   r.x_alignment = PreserveAspectRatio::kMin;
   r.y_alignment = PreserveAspectRatio::kMin;
-  CGAffineTransform t =
-      CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 0));
+  AffineTransform t =
+      TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 0));
 
   r.x_alignment = PreserveAspectRatio::kMid;
   r.y_alignment = PreserveAspectRatio::kMid;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 25));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 25));
 
   r.x_alignment = PreserveAspectRatio::kMax;
   r.y_alignment = PreserveAspectRatio::kMax;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 50));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 50));
 }
 
-- (void)testCGAffineTransformForPreserveAspectRatio_Meet_PortraitViewBox {
-  CGRect target_viewport = CGRectMake(0, 0, 100, 100);
+- (void)testForPreserveAspectRatio_Meet_PortraitViewBox {
+  FloatRect target_viewport(0, 0, 100, 100);
   // The object is uniformly scaled to 50 x 100.
-  CGRect view_box = CGRectMake(0, 0, 10, 20);
+  FloatRect view_box(0, 0, 10, 20);
   PreserveAspectRatio r = PreserveAspectRatio::default_value();
   r.meet_or_slice = PreserveAspectRatio::kMeet;
 
   r.x_alignment = PreserveAspectRatio::kMin;
   r.y_alignment = PreserveAspectRatio::kMin;
-  CGAffineTransform t =
-      CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 0));
+  AffineTransform t =
+      TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 0, 0));
 
   r.x_alignment = PreserveAspectRatio::kMid;
   r.y_alignment = PreserveAspectRatio::kMid;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 25, 0));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 25, 0));
 
   r.x_alignment = PreserveAspectRatio::kMax;
   r.y_alignment = PreserveAspectRatio::kMax;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(5, 50, 0));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(5, 50, 0));
 }
 
-- (void)testCGAffineTransformForPreserveAspectRatio_Slice_LandscapeViewBox {
-  CGRect target_viewport = CGRectMake(0, 0, 100, 100);
+- (void)testForPreserveAspectRatio_Slice_LandscapeViewBox {
+  FloatRect target_viewport(0, 0, 100, 100);
   // The object is uniformly scaled to 200 x 100 (and cliped).
-  CGRect view_box = CGRectMake(0, 0, 20, 10);
+  FloatRect view_box(0, 0, 20, 10);
   PreserveAspectRatio r = PreserveAspectRatio::default_value();
   r.meet_or_slice = PreserveAspectRatio::kSlice;
 
   r.x_alignment = PreserveAspectRatio::kMin;
   r.y_alignment = PreserveAspectRatio::kMin;
-  CGAffineTransform t =
-      CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, 0));
+  AffineTransform t =
+      TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, 0));
 
   r.x_alignment = PreserveAspectRatio::kMid;
   r.y_alignment = PreserveAspectRatio::kMid;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, -50, 0));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, -50, 0));
 
   r.x_alignment = PreserveAspectRatio::kMax;
   r.y_alignment = PreserveAspectRatio::kMax;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, -100, 0));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, -100, 0));
 }
 
-- (void)testCGAffineTransformForPreserveAspectRatio_Slice_PortrailViewBox {
-  CGRect target_viewport = CGRectMake(0, 0, 100, 100);
+- (void)testForPreserveAspectRatio_Slice_PortrailViewBox {
+  FloatRect target_viewport(0, 0, 100, 100);
   // The object is uniformly scaled to 100 x 200 (and cliped)
-  CGRect view_box = CGRectMake(0, 0, 10, 20);
+  FloatRect view_box(0, 0, 10, 20);
   PreserveAspectRatio r = PreserveAspectRatio::default_value();
   r.meet_or_slice = PreserveAspectRatio::kSlice;
 
   r.x_alignment = PreserveAspectRatio::kMin;
   r.y_alignment = PreserveAspectRatio::kMin;
-  CGAffineTransform t =
-      CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, 0));
+  AffineTransform t =
+      TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, 0));
 
   r.x_alignment = PreserveAspectRatio::kMid;
   r.y_alignment = PreserveAspectRatio::kMid;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, -50));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, -50));
 
   r.x_alignment = PreserveAspectRatio::kMax;
   r.y_alignment = PreserveAspectRatio::kMax;
-  t = CGAffineTransformForPreserveAspectRatio(r, view_box, target_viewport);
-  AssertCGAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, -100));
+  t = TransformForPreserveAspectRatio(r, view_box, target_viewport);
+  AssertAffineTransformEqual(t, UniformScaleThenTranslate(10, 0, -100));
 }
 
 - (void)testEvaluateLength_NoUnit {
   Length length(100, Length::kUnitNone);
-  CGFloat value = EvaluateLength(length);
+  Float value = EvaluateLength(length);
   XCTAssertEqualWithAccuracy(value, 100, kTolerance);
 }
 
 - (void)testEvaluateLength_Percentage {
   Length length(100, Length::kUnitPercent);
-  CGFloat value = EvaluateLength(length);
+  Float value = EvaluateLength(length);
   XCTAssertEqualWithAccuracy(value, 1, kTolerance);
 }
 
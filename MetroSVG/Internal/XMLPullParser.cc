@@ -0,0 +1,680 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MetroSVG/Internal/XMLPullParser.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace metrosvg {
+namespace internal {
+
+namespace {
+
+bool IsXMLWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+// Names are limited to ASCII. Others are left to libxml2.
+bool IsXMLNameStartChar(char c) {
+  return static_cast<unsigned char>((c | 0x20) - 'a') < 26 ||
+         c == '_' || c == ':';
+}
+
+bool IsXMLNameChar(char c) {
+  return IsXMLNameStartChar(c) || static_cast<unsigned char>(c - '0') < 10 ||
+         c == '-' || c == '.';
+}
+
+// Control characters, including whitespace other than the space, and
+// non-ASCII bytes.
+bool IsXMLSpecialByte(char c) {
+  return static_cast<unsigned char>(c - 0x20) >= 0x60;
+}
+
+// The Char production of XML 1.0.
+bool IsXMLChar(uint32_t code_point) {
+  return code_point == 0x9 || code_point == 0xA || code_point == 0xD ||
+         (0x20 <= code_point && code_point <= 0xD7FF) ||
+         (0xE000 <= code_point && code_point <= 0xFFFD) ||
+         (0x10000 <= code_point && code_point <= 0x10FFFF);
+}
+
+void AppendUTF8(uint32_t code_point, std::string *s) {
+  if (code_point < 0x80) {
+    *s += static_cast<char>(code_point);
+  } else if (code_point < 0x800) {
+    *s += static_cast<char>(0xC0 | (code_point >> 6));
+    *s += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    *s += static_cast<char>(0xE0 | (code_point >> 12));
+    *s += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    *s += static_cast<char>(0x80 | (code_point & 0x3F));
+  } else {
+    *s += static_cast<char>(0xF0 | (code_point >> 18));
+    *s += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+    *s += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+    *s += static_cast<char>(0x80 | (code_point & 0x3F));
+  }
+}
+
+// |lowercase| must be lowercase.
+bool EqualsIgnoringASCIICase(const StringPiece &s, const char *lowercase) {
+  size_t length = std::strlen(lowercase);
+  if (s.length() != length) {
+    return false;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    char c = s[i];
+    if ('A' <= c && c <= 'Z') {
+      c += 'a' - 'A';
+    }
+    if (c != lowercase[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsPubidLiteral(const StringPiece &literal) {
+  static const char kPubidPunctuation[] = " \r\n-'()+,./:=?;!*#@$_%";
+  for (size_t i = 0; i < literal.length(); ++i) {
+    char c = literal[i];
+    if (!IsXMLNameChar(c) && std::strchr(kPubidPunctuation, c) == NULL) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+XMLPullParser::XMLPullParser(const char *data, size_t length)
+    : end_(data + length),
+      p_(data),
+      status_(kStatusNode),
+      started_(false),
+      node_type_(kNodeTypeText),
+      is_empty_element_(false),
+      line_number_(0),
+      column_number_(0),
+      has_root_element_(false),
+      has_doctype_(false),
+      line_(1),
+      line_counted_up_to_(data),
+      line_begin_(data) {}
+
+XMLPullParser::Status XMLPullParser::Next() {
+  if (status_ != kStatusNode) {
+    return status_;
+  }
+  if (!started_) {
+    started_ = true;
+    if (!ParseXMLDeclaration()) {
+      return Fail();
+    }
+  }
+  name_ = StringPiece();
+  attributes_.clear();
+  is_empty_element_ = false;
+  text_ = StringPiece();
+  decoded_.clear();
+
+  while (true) {
+    if (p_ == end_) {
+      if (!has_root_element_ || !open_element_names_.empty()) {
+        return Fail();
+      }
+      status_ = kStatusEnd;
+      return status_;
+    }
+    const char *node_begin = p_;
+    if (*p_ != '<') {
+      bool has_content;
+      if (!ParseText(&has_content)) {
+        return Fail();
+      }
+      if (!has_content) {
+        decoded_.clear();
+        continue;
+      }
+      node_type_ = kNodeTypeText;
+    } else if (ConsumePrefix("<!--")) {
+      if (!SkipComment()) {
+        return Fail();
+      }
+      continue;
+    } else if (ConsumePrefix("<?")) {
+      if (!SkipProcessingInstruction()) {
+        return Fail();
+      }
+      continue;
+    } else if (ConsumePrefix("<![CDATA[")) {
+      if (open_element_names_.empty() || !ParseCDATA()) {
+        return Fail();
+      }
+      node_type_ = kNodeTypeCDATA;
+    } else if (ConsumePrefix("<!DOCTYPE")) {
+      if (has_doctype_ || has_root_element_ || !ParseDoctype()) {
+        return Fail();
+      }
+      has_doctype_ = true;
+      continue;
+    } else if (ConsumePrefix("</")) {
+      if (!ParseEndTag()) {
+        return Fail();
+      }
+      node_type_ = kNodeTypeEndElement;
+    } else {
+      ++p_;
+      if (!ParseStartTag()) {
+        return Fail();
+      }
+      node_type_ = kNodeTypeStartElement;
+    }
+    UpdatePosition(node_begin);
+    return kStatusNode;
+  }
+}
+
+XMLPullParser::Status XMLPullParser::Fail() {
+  status_ = kStatusUnsupported;
+  return status_;
+}
+
+void XMLPullParser::UpdatePosition(const char *node_begin) {
+  while (const void *newline =
+             std::memchr(line_counted_up_to_, '\n',
+                         node_begin - line_counted_up_to_)) {
+    ++line_;
+    line_begin_ = static_cast<const char *>(newline) + 1;
+    line_counted_up_to_ = line_begin_;
+  }
+  line_counted_up_to_ = node_begin;
+  line_number_ = line_;
+  column_number_ = static_cast<int>(node_begin - line_begin_) + 1;
+}
+
+bool XMLPullParser::ParseXMLDeclaration() {
+  ConsumePrefix("\xEF\xBB\xBF");
+  if (!ConsumePrefix("<?xml")) {
+    return true;
+  }
+  if (!SkipWhitespace()) {
+    // A processing instruction like <?xml-stylesheet ...?>.
+    p_ -= 5;
+    return true;
+  }
+  StringPiece value;
+  if (!ConsumePrefix("version") || !ConsumeEq() ||
+      !ConsumeQuotedLiteral(&value) ||
+      value.length() < 3 || value[0] != '1' || value[1] != '.') {
+    return false;
+  }
+  for (size_t i = 2; i < value.length(); ++i) {
+    if (static_cast<unsigned char>(value[i] - '0') >= 10) {
+      return false;
+    }
+  }
+  bool has_whitespace = SkipWhitespace();
+  if (has_whitespace && ConsumePrefix("encoding")) {
+    // Other encodings are left to libxml2.
+    if (!ConsumeEq() || !ConsumeQuotedLiteral(&value) ||
+        !EqualsIgnoringASCIICase(value, "utf-8")) {
+      return false;
+    }
+    has_whitespace = SkipWhitespace();
+  }
+  if (has_whitespace && ConsumePrefix("standalone")) {
+    if (!ConsumeEq() || !ConsumeQuotedLiteral(&value) ||
+        !(value == "yes" || value == "no")) {
+      return false;
+    }
+    SkipWhitespace();
+  }
+  return ConsumePrefix("?>");
+}
+
+bool XMLPullParser::ParseDoctype() {
+  StringPiece name;
+  StringPiece literal;
+  if (!SkipWhitespace() || !ConsumeName(&name)) {
+    return false;
+  }
+  bool has_whitespace = SkipWhitespace();
+  if (has_whitespace && ConsumePrefix("SYSTEM")) {
+    if (!SkipWhitespace() || !ConsumeQuotedLiteral(&literal)) {
+      return false;
+    }
+    SkipWhitespace();
+  } else if (has_whitespace && ConsumePrefix("PUBLIC")) {
+    if (!SkipWhitespace() || !ConsumeQuotedLiteral(&literal) ||
+        !IsPubidLiteral(literal) ||
+        !SkipWhitespace() || !ConsumeQuotedLiteral(&literal)) {
+      return false;
+    }
+    SkipWhitespace();
+  }
+  // The external subset isn't loaded, so only an internal subset could
+  // declare entities or default attributes. It is left to libxml2.
+  return ConsumePrefix(">");
+}
+
+bool XMLPullParser::SkipComment() {
+  while (true) {
+    while (p_ != end_ && *p_ != '-' && !IsXMLSpecialByte(*p_)) {
+      ++p_;
+    }
+    if (p_ == end_) {
+      return false;
+    }
+    if (*p_ == '-') {
+      ++p_;
+      if (p_ != end_ && *p_ == '-') {
+        // "--" must end the comment.
+        return ConsumePrefix("->");
+      }
+    } else if (!SkipSpecialCharacter()) {
+      return false;
+    }
+  }
+}
+
+bool XMLPullParser::SkipProcessingInstruction() {
+  StringPiece target;
+  if (!ConsumeName(&target) || EqualsIgnoringASCIICase(target, "xml")) {
+    return false;
+  }
+  if (ConsumePrefix("?>")) {
+    return true;
+  }
+  return SkipWhitespace() && SkipPast("?>");
+}
+
+bool XMLPullParser::ParseCDATA() {
+  const char *text_begin = p_;
+  if (!SkipPast("]]>")) {
+    return false;
+  }
+  text_ = StringPiece(text_begin, p_ - 3);
+  return true;
+}
+
+bool XMLPullParser::ParseText(bool *has_content) {
+  const char *text_begin = p_;
+  SkipWhitespace();
+  *has_content = p_ != end_ && *p_ != '<';
+  if (!*has_content) {
+    return true;
+  }
+  // Only whitespace may appear outside of the root element.
+  if (open_element_names_.empty()) {
+    return false;
+  }
+  // Rescans the leading whitespace for line ends to normalize.
+  p_ = text_begin;
+  const char *run_begin = text_begin;
+  bool is_decoded = false;
+  while (true) {
+    while (p_ != end_ && *p_ != '<' && *p_ != '&' && *p_ != '>' &&
+           !IsXMLSpecialByte(*p_)) {
+      ++p_;
+    }
+    if (p_ == end_ || *p_ == '<') {
+      break;
+    }
+    char c = *p_;
+    if (c == '>') {
+      if (p_ - text_begin >= 2 && p_[-1] == ']' && p_[-2] == ']') {
+        return false;
+      }
+      ++p_;
+    } else if (c == '&' || c == '\r') {
+      decoded_.append(run_begin, p_);
+      is_decoded = true;
+      if (c == '&') {
+        if (!DecodeReference()) {
+          return false;
+        }
+      } else {
+        // Line ends are normalized to "\n".
+        ++p_;
+        ConsumePrefix("\n");
+        decoded_ += '\n';
+      }
+      run_begin = p_;
+    } else if (c == '\n' || c == '\t') {
+      ++p_;
+    } else if (!SkipSpecialCharacter()) {
+      return false;
+    }
+  }
+  if (is_decoded) {
+    decoded_.append(run_begin, p_);
+    text_ = StringPiece(decoded_);
+    // Character references may decode to whitespace only, which is
+    // skipped like whitespace in the source.
+    *has_content = false;
+    for (size_t i = 0; i < text_.length(); ++i) {
+      if (!IsXMLWhitespace(text_[i])) {
+        *has_content = true;
+        break;
+      }
+    }
+  } else {
+    text_ = StringPiece(text_begin, p_);
+  }
+  return true;
+}
+
+bool XMLPullParser::ParseStartTag() {
+  // There is only one root element.
+  if (open_element_names_.empty() && has_root_element_) {
+    return false;
+  }
+  if (!ConsumeName(&name_)) {
+    return false;
+  }
+  // Offsets in |decoded_| of the values that were decoded, which are only
+  // set once |decoded_| stops growing.
+  std::vector<std::pair<size_t, size_t>> decoded_values;
+  while (true) {
+    bool has_whitespace = SkipWhitespace();
+    if (ConsumePrefix(">")) {
+      break;
+    }
+    if (ConsumePrefix("/>")) {
+      is_empty_element_ = true;
+      break;
+    }
+    Attribute attribute;
+    if (!has_whitespace || !ConsumeName(&attribute.name) || !ConsumeEq()) {
+      return false;
+    }
+    for (const Attribute &other : attributes_) {
+      if (other.name == attribute.name) {
+        return false;
+      }
+    }
+    size_t decoded_begin = decoded_.size();
+    if (!ParseAttributeValue(&attribute.value)) {
+      return false;
+    }
+    // Undeclaring a prefix is a namespace error, on which libxml2 drops
+    // the attribute.
+    if (attribute.value.length() == 0 &&
+        attribute.name.length() > 6 &&
+        StringPiece(attribute.name.begin(), 6) == "xmlns:") {
+      return false;
+    }
+    if (decoded_.size() != decoded_begin) {
+      decoded_values.emplace_back(attributes_.size(), decoded_begin);
+    }
+    attributes_.push_back(attribute);
+  }
+  for (const auto &decoded_value : decoded_values) {
+    StringPiece *value = &attributes_[decoded_value.first].value;
+    *value = StringPiece(decoded_.data() + decoded_value.second,
+                         value->length());
+  }
+  has_root_element_ = true;
+  if (!is_empty_element_) {
+    open_element_names_.push_back(name_);
+  }
+  return true;
+}
+
+bool XMLPullParser::ParseEndTag() {
+  if (!ConsumeName(&name_)) {
+    return false;
+  }
+  SkipWhitespace();
+  if (!ConsumePrefix(">") || open_element_names_.empty() ||
+      !(open_element_names_.back() == name_)) {
+    return false;
+  }
+  open_element_names_.pop_back();
+  return true;
+}
+
+bool XMLPullParser::ParseAttributeValue(StringPiece *value) {
+  if (p_ == end_ || (*p_ != '"' && *p_ != '\'')) {
+    return false;
+  }
+  char quote = *p_++;
+  const char *value_begin = p_;
+  const char *run_begin = p_;
+  size_t decoded_begin = decoded_.size();
+  bool is_decoded = false;
+  while (true) {
+    while (p_ != end_ && *p_ != quote && *p_ != '&' && *p_ != '<' &&
+           !IsXMLSpecialByte(*p_)) {
+      ++p_;
+    }
+    if (p_ == end_ || *p_ == '<') {
+      return false;
+    }
+    char c = *p_;
+    if (c == quote) {
+      break;
+    }
+    if (c == '&' || IsXMLWhitespace(c)) {
+      decoded_.append(run_begin, p_);
+      is_decoded = true;
+      if (c == '&') {
+        if (!DecodeReference()) {
+          return false;
+        }
+      } else {
+        // Whitespace characters, and "\r\n" line ends, become spaces.
+        ++p_;
+        if (c == '\r') {
+          ConsumePrefix("\n");
+        }
+        decoded_ += ' ';
+      }
+      run_begin = p_;
+    } else if (!SkipSpecialCharacter()) {
+      return false;
+    }
+  }
+  if (is_decoded) {
+    decoded_.append(run_begin, p_);
+    // The caller points the value into |decoded_|.
+    *value = StringPiece(NULL, decoded_.size() - decoded_begin);
+  } else {
+    *value = StringPiece(value_begin, p_);
+  }
+  ++p_;
+  return true;
+}
+
+bool XMLPullParser::DecodeReference() {
+  ++p_;
+  if (ConsumePrefix("#")) {
+    bool is_hex = ConsumePrefix("x");
+    const char *digits_begin = p_;
+    uint32_t code_point = 0;
+    for (; p_ != end_ && *p_ != ';'; ++p_) {
+      char c = *p_;
+      uint32_t digit;
+      if ('0' <= c && c <= '9') {
+        digit = c - '0';
+      } else if (is_hex && 'a' <= (c | 0x20) && (c | 0x20) <= 'f') {
+        digit = (c | 0x20) - 'a' + 10;
+      } else {
+        return false;
+      }
+      code_point = code_point * (is_hex ? 16 : 10) + digit;
+      if (code_point > 0x10FFFF) {
+        return false;
+      }
+    }
+    if (p_ == digits_begin || !ConsumePrefix(";") || !IsXMLChar(code_point)) {
+      return false;
+    }
+    AppendUTF8(code_point, &decoded_);
+    return true;
+  }
+  StringPiece name;
+  if (!ConsumeName(&name) || !ConsumePrefix(";")) {
+    return false;
+  }
+  // Only the predefined entities; others need a DTD.
+  if (name == "lt") {
+    decoded_ += '<';
+  } else if (name == "gt") {
+    decoded_ += '>';
+  } else if (name == "amp") {
+    decoded_ += '&';
+  } else if (name == "apos") {
+    decoded_ += '\'';
+  } else if (name == "quot") {
+    decoded_ += '"';
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool XMLPullParser::ConsumeName(StringPiece *name) {
+  const char *name_begin = p_;
+  if (p_ == end_ || !IsXMLNameStartChar(*p_)) {
+    return false;
+  }
+  ++p_;
+  while (p_ != end_ && IsXMLNameChar(*p_)) {
+    ++p_;
+  }
+  if (p_ != end_ && static_cast<unsigned char>(*p_) >= 0x80) {
+    return false;
+  }
+  *name = StringPiece(name_begin, p_);
+  return true;
+}
+
+bool XMLPullParser::SkipWhitespace() {
+  const char *whitespace_begin = p_;
+  while (p_ != end_ && IsXMLWhitespace(*p_)) {
+    ++p_;
+  }
+  return p_ != whitespace_begin;
+}
+
+bool XMLPullParser::ConsumeEq() {
+  SkipWhitespace();
+  if (!ConsumePrefix("=")) {
+    return false;
+  }
+  SkipWhitespace();
+  return true;
+}
+
+bool XMLPullParser::ConsumeQuotedLiteral(StringPiece *literal) {
+  if (p_ == end_ || (*p_ != '"' && *p_ != '\'')) {
+    return false;
+  }
+  char quote = *p_++;
+  const char *literal_begin = p_;
+  while (p_ != end_ && *p_ != quote) {
+    if (!IsXMLSpecialByte(*p_)) {
+      ++p_;
+    } else if (!SkipSpecialCharacter()) {
+      return false;
+    }
+  }
+  if (p_ == end_) {
+    return false;
+  }
+  *literal = StringPiece(literal_begin, p_);
+  ++p_;
+  return true;
+}
+
+bool XMLPullParser::ConsumePrefix(const char *s) {
+  size_t length = std::strlen(s);
+  if (static_cast<size_t>(end_ - p_) < length ||
+      std::memcmp(p_, s, length) != 0) {
+    return false;
+  }
+  p_ += length;
+  return true;
+}
+
+bool XMLPullParser::SkipPast(const char *terminator) {
+  while (true) {
+    while (p_ != end_ && *p_ != terminator[0] && !IsXMLSpecialByte(*p_)) {
+      ++p_;
+    }
+    if (p_ == end_) {
+      return false;
+    }
+    if (ConsumePrefix(terminator)) {
+      return true;
+    }
+    if (*p_ == terminator[0]) {
+      ++p_;
+    } else if (!SkipSpecialCharacter()) {
+      return false;
+    }
+  }
+}
+
+bool XMLPullParser::SkipSpecialCharacter() {
+  const unsigned char *s = reinterpret_cast<const unsigned char *>(p_);
+  size_t length;
+  uint32_t code_point;
+  if (s[0] < 0x80) {
+    // Control characters other than whitespace aren't allowed.
+    if (!IsXMLWhitespace(*p_)) {
+      return false;
+    }
+    ++p_;
+    return true;
+  } else if (0xC2 <= s[0] && s[0] <= 0xDF) {
+    length = 2;
+    code_point = s[0] & 0x1F;
+  } else if (0xE0 <= s[0] && s[0] <= 0xEF) {
+    length = 3;
+    code_point = s[0] & 0x0F;
+  } else if (0xF0 <= s[0] && s[0] <= 0xF4) {
+    length = 4;
+    code_point = s[0] & 0x07;
+  } else {
+    return false;
+  }
+  if (static_cast<size_t>(end_ - p_) < length) {
+    return false;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if ((s[i] & 0xC0) != 0x80) {
+      return false;
+    }
+    code_point = (code_point << 6) | (s[i] & 0x3F);
+  }
+  // Overlong forms are invalid UTF-8.
+  if ((length == 3 && code_point < 0x800) ||
+      (length == 4 && code_point < 0x10000) ||
+      !IsXMLChar(code_point)) {
+    return false;
+  }
+  p_ += length;
+  return true;
+}
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "MetroSVG/Internal/Macros.h"
+#include "MetroSVG/Internal/StringPiece.h"
+
+namespace metrosvg {
+namespace internal {
+
+// A pull parser for the subset of XML that SVG documents use in practice:
+// UTF-8 text with elements, attributes, character data, CDATA sections,
+// comments, processing instructions, character references, the predefined
+// entities and a document type declaration without an internal subset.
+//
+// Names, attribute values and text are slices of the input. Only values
+// that need decoding, i.e., that contain references or whitespace that XML
+// normalizes, are copied into a buffer of the parser.
+//
+// Anything else, e.g., other entities, an internal DTD subset or another
+// encoding, is reported as unsupported, and so is data that isn't
+// well-formed. The data should then be parsed with libxml2, which has the
+// final say on it. Nodes are reported as the libxml2 reader reports them,
+// with the exceptions that whitespace-only text, comments and processing
+// instructions are skipped and that namespaces aren't resolved.
+class XMLPullParser {
+ public:
+  enum Status {
+    kStatusNode,  // The parser moved to the next node.
+    kStatusEnd,  // The document ended and was well-formed.
+    kStatusUnsupported,
+  };
+
+  enum NodeType {
+    kNodeTypeStartElement,
+    kNodeTypeEndElement,
+    kNodeTypeText,
+    kNodeTypeCDATA,
+  };
+
+  struct Attribute {
+    StringPiece name;
+    StringPiece value;
+  };
+
+  // |data| must outlive the parser.
+  XMLPullParser(const char *data, size_t length);
+
+  // Moves to the next node. After kStatusEnd or kStatusUnsupported, the
+  // parser stays where it is.
+  Status Next();
+
+  // The following describe the current node and are valid until the next
+  // call to Next().
+  NodeType node_type() const { return node_type_; }
+  // Qualified name of an element.
+  const StringPiece &name() const { return name_; }
+  // Attributes of a start element in document order.
+  const std::vector<Attribute> &attributes() const { return attributes_; }
+  // True if a start element has no end tag, e.g., <path/>. No end element
+  // node follows it.
+  bool is_empty_element() const { return is_empty_element_; }
+  // Content of a text node, or the raw content of a CDATA section.
+  const StringPiece &text() const { return text_; }
+  // Position of the first character of the node, counted from 1.
+  int line_number() const { return line_number_; }
+  int column_number() const { return column_number_; }
+
+ private:
+  const char *const end_;
+  const char *p_;
+  Status status_;
+  bool started_;
+
+  NodeType node_type_;
+  StringPiece name_;
+  std::vector<Attribute> attributes_;
+  bool is_empty_element_;
+  StringPiece text_;
+  int line_number_;
+  int column_number_;
+  // Decoded attribute values and text of the current node.
+  std::string decoded_;
+
+  // Names of the open elements, for matching end tags.
+  std::vector<StringPiece> open_element_names_;
+  bool has_root_element_;
+  bool has_doctype_;
+
+  // Line counting is done lazily up to the start of each node.
+  int line_;
+  const char *line_counted_up_to_;
+  const char *line_begin_;
+
+  Status Fail();
+  void UpdatePosition(const char *node_begin);
+
+  bool ParseXMLDeclaration();
+  bool ParseDoctype();
+  bool SkipComment();
+  bool SkipProcessingInstruction();
+  bool ParseCDATA();
+  bool ParseText(bool *has_content);
+  bool ParseStartTag();
+  bool ParseEndTag();
+  // Consumes an attribute value, including the quotes. A value that needs
+  // decoding is appended to |decoded_|, and only its length is returned.
+  bool ParseAttributeValue(StringPiece *value);
+  // Appends the character of the reference at |p_| to |decoded_|.
+  bool DecodeReference();
+
+  bool ConsumeName(StringPiece *name);
+  // Returns true if there was any whitespace.
+  bool SkipWhitespace();
+  // Consumes whitespace, '=' and whitespace.
+  bool ConsumeEq();
+  bool ConsumeQuotedLiteral(StringPiece *literal);
+  // Consumes |s| if the input continues with it.
+  bool ConsumePrefix(const char *s);
+  // Skips to just after the next occurrence of |terminator|, checking that
+  // the characters before it are allowed in XML.
+  bool SkipPast(const char *terminator);
+  // Checks the non-ASCII or control character at |p_| and skips it.
+  bool SkipSpecialCharacter();
+
+  DISALLOW_COPY_AND_ASSIGN(XMLPullParser);
+};
+
+}  // namespace internal
+}  // namespace metrosvg
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2016 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <string>
+
+#include <libxml/xmlreader.h>
+#import <XCTest/XCTest.h>
+
+#include "MetroSVG/Internal/SceneGraph.h"
+#include "MetroSVG/Internal/XMLPullParser.h"
+
+using namespace metrosvg::internal;
+
+// Returns whether |data| is parsed to the end.
+static bool ParsesToEnd(const std::string &data) {
+  XMLPullParser parser(data.data(), data.size());
+  XMLPullParser::Status status;
+  while ((status = parser.Next()) == XMLPullParser::kStatusNode) {
+  }
+  return status == XMLPullParser::kStatusEnd;
+}
+
+// Returns a document of about 1 MB for the performance tests, made of
+// groups of styled shapes like those that drawing tools write.
+static std::string BenchmarkDocument() {
+  std::string data =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\""
+      " height=\"100\" viewBox=\"0 0 100 100\">\n";
+  for (int i = 0; i < 2500; ++i) {
+    std::string index = std::to_string(i);
+    data +=
+        "  <!-- Layer " + index + " -->\n"
+        "  <g id=\"layer" + index + "\" transform=\"translate(1.5 2.25)\">\n"
+        "    <path d=\"M10.5,20.25 C30.125,40.5 50.75,60.375 70,80 "
+        "L90.5,10.25 Z\" style=\"fill:#336699;stroke:none\"/>\n"
+        "    <rect x=\"12\" y=\"34\" width=\"56\" height=\"78\""
+        " fill=\"red\" fill-opacity=\"0.5\" stroke=\"black\"/>\n"
+        "    <circle cx=\"50\" cy=\"50\" r=\"25\" class=\"dot\"/>\n"
+        "  </g>\n";
+  }
+  data += "</svg>\n";
+  return data;
+}
+
+@interface XMLPullParserTest : XCTestCase
+@end
+
+@implementation XMLPullParserTest
+
+- (void)testElements {
+  std::string data =
+      "<svg width='10' height=\"20\">\n"
+      "  <g><rect x = '1'/></g>\n"
+      "</svg>\n";
+  XMLPullParser parser(data.data(), data.size());
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeStartElement);
+  XCTAssert(parser.name() == "svg");
+  XCTAssertFalse(parser.is_empty_element());
+  XCTAssertEqual(parser.attributes().size(), 2U);
+  XCTAssert(parser.attributes()[0].name == "width");
+  XCTAssert(parser.attributes()[0].value == "10");
+  XCTAssert(parser.attributes()[1].name == "height");
+  XCTAssert(parser.attributes()[1].value == "20");
+  XCTAssertEqual(parser.line_number(), 1);
+  XCTAssertEqual(parser.column_number(), 1);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeStartElement);
+  XCTAssert(parser.name() == "g");
+  XCTAssertEqual(parser.attributes().size(), 0U);
+  XCTAssertEqual(parser.line_number(), 2);
+  XCTAssertEqual(parser.column_number(), 3);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeStartElement);
+  XCTAssert(parser.name() == "rect");
+  XCTAssert(parser.is_empty_element());
+  XCTAssertEqual(parser.attributes().size(), 1U);
+  XCTAssert(parser.attributes()[0].value == "1");
+  XCTAssertEqual(parser.column_number(), 6);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+  XCTAssert(parser.name() == "g");
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+  XCTAssert(parser.name() == "svg");
+  XCTAssertEqual(parser.line_number(), 3);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusEnd);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusEnd);
+}
+
+- (void)testAttributeValues {
+  std::string data =
+      "<svg a='&lt;&gt;&amp;&quot;&apos;' b='&#65;&#x42;&#xe9;'"
+      " c='x\ty\r\nz\n' d='\"' e=\"'\"/>";
+  XMLPullParser parser(data.data(), data.size());
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.attributes().size(), 5U);
+  XCTAssert(parser.attributes()[0].value == "<>&\"'");
+  XCTAssert(parser.attributes()[1].value == "AB\xC3\xA9");
+  XCTAssert(parser.attributes()[2].value == "x y z ");
+  XCTAssert(parser.attributes()[3].value == "\"");
+  XCTAssert(parser.attributes()[4].value == "'");
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusEnd);
+}
+
+- (void)testText {
+  std::string data =
+      "<svg>\n"
+      "  <style>a &lt; b\r\nc</style>\n"
+      "  <style><![CDATA[x<y]]></style>\n"
+      "  <style> &#x20; </style>\n"
+      "</svg>";
+  XMLPullParser parser(data.data(), data.size());
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssert(parser.name() == "style");
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeText);
+  XCTAssert(parser.text() == "a < b\nc");
+  XCTAssertEqual(parser.line_number(), 2);
+  XCTAssertEqual(parser.column_number(), 10);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeCDATA);
+  XCTAssert(parser.text() == "x<y");
+
+  // Whitespace-only text is skipped.
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeStartElement);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+}
+
+- (void)testProlog {
+  std::string data =
+      "\xEF\xBB\xBF<?xml version='1.0' encoding='UTF-8' standalone='no'?>\n"
+      "<?xml-stylesheet href='a.css'?>\n"
+      "<!-- Comment -->\n"
+      "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\"\n"
+      "  \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n"
+      "<svg><!-- <g/> --><?pi?></svg>\n"
+      "<!-- Comment -->\n";
+  XMLPullParser parser(data.data(), data.size());
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssert(parser.name() == "svg");
+  XCTAssertEqual(parser.line_number(), 6);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.node_type(), XMLPullParser::kNodeTypeEndElement);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusEnd);
+
+  XCTAssert(ParsesToEnd("<?xml-stylesheet href='a.css'?><svg/>"));
+  XCTAssert(ParsesToEnd("<!DOCTYPE svg><svg/>"));
+  XCTAssert(ParsesToEnd("<!DOCTYPE svg SYSTEM 'svg.dtd'><svg/>"));
+}
+
+- (void)testUnsupported {
+  XCTAssert(ParsesToEnd("<svg/>"));
+  // Left to libxml2.
+  XCTAssertFalse(ParsesToEnd("<!DOCTYPE svg [<!ENTITY a 'b'>]><svg/>"));
+  XCTAssertFalse(ParsesToEnd("<svg a='&a;'/>"));
+  XCTAssertFalse(ParsesToEnd("<svg>&a;</svg>"));
+  XCTAssertFalse(ParsesToEnd(
+      "<?xml version='1.0' encoding='ISO-8859-1'?><svg/>"));
+  XCTAssertFalse(ParsesToEnd("<sv\xC3\xA9/>"));
+  XCTAssertFalse(ParsesToEnd("<svg xmlns:a=''/>"));
+  // Not well-formed.
+  XCTAssertFalse(ParsesToEnd(""));
+  XCTAssertFalse(ParsesToEnd("<svg>"));
+  XCTAssertFalse(ParsesToEnd("<svg></g>"));
+  XCTAssertFalse(ParsesToEnd("<svg/><svg/>"));
+  XCTAssertFalse(ParsesToEnd("<svg/>text"));
+  XCTAssertFalse(ParsesToEnd("<svg a='1' a='2'/>"));
+  XCTAssertFalse(ParsesToEnd("<svg a=1/>"));
+  XCTAssertFalse(ParsesToEnd("<svg a='<'/>"));
+  XCTAssertFalse(ParsesToEnd("<svg a='&#0;'/>"));
+  XCTAssertFalse(ParsesToEnd("<svg>]]></svg>"));
+  XCTAssertFalse(ParsesToEnd("<svg><!-- a -- b --></svg>"));
+  XCTAssertFalse(ParsesToEnd("<svg><?xml version='1.0'?></svg>"));
+  XCTAssertFalse(ParsesToEnd("<svg>\x01</svg>"));
+  XCTAssertFalse(ParsesToEnd("<svg>\xC0\xAF</svg>"));
+  XCTAssertFalse(ParsesToEnd(std::string("<svg>\0</svg>", 12)));
+
+  XMLPullParser parser("<svg><g></svg>", 14);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusNode);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusUnsupported);
+  XCTAssertEqual(parser.Next(), XMLPullParser::kStatusUnsupported);
+}
+
+- (void)testPerformance_Tokenize {
+  std::string data = BenchmarkDocument();
+  const std::string *data_pointer = &data;
+  [self measureBlock:^{
+    XMLPullParser parser(data_pointer->data(), data_pointer->size());
+    size_t attribute_count = 0;
+    while (parser.Next() == XMLPullParser::kStatusNode) {
+      if (parser.node_type() == XMLPullParser::kNodeTypeStartElement) {
+        attribute_count += parser.attributes().size();
+      }
+    }
+    XCTAssertEqual(attribute_count, 4U + 2500U * 15U);
+  }];
+}
+
+// The baseline for testPerformance_Tokenize: the libxml2 reader that
+// ParseSceneGraph falls back to, visiting the same nodes and attributes.
+- (void)testPerformance_TokenizeWithXMLTextReader {
+  std::string data = BenchmarkDocument();
+  const std::string *data_pointer = &data;
+  [self measureBlock:^{
+    xmlTextReader *reader =
+        xmlReaderForMemory(data_pointer->data(),
+                           static_cast<int>(data_pointer->size()),
+                           NULL,
+                           NULL,
+                           XML_PARSE_NOENT | XML_PARSE_NONET);
+    size_t attribute_count = 0;
+    while (xmlTextReaderRead(reader) > 0) {
+      if (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT) {
+        continue;
+      }
+      while (xmlTextReaderMoveToNextAttribute(reader) > 0) {
+        ++attribute_count;
+      }
+    }
+    xmlFreeTextReader(reader);
+    XCTAssertEqual(attribute_count, 4U + 2500U * 15U);
+  }];
+}
+
+- (void)testPerformance_ParseSceneGraph {
+  std::string data = BenchmarkDocument();
+  const std::string *data_pointer = &data;
+  [self measureBlock:^{
+    std::unique_ptr<SceneGraph> graph(
+        ParseSceneGraph(data_pointer->data(), data_pointer->size(), NULL));
+    XCTAssertEqual(graph->elements.size(), 1U + 2500U * 4U);
+  }];
+}
+
+// The baseline for testPerformance_ParseSceneGraph. An internal DTD
+// subset makes ParseSceneGraph build the scene graph from the libxml2
+// reader.
+- (void)testPerformance_ParseSceneGraphWithXMLTextReader {
+  std::string data = BenchmarkDocument();
+  data.insert(data.find("<svg"), "<!DOCTYPE svg []>\n");
+  XCTAssertFalse(ParsesToEnd(data));
+  const std::string *data_pointer = &data;
+  [self measureBlock:^{
+    std::unique_ptr<SceneGraph> graph(
+        ParseSceneGraph(data_pointer->data(), data_pointer->size(), NULL));
+    XCTAssertEqual(graph->elements.size(), 1U + 2500U * 4U);
+  }];
+}
+
+@end
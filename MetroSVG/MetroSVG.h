@@ -19,17 +19,16 @@
 
 #pragma once
 
-#include <TargetConditionals.h>
-
 #include "MetroSVG/Public/MSCDebug.h"
 #include "MetroSVG/Public/MSCDocument.h"
 #include "MetroSVG/Public/MSCStyleSheet.h"
 
-#ifdef __OBJC__ 
+#if defined(__OBJC__) && defined(__APPLE__)
+#include <TargetConditionals.h>
 #if TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
 
 #import "MetroSVG/iOS/MSVGDocument.h"
 #import "MetroSVG/iOS/MSVGStyleSheet.h"
 
 #endif  // TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
-#endif  // __OBJC__
+#endif  // defined(__OBJC__) && defined(__APPLE__)
@@ -14,18 +14,48 @@
  * limitations under the License.
  */
 
+// Defines MSC_CORE_GRAPHICS_SUPPORT, which tells whether the sources that
+// depend on CoreGraphics are built.
+#include "MetroSVG/Public/MSCDocument.h"
+
+#include "MetroSVG/Internal/Arena.cc"
+#include "MetroSVG/Internal/Atom.cc"
+#include "MetroSVG/Internal/AttributeTable.cc"
 #include "MetroSVG/Internal/BasicTypes.cc"
 #include "MetroSVG/Internal/BasicValueParsers.cc"
+#include "MetroSVG/Internal/CharacterScanning.cc"
+#include "MetroSVG/Internal/Compositing.cc"
 #include "MetroSVG/Internal/Constants.cc"
+#if MSC_CORE_GRAPHICS_SUPPORT
+#include "MetroSVG/Internal/CoreGraphicsCanvas.cc"
+#endif
+#include "MetroSVG/Internal/CPUFeatures.cc"
 #include "MetroSVG/Internal/Debug.cc"
+#include "MetroSVG/Internal/DecimalConversion.cc"
 #include "MetroSVG/Internal/Document.cc"
+#include "MetroSVG/Internal/Geometry.cc"
 #include "MetroSVG/Internal/Gradient.cc"
+#if MSC_CORE_GRAPHICS_SUPPORT
+#include "MetroSVG/Internal/GradientCache.cc"
+#endif
 #include "MetroSVG/Internal/LoggingUtils.cc"
+#if MSC_CORE_GRAPHICS_SUPPORT
+#include "MetroSVG/Internal/PathCache.cc"
+#endif
+#include "MetroSVG/Internal/PathData.cc"
 #include "MetroSVG/Internal/PathDataIterator.cc"
+#include "MetroSVG/Internal/Rasterizer.cc"
 #include "MetroSVG/Internal/Renderer.cc"
+#include "MetroSVG/Internal/SceneGraph.cc"
+#include "MetroSVG/Internal/SceneGraphArchive.cc"
+#include "MetroSVG/Internal/SoftwareCanvas.cc"
 #include "MetroSVG/Internal/StringPiece.cc"
+#include "MetroSVG/Internal/Stroker.cc"
 #include "MetroSVG/Internal/StyleIterator.cc"
 #include "MetroSVG/Internal/StyleSheet.cc"
 #include "MetroSVG/Internal/SVGStandardColor.cc"
+#include "MetroSVG/Internal/ThreadPool.cc"
+#include "MetroSVG/Internal/TiledRendering.cc"
 #include "MetroSVG/Internal/TransformIterator.cc"
 #include "MetroSVG/Internal/Utils.cc"
+#include "MetroSVG/Internal/XMLPullParser.cc"
@@ -16,43 +16,267 @@
 
 #pragma once
 
+#include <stddef.h>
+
+// Whether the CoreGraphics functions below are available. They are by
+// default on Apple platforms, where the library otherwise renders with
+// CoreGraphics too.
+#if !defined(MSC_CORE_GRAPHICS_SUPPORT)
+#if defined(__APPLE__)
+#define MSC_CORE_GRAPHICS_SUPPORT 1
+#else
+#define MSC_CORE_GRAPHICS_SUPPORT 0
+#endif
+#endif
+
+#if MSC_CORE_GRAPHICS_SUPPORT
 #include <CoreGraphics/CoreGraphics.h>
+#endif
 
-#include "MetroSVG/Public/MSCStylesheet.h"
+#include "MetroSVG/Public/MSCStyleSheet.h"
 
 #if defined __cplusplus
 extern "C" {
 #endif
 
+// Sizes and rectangles of the functions below. They are CGSize and CGRect
+// when CoreGraphics is available, and structs with the same fields
+// otherwise.
+#if MSC_CORE_GRAPHICS_SUPPORT
+typedef CGSize MSCSize;
+typedef CGRect MSCRect;
+#else
+typedef struct {
+  double x;
+  double y;
+} MSCPoint;
+
+typedef struct {
+  double width;
+  double height;
+} MSCSize;
+
+typedef struct {
+  MSCPoint origin;
+  MSCSize size;
+} MSCRect;
+#endif
+
 // MSCDocument is an opaque type that represents a single SVG document.
+//
+// A document can be rendered from multiple threads at the same time, at the
+// same or different canvas sizes, with the same or different style sheets.
+// Rendering only reads the document and the style sheet; the state of each
+// render is private to it. MSCDocumentPrepareForRendering and
+// MSCDocumentCopySerializedData can also be called while the document is
+// being rendered. MSCDocumentDelete must not be called until all other
+// calls on the document have returned.
 typedef struct MSCDocument MSCDocument;
 
 // Creates an MSCDocument instance with UTF-8-encoded SVG data. The data will be
-// partially parsed to compute basic properties of the image. The returned
-// instance must be deleted with MSCDocumentDelete when it is done.
-// |url| can be NULL.
+// partially parsed to compute basic properties of the image. Gzip-compressed
+// data, e.g., the content of an .svgz file, is instead decompressed and
+// parsed right away through an MSCDocumentLoader, and the document is not
+// tied to |data|. The returned instance must be deleted with
+// MSCDocumentDelete when it is done. |url| can be NULL.
 MSCDocument *MSCDocumentCreateFromData(const char *data,
                                        size_t length,
                                        const char *url);
 
+// Creates an MSCDocument instance with the UTF-8-encoded SVG file at |path|,
+// which is also used as the URL of the document. The file is mapped into memory
+// rather than read, so its pages are shared with other processes that map it
+// and can be evicted by the system; it must not be modified while the document
+// exists. In particular, if the file is truncated, e.g., by another process,
+// rendering the document crashes with SIGBUS when it reads past the new end of
+// the file. Files that other processes may truncate should be read into memory
+// and passed to MSCDocumentCreateFromData instead. A gzip-compressed file,
+// e.g., .svgz, is decompressed and parsed right away, so the document is
+// prepared for rendering as with MSCDocumentPrepareForRendering and the file
+// isn't kept mapped. Returns NULL if the file can't be mapped or decompressed,
+// or if its data is not well-formed where it has been parsed. The returned
+// instance must be deleted with MSCDocumentDelete when it is done.
+MSCDocument *MSCDocumentCreateFromFile(const char *path);
+
 // Deletes an MSCDocument instance.
 void MSCDocumentDelete(MSCDocument *document);
 
-// Fully parses data in a given MSCDocument and creates a CGImage from it.
+// MSCDocumentLoader is an opaque type that parses SVG data into an
+// MSCDocument as the data arrives in chunks, e.g., from a pipe or a
+// decompressor. Each chunk is parsed when it's appended and can be released
+// right away, so the whole data never has to be in memory at once. Data that
+// starts with the gzip magic number is decompressed as it arrives.
+typedef struct MSCDocumentLoader MSCDocumentLoader;
+
+// Creates an MSCDocumentLoader instance. The returned instance must be
+// deleted with MSCDocumentLoaderDelete when it is done. |url| can be NULL.
+MSCDocumentLoader *MSCDocumentLoaderCreate(const char *url);
+
+// Parses the next |length| bytes of UTF-8-encoded SVG data, or of its gzip
+// compression. The data is not accessed after this returns. Returns 1 on
+// success and 0 if the data so far is corrupt or not well-formed, in which
+// case the rest of the data is ignored.
+int MSCDocumentLoaderAppendData(MSCDocumentLoader *loader,
+                                const char *data,
+                                size_t length);
+
+// Ends the data and creates an MSCDocument instance from it that is already
+// prepared for rendering, as with MSCDocumentPrepareForRendering. Returns
+// NULL if the data is truncated or not well-formed. Must be called at most
+// once per loader. The returned instance must be deleted with
+// MSCDocumentDelete when it is done.
+MSCDocument *MSCDocumentLoaderCreateDocument(MSCDocumentLoader *loader);
+
+// Deletes an MSCDocumentLoader instance. Documents created by it are not
+// affected.
+void MSCDocumentLoaderDelete(MSCDocumentLoader *loader);
+
+// Fully parses data in a given MSCDocument and keeps the result, so that
+// subsequent renders don't parse the data again. Once this succeeds, the
+// data passed to MSCDocumentCreateFromData is no longer accessed and may be
+// released. Returns 1 on success and 0 if the data is not well-formed or
+// |document| is NULL. Calling it on a prepared document does nothing and
+// returns 1.
+int MSCDocumentPrepareForRendering(MSCDocument *document);
+
+// Serializes the fully parsed form of a given MSCDocument, preparing it for
+// rendering first if needed. The result can be stored, e.g., as a precompiled
+// asset, and loaded with MSCDocumentCreateFromSerializedData. On success,
+// returns 1 and sets |*data| to a buffer of |*length| bytes that the caller
+// is responsible for releasing with free(). Returns 0 if the data of the
+// document is not well-formed.
+int MSCDocumentCopySerializedData(MSCDocument *document,
+                                  char **data,
+                                  size_t *length);
+
+// Creates an MSCDocument instance from data produced by
+// MSCDocumentCopySerializedData, without any XML or text parsing. The data is
+// not accessed after this returns, so it can be a memory-mapped file that is
+// unmapped right away. Returns NULL if the data is corrupt or was produced by
+// a different version of the library. The returned instance must be deleted
+// with MSCDocumentDelete when it is done.
+MSCDocument *MSCDocumentCreateFromSerializedData(const char *data,
+                                                 size_t length);
+
+#if MSC_CORE_GRAPHICS_SUPPORT
+// Creates a CGImage from a given MSCDocument. Unless the document has been
+// prepared with MSCDocumentPrepareForRendering, its data is fully parsed.
 // The caller is responsible for releasing the returned object.
 // |style_sheet| can be NULL.
 CGImageRef MSCDocumentCreateCGImage(MSCDocument *document,
                                     CGSize canvas_size,
                                     const MSCStyleSheet *style_sheet);
 
+// Creates a CGImage of |canvas_size| from the part of a given MSCDocument
+// inside |source_rect|, e.g., one glyph of a sprite sheet. |source_rect| is
+// in the coordinates of the viewBox of the outermost svg element, or of its
+// width and height if it has no viewBox, and is scaled to fill the image.
+// Only that part of the document is rasterized. Returns NULL if the data is
+// not well-formed or |source_rect| is empty. The caller is responsible for
+// releasing the returned object. |style_sheet| can be NULL.
+CGImageRef MSCDocumentCreateCGImageFromRect(MSCDocument *document,
+                                            CGRect source_rect,
+                                            CGSize canvas_size,
+                                            const MSCStyleSheet *style_sheet);
+#endif  // MSC_CORE_GRAPHICS_SUPPORT
+
+// Pixel formats for MSCDocumentRenderToBuffer. All have 8 bits per channel
+// and premultiplied alpha. The names give the order of the channels in
+// memory.
+typedef enum {
+  kMSCPixelFormatRGBA8888,
+  kMSCPixelFormatBGRA8888,
+} MSCPixelFormat;
+
+// Renders a given MSCDocument into |pixels|, which is provided by the
+// caller, e.g., from a pool of texture upload buffers. No bitmap is
+// allocated or copied. Unless the document has been prepared with
+// MSCDocumentPrepareForRendering, its data is fully parsed. |pixels| must
+// hold the rows of the canvas, top row first, each row |bytes_per_row|
+// bytes apart; |bytes_per_row| must be at least 4 times the canvas width.
+// The previous contents of the canvas area are cleared. Returns 1 on
+// success and 0 if the data of the document is not well-formed or the
+// arguments are invalid. |style_sheet| can be NULL.
+int MSCDocumentRenderToBuffer(MSCDocument *document,
+                              MSCSize canvas_size,
+                              const MSCStyleSheet *style_sheet,
+                              void *pixels,
+                              size_t bytes_per_row,
+                              MSCPixelFormat format);
+
+// Receives a tile rendered by MSCDocumentRenderTiles. The tile covers
+// |width| x |height| pixels from (|x|, |y|) of the whole canvas, counted from
+// the top-left corner. |pixels| holds the tile as 8-bit RGBA with
+// premultiplied alpha, top row first, each row |bytes_per_row| bytes apart.
+// The pixels are only valid during the call.
+typedef void (*MSCDocumentTileCallback)(void *context,
+                                        size_t x,
+                                        size_t y,
+                                        size_t width,
+                                        size_t height,
+                                        const void *pixels,
+                                        size_t bytes_per_row);
+
+// Renders a given MSCDocument as MSCDocumentRenderToBuffer would at
+// |canvas_size|, but in tiles of |tile_size|, or smaller at the right and
+// bottom edges, so that memory use is bounded by the tile size rather than the
+// canvas size. Each tile is drawn with its own translation, so antialiased
+// edges and gradients may differ from a render of the whole canvas by a level
+// or two per channel. The document is prepared for rendering first, as with
+// MSCDocumentPrepareForRendering. Tiles are rendered in parallel on
+// |thread_count| threads including the calling one, or on as many threads as
+// there are CPUs if |thread_count| is 0. |callback| is called with |context|
+// for each tile as soon as it's rendered. The calls are made one at a time, but
+// from any of the threads and in no particular order. Returns 1 when all tiles
+// have been rendered and 0 if the data of the document is not well-formed, the
+// sizes are smaller than a pixel, or |document| or |callback| is NULL.
+// |style_sheet| can be NULL.
+int MSCDocumentRenderTiles(MSCDocument *document,
+                           MSCSize canvas_size,
+                           MSCSize tile_size,
+                           const MSCStyleSheet *style_sheet,
+                           size_t thread_count,
+                           MSCDocumentTileCallback callback,
+                           void *context);
+
 // Returns the image's intrinsic size as defined by "width" and "height"
 // attributes of the outermost svg element. If these attributes are not
 // specified, zero is assumed.
-CGSize MSCDocumentGetImageSize(const MSCDocument *document);
+MSCSize MSCDocumentGetImageSize(const MSCDocument *document);
 
 // Returns value of "viewBox" attribute of the outermost svg element. Returns
-// CGRectNull if the attribute is not specified.
-CGRect MSCDocumentGetImageViewBox(const MSCDocument *document);
+// a rectangle with an infinite origin, CGRectNull when CoreGraphics is
+// available, if the attribute is not specified.
+MSCRect MSCDocumentGetImageViewBox(const MSCDocument *document);
+
+// Rendering a prepared document with CoreGraphics keeps the paths built
+// for its path, polygon and polyline elements until the document is
+// deleted, so that later renders, at any size and with any style sheet,
+// don't build them again. Sets the estimated number of bytes that the kept
+// paths of all documents may take, 4 MB by default. When keeping another
+// path would take more, all the kept paths are dropped first. A limit of 0
+// turns keeping paths off. Without CoreGraphics, paths are never kept.
+void MSCSetPathCacheByteLimit(size_t byte_limit);
+
+// Returns the estimated number of bytes taken by the kept paths of all
+// documents.
+size_t MSCGetPathCacheByteSize(void);
+
+// Backends that MSCDocumentRenderToBuffer and MSCDocumentRenderTiles render
+// with.
+typedef enum {
+  // CoreGraphics when it's available, the software renderer otherwise.
+  kMSCRenderingBackendDefault,
+  // The built-in software renderer, which doesn't depend on any graphics
+  // library.
+  kMSCRenderingBackendSoftware,
+} MSCRenderingBackend;
+
+// Sets the backend of MSCDocumentRenderToBuffer and MSCDocumentRenderTiles,
+// kMSCRenderingBackendDefault by default. CGImages are always rendered with
+// CoreGraphics. The backends antialias edges differently, so their pixels
+// can differ slightly. Renders that have already started are not affected.
+void MSCSetRenderingBackend(MSCRenderingBackend backend);
 
 #if defined __cplusplus
 }  // extern "C"
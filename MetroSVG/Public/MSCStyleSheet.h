@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 #if defined __cplusplus
 extern "C" {
 #endif
@@ -35,7 +35,22 @@
 // partially parsed to populate the receiver's properties.
 - (instancetype)initWithData:(NSData *)data;
 
-// Fully parses the data and renders it into a UIImage. The returned image
+// Initializes the receiver with data returned by -serializedData. No parsing
+// is involved. Returns nil if the data is corrupt or was produced by a
+// different version of the library.
+- (instancetype)initWithSerializedData:(NSData *)data;
+
+// Returns the fully parsed form of the document, which can be stored and
+// loaded later with -initWithSerializedData:. Returns nil if the data is not
+// well-formed.
+- (NSData *)serializedData;
+
+// Fully parses the data once so that subsequent renderings don't parse it
+// again. Returns NO if the data is not well-formed.
+- (BOOL)prepareForRendering;
+
+// Renders the document into a UIImage, fully parsing the data unless the
+// receiver has been prepared for rendering. The returned image
 // has the appropriate density for the screen scale.
 - (UIImage *)imageWithSize:(CGSize)size;
 
@@ -34,11 +34,36 @@
   return self;
 }
 
+- (instancetype)initWithSerializedData:(NSData *)data {
+  self = [super init];
+  if (self) {
+    _document = MSCDocumentCreateFromSerializedData(
+        reinterpret_cast<const char *>(data.bytes), data.length);
+    if (!_document) {
+      return nil;
+    }
+  }
+  return self;
+}
+
 - (void)dealloc {
   MSCDocumentDelete(_document);
   _document = NULL;
 }
 
+- (NSData *)serializedData {
+  char *data = NULL;
+  size_t length = 0;
+  if (!MSCDocumentCopySerializedData(_document, &data, &length)) {
+    return nil;
+  }
+  return [NSData dataWithBytesNoCopy:data length:length freeWhenDone:YES];
+}
+
+- (BOOL)prepareForRendering {
+  return MSCDocumentPrepareForRendering(_document) != 0;
+}
+
 - (CGSize)size {
   return MSCDocumentGetImageSize(_document);
 }